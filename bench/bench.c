@@ -0,0 +1,1067 @@
+/* bench/bench.c */
+
+/*************************************************************
+ * Benchmark harness for the MLC kernels.
+ *
+ * Every benchmark runs a kernel over a range of sizes, from
+ * L1-resident to DRAM-sized. Each measurement does one warm-up
+ * call, calibrates the number of calls per sample so a sample
+ * lasts at least --min-ms, and reports the median over --reps
+ * samples as ns/element, GB/s (nominal bytes read + written)
+ * and GFLOP/s (for kernels with a well-defined flop count).
+ *
+ * Usage (also through `make bench BENCH_ARGS="..."`):
+ *
+ *   mlc_bench [--format text|csv|json] [--filter substr]
+ *             [--reps N] [--min-ms MS] [--max-size ELEMS]
+ *             [--threads N] [--cpu scalar|sse2|avx2|avx512]
+ *
+ * --cpu (or the MLC_CPU_LEVEL environment variable) forces the
+ * kernel level (dispatch.h), to compare levels on one host.
+ *
+ * Activations run in place on the same buffer call after call;
+ * the data drifts but stays finite, which is enough for timing.
+ * CSV and JSON output are meant to be saved per commit and
+ * compared between them.
+ *************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <mlc/data.h>
+#include <mlc/activations.h>
+#include <mlc/vector.h>
+#include <mlc/matrix.h>
+#include <mlc/pipeline.h>
+#include <mlc/io.h>
+#include <mlc/csv_stream.h>
+#include <mlc/quant.h>
+#include <mlc/layers.h>
+#include <mlc/optim.h>
+#include <mlc/train.h>
+#include <mlc/sparse.h>
+#include <mlc/csv.h>
+#include <mlc/stats.h>
+#include <mlc/loader.h>
+#include <mlc/sampler.h>
+#include <mlc/conv.h>
+#include <mlc/kmeans.h>
+
+typedef enum
+{
+    BENCH_TEXT,
+    BENCH_CSV,
+    BENCH_JSON
+}
+BenchFormat;
+
+typedef struct
+{
+    BenchFormat format;
+    const char * filter;
+    size_t reps;
+    double min_seconds;
+    size_t max_size;
+    size_t results;     /* rows printed so far (JSON separators) */
+}
+BenchConfig;
+
+/* Operands shared by the kernel thunks */
+typedef struct
+{
+    MlcArray a;
+    MlcArray b;
+    MlcArray out;
+    MlcChain chain;
+    MlcQuantArray qa;
+    MlcQuantArray qb;
+    MlcMlp mlp;
+    MlcOptimizer optim;
+    MlcOptimState state;
+    MlcTrainer trainer;
+    MlcSparse sparse;
+    MlcCsvOptions csv;
+    MlcColumnStats stats;
+    MlcSampler sampler;
+    MlcConv2d conv;
+    MlcPool2d pool;
+    MlcKMeansOptions kmeans;
+    void * raw;
+    DataType raw_type;
+    const char * path;
+    float scalar;
+}
+BenchData;
+
+typedef void (*BenchFn)(BenchData * data);
+
+static double
+bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int
+bench_compare(const void * x, const void * y)
+{
+    double a = *(const double *)x;
+    double b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static int
+bench_selected(const BenchConfig * config, const char * name)
+{
+    return config->filter == NULL || strstr(name, config->filter) != NULL;
+}
+
+/**********************************
+ * Times fn(data) and prints one result row.
+ *
+ *  - elements: work items, for ns/element.
+ *  - bytes: nominal bytes moved per call, for GB/s.
+ *  - flops: floating point operations per call (0 = not reported).
+ **********************************/
+static void
+bench_measure(BenchConfig * config, const char * name, size_t size,
+              size_t elements, double bytes, double flops,
+              BenchFn fn, BenchData * data)
+{
+    double samples[64];
+    size_t reps = (config->reps > 64) ? 64 : config->reps;
+    size_t calls = 1;
+
+    /* Warm-up: faults pages in, starts the thread pool */
+    fn(data);
+
+    /* Calibrate calls per sample */
+    for (;;) {
+        double start = bench_now();
+        for (size_t c = 0; c < calls; ++c) fn(data);
+        double elapsed = bench_now() - start;
+
+        if (elapsed >= config->min_seconds || calls >= ((size_t)1 << 30)) break;
+        calls *= (elapsed > 0.0 && config->min_seconds / elapsed < 10.0) ? 2 : 10;
+    }
+    for (size_t r = 0; r < reps; ++r) {
+        double start = bench_now();
+        for (size_t c = 0; c < calls; ++c) fn(data);
+        samples[r] = (bench_now() - start) / (double)calls;
+    }
+    qsort(samples, reps, sizeof(double), bench_compare);
+
+    double median = (reps % 2) ? samples[reps / 2]
+                               : 0.5 * (samples[reps / 2 - 1] + samples[reps / 2]);
+    double ns_per_elem = median * 1e9 / (double)elements;
+    double gbps = bytes / median * 1e-9;
+    double gflops = flops / median * 1e-9;
+
+    switch (config->format)
+    {
+        case BENCH_CSV:
+            printf("%s,%zu,%zu,%.1f,%.4f,%.3f,%.3f\n",
+                   name, size, elements, median * 1e9, ns_per_elem, gbps, gflops);
+            break;
+        case BENCH_JSON:
+            printf("%s\n  {\"kernel\": \"%s\", \"size\": %zu, \"elements\": %zu, "
+                   "\"median_ns\": %.1f, \"ns_per_elem\": %.4f, \"gb_per_s\": %.3f, "
+                   "\"gflop_per_s\": %.3f}",
+                   config->results ? "," : "", name, size, elements,
+                   median * 1e9, ns_per_elem, gbps, gflops);
+            break;
+        case BENCH_TEXT:
+        default:
+            if (flops > 0.0) {
+                printf("%-22s %10zu %12.3f %10.2f %10.2f %12.3f\n",
+                       name, size, ns_per_elem, gbps, gflops, median * 1e3);
+            }
+            else {
+                printf("%-22s %10zu %12.3f %10.2f %10s %12.3f\n",
+                       name, size, ns_per_elem, gbps, "-", median * 1e3);
+            }
+            break;
+    }
+    config->results++;
+    fflush(stdout);
+}
+
+/* Deterministic inputs in [-4, 4) */
+static void
+bench_fill(float * x, size_t n, unsigned seed)
+{
+    unsigned state = seed * 2654435761u + 1u;
+
+    for (size_t i = 0; i < n; ++i) {
+        state = state * 1664525u + 1013904223u;
+        x[i] = (float)(state >> 8) * (8.0f / 16777216.0f) - 4.0f;
+    }
+}
+
+static MlcArray
+bench_array(size_t ndims, size_t * shape, unsigned seed)
+{
+    size_t size = 1;
+    for (size_t i = 0; i < ndims; ++i) size *= shape[i];
+
+    float * values = (float *)malloc(size * sizeof(float));
+    if (values == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    bench_fill(values, size, seed);
+
+    MlcArray array = prepare_data(values, ndims, shape, TYPE_FLOAT);
+    free(values);
+    if (array.data == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(1);
+    }
+    return array;
+}
+
+/**********************************
+ * Kernel thunks
+ **********************************/
+static void run_relu(BenchData * d)       { relu(&d->a); }
+static void run_sigmoid(BenchData * d)    { sigmoid(&d->a); }
+static void run_tanh(BenchData * d)       { tanh_(&d->a); }
+static void run_leaky_relu(BenchData * d) { leaky_relu(&d->a, 0.01f); }
+static void run_softmax(BenchData * d)    { softmax(&d->a); }
+static void run_swish(BenchData * d)      { swish(&d->a); }
+static void run_add(BenchData * d)        { vector_add(&d->a, &d->b, &d->out); }
+static void run_sub(BenchData * d)        { vector_sub(&d->a, &d->b, &d->out); }
+static void run_scale(BenchData * d)      { vector_scale(&d->a, 0.5f, &d->out); }
+static void run_dot(BenchData * d)        { d->scalar += vector_dot(&d->a, &d->b); }
+static void run_chain(BenchData * d)      { mlc_chain_run(&d->chain, &d->a); }
+static void run_gemm(BenchData * d)       { matrix_mult(&d->a, &d->b, &d->out); }
+static void run_gemv(BenchData * d)       { matrix_vector_mult(&d->a, &d->b, &d->out); }
+static void run_qdot(BenchData * d)       { d->scalar += mlc_quant_dot(&d->qa, &d->qb); }
+static void run_qgemv(BenchData * d)      { mlc_quant_matvec(&d->qa, &d->qb, &d->out); }
+static void run_mlp(BenchData * d)        { mlc_mlp_forward(&d->mlp, &d->a, &d->out); }
+static void run_optim(BenchData * d)      { mlc_optim_update(&d->optim, &d->state, &d->a, &d->b); }
+static void run_spmv(BenchData * d)       { mlc_spmv(&d->sparse, &d->b, &d->out); }
+static void run_spmm(BenchData * d)       { mlc_spmm(&d->sparse, &d->b, &d->out); }
+static void run_train(BenchData * d)      { d->scalar += mlc_train_step(&d->trainer, &d->a, &d->out); }
+static void run_fit_normalize(BenchData * d) { mlc_fit_normalize(&d->a, NULL, MLC_NORM_ZSCORE); }
+static void run_conv2d(BenchData * d)     { mlc_conv2d(&d->a, &d->b, NULL, &d->conv, &d->out); }
+static void run_max_pool(BenchData * d)   { mlc_max_pool2d(&d->a, &d->pool, &d->out); }
+
+static void
+run_kmeans(BenchData * d)
+{
+    MlcKMeans model;
+
+    mlc_kmeans(&d->a, &d->kmeans, &model);
+    d->scalar += (float)model.inertia;
+    mlc_kmeans_finish(&model);
+}
+
+/* One shuffled epoch of 256-row batches */
+static void
+run_gather(BenchData * d)
+{
+    while (mlc_sampler_next(&d->sampler) > 0) {
+        mlc_sampler_gather(&d->sampler, &d->a, &d->out);
+    }
+}
+
+static void
+run_stats(BenchData * d)
+{
+    mlc_stats_reset(&d->stats);
+    mlc_stats_update(&d->stats, &d->a);
+}
+
+/* Fresh upstream gradient in d->out: repeated in-place backward
+ * passes would shrink it into denormals. The copy is counted in
+ * the bytes of the backward rows. */
+static MlcArray *
+bench_grad(BenchData * d)
+{
+    memcpy(d->out.data, d->b.data, d->b.size * sizeof(float));
+    return &d->out;
+}
+
+static void run_relu_bwd(BenchData * d)    { relu_backward(&d->a, bench_grad(d)); }
+static void run_sigmoid_bwd(BenchData * d) { sigmoid_backward(&d->a, bench_grad(d)); }
+static void run_softmax_bwd(BenchData * d) { softmax_backward(&d->a, bench_grad(d)); }
+static void run_swish_bwd(BenchData * d)   { swish_backward(&d->a, bench_grad(d)); }
+
+static void
+run_quantize(BenchData * d)
+{
+    MlcQuantArray q = mlc_quantize(&d->a, MLC_QUANT_ASYMMETRIC, MLC_QUANT_PER_TENSOR);
+    d->scalar += q.scales[0];
+    mlc_quant_finish(&q);
+}
+
+static void
+run_prepare(BenchData * d)
+{
+    MlcArray array = prepare_data(d->raw, 1, &d->a.size, d->raw_type);
+
+    /* use the result, or the compiler may drop malloc/convert/free */
+    d->scalar += array.data[array.size - 1];
+    mlc_finish(&array);
+}
+
+static void
+run_prepare_into(BenchData * d)
+{
+    prepare_data_into(d->raw, d->raw_type, &d->out);
+    d->scalar += d->out.data[d->out.size - 1];
+}
+
+static void
+run_read_csv(BenchData * d)
+{
+    MlcArray array = mlc_read_csv(d->path);
+    d->scalar += array.data[array.size - 1];
+    mlc_finish(&array);
+}
+
+static void
+run_read_csv_with(BenchData * d)
+{
+    MlcArray array = mlc_read_csv_with(d->path, &d->csv);
+    d->scalar += array.data[array.size - 1];
+    mlc_finish(&array);
+}
+
+static void
+run_csv_stream(BenchData * d)
+{
+    MlcCsvReader * reader = mlc_csv_open(d->path);
+
+    while (mlc_csv_next_batch(reader, 256, &d->out) > 0) {
+        d->scalar += d->out.data[0];
+    }
+    mlc_csv_close(reader);
+}
+
+/* One epoch of 256-row batches, loaded by the loader thread */
+static void
+run_loader(BenchData * d)
+{
+    MlcLoaderOptions options = mlc_loader_options(256);
+    MlcLoader * loader = mlc_loader_open_csv(d->path, &options);
+    MlcArray * batch;
+
+    while (mlc_loader_next(loader, &batch) > 0) {
+        d->scalar += batch->data[0];
+    }
+    mlc_loader_close(loader);
+}
+
+static void
+run_load_mmap(BenchData * d)
+{
+    MlcArray array = mlc_load_mmap(d->path, MLC_MAP_READONLY);
+    volatile float sink = 0.0f;
+
+    /* touch one value per page so the mapping is actually read */
+    for (size_t i = 0; i < array.size; i += 1024) sink += array.data[i];
+    (void)sink;
+    mlc_finish(&array);
+}
+
+/**********************************
+ * Benchmarks: each sweeps its sizes and measures.
+ **********************************/
+typedef struct
+{
+    const char * name;
+    BenchFn fn;
+    double bytes_per_elem;
+    double flops_per_elem;
+    MlcDtype dtype;         /* storage of the operands */
+}
+BenchElementwise;
+
+static const BenchElementwise bench_elementwise[] = {
+    {"relu",        run_relu,        8.0,  1.0, MLC_DTYPE_F32},
+    {"sigmoid",     run_sigmoid,     8.0,  0.0, MLC_DTYPE_F32},
+    {"tanh_",       run_tanh,        8.0,  0.0, MLC_DTYPE_F32},
+    {"leaky_relu",  run_leaky_relu,  8.0,  2.0, MLC_DTYPE_F32},
+    {"softmax",     run_softmax,     16.0, 0.0, MLC_DTYPE_F32},
+    {"swish",       run_swish,       8.0,  0.0, MLC_DTYPE_F32},
+    {"relu_backward", run_relu_bwd,  20.0, 1.0, MLC_DTYPE_F32},
+    {"sigmoid_backward", run_sigmoid_bwd, 20.0, 3.0, MLC_DTYPE_F32},
+    {"softmax_backward", run_softmax_bwd, 28.0, 4.0, MLC_DTYPE_F32},
+    {"swish_backward", run_swish_bwd, 20.0, 0.0, MLC_DTYPE_F32},
+    {"vector_add",  run_add,         12.0, 1.0, MLC_DTYPE_F32},
+    {"vector_sub",  run_sub,         12.0, 1.0, MLC_DTYPE_F32},
+    {"vector_scale", run_scale,      8.0,  1.0, MLC_DTYPE_F32},
+    {"vector_dot",  run_dot,         8.0,  2.0, MLC_DTYPE_F32},
+    {"chain_4ops",  run_chain,       8.0,  0.0, MLC_DTYPE_F32},
+    {"relu_f16",    run_relu,        4.0,  1.0, MLC_DTYPE_F16},
+    {"sigmoid_f16", run_sigmoid,     4.0,  0.0, MLC_DTYPE_F16},
+    {"vector_add_f16", run_add,      6.0,  1.0, MLC_DTYPE_F16},
+    {"vector_dot_f16", run_dot,      4.0,  2.0, MLC_DTYPE_F16},
+    {"relu_bf16",   run_relu,        4.0,  1.0, MLC_DTYPE_BF16},
+    {"vector_add_bf16", run_add,     6.0,  1.0, MLC_DTYPE_BF16},
+};
+
+/* Operand of n elements stored as `dtype` */
+static MlcArray
+bench_operand(size_t n, unsigned seed, MlcDtype dtype)
+{
+    MlcArray array = bench_array(1, &n, seed);
+
+    if (dtype != MLC_DTYPE_F32) {
+        MlcArray narrow = mlc_cast(&array, dtype);
+        mlc_finish(&array);
+        if (narrow.data == NULL) {
+            fprintf(stderr, "bench: out of memory\n");
+            exit(1);
+        }
+        array = narrow;
+    }
+    return array;
+}
+
+static void
+bench_run_elementwise(BenchConfig * config)
+{
+    size_t count = sizeof(bench_elementwise) / sizeof(bench_elementwise[0]);
+
+    for (size_t k = 0; k < count; ++k) {
+        const BenchElementwise * b = &bench_elementwise[k];
+        if (!bench_selected(config, b->name)) continue;
+
+        for (size_t n = 1024; n <= config->max_size; n *= 4) {
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_operand(n, 1, b->dtype);
+            data.b = bench_operand(n, 2, b->dtype);
+            data.out = bench_operand(n, 3, b->dtype);
+
+            mlc_chain_init(&data.chain);
+            mlc_chain_push(&data.chain, MLC_OP_SCALE, 0.5f);
+            mlc_chain_push(&data.chain, MLC_OP_ADD, 0.1f);
+            mlc_chain_push(&data.chain, MLC_OP_LEAKY_RELU, 0.01f);
+            mlc_chain_push(&data.chain, MLC_OP_SIGMOID, 0.0f);
+
+            bench_measure(config, b->name, n, n, b->bytes_per_elem * (double)n,
+                          b->flops_per_elem * (double)n, b->fn, &data);
+
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+}
+
+static void
+bench_run_prepare(BenchConfig * config)
+{
+    static const struct {
+        const char * name; DataType type; size_t width; void (*fn)(BenchData *);
+    } kinds[] = {
+        {"prepare_data_int",    TYPE_INT,    sizeof(int),    run_prepare},
+        {"prepare_data_float",  TYPE_FLOAT,  sizeof(float),  run_prepare},
+        {"prepare_data_double", TYPE_DOUBLE, sizeof(double), run_prepare},
+        {"prepare_into_int",    TYPE_INT,    sizeof(int),    run_prepare_into},
+        {"prepare_into_double", TYPE_DOUBLE, sizeof(double), run_prepare_into},
+    };
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); ++k) {
+        if (!bench_selected(config, kinds[k].name)) continue;
+
+        for (size_t n = 1024; n <= config->max_size; n *= 4) {
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.raw = calloc(n, kinds[k].width);
+            data.raw_type = kinds[k].type;
+            data.a.size = n;
+            if (data.raw == NULL) {
+                fprintf(stderr, "bench: out of memory\n");
+                exit(1);
+            }
+            if (kinds[k].fn == run_prepare_into) {
+                data.out = bench_array(1, &n, 3);
+            }
+            bench_measure(config, kinds[k].name, n, n,
+                          (double)(kinds[k].width + sizeof(float)) * (double)n, 0.0,
+                          kinds[k].fn, &data);
+            mlc_finish(&data.out);
+            free(data.raw);
+        }
+    }
+}
+
+/* Writes a rows x 16 CSV of random values; returns its size in bytes */
+static size_t
+bench_write_csv(const char * path, size_t elements)
+{
+    FILE * file = fopen(path, "w");
+    size_t cols = 16;
+    unsigned state = 12345u;
+
+    if (file == NULL) {
+        fprintf(stderr, "bench: cannot write %s\n", path);
+        exit(1);
+    }
+    for (size_t i = 0; i < elements; ++i) {
+        state = state * 1664525u + 1013904223u;
+        fprintf(file, "%.4f%c", (float)(state >> 8) * (8.0f / 16777216.0f) - 4.0f,
+                (i % cols == cols - 1) ? '\n' : ',');
+    }
+    fclose(file);
+
+    struct stat st;
+    return (stat(path, &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+static void
+bench_run_files(BenchConfig * config)
+{
+    int want_csv = bench_selected(config, "mlc_read_csv");
+    int want_project = bench_selected(config, "mlc_read_csv_with");
+    int want_stream = bench_selected(config, "mlc_csv_next_batch");
+    int want_loader = bench_selected(config, "mlc_loader_next");
+    int want_mmap = bench_selected(config, "mlc_load_mmap");
+    char path[64];
+
+    if (!want_csv && !want_project && !want_stream && !want_loader && !want_mmap) return;
+
+    for (size_t n = 16384; n <= config->max_size; n *= 4) {
+        BenchData data;
+        memset(&data, 0, sizeof(data));
+        data.path = path;
+
+        snprintf(path, sizeof(path), "/tmp/mlc_bench_%ld.csv", (long)getpid());
+        size_t bytes = bench_write_csv(path, n);
+
+        if (want_csv) {
+            bench_measure(config, "mlc_read_csv", n, n, (double)(bytes + n * sizeof(float)),
+                          0.0, run_read_csv, &data);
+        }
+        if (want_project) {
+            /* Projection: 2 of the 16 columns, the rest of each line skipped */
+            static const size_t keep[] = {0, 5};
+            data.csv = mlc_csv_options();
+            data.csv.indices = keep;
+            data.csv.index_count = 2;
+            bench_measure(config, "mlc_read_csv_with", n, n, (double)(bytes + n / 8 * sizeof(float)),
+                          0.0, run_read_csv_with, &data);
+        }
+        if (want_stream) {
+            /* 256-row batches into one reused array */
+            data.out.ndims = 2;
+            bench_measure(config, "mlc_csv_next_batch", n, n, (double)(bytes + n * sizeof(float)),
+                          0.0, run_csv_stream, &data);
+            mlc_finish(&data.out);
+        }
+        if (want_loader) {
+            bench_measure(config, "mlc_loader_next", n, n, (double)(bytes + n * sizeof(float)),
+                          0.0, run_loader, &data);
+        }
+        if (want_mmap) {
+            MlcArray array = mlc_read_csv(path);
+            remove(path);
+            snprintf(path, sizeof(path), "/tmp/mlc_bench_%ld.mlct", (long)getpid());
+            mlc_save(path, &array);
+            mlc_finish(&array);
+            bench_measure(config, "mlc_load_mmap", n, n, (double)(n * sizeof(float)),
+                          0.0, run_load_mmap, &data);
+        }
+        remove(path);
+    }
+}
+
+static void
+bench_run_matrix(BenchConfig * config)
+{
+    if (bench_selected(config, "matrix_mult")) {
+        for (size_t dim = 32; dim * dim <= config->max_size && dim <= 2048; dim *= 2) {
+            size_t shape[2] = {dim, dim};
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_array(2, shape, 1);
+            data.b = bench_array(2, shape, 2);
+            data.out = bench_array(2, shape, 3);
+
+            double d = (double)dim;
+            bench_measure(config, "matrix_mult", dim, dim * dim, 12.0 * d * d,
+                          2.0 * d * d * d, run_gemm, &data);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+    if (bench_selected(config, "matrix_vector_mult")) {
+        for (size_t dim = 32; dim * dim <= config->max_size && dim <= 8192; dim *= 2) {
+            size_t shape[2] = {dim, dim};
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_array(2, shape, 1);
+            data.b = bench_array(1, &dim, 2);
+            data.out = bench_array(1, &dim, 3);
+
+            double d = (double)dim;
+            bench_measure(config, "matrix_vector_mult", dim, dim * dim, 4.0 * (d * d + 2.0 * d),
+                          2.0 * d * d, run_gemv, &data);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+}
+
+static void
+bench_run_quant(BenchConfig * config)
+{
+    if (bench_selected(config, "mlc_quantize") || bench_selected(config, "quant_dot")) {
+        for (size_t n = 1024; n <= config->max_size; n *= 4) {
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_array(1, &n, 1);
+            data.b = bench_array(1, &n, 2);
+            data.qa = mlc_quantize(&data.a, MLC_QUANT_SYMMETRIC, MLC_QUANT_PER_TENSOR);
+            data.qb = mlc_quantize(&data.b, MLC_QUANT_ASYMMETRIC, MLC_QUANT_PER_TENSOR);
+
+            if (bench_selected(config, "mlc_quantize")) {
+                bench_measure(config, "mlc_quantize", n, n, 5.0 * (double)n, 0.0,
+                              run_quantize, &data);
+            }
+            if (bench_selected(config, "quant_dot")) {
+                bench_measure(config, "quant_dot", n, n, 2.0 * (double)n, 2.0 * (double)n,
+                              run_qdot, &data);
+            }
+            mlc_quant_finish(&data.qa);
+            mlc_quant_finish(&data.qb);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+        }
+    }
+    if (bench_selected(config, "quant_matvec")) {
+        for (size_t dim = 32; dim * dim <= config->max_size && dim <= 8192; dim *= 2) {
+            size_t shape[2] = {dim, dim};
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_array(2, shape, 1);
+            data.b = bench_array(1, &dim, 2);
+            data.out = bench_array(1, &dim, 3);
+            data.qa = mlc_quantize(&data.a, MLC_QUANT_SYMMETRIC, MLC_QUANT_PER_ROW);
+            data.qb = mlc_quantize(&data.b, MLC_QUANT_ASYMMETRIC, MLC_QUANT_PER_TENSOR);
+
+            double d = (double)dim;
+            bench_measure(config, "quant_matvec", dim, dim * dim, d * d + 6.0 * d,
+                          2.0 * d * d, run_qgemv, &data);
+            mlc_quant_finish(&data.qa);
+            mlc_quant_finish(&data.qb);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+}
+
+/* 256-256-256-10 MLP (relu, relu, softmax), batches of 1 to 256 rows */
+static void
+bench_run_mlp(BenchConfig * config)
+{
+    if (!bench_selected(config, "mlp_forward")) return;
+
+    size_t dims[] = {256, 256, 256, 10};
+    double weights = 0.0, flops = 0.0;
+    BenchData data;
+    memset(&data, 0, sizeof(data));
+    mlc_mlp_init(&data.mlp, 256);
+
+    for (size_t l = 0; l < 3; ++l) {
+        size_t shape[2] = {dims[l], dims[l + 1]};
+        MlcArray w = bench_array(2, shape, (unsigned)(10 + l));
+
+        /* keep activations in range across layers */
+        for (size_t i = 0; i < w.size; ++i) w.data[i] *= 0.02f;
+        mlc_mlp_add(&data.mlp, &w, NULL, (l == 2) ? MLC_ACT_SOFTMAX : MLC_ACT_RELU, 0.0f);
+        mlc_finish(&w);
+        weights += (double)(dims[l] * dims[l + 1]);
+    }
+    flops = 2.0 * weights;
+
+    for (size_t batch = 1; batch <= 256; batch *= 4) {
+        size_t in_shape[2] = {batch, dims[0]};
+        size_t out_shape[2] = {batch, dims[3]};
+        double b = (double)batch;
+
+        data.a = bench_array(2, in_shape, 1);
+        data.out = bench_array(2, out_shape, 2);
+        bench_measure(config, "mlp_forward", batch, batch,
+                      4.0 * (weights + b * (double)(dims[0] + dims[3])), b * flops,
+                      run_mlp, &data);
+        mlc_finish(&data.a);
+        mlc_finish(&data.out);
+    }
+    mlc_mlp_finish(&data.mlp);
+}
+
+/* CSR matrix with 40 nonzeros per row over 4000 columns (1% dense) */
+static MlcSparse
+bench_sparse(size_t nnz, MlcSparseFormat format)
+{
+    size_t per_row = 40, cols = 4000, rows = nnz / per_row;
+    MlcSparse a = mlc_sparse_alloc_(MLC_SPARSE_CSR, rows, cols, rows * per_row);
+    unsigned state = 777u;
+
+    if (a.indptr == NULL) exit(1);
+    for (size_t r = 0; r <= rows; ++r) {
+        a.indptr[r] = r * per_row;
+    }
+    for (size_t k = 0; k < a.nnz; ++k) {
+        state = state * 1664525u + 1013904223u;
+        a.indices[k] = (uint32_t)((k % per_row) * (cols / per_row) + (state >> 8) % (cols / per_row));
+        a.values[k] = (float)(state >> 8) * (1.0f / 16777216.0f) - 0.5f;
+    }
+    if (format == MLC_SPARSE_CSC) {
+        MlcSparse csc = mlc_sparse_convert(&a, MLC_SPARSE_CSC);
+        mlc_sparse_finish(&a);
+        a = csc;
+    }
+    return a;
+}
+
+/* SpMV and SpMM (32 columns) over 1%-dense matrices, sized by nnz */
+static void
+bench_run_sparse(BenchConfig * config)
+{
+    static const struct {
+        const char * name; MlcSparseFormat format; size_t n;
+    } cases[] = {
+        {"spmv_csr", MLC_SPARSE_CSR, 1},
+        {"spmv_csc", MLC_SPARSE_CSC, 1},
+        {"spmm_csr", MLC_SPARSE_CSR, 32},
+        {"spmm_csc", MLC_SPARSE_CSC, 32},
+    };
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+        if (!bench_selected(config, cases[k].name)) continue;
+
+        for (size_t nnz = 16384; nnz <= config->max_size; nnz *= 4) {
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.sparse = bench_sparse(nnz, cases[k].format);
+
+            size_t n = cases[k].n;
+            size_t b_shape[2] = {data.sparse.cols, n};
+            size_t out_shape[2] = {data.sparse.rows, n};
+            data.b = bench_array(n > 1 ? 2 : 1, b_shape, 1);
+            data.out = bench_array(n > 1 ? 2 : 1, out_shape, 2);
+
+            /* values and indices, plus the dense operand row read and output row written per nonzero */
+            bench_measure(config, cases[k].name, nnz, nnz,
+                          (double)nnz * (8.0 + 8.0 * (double)n), 2.0 * (double)nnz * (double)n,
+                          n > 1 ? run_spmm : run_spmv, &data);
+
+            mlc_sparse_finish(&data.sparse);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+}
+
+/* Fused optimizer updates; params in a, gradients in b */
+static void
+bench_run_optim(BenchConfig * config)
+{
+    static const struct {
+        const char * name; MlcOptimizer opt; double bytes; double flops;
+    } cases[] = {
+        {"optim_sgd",      {MLC_OPTIM_SGD, 1e-3f, 0.0f, 0.0f, 0.0f, 1e-4f},            12.0, 3.0},
+        {"optim_momentum", {MLC_OPTIM_MOMENTUM, 1e-3f, 0.9f, 0.0f, 0.0f, 1e-4f},       20.0, 6.0},
+        {"optim_adam",     {MLC_OPTIM_ADAM, 1e-3f, 0.9f, 0.999f, 1e-8f, 1e-4f},        28.0, 12.0},
+    };
+
+    for (size_t k = 0; k < sizeof(cases) / sizeof(cases[0]); ++k) {
+        if (!bench_selected(config, cases[k].name)) continue;
+
+        for (size_t n = 1024; n <= config->max_size; n *= 4) {
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_operand(n, 1, MLC_DTYPE_F32);
+            data.b = bench_operand(n, 2, MLC_DTYPE_F32);
+            data.optim = cases[k].opt;
+            if (mlc_optim_state_init(&data.state, &data.optim, n) != 0) exit(1);
+
+            bench_measure(config, cases[k].name, n, n, cases[k].bytes * (double)n,
+                          cases[k].flops * (double)n, run_optim, &data);
+
+            mlc_optim_state_finish(&data.state);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+        }
+    }
+}
+
+/* Column statistics and z-score normalization of an (n / 32 x 32) matrix */
+static void
+bench_run_stats(BenchConfig * config)
+{
+    int want_stats = bench_selected(config, "stats_update");
+    int want_norm = bench_selected(config, "fit_normalize");
+
+    if (!want_stats && !want_norm) return;
+
+    for (size_t n = 16384; n <= config->max_size; n *= 4) {
+        size_t shape[2] = {n / 32, 32};
+        BenchData data;
+        memset(&data, 0, sizeof(data));
+        data.a = bench_array(2, shape, 1);
+
+        if (want_stats) {
+            mlc_stats_init(&data.stats, 32);
+            bench_measure(config, "stats_update", n, n, 4.0 * (double)n, 0.0, run_stats, &data);
+            mlc_stats_finish(&data.stats);
+        }
+        /* The first call standardizes the data; later ones refit and rescale it unchanged */
+        if (want_norm) {
+            bench_measure(config, "fit_normalize", n, n, 12.0 * (double)n, 0.0,
+                          run_fit_normalize, &data);
+        }
+        mlc_finish(&data.a);
+    }
+}
+
+/* Shuffled mini-batch gathers of (n / 16 x 16) rows; the epoch's reshuffle is included */
+static void
+bench_run_gather(BenchConfig * config)
+{
+    if (!bench_selected(config, "gather_rows")) return;
+
+    for (size_t n = 16384; n <= config->max_size; n *= 4) {
+        size_t shape[2] = {n / 16, 16};
+        BenchData data;
+        memset(&data, 0, sizeof(data));
+        data.a = bench_array(2, shape, 1);
+        data.out.ndims = 2;
+        mlc_sampler_init(&data.sampler, n / 16, 256, MLC_SAMPLE_SHUFFLE, NULL, 1);
+
+        bench_measure(config, "gather_rows", n, n, 8.0 * (double)n, 0.0, run_gather, &data);
+        mlc_sampler_finish(&data.sampler);
+        mlc_finish(&data.a);
+        mlc_finish(&data.out);
+    }
+}
+
+/* 3x3 convolutions, 8 images of 16 -> 32 channels, both paths; then 2x2 max pooling */
+static void
+bench_run_conv(BenchConfig * config)
+{
+    static const struct { const char * name; MlcConvAlgo algo; } paths[] = {
+        {"conv2d_im2col", MLC_CONV_IM2COL},
+        {"conv2d_direct", MLC_CONV_DIRECT},
+    };
+
+    for (size_t k = 0; k < 2; ++k) {
+        if (!bench_selected(config, paths[k].name)) continue;
+
+        for (size_t side = 16; side <= 64 && 8 * 16 * side * side <= config->max_size; side *= 2) {
+            size_t in_shape[4] = {8, 16, side, side};
+            size_t w_shape[4] = {32, 16, 3, 3};
+            size_t out_shape[4] = {8, 32, side, side};
+            size_t n = 8 * 32 * side * side;
+            BenchData data;
+            memset(&data, 0, sizeof(data));
+            data.a = bench_array(4, in_shape, 1);
+            data.b = bench_array(4, w_shape, 2);
+            data.out = bench_array(4, out_shape, 3);
+            data.conv = mlc_conv2d_params(1, 1, 1);
+            data.conv.algo = paths[k].algo;
+
+            bench_measure(config, paths[k].name, n, n,
+                          4.0 * (double)(data.a.size + data.b.size + n),
+                          2.0 * (double)n * 16.0 * 9.0, run_conv2d, &data);
+            mlc_finish(&data.a);
+            mlc_finish(&data.b);
+            mlc_finish(&data.out);
+        }
+    }
+    if (!bench_selected(config, "max_pool2d")) return;
+
+    for (size_t side = 32; 8 * 32 * side * side <= config->max_size; side *= 2) {
+        size_t in_shape[4] = {8, 32, side, side};
+        size_t out_shape[4] = {8, 32, side / 2, side / 2};
+        size_t n = 8 * 32 * side * side;
+        BenchData data;
+        memset(&data, 0, sizeof(data));
+        data.a = bench_array(4, in_shape, 1);
+        data.out = bench_array(4, out_shape, 2);
+        data.pool = mlc_pool2d_params(2, 2, 0);
+
+        bench_measure(config, "max_pool2d", n, n, 5.0 * (double)n, (double)n, run_max_pool, &data);
+        mlc_finish(&data.a);
+        mlc_finish(&data.out);
+    }
+}
+
+/* k-means++ and 10 Lloyd iterations, 64 clusters of 16-column rows; flops of the distance GEMMs */
+static void
+bench_run_kmeans(BenchConfig * config)
+{
+    if (!bench_selected(config, "kmeans")) return;
+
+    for (size_t n = 65536; n <= config->max_size; n *= 4) {
+        size_t shape[2] = {n / 16, 16};
+        BenchData data;
+        memset(&data, 0, sizeof(data));
+        data.a = bench_array(2, shape, 1);
+        data.kmeans = mlc_kmeans_options(64);
+        data.kmeans.max_iter = 10;
+        data.kmeans.tol = 0.0;
+
+        bench_measure(config, "kmeans", n, n, 4.0 * (double)n * 11.0,
+                      2.0 * (double)n * 64.0 * 11.0, run_kmeans, &data);
+        mlc_finish(&data.a);
+    }
+}
+
+/* Training steps (forward, backward, Adam) of the mlp_forward model, batches of 16 to 256 */
+static void
+bench_run_train(BenchConfig * config)
+{
+    if (!bench_selected(config, "train_step")) return;
+
+    size_t dims[] = {256, 256, 256, 10};
+    double weights = 0.0;
+    BenchData data;
+    memset(&data, 0, sizeof(data));
+    mlc_mlp_init(&data.mlp, 256);
+
+    for (size_t l = 0; l < 3; ++l) {
+        size_t shape[2] = {dims[l], dims[l + 1]};
+        MlcArray w = bench_array(2, shape, (unsigned)(10 + l));
+
+        for (size_t i = 0; i < w.size; ++i) w.data[i] *= 0.02f;
+        mlc_mlp_add(&data.mlp, &w, NULL, (l == 2) ? MLC_ACT_SOFTMAX : MLC_ACT_RELU, 0.0f);
+        mlc_finish(&w);
+        weights += (double)(dims[l] * dims[l + 1]);
+    }
+    data.optim = mlc_adam(1e-4f, 0.9f, 0.999f, 1e-8f, 0.0f);
+    if (mlc_trainer_init(&data.trainer, &data.mlp, &data.optim,
+                         MLC_LOSS_CROSS_ENTROPY, 256) != 0) exit(1);
+
+    for (size_t batch = 16; batch <= 256; batch *= 4) {
+        size_t in_shape[2] = {batch, dims[0]};
+        size_t out_shape[2] = {batch, dims[3]};
+        double b = (double)batch;
+
+        data.a = bench_array(2, in_shape, 1);
+        data.out = bench_array(2, out_shape, 2);
+        /* one-hot targets */
+        memset(data.out.data, 0, data.out.size * sizeof(float));
+        for (size_t i = 0; i < batch; ++i) data.out.data[i * dims[3] + i % dims[3]] = 1.0f;
+
+        /* forward 2 flops per weight, backward 4 */
+        bench_measure(config, "train_step", batch, batch,
+                      4.0 * (8.0 * weights + b * (double)(dims[0] + dims[3])), 6.0 * b * weights,
+                      run_train, &data);
+        mlc_finish(&data.a);
+        mlc_finish(&data.out);
+    }
+    mlc_trainer_finish(&data.trainer);
+    mlc_mlp_finish(&data.mlp);
+}
+
+static void
+bench_usage(const char * program)
+{
+    fprintf(stderr,
+            "usage: %s [--format text|csv|json] [--filter substr] [--reps N]\n"
+            "          [--min-ms MS] [--max-size ELEMS] [--threads N]\n"
+            "          [--cpu scalar|sse2|avx2|avx512]\n",
+            program);
+}
+
+int main(int argc, char ** argv)
+{
+    BenchConfig config = {BENCH_TEXT, NULL, 7, 0.002, (size_t)1 << 24, 0};
+
+    for (int i = 1; i < argc; ++i) {
+        const char * value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (value == NULL) {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--format") == 0) {
+            config.format = (strcmp(value, "csv") == 0)  ? BENCH_CSV
+                          : (strcmp(value, "json") == 0) ? BENCH_JSON
+                                                         : BENCH_TEXT;
+        }
+        else if (strcmp(argv[i], "--filter") == 0) {
+            config.filter = value;
+        }
+        else if (strcmp(argv[i], "--reps") == 0) {
+            config.reps = (size_t)strtoul(value, NULL, 10);
+            if (config.reps == 0) config.reps = 1;
+        }
+        else if (strcmp(argv[i], "--min-ms") == 0) {
+            config.min_seconds = strtod(value, NULL) * 1e-3;
+        }
+        else if (strcmp(argv[i], "--max-size") == 0) {
+            config.max_size = (size_t)strtoull(value, NULL, 10);
+        }
+        else if (strcmp(argv[i], "--threads") == 0) {
+            mlc_set_num_threads((size_t)strtoul(value, NULL, 10));
+        }
+        else if (strcmp(argv[i], "--cpu") == 0) {
+            int level = MLC_CPU_SCALAR;
+            while (level <= MLC_CPU_AVX512 && strcmp(value, mlc_cpu_level_name((MlcCpuLevel)level)) != 0) {
+                ++level;
+            }
+            if (level > MLC_CPU_AVX512) {
+                bench_usage(argv[0]);
+                return 1;
+            }
+            mlc_set_cpu_level((MlcCpuLevel)level);
+        }
+        else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    switch (config.format)
+    {
+        case BENCH_CSV:
+            printf("kernel,size,elements,median_ns,ns_per_elem,gb_per_s,gflop_per_s\n");
+            break;
+        case BENCH_JSON:
+            printf("{\"threads\": %zu, \"cpu\": \"%s\", \"results\": [", mlc_get_num_threads(),
+                   mlc_cpu_level_name(mlc_cpu_level()));
+            break;
+        case BENCH_TEXT:
+        default:
+            printf("threads: %zu, cpu: %s, reps: %zu, min sample: %.1f ms\n",
+                   mlc_get_num_threads(), mlc_cpu_level_name(mlc_cpu_level()),
+                   config.reps, config.min_seconds * 1e3);
+            printf("%-22s %10s %12s %10s %10s %12s\n",
+                   "kernel", "size", "ns/elem", "GB/s", "GFLOP/s", "median ms");
+            break;
+    }
+
+    bench_run_elementwise(&config);
+    bench_run_prepare(&config);
+    bench_run_files(&config);
+    bench_run_matrix(&config);
+    bench_run_quant(&config);
+    bench_run_mlp(&config);
+    bench_run_sparse(&config);
+    bench_run_optim(&config);
+    bench_run_train(&config);
+    bench_run_stats(&config);
+    bench_run_gather(&config);
+    bench_run_conv(&config);
+    bench_run_kmeans(&config);
+
+    if (config.format == BENCH_JSON) printf("\n]}\n");
+    mlc_parallel_shutdown();
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* examples/arena_test.c */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <mlc/data.h>
+#include <mlc/arena.h>
+#include <mlc/activations.h>
+
+int main() 
+{
+    MlcArena arena;
+    if (mlc_arena_init(&arena, 0) != 0) {
+        printf("Error initializing arena\n");
+        return 1;
+    }
+
+    /* pooled arrays: finishing one makes its block reusable */
+    double batch_data[] = {-1.5, 2.0, -0.5, 4.0, 0.25, -3.0};
+    size_t batch_shape[] = {2, 3};
+    float * first_block = NULL;
+
+    for (int step = 0; step < 3; ++step) {
+        MlcArray batch = mlc_arena_prepare_data(&arena, batch_data, 2, batch_shape, TYPE_DOUBLE);
+        if (batch.data == NULL) {
+            printf("Error allocating batch\n");
+            return 1;
+        }
+        if (first_block == NULL) first_block = batch.data;
+
+        relu(&batch);
+        printf("Step %d: aligned=%d reused=%d:", step,
+               (int)((uintptr_t)batch.data % MLC_ARENA_ALIGN == 0),
+               (int)(batch.data == first_block));
+        for (size_t i = 0; i < batch.size; ++i) {
+            printf(" %.2f", batch.data[i]);
+        }
+        printf("\n");
+        mlc_finish(&batch);
+    }
+
+    /* bump-allocated temporaries, reclaimed together by reset */
+    size_t tmp_shape[] = {1000};
+    for (int i = 0; i < 4; ++i) {
+        MlcArray tmp = mlc_arena_array(&arena, 1, tmp_shape);
+        if (tmp.data == NULL) {
+            printf("Error allocating temporary\n");
+            return 1;
+        }
+        tmp.data[0] = (float)i;
+    }
+    mlc_arena_reset(&arena);
+
+    mlc_arena_destroy(&arena);
+    return 0;
+}
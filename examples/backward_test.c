@@ -0,0 +1,59 @@
+/* examples/backward_test.c */
+
+#include <stdio.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/activations.h>
+
+/* loss(x) = Σ w[i] * f(x)[i], so dloss/df = w */
+static float
+loss(float * x, size_t n, const float * w, int softmax_)
+{
+    size_t shape[] = {n};
+    MlcArray a = prepare_data(x, 1, shape, TYPE_FLOAT);
+    float sum = 0.0f;
+
+    if (softmax_) softmax(&a);
+    else sigmoid(&a);
+    for (size_t i = 0; i < n; ++i) {
+        sum += w[i] * a.data[i];
+    }
+    mlc_finish(&a);
+    return sum;
+}
+
+int main()
+{
+    float x[] = {0.5f, -1.0f, 2.0f, 0.1f, -0.3f};
+    float w[] = {1.0f, -2.0f, 0.5f, 3.0f, 0.25f};
+    size_t shape[] = {5};
+    const char * names[] = {"sigmoid", "softmax"};
+
+    for (int softmax_ = 0; softmax_ <= 1; ++softmax_) {
+        MlcArray y = prepare_data(x, 1, shape, TYPE_FLOAT);
+        MlcArray grad = prepare_data(w, 1, shape, TYPE_FLOAT);
+
+        /* forward, then one fused pass for dloss/dx from the saved output */
+        if (softmax_) {
+            softmax(&y);
+            softmax_backward(&y, &grad);
+        }
+        else {
+            sigmoid(&y);
+            sigmoid_backward(&y, &grad);
+        }
+
+        printf("%s: i  backward   numeric\n", names[softmax_]);
+        for (size_t i = 0; i < 5; ++i) {
+            float xp[5], xm[5];
+            for (size_t j = 0; j < 5; ++j) xp[j] = xm[j] = x[j];
+            xp[i] += 1e-2f;
+            xm[i] -= 1e-2f;
+            float numeric = (loss(xp, 5, w, softmax_) - loss(xm, 5, w, softmax_)) / 2e-2f;
+            printf("         %zu  %8.4f  %8.4f\n", i, grad.data[i], numeric);
+        }
+        mlc_finish(&y);
+        mlc_finish(&grad);
+    }
+    return 0;
+}
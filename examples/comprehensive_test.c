@@ -7,6 +7,8 @@
 #include <mlc/data.h>
 #include <mlc/activations.h>
 #include <mlc/vector.h>
+#include <mlc/matrix.h>
+#include <mlc/pipeline.h>
 
 static void print_array(const char * label, MlcArray * arr) 
 {
@@ -133,8 +135,43 @@ int main()
     vector_scale(&vec_a, k, &vec_result);
     print_array("vector_scale (k * a)", &vec_result);
 
+    printf("=== Matrix Operation Tests ===\n");
+    float mat_a_data[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+    float mat_b_data[] = {1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    size_t mat_a_shape[] = {2, 3};
+    size_t mat_b_shape[] = {3, 2};
+    size_t mat_c_shape[] = {2, 2};
+    size_t mv_shape[] = {2};
+
+    MlcArray mat_a = prepare_data(mat_a_data, 2, mat_a_shape, TYPE_FLOAT);
+    MlcArray mat_b = prepare_data(mat_b_data, 2, mat_b_shape, TYPE_FLOAT);
+    MlcArray mat_c = prepare_data(mat_b_data, 2, mat_c_shape, TYPE_FLOAT);
+    MlcArray mv_result = prepare_data(vec_a_data, 1, mv_shape, TYPE_FLOAT);
+
+    matrix_mult(&mat_a, &mat_b, &mat_c);
+    print_array("matrix_mult (A * B)", &mat_c);
+
+    matrix_vector_mult(&mat_a, &vec_a, &mv_result);
+    print_array("matrix_vector_mult (A * a)", &mv_result);
+
+    printf("=== Fused Pipeline Tests ===\n");
+    float bias_data[] = {0.5f, -0.5f};
+    size_t bias_shape[] = {2};
+
+    MlcArray bias = prepare_data(bias_data, 1, bias_shape, TYPE_FLOAT);
+    MlcChain chain;
+
+    mlc_chain_init(&chain);
+    mlc_chain_push(&chain, MLC_OP_SCALE, 0.5f);
+    mlc_chain_push_bias(&chain, &bias);
+    mlc_chain_push(&chain, MLC_OP_LEAKY_RELU, 0.01f);
+    mlc_chain_push(&chain, MLC_OP_SIGMOID, 0.0f);
+
+    mlc_chain_run(&chain, &mat_c);
+    print_array("scale -> bias -> leaky_relu -> sigmoid", &mat_c);
+
     printf("=== Error Handling ===\n");
-    MlcArray null_arr = {NULL, 1, vec_shape, 5};
+    MlcArray null_arr = {NULL, 1, vec_shape, 5, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
 
     if (relu(&null_arr) == -1) {
         printf("Caught NULL error in relu\n");
@@ -148,6 +185,11 @@ int main()
     mlc_finish(&vec_a);
     mlc_finish(&vec_b);
     mlc_finish(&vec_result);
+    mlc_finish(&mat_a);
+    mlc_finish(&mat_b);
+    mlc_finish(&mat_c);
+    mlc_finish(&mv_result);
+    mlc_finish(&bias);
 
     return 0;
 }
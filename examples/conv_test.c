@@ -0,0 +1,55 @@
+/* examples/conv_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/conv.h>
+
+int main()
+{
+    /* One 6x6 image with a vertical edge, one 3x3 edge detector */
+    float pixels[36], kernel[9] = {-1, 0, 1, -1, 0, 1, -1, 0, 1};
+    size_t in_shape[] = {1, 1, 6, 6}, w_shape[] = {1, 1, 3, 3};
+
+    for (size_t i = 0; i < 36; ++i) pixels[i] = (i % 6 < 3) ? 0.0f : 1.0f;
+    MlcArray image = prepare_data(pixels, 4, in_shape, TYPE_FLOAT);
+    MlcArray weight = prepare_data(kernel, 4, w_shape, TYPE_FLOAT);
+
+    /* Stride 1, padding 1: same size out; the output buffer is the caller's */
+    MlcConv2d params = mlc_conv2d_params(1, 1, 1);
+    size_t side = mlc_conv_out_dim(6, 3, 1, 1, 1);
+    float zeros[36] = {0};
+    size_t out_shape[] = {1, 1, side, side};
+    MlcArray edges = prepare_data(zeros, 4, out_shape, TYPE_FLOAT);
+
+    /* Both paths give the same result */
+    MlcConvAlgo algos[] = {MLC_CONV_IM2COL, MLC_CONV_DIRECT};
+    for (size_t a = 0; a < 2; ++a) {
+        params.algo = algos[a];
+        if (mlc_conv2d(&image, &weight, NULL, &params, &edges) != 0) return 1;
+
+        printf("%s:\n", (a == 0) ? "im2col" : "direct");
+        for (size_t y = 0; y < side; ++y) {
+            for (size_t x = 0; x < side; ++x) printf(" %3.0f", edges.data[y * side + x]);
+            printf("\n");
+        }
+    }
+
+    /* 2x2 max and average pooling, stride 2 */
+    MlcPool2d pool = mlc_pool2d_params(2, 2, 0);
+    size_t pool_shape[] = {1, 1, 3, 3};
+    MlcArray pooled = prepare_data(zeros, 4, pool_shape, TYPE_FLOAT);
+
+    if (mlc_max_pool2d(&edges, &pool, &pooled) != 0) return 1;
+    printf("max pool:");
+    for (size_t i = 0; i < 9; ++i) printf(" %.0f", pooled.data[i]);
+    if (mlc_avg_pool2d(&edges, &pool, &pooled) != 0) return 1;
+    printf("\navg pool:");
+    for (size_t i = 0; i < 9; ++i) printf(" %.1f", pooled.data[i]);
+    printf("\n");
+
+    mlc_finish(&image);
+    mlc_finish(&weight);
+    mlc_finish(&edges);
+    mlc_finish(&pooled);
+    return 0;
+}
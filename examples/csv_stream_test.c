@@ -0,0 +1,47 @@
+/* examples/csv_stream_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/csv_stream.h>
+#include <mlc/activations.h>
+
+int main() 
+{
+    /* write a small CSV file with a blank line in the middle */
+    FILE * file = fopen("stream_test.csv", "w");
+    if (file == NULL) {
+        printf("Error writing CSV file\n");
+        return 1;
+    }
+    for (int i = 0; i < 10; ++i) {
+        fprintf(file, "%d,%d,%d\n", i, -i, i * 10);
+        if (i == 4) fprintf(file, "\n");
+    }
+    fclose(file);
+
+    /* read it back four rows at a time into one reused array */
+    MlcCsvReader * reader = mlc_csv_open("stream_test.csv");
+    if (reader == NULL) {
+        printf("Error opening CSV file\n");
+        return 1;
+    }
+    MlcArray batch = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    int status;
+
+    while ((status = mlc_csv_next_batch(reader, 4, &batch)) > 0) {
+        relu(&batch);
+        printf("Batch (%zu x %zu):\n", batch.shape[0], batch.shape[1]);
+        for (size_t i = 0; i < batch.shape[0]; ++i) {
+            for (size_t j = 0; j < batch.shape[1]; ++j) {
+                printf("%6.1f ", batch.data[i * batch.shape[1] + j]);
+            }
+            printf("\n");
+        }
+    }
+    printf("Rows read: %zu, status: %d\n", reader->rows_read, status);
+
+    mlc_finish(&batch);
+    mlc_csv_close(reader);
+    remove("stream_test.csv");
+    return status;
+}
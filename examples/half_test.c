@@ -0,0 +1,55 @@
+/* examples/half_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/activations.h>
+#include <mlc/vector.h>
+
+static void
+print_matrix(const char * title, const MlcArray * arr)
+{
+    /* widen to fp32 for printing */
+    MlcArray wide = mlc_cast(arr, MLC_DTYPE_F32);
+
+    printf("%s (%zu bytes per element):\n", title, mlc_dtype_size(arr->dtype));
+    for (size_t i = 0; i < wide.shape[0]; ++i) {
+        for (size_t j = 0; j < wide.shape[1]; ++j) {
+            printf("%9.5f ", wide.data[i * wide.shape[1] + j]);
+        }
+        printf("\n");
+    }
+    mlc_finish(&wide);
+}
+
+int main()
+{
+    double data[] = {0.1, -1.5, 2.25, 3.0, -0.001, 1000.3};
+    size_t shape[] = {2, 3};
+
+    /* same values stored as fp32, fp16 and bf16 */
+    MlcArray f32 = prepare_data(data, 2, shape, TYPE_DOUBLE);
+    MlcArray f16 = prepare_data_as(data, 2, shape, TYPE_DOUBLE, MLC_DTYPE_F16);
+    MlcArray bf16 = prepare_data_as(data, 2, shape, TYPE_DOUBLE, MLC_DTYPE_BF16);
+    if (f32.data == NULL || f16.data == NULL || bf16.data == NULL) {
+        printf("Error preparing data\n");
+        return 1;
+    }
+    print_matrix("fp32", &f32);
+    print_matrix("fp16", &f16);
+    print_matrix("bf16", &bf16);
+
+    /* kernels compute in fp32 and round the result back */
+    sigmoid(&f16);
+    print_matrix("fp16 after sigmoid", &f16);
+
+    /* operands may mix storage types */
+    vector_add(&f32, &bf16, &f16);
+    print_matrix("fp16 = fp32 + bf16", &f16);
+    printf("dot(fp32, bf16) = %f\n", vector_dot(&f32, &bf16));
+
+    mlc_finish(&f32);
+    mlc_finish(&f16);
+    mlc_finish(&bf16);
+    return 0;
+}
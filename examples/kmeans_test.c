@@ -0,0 +1,51 @@
+/* examples/kmeans_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/kmeans.h>
+
+#define ROWS 3000
+
+int main()
+{
+    /* Three blobs around (0, 0), (10, 0) and (0, 10) */
+    static float points[ROWS * 2];
+    const float centers[3][2] = {{0.0f, 0.0f}, {10.0f, 0.0f}, {0.0f, 10.0f}};
+    size_t shape[] = {ROWS, 2};
+    unsigned state = 1;
+
+    for (size_t r = 0; r < ROWS; ++r) {
+        for (size_t c = 0; c < 2; ++c) {
+            state = state * 1664525u + 1013904223u;
+            points[2 * r + c] = centers[r % 3][c] + (float)(state >> 8) / 16777216.0f - 0.5f;
+        }
+    }
+    MlcArray data = prepare_data(points, 2, shape, TYPE_FLOAT);
+
+    MlcKMeansOptions options = mlc_kmeans_options(3);
+    options.seed = 42;
+    MlcKMeans model;
+    if (mlc_kmeans(&data, &options, &model) != 0) return 1;
+
+    printf("%zu iterations, inertia %.1f\n", model.iterations, model.inertia);
+    for (size_t j = 0; j < 3; ++j) {
+        size_t members = 0;
+
+        for (size_t r = 0; r < ROWS; ++r) members += (model.labels[r] == j);
+        printf("cluster %zu: (%5.2f, %5.2f), %zu rows\n", j, model.centroids.data[2 * j],
+               model.centroids.data[2 * j + 1], members);
+    }
+
+    /* New points go to the nearest centroid */
+    float queries[] = {9.0f, 1.0f, -1.0f, 8.0f};
+    size_t q_shape[] = {2, 2}, labels[2];
+    MlcArray q = prepare_data(queries, 2, q_shape, TYPE_FLOAT);
+
+    if (mlc_kmeans_predict(&model, &q, labels) != 0) return 1;
+    printf("(9, 1) -> cluster %zu, (-1, 8) -> cluster %zu\n", labels[0], labels[1]);
+
+    mlc_finish(&q);
+    mlc_kmeans_finish(&model);
+    mlc_finish(&data);
+    return 0;
+}
@@ -0,0 +1,49 @@
+/* examples/loader_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/loader.h>
+
+int main()
+{
+    const char * path = "/tmp/mlc_loader_test.csv";
+    FILE * file = fopen(path, "w");
+
+    if (file == NULL) return 1;
+    for (int r = 0; r < 1000; ++r) {
+        fprintf(file, "%d,%d\n", r, r % 10);
+    }
+    fclose(file);
+
+    /* Batches of 64 rows, shuffled, parsed ahead on a background thread */
+    MlcLoaderOptions options = mlc_loader_options(64);
+    options.shuffle = 1;
+    options.seed = 7;
+    MlcLoader * loader = mlc_loader_open_csv(path, &options);
+    if (loader == NULL) return 1;
+
+    for (int epoch = 0; epoch < 2; ++epoch) {
+        MlcArray * batch;
+        size_t batches = 0, rows = 0;
+        double sum = 0.0;
+        int status;
+
+        while ((status = mlc_loader_next(loader, &batch)) > 0) {
+            /* The compute on this batch overlaps the loading of the next */
+            if (batches == 0) {
+                printf("epoch %d, first rows:", epoch);
+                for (size_t r = 0; r < 4; ++r) printf(" %.0f", batch->data[2 * r]);
+                printf("\n");
+            }
+            for (size_t r = 0; r < batch->shape[0]; ++r) sum += batch->data[2 * r];
+            rows += batch->shape[0];
+            ++batches;
+        }
+        if (status < 0) return 1;
+        printf("epoch %d: %zu batches, %zu rows, sum %.0f\n", epoch, batches, rows, sum);
+    }
+
+    mlc_loader_close(loader);
+    remove(path);
+    return 0;
+}
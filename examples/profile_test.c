@@ -0,0 +1,55 @@
+/* examples/profile_test.c */
+
+/* Must come before any MLC header: turns the profiling hooks on */
+#define MLC_PROFILE
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/activations.h>
+#include <mlc/matrix.h>
+#include <mlc/conv.h>
+#include <mlc/profile.h>
+
+#define SIDE 64
+
+int main()
+{
+    static float values[SIDE * SIDE], zeros[SIDE * SIDE];
+    size_t mat_shape[] = {SIDE, SIDE};
+    size_t img_shape[] = {1, 1, SIDE, SIDE}, pool_shape[] = {1, 1, SIDE / 2, SIDE / 2};
+
+    for (size_t i = 0; i < SIDE * SIDE; ++i) values[i] = (float)(i % 17) - 8.0f;
+    MlcArray a = prepare_data(values, 2, mat_shape, TYPE_FLOAT);
+    MlcArray b = prepare_data(values, 2, mat_shape, TYPE_FLOAT);
+    MlcArray c = prepare_data(zeros, 2, mat_shape, TYPE_FLOAT);
+    MlcArray image = prepare_data(values, 4, img_shape, TYPE_FLOAT);
+    MlcArray pooled = prepare_data(zeros, 4, pool_shape, TYPE_FLOAT);
+    MlcPool2d pool = mlc_pool2d_params(2, 2, 0);
+
+    /* A few operations, some called more than once */
+    for (int i = 0; i < 3; ++i) relu(&a);
+    matrix_mult(&a, &b, &c);
+    mlc_max_pool2d(&image, &pool, &pooled);
+    mlc_avg_pool2d(&image, &pool, &pooled);
+    mlc_avg_pool2d(&image, &pool, &pooled);
+
+    /* Per-operation counters; each operation has its own entry */
+    const char * names[] = {"relu", "mlc_max_pool2d", "mlc_avg_pool2d"};
+    for (size_t i = 0; i < 3; ++i) {
+        MlcProfileCounter counter;
+
+        if (mlc_profile_get(names[i], &counter) != 0) return 1;
+        printf("%-16s %llu calls, %llu elements\n", names[i], counter.calls, counter.elements);
+    }
+
+    /* Timings vary from run to run */
+    printf("\n");
+    mlc_profile_report(stdout);
+
+    mlc_finish(&a);
+    mlc_finish(&b);
+    mlc_finish(&c);
+    mlc_finish(&image);
+    mlc_finish(&pooled);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/* examples/quant_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/matrix.h>
+#include <mlc/quant.h>
+
+int main()
+{
+    float weights[] = {0.5f, -1.0f, 0.25f, 2.0f,
+                       -0.75f, 0.1f, 1.5f, -0.3f,
+                       0.05f, 0.02f, -0.01f, 0.04f};
+    float input[] = {1.0f, 0.5f, -2.0f, 0.25f};
+    float bias[] = {0.1f, -0.2f, 0.0f};
+    size_t w_shape[] = {3, 4};
+    size_t x_shape[] = {4};
+    size_t y_shape[] = {3};
+
+    MlcArray w = prepare_data(weights, 2, w_shape, TYPE_FLOAT);
+    MlcArray x = prepare_data(input, 1, x_shape, TYPE_FLOAT);
+    MlcArray b = prepare_data(bias, 1, y_shape, TYPE_FLOAT);
+    MlcArray exact = prepare_data(bias, 1, y_shape, TYPE_FLOAT);
+    MlcArray approx = prepare_data(bias, 1, y_shape, TYPE_FLOAT);
+
+    /* per-row scales keep the small third row accurate */
+    MlcQuantArray qw = mlc_quantize(&w, MLC_QUANT_SYMMETRIC, MLC_QUANT_PER_ROW);
+    MlcQuantArray qx = mlc_quantize(&x, MLC_QUANT_ASYMMETRIC, MLC_QUANT_PER_TENSOR);
+    MlcQuantArray qy = mlc_quant_alloc(1, y_shape, MLC_QUANT_PER_TENSOR);
+
+    if (qw.data == NULL || qx.data == NULL || qy.data == NULL ||
+        matrix_vector_mult(&w, &x, &exact) != 0 || mlc_quant_matvec(&qw, &qx, &approx) != 0) {
+        printf("Error in quantized matrix-vector product\n");
+        return 1;
+    }
+    printf("row  scale     fp32 w.x   int8 w.x\n");
+    for (size_t i = 0; i < 3; ++i) {
+        printf("%zu    %.6f  %9.5f  %9.5f\n", i, qw.scales[i], exact.data[i], approx.data[i]);
+    }
+
+    /* int8 output of relu(w.x + b): zero maps to the zero point */
+    qy.scales[0] = 0.05f;
+    qy.zero_points[0] = -127;
+    mlc_quant_matvec_requant(&qw, &qx, &b, 1, &qy);
+    mlc_dequantize(&qy, &approx);
+    printf("relu(w.x + b) via int8: %.3f %.3f %.3f (q = %d %d %d)\n",
+           approx.data[0], approx.data[1], approx.data[2], qy.data[0], qy.data[1], qy.data[2]);
+
+    float dot = mlc_quant_dot(&qx, &qx);
+    printf("x.x via int8: %.4f\n", dot);
+
+    mlc_quant_finish(&qw);
+    mlc_quant_finish(&qx);
+    mlc_quant_finish(&qy);
+    mlc_finish(&w);
+    mlc_finish(&x);
+    mlc_finish(&b);
+    mlc_finish(&exact);
+    mlc_finish(&approx);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/* examples/sampler_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/sampler.h>
+
+#define ROWS 40
+
+int main()
+{
+    /* Row r holds (r, r * r); the first 30 rows are class 0, the last 10 class 1 */
+    float features[ROWS * 2], labels[ROWS];
+    size_t x_shape[] = {ROWS, 2}, y_shape[] = {ROWS};
+
+    for (size_t r = 0; r < ROWS; ++r) {
+        features[2 * r] = (float)r;
+        features[2 * r + 1] = (float)(r * r);
+        labels[r] = (r < 30) ? 0.0f : 1.0f;
+    }
+    MlcArray x = prepare_data(features, 2, x_shape, TYPE_FLOAT);
+    MlcArray y = prepare_data(labels, 1, y_shape, TYPE_FLOAT);
+
+    /* Batches of 8 keep the 3:1 class ratio; the dataset is never moved */
+    MlcSampler sampler;
+    if (mlc_sampler_init(&sampler, ROWS, 8, MLC_SAMPLE_STRATIFIED, &y, 42) != 0) return 1;
+
+    MlcArray bx = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    MlcArray by = {NULL, 1, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    while (mlc_sampler_next(&sampler) > 0) {
+        size_t ones = 0;
+
+        /* Same indices for features and labels, into reused buffers */
+        mlc_sampler_gather(&sampler, &x, &bx);
+        mlc_sampler_gather(&sampler, &y, &by);
+
+        printf("rows:");
+        for (size_t i = 0; i < bx.shape[0]; ++i) {
+            printf(" %2.0f", bx.data[2 * i]);
+            ones += (by.data[i] == 1.0f);
+        }
+        printf("   class 1: %zu of %zu\n", ones, by.shape[0]);
+    }
+
+    mlc_sampler_finish(&sampler);
+    mlc_finish(&bx);
+    mlc_finish(&by);
+    mlc_finish(&x);
+    mlc_finish(&y);
+    return 0;
+}
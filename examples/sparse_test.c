@@ -0,0 +1,48 @@
+/* examples/sparse_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/sparse.h>
+
+int main()
+{
+    float values[] = {
+        0.0f, 2.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 3.0f,
+        0.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 4.0f, 5.0f, 0.0f,
+    };
+    float v[] = {1.0f, 2.0f, 3.0f, 4.0f};
+    size_t shape[] = {4, 4}, v_shape[] = {4};
+
+    MlcArray dense = prepare_data(values, 2, shape, TYPE_FLOAT);
+    MlcArray x = prepare_data(v, 1, v_shape, TYPE_FLOAT);
+    MlcArray y = prepare_data(v, 1, v_shape, TYPE_FLOAT);
+
+    /* Only the 5 nonzeros are kept */
+    MlcSparse csr = mlc_sparse_from_dense(&dense, MLC_SPARSE_CSR);
+    printf("CSR: %zu x %zu, nnz %zu\n", csr.rows, csr.cols, csr.nnz);
+    for (size_t r = 0; r < csr.rows; ++r) {
+        printf("  row %zu:", r);
+        for (size_t k = csr.indptr[r]; k < csr.indptr[r + 1]; ++k) {
+            printf(" (%u, %.1f)", csr.indices[k], csr.values[k]);
+        }
+        printf("\n");
+    }
+
+    /* y = A x, from CSR and from CSC */
+    MlcSparse csc = mlc_sparse_convert(&csr, MLC_SPARSE_CSC);
+    for (int pass = 0; pass < 2; ++pass) {
+        mlc_spmv(pass ? &csc : &csr, &x, &y);
+        printf("%s A x =", pass ? "CSC" : "CSR");
+        for (size_t i = 0; i < 4; ++i) printf(" %.1f", y.data[i]);
+        printf("\n");
+    }
+
+    mlc_sparse_finish(&csr);
+    mlc_sparse_finish(&csc);
+    mlc_finish(&dense);
+    mlc_finish(&x);
+    mlc_finish(&y);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/* examples/stats_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/stats.h>
+
+int main()
+{
+    /* Two batches of (height cm, weight kg) */
+    float first[] = {
+        170.0f, 65.0f,
+        182.0f, 80.0f,
+        158.0f, 52.0f,
+    };
+    float second[] = {
+        175.0f, 71.0f,
+        190.0f, 95.0f,
+    };
+    size_t first_shape[] = {3, 2}, second_shape[] = {2, 2};
+
+    MlcArray a = prepare_data(first, 2, first_shape, TYPE_FLOAT);
+    MlcArray b = prepare_data(second, 2, second_shape, TYPE_FLOAT);
+
+    /* Statistics accumulate across batches */
+    MlcColumnStats stats;
+    if (mlc_stats_init(&stats, 2) != 0) return 1;
+    mlc_stats_update(&stats, &a);
+    mlc_stats_update(&stats, &b);
+
+    printf("rows: %zu\n", stats.count);
+    for (size_t c = 0; c < 2; ++c) {
+        printf("column %zu: mean %.2f  var %.2f  min %.1f  max %.1f\n", c,
+               stats.mean[c], mlc_stats_variance(&stats, c), stats.min[c], stats.max[c]);
+    }
+
+    /* Then every batch is standardized with the same statistics */
+    mlc_normalize(&a, &stats, MLC_NORM_ZSCORE);
+    mlc_normalize(&b, &stats, MLC_NORM_ZSCORE);
+    printf("z-scores of the second batch:\n");
+    for (size_t r = 0; r < 2; ++r) {
+        printf("  %6.3f %6.3f\n", b.data[2 * r], b.data[2 * r + 1]);
+    }
+
+    mlc_stats_finish(&stats);
+    mlc_finish(&a);
+    mlc_finish(&b);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/* examples/tensor_file_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/io.h>
+#include <mlc/activations.h>
+
+int main() 
+{
+    /* store a small matrix in the binary tensor format */
+    float mat_data[] = {1.0f, -2.0f, 3.0f, -4.0f, 5.0f, -6.0f};
+    size_t mat_shape[] = {2, 3};
+
+    MlcArray mat = prepare_data(mat_data, 2, mat_shape, TYPE_FLOAT);
+    if (mat.data == NULL || mlc_save("tensor_test.mlct", &mat) != 0) {
+        printf("Error saving tensor file\n");
+        return 1;
+    }
+    mlc_finish(&mat);
+
+    /* map it back copy-on-write, so it can be modified in place */
+    MlcArray mapped = mlc_load_mmap("tensor_test.mlct", MLC_MAP_PRIVATE);
+    if (mapped.data == NULL) {
+        printf("Error mapping tensor file\n");
+        return 1;
+    }
+    relu(&mapped);
+
+    printf("Mapped tensor after ReLU (%zu x %zu):\n", mapped.shape[0], mapped.shape[1]);
+    for (size_t i = 0; i < mapped.shape[0]; ++i) {
+        for (size_t j = 0; j < mapped.shape[1]; ++j) {
+            printf("%6.1f ", mapped.data[i * mapped.shape[1] + j]);
+        }
+        printf("\n");
+    }
+
+    /* unmaps the file */
+    mlc_finish(&mapped);
+    remove("tensor_test.mlct");
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* examples/train_test.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <mlc/data.h>
+#include <mlc/layers.h>
+#include <mlc/optim.h>
+#include <mlc/train.h>
+
+#define POINTS 256
+
+/* Small random weights (inputs x outputs) */
+static MlcArray
+random_weights(size_t inputs, size_t outputs, unsigned * seed)
+{
+    size_t shape[] = {inputs, outputs};
+    float * w = (float *)malloc(inputs * outputs * sizeof(float));
+
+    for (size_t i = 0; i < inputs * outputs; ++i) {
+        *seed = *seed * 1664525u + 1013904223u;
+        w[i] = ((float)(*seed >> 8) / 16777216.0f - 0.5f) * 1.5f;
+    }
+    MlcArray array = prepare_data(w, 2, shape, TYPE_FLOAT);
+    free(w);
+    return array;
+}
+
+int main()
+{
+    /* Two classes on a grid: inside or outside a circle */
+    float x[POINTS * 2], y[POINTS * 2];
+    size_t x_shape[] = {POINTS, 2}, y_shape[] = {POINTS, 2};
+
+    for (size_t i = 0; i < POINTS; ++i) {
+        float a = (float)(i % 16) / 7.5f - 1.0f, b = (float)(i / 16) / 7.5f - 1.0f;
+        int inside = (a * a + b * b < 0.5f);
+
+        x[2 * i] = a;
+        x[2 * i + 1] = b;
+        y[2 * i] = (float)inside;
+        y[2 * i + 1] = (float)!inside;
+    }
+    MlcArray input = prepare_data(x, 2, x_shape, TYPE_FLOAT);
+    MlcArray target = prepare_data(y, 2, y_shape, TYPE_FLOAT);
+
+    /* 2-16-16-2 MLP */
+    unsigned seed = 42;
+    size_t dims[] = {2, 16, 16, 2};
+    MlcMlp mlp;
+    mlc_mlp_init(&mlp, POINTS);
+    for (size_t l = 0; l < 3; ++l) {
+        MlcArray w = random_weights(dims[l], dims[l + 1], &seed);
+        mlc_mlp_add(&mlp, &w, NULL, (l == 2) ? MLC_ACT_SOFTMAX : MLC_ACT_TANH, 0.0f);
+        mlc_finish(&w);
+    }
+
+    /* Full-batch Adam; the batch is split across the thread pool */
+    MlcOptimizer adam = mlc_adam(0.02f, 0.9f, 0.999f, 1e-8f, 0.0f);
+    MlcTrainer trainer;
+    if (mlc_trainer_init(&trainer, &mlp, &adam, MLC_LOSS_CROSS_ENTROPY, POINTS) != 0) {
+        return 1;
+    }
+    for (int step = 0; step <= 500; ++step) {
+        float loss = mlc_train_step(&trainer, &input, &target);
+        if (step % 100 == 0) printf("step %3d  loss %.4f\n", step, loss);
+    }
+
+    /* Accuracy of the trained model */
+    float p[POINTS * 2];
+    MlcArray output = prepare_data(p, 2, y_shape, TYPE_FLOAT);
+    size_t correct = 0;
+
+    mlc_mlp_forward(&mlp, &input, &output);
+    for (size_t i = 0; i < POINTS; ++i) {
+        correct += ((output.data[2 * i] > output.data[2 * i + 1]) == (y[2 * i] > 0.5f));
+    }
+    printf("accuracy: %zu / %d\n", correct, POINTS);
+
+    mlc_trainer_finish(&trainer);
+    mlc_mlp_finish(&mlp);
+    mlc_finish(&input);
+    mlc_finish(&target);
+    mlc_finish(&output);
+    return 0;
+}
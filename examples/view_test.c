@@ -0,0 +1,60 @@
+/* examples/view_test.c */
+
+#include <stdio.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/activations.h>
+#include <mlc/vector.h>
+
+static void print_matrix(const char * label, const MlcArray * arr)
+{
+    printf("%s (%zu x %zu, %s):\n", label, arr->shape[0], arr->shape[1],
+           mlc_is_contiguous(arr) ? "contiguous" : "strided");
+    for (size_t i = 0; i < arr->shape[0]; ++i) {
+        for (size_t j = 0; j < arr->shape[1]; ++j) {
+            printf("%6.2f ", arr->data[i * mlc_stride_(arr, 0) + j * mlc_stride_(arr, 1)]);
+        }
+        printf("\n");
+    }
+}
+
+int main() 
+{
+    float data[] = {1, -2, 3, -4,
+                    5, -6, 7, -8,
+                    9, -10, 11, -12};
+    size_t shape[] = {3, 4};
+
+    MlcArray mat = prepare_data(data, 2, shape, TYPE_FLOAT);
+    if (mat.data == NULL) {
+        printf("Error preparing data\n");
+        return 1;
+    }
+
+    /* rows 1..2 without copying, activated in place */
+    MlcArray rows = mlc_view_rows(&mat, 1, 2);
+    relu(&rows);
+    print_matrix("Rows 1-2 after ReLU", &rows);
+
+    /* transposed view: softmax now runs down the original columns */
+    MlcArray cols = mlc_transpose_view(&mat);
+    softmax(&cols);
+    print_matrix("Transpose after softmax", &cols);
+    print_matrix("Original matrix", &mat);
+
+    /* reshape to 2 x 6 and take a dot product of its two rows */
+    size_t flat_shape[] = {2, 6};
+    MlcArray flat = mlc_reshape(&mat, 2, flat_shape);
+    MlcArray first = mlc_view_rows(&flat, 0, 1);
+    MlcArray second = mlc_view_rows(&flat, 1, 1);
+    printf("Dot of reshaped rows: %f\n", vector_dot(&first, &second));
+
+    /* views free only their shape */
+    mlc_finish(&first);
+    mlc_finish(&second);
+    mlc_finish(&flat);
+    mlc_finish(&cols);
+    mlc_finish(&rows);
+    mlc_finish(&mat);
+    return 0;
+}
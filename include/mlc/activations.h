@@ -7,6 +7,10 @@
 #include <stdlib.h>
 #include <math.h>
 #include <mlc/data.h>
+#include <mlc/simd_math.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
 #include <mlc/config.h>
 
 /* Activation functions: */
@@ -21,19 +25,279 @@
  * directly, and no additional memory is allocated.
  * 
  * Note:
- *  - Functions operate on float (32-bit) data, the internal type 
- *    of the MLC library.
- *  - expf() and tanhf() are float-specific functions defined in math.h.
+ *  - Functions compute in float (32-bit), the internal type of
+ *    the MLC library. fp16/bf16 arrays are converted to float a
+ *    tile at a time and rounded back, in the same pass.
+ *  - sigmoid, tanh_, softmax and swish use the vectorized exp/tanh
+ *    kernels from simd_math.h; define MLC_MATH_ACCURACY to trade
+ *    accuracy for speed (or to fall back to libm expf()/tanhf()).
+ *  - The span kernels (kernels.h) run at the best instruction-set
+ *    level of the host, see dispatch.h.
  *  - Users must preprocess data into an MlcArray using prepare_data() 
  *    from data.h if their input is in a different format or type.
  *  - Functions work on any dimension (1D vectors, 2D matrices, etc.), 
  *    treating the data as a flat array of size elements.
+ *  - Large arrays are split across the thread pool (parallel.h);
+ *    softmax splits multi-dimensional inputs by rows.
+ *  - Strided views (view.h) are processed row by row in place,
+ *    gathering rows with a non-unit stride into a small tile.
+ *  - Each activation has a *_backward() counterpart for training
+ *    that multiplies an upstream gradient in place by the
+ *    derivative, taken from the saved forward output (the input,
+ *    for swish), in a single pass.
  * 
  * Activation functions return -1 if the input array is NULL or 
  * its size is 0. Otherwise, if the process is successful, they 
  * return 0.
  *************************************************************/
 
+/* Returns max(x[0..n)) */
+static inline float
+mlc_max_span_(const float * x, size_t n)
+{
+    float max = x[0];
+
+    for (size_t i = 1; i < n; ++i) {
+        max = (x[i] > max) ? x[i] : max;
+    }
+    return max;
+}
+
+/* Softmax of one contiguous slice, in-place */
+static inline void
+mlc_softmax_span_(float * x, size_t n)
+{
+    /* Step 1: Find the maximum element for numerical stability */
+    float max = mlc_max_span_(x, n);
+
+    /* Step 2: Compute exponentials in-place and their sum */
+    float sum = mlc_exp_sum_span_(x, n, max);
+
+    /* Step 3: Normalize to get probabilities */
+    mlc_scale_span_(x, n, 1.0f / sum);
+}
+
+/**********************************
+ * Activation selector for code that applies an activation
+ * chosen at runtime (GEMM epilogues, layers.h). `alpha` is the
+ * leaky ReLU slope.
+ **********************************/
+typedef enum
+{
+    MLC_ACT_NONE,
+    MLC_ACT_RELU,
+    MLC_ACT_LEAKY_RELU,
+    MLC_ACT_SIGMOID,
+    MLC_ACT_TANH,
+    MLC_ACT_SWISH,
+    MLC_ACT_SOFTMAX
+}
+MlcActivation;
+
+/* Applies `act` in-place to a contiguous span (one row, for softmax) */
+static inline void
+mlc_activation_span_(MlcActivation act, float alpha, float * x, size_t n)
+{
+    switch (act)
+    {
+        case MLC_ACT_NONE:
+            break;
+        case MLC_ACT_RELU:
+            mlc_relu_span_(x, n);
+            break;
+        case MLC_ACT_LEAKY_RELU:
+            mlc_leaky_relu_span_(x, n, alpha);
+            break;
+        case MLC_ACT_SIGMOID:
+            mlc_sigmoid_span_(x, n);
+            break;
+        case MLC_ACT_TANH:
+            mlc_tanh_span_(x, n);
+            break;
+        case MLC_ACT_SWISH:
+            mlc_swish_span_(x, n);
+            break;
+        case MLC_ACT_SOFTMAX:
+            mlc_softmax_span_(x, n);
+            break;
+    }
+}
+
+/**********************************
+ * Backward of mlc_activation_span_(): multiplies the gradient g
+ * in place by the derivative of `act`, read from the saved
+ * forward output y (the input, for swish). One row, for softmax.
+ **********************************/
+static inline void
+mlc_activation_backward_span_(MlcActivation act, float alpha, const float * y, float * g, size_t n)
+{
+    switch (act)
+    {
+        case MLC_ACT_NONE:
+            break;
+        case MLC_ACT_RELU:
+            mlc_relu_backward_span_(y, g, n);
+            break;
+        case MLC_ACT_LEAKY_RELU:
+            mlc_leaky_relu_backward_span_(y, g, n, alpha);
+            break;
+        case MLC_ACT_SIGMOID:
+            mlc_sigmoid_backward_span_(y, g, n);
+            break;
+        case MLC_ACT_TANH:
+            mlc_tanh_backward_span_(y, g, n);
+            break;
+        case MLC_ACT_SWISH:
+            mlc_swish_backward_span_(y, g, n);
+            break;
+        case MLC_ACT_SOFTMAX:
+            mlc_softmax_backward_span_(y, g, n, mlc_dot_span_(y, g, n));
+            break;
+    }
+}
+
+/**********************************
+ * Parallel drivers: an activation job applies one span kernel
+ * to a range of the flat data.
+ **********************************/
+typedef struct
+{
+    float * data;
+    const MlcArray * array;         /* strided path */
+    void (*span)(float *, size_t);
+    float alpha;                    /* leaky ReLU, when span is NULL */
+    size_t row;                     /* softmax: row length */
+    float partial[MLC_MAX_THREADS]; /* softmax 1D: per-part max / sum */
+}
+MlcActivationJob_;
+
+static inline void
+mlc_activation_apply_(const MlcActivationJob_ * job, float * x, size_t n)
+{
+    if (job->span != NULL) {
+        job->span(x, n);
+    }
+    else {
+        mlc_leaky_relu_span_(x, n, job->alpha);
+    }
+}
+
+static inline void
+mlc_activation_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    (void)part;
+
+    mlc_activation_apply_(job, job->data + begin, end - begin);
+}
+
+/* Same over logical positions [begin, end) of a strided or fp16/bf16 array */
+static inline void
+mlc_activation_strided_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    const MlcArray * array = job->array;
+    float tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t pos = begin; pos < end;) {
+        size_t n, stride;
+        float * x = mlc_view_run_(array, pos, end, &n, &stride);
+
+        if (stride == 1 && array->dtype == MLC_DTYPE_F32) {
+            mlc_activation_apply_(job, x, n);
+        }
+        else {
+            for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+                size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+                float * xi = mlc_view_advance_(array, x, i * stride);
+
+                mlc_view_load_(array, xi, m, stride, tile);
+                mlc_activation_apply_(job, tile, m);
+                mlc_view_store_(array, xi, m, stride, tile);
+            }
+        }
+        pos += n;
+    }
+}
+
+static inline void
+mlc_activation_run_(MlcArray * array, void (*span)(float *, size_t), float alpha)
+{
+    MlcActivationJob_ job;
+
+    job.data = array->data;
+    job.array = array;
+    job.span = span;
+    job.alpha = alpha;
+    mlc_parallel_for(array->size, mlc_parallel_grain(1),
+                     mlc_is_direct_(array) ? mlc_activation_range_
+                                           : mlc_activation_strided_range_, &job);
+}
+
+/* Softmax over rows [begin, end) of length job->row */
+static inline void
+mlc_softmax_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    (void)part;
+
+    for (size_t p = begin; p < end; ++p) {
+        mlc_softmax_span_(job->data + p * job->row, job->row);
+    }
+}
+
+/* Softmax over rows [begin, end) of a strided or fp16/bf16 array */
+static inline void
+mlc_softmax_strided_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    float * tmp = NULL;
+    (void)part;
+
+    for (size_t p = begin; p < end; ++p) {
+        size_t n, stride;
+        float * x = mlc_view_run_(job->array, p * job->row, job->array->size, &n, &stride);
+
+        if (stride == 1 && job->array->dtype == MLC_DTYPE_F32) {
+            mlc_softmax_span_(x, n);
+            continue;
+        }
+        if (tmp == NULL) tmp = (float *)malloc(job->row * sizeof(float));
+        if (tmp == NULL) {
+            LOG_ERROR("Memory allocation failed for softmax row");
+            return;
+        }
+        mlc_view_load_(job->array, x, n, stride, tmp);
+        mlc_softmax_span_(tmp, n);
+        mlc_view_store_(job->array, x, n, stride, tmp);
+    }
+    free(tmp);
+}
+
+/* 1D softmax phases: partial max, partial exp-sum, scale */
+static inline void
+mlc_softmax_max_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    job->partial[part] = mlc_max_span_(job->data + begin, end - begin);
+}
+
+static inline void
+mlc_softmax_exp_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    job->partial[part] = mlc_exp_sum_span_(job->data + begin, end - begin, job->alpha);
+}
+
+static inline void
+mlc_softmax_scale_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcActivationJob_ * job = (MlcActivationJob_ *)ctx;
+    (void)part;
+    mlc_scale_span_(job->data + begin, end - begin, job->alpha);
+}
+
 /**********************************
  * Mathematical synopsis of ReLU:
  * 
@@ -46,10 +310,10 @@ static inline int
 relu(MlcArray * array)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("relu");
 
-    for (size_t i = 0; i < array->size; ++i) {
-        array->data[i] = (array->data[i] > 0.0f) ? array->data[i] : 0.0f;
-    }
+    mlc_activation_run_(array, mlc_relu_span_, 0.0f);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
     return 0;
 }
 
@@ -63,10 +327,10 @@ static inline int
 sigmoid(MlcArray * array)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("sigmoid");
 
-    for (size_t i = 0; i < array->size; ++i) {
-        array->data[i] = 1.0f / (1.0f + expf(-array->data[i]));
-    }
+    mlc_activation_run_(array, mlc_sigmoid_span_, 0.0f);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
     return 0;
 }
 
@@ -81,10 +345,10 @@ static inline int
 tanh_(MlcArray * array)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("tanh_");
 
-    for (size_t i = 0; i < array->size; ++i) {
-        array->data[i] = tanhf(array->data[i]);
-    }
+    mlc_activation_run_(array, mlc_tanh_span_, 0.0f);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
     return 0;
 }
 
@@ -100,10 +364,10 @@ static inline int
 leaky_relu(MlcArray * array, float alpha)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("leaky_relu");
 
-    for (size_t i = 0; i < array->size; ++i) {
-        array->data[i] = (array->data[i] > 0.0f) ? array->data[i] : alpha * array->data[i];
-    }
+    mlc_activation_run_(array, NULL, alpha);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
     return 0;
 }
 
@@ -122,52 +386,61 @@ static inline int
 softmax(MlcArray *array)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("softmax");
+
+    MlcActivationJob_ job;
+    job.data = array->data;
+    job.array = array;
+
+    if (!mlc_is_direct_(array)) {
+        /* Strided view or fp16/bf16: rows along the last dimension,
+         * one at a time through an fp32 buffer */
+        job.row = array->shape[array->ndims - 1];
+        mlc_parallel_for(array->size / job.row, mlc_parallel_grain(job.row),
+                         mlc_softmax_strided_rows_, &job);
+    }
+    else if (array->ndims == 1) {
+        /* 1D case: reduce the max and the sum across threads */
+        size_t grain = mlc_parallel_grain(1);
+        size_t parts = (array->size + grain - 1) / grain;
+
+        if (parts > MLC_MAX_THREADS) parts = MLC_MAX_THREADS;
+        for (size_t t = 0; t < parts; ++t) {
+            job.partial[t] = -HUGE_VALF;
+        }
 
-    if (array->ndims == 1) {
-        /* Step 1: Find the maximum element for numerical stability (1D case) */
-        float max = array->data[0];
-        for (size_t i = 1; i < array->size; ++i) {
-            max = (array->data[i] > max) ? array->data[i] : max;
+        /* Step 1: Find the maximum element for numerical stability */
+        mlc_parallel_for(array->size, grain, mlc_softmax_max_range_, &job);
+        float max = job.partial[0];
+        for (size_t t = 1; t < parts; ++t) {
+            max = (job.partial[t] > max) ? job.partial[t] : max;
         }
 
         /* Step 2: Compute exponentials in-place and their sum */
+        for (size_t t = 0; t < parts; ++t) {
+            job.partial[t] = 0.0f;
+        }
+        job.alpha = max;
+        mlc_parallel_for(array->size, grain, mlc_softmax_exp_range_, &job);
         float sum = 0.0f;
-        for (size_t i = 0; i < array->size; ++i) {
-            array->data[i] = expf(array->data[i] - max);
-            sum += array->data[i];
+        for (size_t t = 0; t < parts; ++t) {
+            sum += job.partial[t];
         }
 
         /* Step 3: Normalize to get probabilities */
-        for (size_t i = 0; i < array->size; ++i) {
-            array->data[i] /= sum;
-        }
+        job.alpha = 1.0f / sum;
+        mlc_parallel_for(array->size, grain, mlc_softmax_scale_range_, &job);
     } 
 
     else {
-        /* Multi-dimensional case: Apply softmax along the last dimension */
-        size_t last_dim = array->shape[array->ndims - 1];  /* len of last dim */
-        size_t prefix_size = array->size / last_dim;       /* product of prev. dims */
-
-        for (size_t p = 0; p < prefix_size; ++p) {
-            /* Step 1: Find the maximum in the current last-dimension slice */
-            float max = array->data[p * last_dim];
-            for (size_t i = 1; i < last_dim; ++i) {
-                max = (array->data[p * last_dim + i] > max) ? array->data[p * last_dim + i] : max;
-            }
+        /* Multi-dimensional case: Apply softmax along the last dimension,
+         * each row independently, rows split across threads */
+        job.row = array->shape[array->ndims - 1];     /* len of last dim */
+        size_t prefix_size = array->size / job.row;   /* product of prev. dims */
 
-            /* Step 2: Compute exponentials and their sum for the slice */
-            float sum = 0.0f;
-            for (size_t i = 0; i < last_dim; ++i) {
-                array->data[p * last_dim + i] = expf(array->data[p * last_dim + i] - max);
-                sum += array->data[p * last_dim + i];
-            }
-
-            /* Step 3: Normalize the slice */
-            for (size_t i = 0; i < last_dim; ++i) {
-                array->data[p * last_dim + i] /= sum;
-            }
-        }
+        mlc_parallel_for(prefix_size, mlc_parallel_grain(job.row), mlc_softmax_rows_, &job);
     }
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
     return 0;
 }
 
@@ -181,11 +454,339 @@ static inline int
 swish(MlcArray * array)
 {
     if (check_inputs(array) != 0) return -1;
+    MLC_PROFILE_BEGIN("swish");
+
+    mlc_activation_run_(array, mlc_swish_span_, 0.0f);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
+    return 0;
+}
+
+/* Backward pass: */
+
+/**********************************
+ * Backward drivers: a backward job multiplies the upstream
+ * gradient `grad` in place by the activation's derivative,
+ * read from the array saved by the forward pass (its output,
+ * or its input for swish). One read of each array and one
+ * write of grad, no temporaries.
+ **********************************/
+typedef enum
+{
+    MLC_BWD_RELU,
+    MLC_BWD_LEAKY_RELU,
+    MLC_BWD_SIGMOID,
+    MLC_BWD_TANH,
+    MLC_BWD_SWISH,
+    MLC_BWD_SOFTMAX
+}
+MlcBackwardOp_;
+
+typedef struct
+{
+    MlcBackwardOp_ op;
+    const MlcArray * saved;         /* forward output (input for swish) */
+    const MlcArray * grad;
+    float alpha;                    /* leaky ReLU slope; softmax 1D: Σ y * g */
+    size_t row;                     /* softmax: row length */
+    float partial[MLC_MAX_THREADS]; /* softmax 1D: per-part Σ y * g */
+}
+MlcBackwardJob_;
 
-    for (size_t i = 0; i < array->size; ++i) {
-        float x = array->data[i];
-        array->data[i] = x * (1.0f / (1.0f + expf(-x)));
+static inline void
+mlc_backward_apply_(const MlcBackwardJob_ * job, const float * y, float * g, size_t n)
+{
+    switch (job->op)
+    {
+        case MLC_BWD_RELU:
+            mlc_relu_backward_span_(y, g, n);
+            break;
+        case MLC_BWD_LEAKY_RELU:
+            mlc_leaky_relu_backward_span_(y, g, n, job->alpha);
+            break;
+        case MLC_BWD_SIGMOID:
+            mlc_sigmoid_backward_span_(y, g, n);
+            break;
+        case MLC_BWD_TANH:
+            mlc_tanh_backward_span_(y, g, n);
+            break;
+        case MLC_BWD_SWISH:
+            mlc_swish_backward_span_(y, g, n);
+            break;
+        case MLC_BWD_SOFTMAX:
+            mlc_softmax_backward_span_(y, g, n, job->alpha);
+            break;
     }
+}
+
+static inline void
+mlc_backward_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcBackwardJob_ * job = (MlcBackwardJob_ *)ctx;
+    (void)part;
+
+    mlc_backward_apply_(job, job->saved->data + begin, job->grad->data + begin, end - begin);
+}
+
+/* Same over logical positions [begin, end) when either array is strided or fp16/bf16 */
+static inline void
+mlc_backward_strided_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcBackwardJob_ * job = (MlcBackwardJob_ *)ctx;
+    float y_tile[MLC_VIEW_TILE], g_tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t pos = begin; pos < end;) {
+        size_t n, m, y_stride, g_stride;
+        const float * y = mlc_view_run_(job->saved, pos, end, &n, &y_stride);
+        float * g = mlc_view_run_(job->grad, pos, end, &m, &g_stride);
+        n = (m < n) ? m : n;
+
+        if (y_stride == 1 && job->saved->dtype == MLC_DTYPE_F32 &&
+            g_stride == 1 && job->grad->dtype == MLC_DTYPE_F32) {
+            mlc_backward_apply_(job, y, g, n);
+        }
+        else {
+            for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+                m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+                float * gi = mlc_view_advance_(job->grad, g, i * g_stride);
+
+                mlc_view_load_(job->saved, mlc_view_advance_(job->saved, y, i * y_stride),
+                               m, y_stride, y_tile);
+                mlc_view_load_(job->grad, gi, m, g_stride, g_tile);
+                mlc_backward_apply_(job, y_tile, g_tile, m);
+                mlc_view_store_(job->grad, gi, m, g_stride, g_tile);
+            }
+        }
+        pos += n;
+    }
+}
+
+/* Checks the saved array against grad; strided operands pair by position */
+static inline int
+mlc_backward_check_(MlcArray * saved, MlcArray * grad)
+{
+    if (check_inputs(saved) != 0 ||
+        check_inputs(grad) != 0 ||
+        saved->size != grad->size ||
+        (!(mlc_is_contiguous(saved) && mlc_is_contiguous(grad)) && !mlc_same_shape_(saved, grad))
+        ) {
+        LOG_ERROR("Invalid or mismatched array sizes");
+        return -1;
+    }
+    return 0;
+}
+
+static inline void
+mlc_backward_run_(MlcBackwardOp_ op, const MlcArray * saved, const MlcArray * grad, float alpha)
+{
+    MlcBackwardJob_ job;
+
+    job.op = op;
+    job.saved = saved;
+    job.grad = grad;
+    job.alpha = alpha;
+    mlc_parallel_for(grad->size, mlc_parallel_grain(1),
+                     (mlc_is_direct_(saved) && mlc_is_direct_(grad)) ? mlc_backward_range_
+                                                                   : mlc_backward_strided_range_,
+                     &job);
+}
+
+/* Softmax backward over rows [begin, end) of length job->row */
+static inline void
+mlc_softmax_backward_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcBackwardJob_ * job = (MlcBackwardJob_ *)ctx;
+    (void)part;
+
+    for (size_t p = begin; p < end; ++p) {
+        const float * y = job->saved->data + p * job->row;
+        float * g = job->grad->data + p * job->row;
+
+        mlc_softmax_backward_span_(y, g, job->row, mlc_dot_span_(y, g, job->row));
+    }
+}
+
+/* Same for strided or fp16/bf16 arrays, a row at a time through fp32 buffers */
+static inline void
+mlc_softmax_backward_strided_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcBackwardJob_ * job = (MlcBackwardJob_ *)ctx;
+    float * tmp = NULL;
+    (void)part;
+
+    for (size_t p = begin; p < end; ++p) {
+        size_t n, y_stride, g_stride;
+        const float * y = mlc_view_run_(job->saved, p * job->row, job->saved->size, &n, &y_stride);
+        float * g = mlc_view_run_(job->grad, p * job->row, job->grad->size, &n, &g_stride);
+
+        if (y_stride == 1 && job->saved->dtype == MLC_DTYPE_F32 &&
+            g_stride == 1 && job->grad->dtype == MLC_DTYPE_F32) {
+            mlc_softmax_backward_span_(y, g, n, mlc_dot_span_(y, g, n));
+            continue;
+        }
+        if (tmp == NULL) tmp = (float *)malloc(2 * job->row * sizeof(float));
+        if (tmp == NULL) {
+            LOG_ERROR("Memory allocation failed for softmax row");
+            return;
+        }
+        mlc_view_load_(job->saved, y, n, y_stride, tmp);
+        mlc_view_load_(job->grad, g, n, g_stride, tmp + job->row);
+        mlc_softmax_backward_span_(tmp, tmp + job->row, n, mlc_dot_span_(tmp, tmp + job->row, n));
+        mlc_view_store_(job->grad, g, n, g_stride, tmp + job->row);
+    }
+    free(tmp);
+}
+
+/* 1D softmax backward, phase 1: partial Σ y * g */
+static inline void
+mlc_softmax_backward_dot_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcBackwardJob_ * job = (MlcBackwardJob_ *)ctx;
+    job->partial[part] = mlc_dot_span_(job->saved->data + begin, job->grad->data + begin, end - begin);
+}
+
+/**********************************
+ * Backward of ReLU, given the forward output y:
+ *
+ * grad[i] = grad[i] if y[i] > 0, 0 otherwise
+ *
+ * Note: The backward functions overwrite `grad` (the gradient
+ * of the loss with respect to the activation's output) with the
+ * gradient with respect to its input. They return -1 if an
+ * array is NULL or empty, or if the sizes (shapes, for strided
+ * views) differ; 0 otherwise.
+ **********************************/
+static inline int
+relu_backward(MlcArray * output, MlcArray * grad)
+{
+    if (mlc_backward_check_(output, grad) != 0) return -1;
+    MLC_PROFILE_BEGIN("relu_backward");
+
+    mlc_backward_run_(MLC_BWD_RELU, output, grad, 0.0f);
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Backward of sigmoid, given the forward output y:
+ *
+ * grad[i] *= y[i] * (1 - y[i])
+ *
+ **********************************/
+static inline int
+sigmoid_backward(MlcArray * output, MlcArray * grad)
+{
+    if (mlc_backward_check_(output, grad) != 0) return -1;
+    MLC_PROFILE_BEGIN("sigmoid_backward");
+
+    mlc_backward_run_(MLC_BWD_SIGMOID, output, grad, 0.0f);
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Backward of tanh, given the forward output y:
+ *
+ * grad[i] *= 1 - y[i]^2
+ *
+ **********************************/
+static inline int
+tanh_backward(MlcArray * output, MlcArray * grad)
+{
+    if (mlc_backward_check_(output, grad) != 0) return -1;
+    MLC_PROFILE_BEGIN("tanh_backward");
+
+    mlc_backward_run_(MLC_BWD_TANH, output, grad, 0.0f);
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Backward of leaky ReLU, given the forward output y:
+ *
+ * grad[i] = grad[i] if y[i] > 0, alpha * grad[i] otherwise
+ *
+ * Note: y has the sign of the input only for alpha >= 0, which
+ * this assumes.
+ **********************************/
+static inline int
+leaky_relu_backward(MlcArray * output, MlcArray * grad, float alpha)
+{
+    if (mlc_backward_check_(output, grad) != 0) return -1;
+    MLC_PROFILE_BEGIN("leaky_relu_backward");
+
+    mlc_backward_run_(MLC_BWD_LEAKY_RELU, output, grad, alpha);
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Backward of softmax (its Jacobian-vector product), given the
+ * forward output y, along the last dimension as in softmax():
+ *
+ * grad[i] = y[i] * (grad[i] - Σ_j y[j] * grad[j])
+ *
+ * Note: The softmax Jacobian diag(y) - y y^T is symmetric, so
+ * this is both its vector-Jacobian and Jacobian-vector product.
+ * Needs `output` and `grad` of the same shape.
+ **********************************/
+static inline int
+softmax_backward(MlcArray * output, MlcArray * grad)
+{
+    if (mlc_backward_check_(output, grad) != 0) return -1;
+    if (!mlc_same_shape_(output, grad)) {
+        LOG_ERROR("Invalid or mismatched array sizes");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("softmax_backward");
+
+    MlcBackwardJob_ job;
+    job.op = MLC_BWD_SOFTMAX;
+    job.saved = output;
+    job.grad = grad;
+    job.row = grad->shape[grad->ndims - 1];
+
+    if (!mlc_is_direct_(output) || !mlc_is_direct_(grad)) {
+        mlc_parallel_for(grad->size / job.row, mlc_parallel_grain(2 * job.row),
+                         mlc_softmax_backward_strided_rows_, &job);
+    }
+    else if (grad->ndims == 1) {
+        /* 1D case: reduce Σ y * g across threads, then apply */
+        for (size_t t = 0; t < MLC_MAX_THREADS; ++t) {
+            job.partial[t] = 0.0f;
+        }
+        mlc_parallel_for(grad->size, mlc_parallel_grain(1), mlc_softmax_backward_dot_range_, &job);
+        job.alpha = 0.0f;
+        for (size_t t = 0; t < MLC_MAX_THREADS; ++t) {
+            job.alpha += job.partial[t];
+        }
+        mlc_parallel_for(grad->size, mlc_parallel_grain(1), mlc_backward_range_, &job);
+    }
+    else {
+        mlc_parallel_for(grad->size / job.row, mlc_parallel_grain(2 * job.row),
+                         mlc_softmax_backward_rows_, &job);
+    }
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Backward of swish, given the forward INPUT x:
+ *
+ * grad[i] *= s + x[i] * s * (1 - s),  s = sigmoid(x[i])
+ *
+ * Note: swish is not monotonic, so its output does not
+ * determine the derivative; pass the array swish() was applied
+ * to before it was activated (the pre-activation).
+ **********************************/
+static inline int
+swish_backward(MlcArray * input, MlcArray * grad)
+{
+    if (mlc_backward_check_(input, grad) != 0) return -1;
+    MLC_PROFILE_BEGIN("swish_backward");
+
+    mlc_backward_run_(MLC_BWD_SWISH, input, grad, 0.0f);
+    MLC_PROFILE_END(grad->size, 3 * grad->size * sizeof(float));
     return 0;
 }
 
@@ -0,0 +1,356 @@
+/* include/mlc/arena.h */
+
+#ifndef MLC_ARENA_H
+#define MLC_ARENA_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mlc/data.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Arena allocation for MlcArray:
+ *
+ * prepare_data() and mlc_read_csv() make two separate malloc()
+ * calls per array (data and shape). Loops that create and
+ * finish many short-lived arrays pay for that on every batch.
+ * An MlcArena hands out arrays as one block each, with the
+ * shape stored inline in front of 64-byte aligned data:
+ *
+ *   [MlcBlockHeader | shape[ndims] | pad] [data ...]
+ *                                          ^ 64-byte aligned
+ *
+ * Blocks come from large chunks obtained with aligned_alloc(),
+ * in one of two ways:
+ *
+ *  - mlc_arena_array(): bump allocation. mlc_finish() on such
+ *    an array only detaches it; the memory is reclaimed all at
+ *    once by mlc_arena_reset(). Best for per-batch temporaries.
+ *  - mlc_arena_pooled_array(): the block size is rounded up to
+ *    a power-of-two size class, and mlc_finish() puts it on the
+ *    arena's free list for that class, to be reused by the next
+ *    array of a similar size.
+ *
+ * Example:
+ *
+ *   MlcArena arena;
+ *   mlc_arena_init(&arena, 0);
+ *   for (each batch) {
+ *       MlcArray tmp = mlc_arena_array(&arena, 2, shape);
+ *       ...
+ *       mlc_arena_reset(&arena);
+ *   }
+ *   mlc_arena_destroy(&arena);
+ *
+ * Note:
+ *  - An arena is not thread-safe; use one arena per thread.
+ *  - mlc_arena_reset() and mlc_arena_destroy() invalidate every
+ *    array taken from the arena, pooled or not.
+ *  - Arena arrays work with every kernel, exactly like heap
+ *    arrays; their data is additionally MLC_ARENA_ALIGN-aligned.
+ *
+ * Functions return -1 (or an MlcArray with data = NULL) on
+ * error, and 0 on success.
+ *************************************************************/
+
+#ifndef MLC_ARENA_ALIGN
+    #define MLC_ARENA_ALIGN 64u
+#endif
+#ifndef MLC_ARENA_CHUNK
+    #define MLC_ARENA_CHUNK (1u << 20)    /* default chunk size in bytes */
+#endif
+#define MLC_ARENA_MIN_CLASS 8u            /* smallest pooled block: 256 bytes */
+#define MLC_ARENA_CLASSES 32
+
+/* A chunk of arena memory; blocks are carved from its tail. */
+typedef struct MlcArenaChunk_
+{
+    struct MlcArenaChunk_ * next;
+    size_t size;                /* bytes, header included */
+    size_t used;                /* bytes, header included */
+}
+MlcArenaChunk_;
+
+typedef struct
+{
+    MlcArenaChunk_ * chunks;    /* in allocation order */
+    MlcArenaChunk_ * current;   /* chunk being bumped */
+    size_t chunk_size;
+    MlcBlockHeader * free_list[MLC_ARENA_CLASSES];
+}
+MlcArena;
+
+static inline size_t
+mlc_arena_round_up_(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+/* Offset of the chunk payload: the chunk header padded to the alignment */
+#define MLC_ARENA_CHUNK_HEADER_ \
+    ((sizeof(MlcArenaChunk_) + MLC_ARENA_ALIGN - 1) / MLC_ARENA_ALIGN * MLC_ARENA_ALIGN)
+
+/**********************************
+ * Initializes an empty arena. Chunks of `chunk_size` bytes
+ * (0 = MLC_ARENA_CHUNK) are allocated as needed; larger
+ * requests get a chunk of their own.
+ **********************************/
+static inline int
+mlc_arena_init(MlcArena * arena, size_t chunk_size)
+{
+    if (arena == NULL) {
+        LOG_ERROR("Invalid arena");
+        return -1;
+    }
+    memset(arena, 0, sizeof(*arena));
+    arena->chunk_size = (chunk_size != 0) ? chunk_size : MLC_ARENA_CHUNK;
+    return 0;
+}
+
+/**********************************
+ * Returns `bytes` bytes of MLC_ARENA_ALIGN-aligned memory from
+ * the arena, or NULL if a new chunk cannot be allocated. The
+ * memory stays valid until mlc_arena_reset()/mlc_arena_destroy().
+ **********************************/
+static inline void *
+mlc_arena_alloc(MlcArena * arena, size_t bytes)
+{
+    if (arena == NULL || bytes == 0) {
+        LOG_ERROR("Invalid arena or size");
+        return NULL;
+    }
+    bytes = mlc_arena_round_up_(bytes, MLC_ARENA_ALIGN);
+
+    /* Walk forward through chunks kept from before the last reset */
+    while (arena->current != NULL &&
+           arena->current->size - arena->current->used < bytes) {
+        arena->current = arena->current->next;
+    }
+    if (arena->current == NULL) {
+        size_t size = MLC_ARENA_CHUNK_HEADER_ + bytes;
+
+        if (size < arena->chunk_size) size = arena->chunk_size;
+        size = mlc_arena_round_up_(size, MLC_ARENA_ALIGN);
+
+        MlcArenaChunk_ * chunk = (MlcArenaChunk_ *)aligned_alloc(MLC_ARENA_ALIGN, size);
+        if (chunk == NULL) {
+            LOG_ERROR("Memory allocation failed for arena chunk");
+            return NULL;
+        }
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = MLC_ARENA_CHUNK_HEADER_;
+
+        /* Append, so reset() reuses chunks in the same order */
+        MlcArenaChunk_ ** link = &arena->chunks;
+        while (*link != NULL) link = &(*link)->next;
+        *link = chunk;
+        arena->current = chunk;
+    }
+    char * memory = (char *)arena->current + arena->current->used;
+    arena->current->used += bytes;
+    return memory;
+}
+
+/**********************************
+ * Makes all arena memory available again without returning it
+ * to the system. Every array and block taken from the arena
+ * becomes invalid.
+ **********************************/
+static inline void
+mlc_arena_reset(MlcArena * arena)
+{
+    if (arena == NULL) return;
+
+    for (MlcArenaChunk_ * chunk = arena->chunks; chunk != NULL; chunk = chunk->next) {
+        chunk->used = MLC_ARENA_CHUNK_HEADER_;
+    }
+    arena->current = arena->chunks;
+    memset(arena->free_list, 0, sizeof(arena->free_list));
+}
+
+/* Frees every chunk; the arena can be initialized again afterwards. */
+static inline void
+mlc_arena_destroy(MlcArena * arena)
+{
+    if (arena == NULL) return;
+
+    MlcArenaChunk_ * chunk = arena->chunks;
+    while (chunk != NULL) {
+        MlcArenaChunk_ * next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+/* Offset of the data from the start of a block with `ndims` dims */
+static inline size_t
+mlc_arena_data_offset_(size_t ndims)
+{
+    return mlc_arena_round_up_(sizeof(MlcBlockHeader) + ndims * sizeof(size_t), MLC_ARENA_ALIGN);
+}
+
+/* free-list push, installed as MlcBlockHeader::release for pooled blocks */
+static inline void
+mlc_arena_release_(MlcBlockHeader * block)
+{
+    MlcArena * arena = (MlcArena *)block->owner;
+
+    block->next = arena->free_list[block->size_class];
+    arena->free_list[block->size_class] = block;
+}
+
+/* Size class (power of two, at least 2^MLC_ARENA_MIN_CLASS) for `bytes` */
+static inline size_t
+mlc_arena_size_class_(size_t bytes)
+{
+    size_t size_class = MLC_ARENA_MIN_CLASS;
+
+    while (size_class < MLC_ARENA_CLASSES - 1 && ((size_t)1 << size_class) < bytes) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+/* Fills in the block header, the inline shape and the MlcArray fields */
+static inline MlcArray
+mlc_arena_wrap_(MlcBlockHeader * block, size_t ndims, const size_t * shape, size_t size)
+{
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_ARENA, NULL, 0, NULL, MLC_DTYPE_F32};
+    size_t * inline_shape = (size_t *)(block + 1);
+
+    memcpy(inline_shape, shape, ndims * sizeof(size_t));
+    result.data = (float *)((char *)block + mlc_arena_data_offset_(ndims));
+    result.shape = inline_shape;
+    result.size = size;
+    result.base = block;
+    return result;
+}
+
+/* Product of the shape, or 0 if it is invalid */
+static inline size_t
+mlc_arena_shape_size_(size_t ndims, const size_t * shape)
+{
+    size_t size = 1;
+
+    if (ndims == 0 || shape == NULL) return 0;
+    for (size_t i = 0; i < ndims; ++i) {
+        size *= shape[i];
+    }
+    return size;
+}
+
+/**********************************
+ * Creates an uninitialized array in the arena by bump
+ * allocation: one block holding the shape and 64-byte aligned
+ * data. mlc_finish() releases nothing; the block is reclaimed
+ * by mlc_arena_reset().
+ *
+ * Arguments:
+ *  - arena: Arena to allocate from.
+ *  - ndims: Number of dimensions.
+ *  - shape: Array of dimension sizes (copied into the block).
+ *
+ * Returns:
+ *  - An MlcArray with storage MLC_STORAGE_ARENA.
+ *  - If error occurs, data = NULL.
+ **********************************/
+static inline MlcArray
+mlc_arena_array(MlcArena * arena, size_t ndims, const size_t * shape)
+{
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    size_t size = mlc_arena_shape_size_(ndims, shape);
+
+    if (arena == NULL || size == 0) {
+        LOG_ERROR("Invalid arena or shape");
+        return result;
+    }
+    size_t bytes = mlc_arena_data_offset_(ndims) + size * sizeof(float);
+    MlcBlockHeader * block = (MlcBlockHeader *)mlc_arena_alloc(arena, bytes);
+
+    if (block == NULL) return result;
+    block->release = NULL;
+    block->owner = arena;
+    block->size_class = 0;
+    block->next = NULL;
+    return mlc_arena_wrap_(block, ndims, shape, size);
+}
+
+/**********************************
+ * Creates an uninitialized array from the arena's size-class
+ * pool. mlc_finish() returns the block to the pool, and later
+ * pooled arrays of the same class reuse it instead of growing
+ * the arena, so create/finish loops run in constant memory.
+ *
+ * Arguments and return value as for mlc_arena_array().
+ **********************************/
+static inline MlcArray
+mlc_arena_pooled_array(MlcArena * arena, size_t ndims, const size_t * shape)
+{
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    size_t size = mlc_arena_shape_size_(ndims, shape);
+
+    if (arena == NULL || size == 0) {
+        LOG_ERROR("Invalid arena or shape");
+        return result;
+    }
+    size_t bytes = mlc_arena_data_offset_(ndims) + size * sizeof(float);
+    size_t size_class = mlc_arena_size_class_(bytes);
+
+    if (bytes > ((size_t)1 << size_class)) {
+        LOG_ERROR("Array too large for the arena pool");
+        return result;
+    }
+    MlcBlockHeader * block = arena->free_list[size_class];
+
+    if (block != NULL) {
+        arena->free_list[size_class] = block->next;
+    }
+    else {
+        block = (MlcBlockHeader *)mlc_arena_alloc(arena, (size_t)1 << size_class);
+        if (block == NULL) return result;
+    }
+    block->release = mlc_arena_release_;
+    block->owner = arena;
+    block->size_class = size_class;
+    block->next = NULL;
+    return mlc_arena_wrap_(block, ndims, shape, size);
+}
+
+/**********************************
+ * prepare_data() into a pooled arena block: converts `input`
+ * to float in a single aligned allocation instead of two
+ * malloc() calls.
+ *
+ * Arguments:
+ *  - arena: Arena to allocate from.
+ *  - input, ndims, shape, input_type: As for prepare_data().
+ *
+ * Returns:
+ *  - An MlcArray with storage MLC_STORAGE_ARENA.
+ *  - If error occurs, data = NULL.
+ **********************************/
+static inline MlcArray
+mlc_arena_prepare_data(MlcArena * arena, const void * input, size_t ndims,
+                       const size_t * shape, DataType input_type)
+{
+    if (input == NULL) {
+        MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+        LOG_ERROR("Invalid input or dimensions");
+        return result;
+    }
+    MLC_PROFILE_BEGIN("mlc_arena_prepare_data");
+    MlcArray result = mlc_arena_pooled_array(arena, ndims, shape);
+
+    if (result.data == NULL) return result;
+    if (mlc_convert_to_float_(input, input_type, result.data, result.size) != 0) {
+        mlc_finish(&result);
+        return result;
+    }
+    MLC_PROFILE_END(result.size, 2 * result.size * sizeof(float));
+    return result;
+}
+
+#endif /* MLC_ARENA_H */
@@ -18,4 +18,10 @@
     #define LOG_ERROR(msg) do {} while (0)
 #endif
 
+/*
+ * Define MLC_PROFILE the same way to record per-kernel call counts,
+ * elements, bytes and time; see profile.h for mlc_profile_report().
+ */
+#include <mlc/profile.h>
+
 #endif /* MLC_CONFIG_H */
\ No newline at end of file
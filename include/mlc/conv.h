@@ -0,0 +1,626 @@
+/* include/mlc/conv.h */
+
+#ifndef MLC_CONV_H
+#define MLC_CONV_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/matrix.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Convolution and pooling:
+ *
+ * Images are NCHW MlcArrays: (N x C x H x W), or (C x H x W)
+ * for a single image. Weights are (K x C x R x S) for K output
+ * channels and an R x S kernel. Results are written into a
+ * caller provided array of the right shape; it must be fp32,
+ * contiguous and must not alias the inputs. mlc_conv_out_dim()
+ * gives the output height and width:
+ *
+ *   P = (H + 2 pad_h - dilation_h (R - 1) - 1) / stride_h + 1
+ *
+ * mlc_conv2d() has two paths, picked by shape (or forced with
+ * MlcConv2d.algo):
+ *
+ *  - im2col + GEMM: the output positions of an image are cut
+ *    into tiles; for each tile the (C R S x tile) patch matrix
+ *    is built in a small per-thread buffer and multiplied by
+ *    the (K x C R S) weights with mlc_sgemm() (matrix.h). The
+ *    patch matrix is never built for the whole image, and a
+ *    1x1 convolution with stride 1 multiplies the input
+ *    directly. Used for 1x1 layers and large C R S.
+ *  - direct: the weights are packed into blocks of 8 output
+ *    channels (the "c" of NCHWc) and each output row is
+ *    computed by mlc_conv_direct_row_() (kernels.h), keeping
+ *    8 positions x 8 channels in registers and reading the
+ *    (zero-padded) input in place. Used while a block of
+ *    weights fits L1 (C R S <= MLC_CONV_DIRECT_MAX_TAPS):
+ *    there building the patch matrix costs about as much as
+ *    the products, most of all for the first layers of a CNN.
+ *
+ * Tiles (im2col) and output rows (direct) are split across the
+ * thread pool. mlc_max_pool2d() and mlc_avg_pool2d() pool each
+ * plane; padding is never part of a window (average pooling
+ * divides by the elements actually covered).
+ *
+ * fp16/bf16 or strided inputs and weights are first widened to
+ * contiguous fp32 copies with mlc_cast().
+ *
+ * Functions return -1 on invalid or mismatched shapes and on
+ * allocation failure, and 0 on success.
+ *************************************************************/
+
+#ifndef MLC_CONV_TILE_BYTES
+    #define MLC_CONV_TILE_BYTES (128u << 10)   /* im2col patch buffer per thread */
+#endif
+#ifndef MLC_CONV_DIRECT_MAX_TAPS
+    #define MLC_CONV_DIRECT_MAX_TAPS 512       /* auto: direct up to this C R S (16 KB weight block) */
+#endif
+
+typedef enum
+{
+    MLC_CONV_AUTO,
+    MLC_CONV_IM2COL,
+    MLC_CONV_DIRECT
+}
+MlcConvAlgo;
+
+typedef struct
+{
+    size_t stride_h, stride_w;
+    size_t pad_h, pad_w;            /* zeros added on each side */
+    size_t dilation_h, dilation_w;  /* 1: dense kernel */
+    MlcConvAlgo algo;
+}
+MlcConv2d;
+
+typedef struct
+{
+    size_t kernel_h, kernel_w;
+    size_t stride_h, stride_w;
+    size_t pad_h, pad_w;
+}
+MlcPool2d;
+
+/* Same stride, padding and dilation in both directions, path picked by shape */
+static inline MlcConv2d
+mlc_conv2d_params(size_t stride, size_t pad, size_t dilation)
+{
+    MlcConv2d params = {stride, stride, pad, pad, dilation, dilation, MLC_CONV_AUTO};
+    return params;
+}
+
+static inline MlcPool2d
+mlc_pool2d_params(size_t kernel, size_t stride, size_t pad)
+{
+    MlcPool2d params = {kernel, kernel, stride, stride, pad, pad};
+    return params;
+}
+
+/* Output size along one dimension; 0 if the kernel does not fit */
+static inline size_t
+mlc_conv_out_dim(size_t size, size_t kernel, size_t stride, size_t pad, size_t dilation)
+{
+    size_t span = dilation * (kernel - 1) + 1;
+
+    if (kernel == 0 || stride == 0 || dilation == 0 || size + 2 * pad < span) return 0;
+    return (size + 2 * pad - span) / stride + 1;
+}
+
+typedef struct
+{
+    size_t n, c, h, w;              /* input */
+    size_t k, r, s;                 /* weights */
+    size_t p, q;                    /* output */
+}
+MlcConvShape_;
+
+/* Images, channels, height and width of a 3D or 4D NCHW array */
+static inline int
+mlc_conv_nchw_(const MlcArray * x, size_t dims[4])
+{
+    if (check_inputs((MlcArray *)x) != 0 || (x->ndims != 3 && x->ndims != 4)) return -1;
+
+    size_t first = x->ndims - 3;
+    dims[0] = (x->ndims == 4) ? x->shape[0] : 1;
+    dims[1] = x->shape[first];
+    dims[2] = x->shape[first + 1];
+    dims[3] = x->shape[first + 2];
+    return 0;
+}
+
+/* Checks that output is a contiguous fp32 NCHW array of {n, c, p, q}, like input */
+static inline int
+mlc_conv_output_ok_(const MlcArray * input, const MlcArray * output, size_t n, size_t c,
+                    size_t p, size_t q)
+{
+    size_t dims[4];
+
+    return mlc_conv_nchw_(output, dims) == 0 && output->ndims == input->ndims &&
+           mlc_is_direct_(output) &&
+           dims[0] == n && dims[1] == c && dims[2] == p && dims[3] == q;
+}
+
+/* x itself if contiguous fp32, otherwise a contiguous fp32 copy in *copy */
+static inline const MlcArray *
+mlc_conv_operand_(const MlcArray * x, MlcArray * copy)
+{
+    MlcArray empty = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    *copy = empty;
+    if (mlc_is_direct_(x)) return x;
+    *copy = mlc_cast(x, MLC_DTYPE_F32);
+    return copy;
+}
+
+/**********************************
+ * im2col + GEMM path
+ **********************************/
+typedef struct
+{
+    const float * in;
+    const float * weight;           /* (K x C R S) */
+    const float * bias;
+    float * out;
+    MlcConvShape_ sh;
+    MlcConv2d params;
+    size_t tile;                    /* output positions per tile */
+    size_t tiles;                   /* tiles per image */
+    float * scratch;                /* per part: patches, then GEMM workspace */
+    size_t scratch_floats;
+}
+MlcConvGemmJob_;
+
+/* Patch matrix of positions [j0, j0 + count) of one image: (C R S x count) */
+static inline void
+mlc_conv_im2col_(const MlcConvGemmJob_ * job, const float * image, size_t j0, size_t count,
+                 float * col)
+{
+    const MlcConvShape_ * sh = &job->sh;
+    const MlcConv2d * pr = &job->params;
+
+    for (size_t c = 0; c < sh->c; ++c) {
+        const float * plane = image + c * sh->h * sh->w;
+
+        for (size_t r = 0; r < sh->r; ++r) {
+            for (size_t s = 0; s < sh->s; ++s) {
+                size_t op = j0 / sh->q, oq = j0 % sh->q;
+
+                for (size_t j = 0; j < count; ++j) {
+                    /* Unsigned wrap-around makes negative coordinates fail the bounds check */
+                    size_t ih = op * pr->stride_h + r * pr->dilation_h - pr->pad_h;
+                    size_t iw = oq * pr->stride_w + s * pr->dilation_w - pr->pad_w;
+
+                    col[j] = (ih < sh->h && iw < sh->w) ? plane[ih * sh->w + iw] : 0.0f;
+                    if (++oq == sh->q) {
+                        oq = 0;
+                        ++op;
+                    }
+                }
+                col += count;
+            }
+        }
+    }
+}
+
+static inline void
+mlc_conv_gemm_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcConvGemmJob_ * job = (const MlcConvGemmJob_ *)ctx;
+    const MlcConvShape_ * sh = &job->sh;
+    const MlcConv2d * pr = &job->params;
+    size_t taps = sh->c * sh->r * sh->s;
+    size_t positions = sh->p * sh->q;
+    int pointwise = (sh->r == 1 && sh->s == 1 && pr->stride_h == 1 && pr->stride_w == 1 &&
+                     pr->pad_h == 0 && pr->pad_w == 0);
+    float * col = job->scratch + part * job->scratch_floats;
+    float * workspace = col + (pointwise ? 0 : mlc_gemm_round_up_(taps * job->tile, 16));
+
+    for (size_t item = begin; item < end; ++item) {
+        size_t n = item / job->tiles;
+        size_t j0 = (item % job->tiles) * job->tile;
+        size_t count = (positions - j0 < job->tile) ? positions - j0 : job->tile;
+        const float * image = job->in + n * sh->c * sh->h * sh->w;
+        float * out = job->out + n * sh->k * positions + j0;
+
+        if (pointwise) {
+            /* The input planes are the patch matrix already */
+            mlc_sgemm(sh->k, count, taps, job->weight, taps, image + j0, positions,
+                      out, positions, workspace);
+        }
+        else {
+            mlc_conv_im2col_(job, image, j0, count, col);
+            mlc_sgemm(sh->k, count, taps, job->weight, taps, col, count, out, positions, workspace);
+        }
+        if (job->bias != NULL) {
+            for (size_t k = 0; k < sh->k; ++k) {
+                float b = job->bias[k];
+                float * row = out + k * positions;
+
+                for (size_t j = 0; j < count; ++j) row[j] += b;
+            }
+        }
+    }
+}
+
+static inline int
+mlc_conv_gemm_(const float * in, const float * weight, const float * bias, float * out,
+               const MlcConvShape_ * sh, const MlcConv2d * params)
+{
+    size_t taps = sh->c * sh->r * sh->s;
+    size_t positions = sh->p * sh->q;
+
+    /* Tiles of whole micro-kernel widths whose patches fit MLC_CONV_TILE_BYTES */
+    size_t tile = MLC_CONV_TILE_BYTES / sizeof(float) / taps / MLC_GEMM_NR * MLC_GEMM_NR;
+    if (tile < MLC_GEMM_NR) tile = MLC_GEMM_NR;
+    if (tile > positions) tile = positions;
+
+    MlcConvGemmJob_ job = {in, weight, bias, out, *sh, *params, tile,
+                           (positions + tile - 1) / tile, NULL, 0};
+    size_t items = sh->n * job.tiles;
+    size_t parts = mlc_get_num_threads();
+    if (parts > items) parts = items;
+
+    job.scratch_floats = mlc_gemm_round_up_(taps * tile, 16) +
+                         mlc_gemm_round_up_(mlc_gemm_workspace_size(sh->k, tile, taps), 16);
+    job.scratch = (float *)aligned_alloc(64, parts * job.scratch_floats * sizeof(float));
+    if (job.scratch == NULL) {
+        LOG_ERROR("Memory allocation failed for convolution workspace");
+        return -1;
+    }
+    mlc_parallel_for(items, 1, mlc_conv_gemm_range_, &job);
+    free(job.scratch);
+    return 0;
+}
+
+/**********************************
+ * Direct path
+ **********************************/
+typedef struct
+{
+    const float * in;               /* zero-padded input, (N x C x Hp x Wp) */
+    size_t hp, wp;
+    const float * packed;           /* (K/8 x C R S x 8) weights */
+    const size_t * offsets;         /* per tap, into one padded image */
+    const float * bias;
+    float * out;
+    MlcConvShape_ sh;
+    MlcConv2d params;
+    size_t blocks;                  /* K/8, rounded up */
+    float * rows;                   /* per part: one output row of 8 channels */
+    const float * source;           /* unpadded input, for mlc_conv_pad_range_ */
+}
+MlcConvDirectJob_;
+
+static inline void
+mlc_conv_direct_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcConvDirectJob_ * job = (const MlcConvDirectJob_ *)ctx;
+    const MlcConvShape_ * sh = &job->sh;
+    size_t taps = sh->c * sh->r * sh->s;
+    size_t positions = sh->p * sh->q;
+    float * row = job->rows + part * sh->q * 8;
+
+    /* Items run over (image, channel block, output row), rows fastest: weights stay cached */
+    for (size_t item = begin; item < end; ++item) {
+        size_t op = item % sh->p;
+        size_t kb = (item / sh->p) % job->blocks;
+        size_t n = item / sh->p / job->blocks;
+        const float * base = job->in + n * sh->c * job->hp * job->wp +
+                             op * job->params.stride_h * job->wp;
+        size_t lanes = (sh->k - kb * 8 < 8) ? sh->k - kb * 8 : 8;
+
+        mlc_conv_direct_row_(base, job->params.stride_w, job->offsets,
+                             job->packed + kb * taps * 8, taps, row, sh->q);
+
+        /* Blocked row back to NCHW */
+        for (size_t l = 0; l < lanes; ++l) {
+            size_t k = kb * 8 + l;
+            float b = job->bias ? job->bias[k] : 0.0f;
+            float * out = job->out + (n * sh->k + k) * positions + op * sh->q;
+
+            for (size_t q = 0; q < sh->q; ++q) out[q] = row[q * 8 + l] + b;
+        }
+    }
+}
+
+/* Copies plane by plane into the zero border of a padded buffer */
+static inline void
+mlc_conv_pad_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcConvDirectJob_ * job = (const MlcConvDirectJob_ *)ctx;
+    const MlcConvShape_ * sh = &job->sh;
+    float * padded = (float *)job->in;
+    (void)part;
+
+    for (size_t plane = begin; plane < end; ++plane) {
+        const float * src = job->source + plane * sh->h * sh->w;
+        float * dst = padded + plane * job->hp * job->wp;
+
+        memset(dst, 0, job->hp * job->wp * sizeof(float));
+        for (size_t y = 0; y < sh->h; ++y) {
+            memcpy(dst + (y + job->params.pad_h) * job->wp + job->params.pad_w,
+                   src + y * sh->w, sh->w * sizeof(float));
+        }
+    }
+}
+
+static inline int
+mlc_conv_direct_(const float * in, const float * weight, const float * bias, float * out,
+                 const MlcConvShape_ * sh, const MlcConv2d * params)
+{
+    size_t taps = sh->c * sh->r * sh->s;
+    size_t blocks = (sh->k + 7) / 8;
+    size_t hp = sh->h + 2 * params->pad_h;
+    size_t wp = sh->w + 2 * params->pad_w;
+    int padded = (params->pad_h != 0 || params->pad_w != 0);
+    size_t parts = mlc_get_num_threads();
+
+    float * packed = (float *)malloc(blocks * taps * 8 * sizeof(float));
+    size_t * offsets = (size_t *)malloc(taps * sizeof(size_t));
+    float * rows = (float *)malloc(parts * sh->q * 8 * sizeof(float));
+    float * buffer = padded ? (float *)malloc(sh->n * sh->c * hp * wp * sizeof(float)) : NULL;
+
+    if (packed == NULL || offsets == NULL || rows == NULL || (padded && buffer == NULL)) {
+        LOG_ERROR("Memory allocation failed for convolution workspace");
+        free(packed);
+        free(offsets);
+        free(rows);
+        free(buffer);
+        return -1;
+    }
+
+    /* packed[kb][t][l] = weight[kb * 8 + l][t], zero past K */
+    for (size_t kb = 0; kb < blocks; ++kb) {
+        for (size_t t = 0; t < taps; ++t) {
+            for (size_t l = 0; l < 8; ++l) {
+                size_t k = kb * 8 + l;
+                packed[(kb * taps + t) * 8 + l] = (k < sh->k) ? weight[k * taps + t] : 0.0f;
+            }
+        }
+    }
+    for (size_t c = 0, t = 0; c < sh->c; ++c) {
+        for (size_t r = 0; r < sh->r; ++r) {
+            for (size_t s = 0; s < sh->s; ++s, ++t) {
+                offsets[t] = (c * hp + r * params->dilation_h) * wp + s * params->dilation_w;
+            }
+        }
+    }
+
+    MlcConvDirectJob_ job = {padded ? buffer : in, hp, wp, packed, offsets, bias, out,
+                             *sh, *params, blocks, rows, in};
+    if (padded) {
+        mlc_parallel_for(sh->n * sh->c, mlc_parallel_grain(hp * wp), mlc_conv_pad_range_, &job);
+    }
+    mlc_parallel_for(sh->n * blocks * sh->p, 1, mlc_conv_direct_range_, &job);
+
+    free(packed);
+    free(offsets);
+    free(rows);
+    free(buffer);
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of 2D convolution:
+ *
+ * out[n][k][p][q] = bias[k] + Σ_c Σ_r Σ_s weight[k][c][r][s] *
+ *     in[n][c][p * stride_h + r * dilation_h - pad_h]
+ *              [q * stride_w + s * dilation_w - pad_w]
+ *
+ * with zeros outside the input (cross-correlation, as in most
+ * frameworks).
+ * Shapes: input (N x C x H x W) or (C x H x W), weight
+ * (K x C x R x S), bias K elements or NULL, output (N x K x P x Q)
+ * or (K x P x Q), see mlc_conv_out_dim().
+ **********************************/
+static inline int
+mlc_conv2d(const MlcArray * input, const MlcArray * weight, const MlcArray * bias,
+           const MlcConv2d * params, MlcArray * output)
+{
+    size_t in_dims[4];
+    MlcConvShape_ sh;
+
+    if (params == NULL || mlc_conv_nchw_(input, in_dims) != 0 ||
+        check_inputs((MlcArray *)weight) != 0 || weight->ndims != 4 ||
+        weight->shape[1] != in_dims[1] ||
+        (bias != NULL && (check_inputs((MlcArray *)bias) != 0 || bias->size != weight->shape[0]))) {
+        LOG_ERROR("Invalid or mismatched convolution input");
+        return -1;
+    }
+    sh.n = in_dims[0];
+    sh.c = in_dims[1];
+    sh.h = in_dims[2];
+    sh.w = in_dims[3];
+    sh.k = weight->shape[0];
+    sh.r = weight->shape[2];
+    sh.s = weight->shape[3];
+    sh.p = mlc_conv_out_dim(sh.h, sh.r, params->stride_h, params->pad_h, params->dilation_h);
+    sh.q = mlc_conv_out_dim(sh.w, sh.s, params->stride_w, params->pad_w, params->dilation_w);
+
+    if (sh.p == 0 || sh.q == 0 || !mlc_conv_output_ok_(input, output, sh.n, sh.k, sh.p, sh.q)) {
+        LOG_ERROR("Invalid convolution parameters or output shape");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_conv2d");
+
+    MlcArray in_copy, w_copy, b_copy = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    const MlcArray * x = mlc_conv_operand_(input, &in_copy);
+    const MlcArray * w = mlc_conv_operand_(weight, &w_copy);
+    const MlcArray * b = bias ? mlc_conv_operand_(bias, &b_copy) : NULL;
+    int status = -1;
+
+    if (x->data == NULL || w->data == NULL || (b != NULL && b->data == NULL)) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+    }
+    else {
+        MlcConvAlgo algo = params->algo;
+
+        if (algo == MLC_CONV_AUTO) {
+            /* A pointwise layer is a plain GEMM; otherwise direct while a weight block fits L1 */
+            int pointwise = (sh.r == 1 && sh.s == 1 && params->stride_h == 1 && params->stride_w == 1 &&
+                             params->pad_h == 0 && params->pad_w == 0);
+            algo = (!pointwise && sh.c * sh.r * sh.s <= MLC_CONV_DIRECT_MAX_TAPS)
+                 ? MLC_CONV_DIRECT : MLC_CONV_IM2COL;
+        }
+        status = (algo == MLC_CONV_DIRECT)
+               ? mlc_conv_direct_(x->data, w->data, b ? b->data : NULL, output->data, &sh, params)
+               : mlc_conv_gemm_(x->data, w->data, b ? b->data : NULL, output->data, &sh, params);
+    }
+    mlc_finish(&in_copy);
+    mlc_finish(&w_copy);
+    mlc_finish(&b_copy);
+    MLC_PROFILE_END(sh.n * sh.k * sh.p * sh.q * sh.c * sh.r * sh.s,
+                    (input->size + weight->size + output->size) * sizeof(float));
+    return status;
+}
+
+/**********************************
+ * Pooling
+ **********************************/
+typedef struct
+{
+    const float * in;
+    float * out;
+    size_t h, w, p, q;
+    MlcPool2d params;
+    int max;
+}
+MlcPoolJob_;
+
+static inline void
+mlc_pool_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcPoolJob_ * job = (const MlcPoolJob_ *)ctx;
+    const MlcPool2d * pr = &job->params;
+    (void)part;
+
+    for (size_t plane = begin; plane < end; ++plane) {
+        const float * in = job->in + plane * job->h * job->w;
+        float * out = job->out + plane * job->p * job->q;
+
+        for (size_t op = 0; op < job->p; ++op) {
+            /* Window rows clipped to the input */
+            size_t top = op * pr->stride_h;
+            size_t y0 = (top > pr->pad_h) ? top - pr->pad_h : 0;
+            size_t y1 = top + pr->kernel_h - pr->pad_h;
+            if (y1 > job->h) y1 = job->h;
+
+            for (size_t oq = 0; oq < job->q; ++oq) {
+                size_t left = oq * pr->stride_w;
+                size_t x0 = (left > pr->pad_w) ? left - pr->pad_w : 0;
+                size_t x1 = left + pr->kernel_w - pr->pad_w;
+                if (x1 > job->w) x1 = job->w;
+
+                float acc = job->max ? -INFINITY : 0.0f;
+                for (size_t y = y0; y < y1; ++y) {
+                    const float * row = in + y * job->w;
+
+                    if (job->max) {
+                        for (size_t x = x0; x < x1; ++x) acc = (row[x] > acc) ? row[x] : acc;
+                    }
+                    else {
+                        for (size_t x = x0; x < x1; ++x) acc += row[x];
+                    }
+                }
+                out[op * job->q + oq] = job->max ? acc : acc / (float)((y1 - y0) * (x1 - x0));
+            }
+        }
+    }
+}
+
+/* Checks a pooling call; dims[4] = {N, C, P, Q} of the output */
+static inline int
+mlc_pool2d_check_(const MlcArray * input, const MlcPool2d * params, const MlcArray * output,
+                  size_t dims[4])
+{
+    if (params == NULL || mlc_conv_nchw_(input, dims) != 0 ||
+        params->pad_h >= params->kernel_h || params->pad_w >= params->kernel_w) {
+        LOG_ERROR("Invalid pooling input or parameters (padding must be below the kernel size)");
+        return -1;
+    }
+    dims[2] = mlc_conv_out_dim(dims[2], params->kernel_h, params->stride_h, params->pad_h, 1);
+    dims[3] = mlc_conv_out_dim(dims[3], params->kernel_w, params->stride_w, params->pad_w, 1);
+
+    if (dims[2] == 0 || dims[3] == 0 ||
+        !mlc_conv_output_ok_(input, output, dims[0], dims[1], dims[2], dims[3])) {
+        LOG_ERROR("Invalid pooling parameters or output shape");
+        return -1;
+    }
+    return 0;
+}
+
+static inline int
+mlc_pool2d_(const MlcArray * input, const MlcPool2d * params, MlcArray * output,
+            const size_t dims[4], int max)
+{
+    size_t first = input->ndims - 3;
+    MlcArray copy;
+    const MlcArray * x = mlc_conv_operand_(input, &copy);
+
+    if (x->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        return -1;
+    }
+    MlcPoolJob_ job = {x->data, output->data, input->shape[first + 1], input->shape[first + 2],
+                       dims[2], dims[3], *params, max};
+    mlc_parallel_for(dims[0] * dims[1], mlc_parallel_grain(job.h * job.w), mlc_pool_range_, &job);
+
+    mlc_finish(&copy);
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of max pooling:
+ *
+ * out[n][c][p][q] = max over the window of
+ *     in[n][c][p * stride_h - pad_h + i][q * stride_w - pad_w + j]
+ *     (i < kernel_h, j < kernel_w, inside the input)
+ *
+ * Shapes: input (N x C x H x W) or (C x H x W), output
+ * (N x C x P x Q) or (C x P x Q); pad < kernel.
+ **********************************/
+static inline int
+mlc_max_pool2d(const MlcArray * input, const MlcPool2d * params, MlcArray * output)
+{
+    size_t dims[4];
+
+    if (mlc_pool2d_check_(input, params, output, dims) != 0) return -1;
+    MLC_PROFILE_BEGIN("mlc_max_pool2d");
+
+    int status = mlc_pool2d_(input, params, output, dims, 1);
+
+    MLC_PROFILE_END(output->size * params->kernel_h * params->kernel_w,
+                    (input->size + output->size) * sizeof(float));
+    return status;
+}
+
+/**********************************
+ * Mathematical synopsis of average pooling:
+ *
+ * out[n][c][p][q] = mean over the window (as for max pooling)
+ * of the elements inside the input; padding is not counted.
+ **********************************/
+static inline int
+mlc_avg_pool2d(const MlcArray * input, const MlcPool2d * params, MlcArray * output)
+{
+    size_t dims[4];
+
+    if (mlc_pool2d_check_(input, params, output, dims) != 0) return -1;
+    MLC_PROFILE_BEGIN("mlc_avg_pool2d");
+
+    int status = mlc_pool2d_(input, params, output, dims, 0);
+
+    MLC_PROFILE_END(output->size * params->kernel_h * params->kernel_w,
+                    (input->size + output->size) * sizeof(float));
+    return status;
+}
+
+#endif /* MLC_CONV_H */
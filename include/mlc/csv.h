@@ -0,0 +1,405 @@
+/* include/mlc/csv.h */
+
+#ifndef MLC_CSV_H
+#define MLC_CSV_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * CSV loading with options:
+ *
+ * mlc_read_csv() (data.h) reads a header-less file of numbers
+ * and keeps every column. mlc_read_csv_with() takes an
+ * MlcCsvOptions to:
+ *
+ *  - skip a header line, and select columns by its names,
+ *  - or select columns by index,
+ *  - read quoted fields ("1.5", "a, b" and "" escapes),
+ *  - fill missing values (empty fields, NA, N/A, null) with a
+ *    chosen value, NaN by default,
+ *  - store the result as fp32, fp16 or bf16.
+ *
+ *   const char * keep[] = {"age", "income"};
+ *   MlcCsvOptions options = mlc_csv_options();
+ *   options.header = 1;
+ *   options.names = keep;
+ *   options.name_count = 2;
+ *   MlcArray x = mlc_read_csv_with("people.csv", &options);   (rows x 2)
+ *
+ * Columns come out in the order they were selected. Parsing is
+ * projected: a field of an unselected column is only scanned
+ * for the next separator, never converted or stored, and the
+ * rest of a line after its last selected column is not scanned
+ * at all. Parse time and memory therefore shrink with the
+ * columns dropped, the more so when the kept columns come
+ * first. Unselected columns may hold text.
+ *
+ * Every line must have at least the fields up to the last
+ * selected column; when all columns are kept, exactly as many
+ * as the first line. Quoted fields may not span lines. The
+ * file is split and parsed in parallel as in mlc_read_csv().
+ *************************************************************/
+
+typedef struct
+{
+    int header;                     /* 1: the first non-empty line holds column names */
+    const char * const * names;     /* columns to keep, by header name ... */
+    size_t name_count;
+    const size_t * indices;         /* ... or by 0-based index (neither: all columns) */
+    size_t index_count;
+    float missing;                  /* value of empty and NA fields */
+    MlcDtype dtype;                 /* storage of the result */
+}
+MlcCsvOptions;
+
+/* Default options: no header, every column, NaN for missing values, fp32 */
+static inline MlcCsvOptions
+mlc_csv_options(void)
+{
+    MlcCsvOptions options = {0, NULL, 0, NULL, 0, NAN, MLC_DTYPE_F32};
+    return options;
+}
+
+/**********************************
+ * Finds the field starting at p on the line ending at eol.
+ * Sets [*begin, *end) to its content, trimmed and without the
+ * quotes of a quoted field (doubled quotes stay doubled).
+ * Returns the separator after it (',' or eol), or NULL for an
+ * unterminated quote or text after a closing quote.
+ **********************************/
+static inline const char *
+mlc_csv_field_(const char * p, const char * eol, const char ** begin, const char ** end)
+{
+    while (p < eol && mlc_csv_is_blank_(*p)) ++p;
+
+    if (p < eol && *p == '"') {
+        const char * q = ++p;
+
+        for (;;) {
+            q = (const char *)memchr(q, '"', (size_t)(eol - q));
+            if (q == NULL) return NULL;
+            if (q + 1 < eol && q[1] == '"') {
+                q += 2;
+                continue;
+            }
+            break;
+        }
+        *begin = p;
+        *end = q;
+        for (++q; q < eol && mlc_csv_is_blank_(*q); ++q) {}
+        return (q == eol || *q == ',') ? q : NULL;
+    }
+
+    const char * sep = (const char *)memchr(p, ',', (size_t)(eol - p));
+    const char * e;
+
+    if (sep == NULL) sep = eol;
+    for (e = sep; e > p && mlc_csv_is_blank_(e[-1]); --e) {}
+    *begin = p;
+    *end = e;
+    return sep;
+}
+
+/* Fields on a line, honouring quotes; 0 if the line is malformed */
+static inline size_t
+mlc_csv_count_quoted_(const char * p, const char * eol)
+{
+    size_t count = 0;
+
+    for (;;) {
+        const char * begin, * end;
+        const char * sep = mlc_csv_field_(p, eol, &begin, &end);
+
+        if (sep == NULL) return 0;
+        ++count;
+        if (sep == eol) return count;
+        p = sep + 1;
+    }
+}
+
+/* Returns 1 for the spellings of a missing value */
+static inline int
+mlc_csv_is_missing_(const char * begin, const char * end)
+{
+    size_t n = (size_t)(end - begin);
+
+    return n == 0 ||
+           (n == 2 && memcmp(begin, "NA", 2) == 0) ||
+           (n == 3 && memcmp(begin, "N/A", 3) == 0) ||
+           (n == 4 && (memcmp(begin, "null", 4) == 0 || memcmp(begin, "NULL", 4) == 0));
+}
+
+/* Compares a header field (doubled quotes unescaped) with a name */
+static inline int
+mlc_csv_name_equals_(const char * begin, const char * end, const char * name)
+{
+    while (begin < end && *name != '\0') {
+        if (*begin != *name) return 0;
+        begin += (*begin == '"' && begin + 1 < end && begin[1] == '"') ? 2 : 1;
+        ++name;
+    }
+    return begin == end && *name == '\0';
+}
+
+/**********************************
+ * Projection plan: where each column of the file goes.
+ **********************************/
+typedef struct
+{
+    size_t cols;            /* fields on the first line */
+    size_t width;           /* selected columns */
+    size_t last;            /* one past the last selected column */
+    size_t * slot;          /* per file column: output position, or (size_t)-1 */
+    float missing;
+    MlcDtype dtype;
+}
+MlcCsvPlan_;
+
+/**********************************
+ * Builds the plan from the options and the first line
+ * [line, eol) (the header, if any). Returns -1 on unknown,
+ * out-of-range or repeated columns.
+ **********************************/
+static inline int
+mlc_csv_plan_(MlcCsvPlan_ * plan, const MlcCsvOptions * options, const char * line, const char * eol)
+{
+    size_t count = options->name_count ? options->name_count : options->index_count;
+
+    plan->cols = mlc_csv_count_quoted_(line, eol);
+    plan->width = count ? count : plan->cols;
+    plan->last = 0;
+    plan->missing = options->missing;
+    plan->dtype = options->dtype;
+    plan->slot = (size_t *)malloc((plan->cols ? plan->cols : 1) * sizeof(size_t));
+
+    if (plan->cols == 0 || plan->slot == NULL) {
+        LOG_ERROR(plan->cols == 0 ? "Malformed CSV line" : "Memory allocation failed");
+        return -1;
+    }
+    for (size_t c = 0; c < plan->cols; ++c) {
+        plan->slot[c] = count ? (size_t)-1 : c;
+    }
+    if (count == 0) {
+        plan->last = plan->cols;
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t c = plan->cols;
+
+        if (options->name_count) {
+            const char * p = line;
+
+            for (size_t k = 0; k < plan->cols; ++k) {
+                const char * begin, * end;
+                const char * sep = mlc_csv_field_(p, eol, &begin, &end);
+
+                if (options->names[i] != NULL && mlc_csv_name_equals_(begin, end, options->names[i])) {
+                    c = k;
+                    break;
+                }
+                p = sep + 1;
+            }
+        }
+        else {
+            c = options->indices[i];
+        }
+        if (c >= plan->cols || plan->slot[c] != (size_t)-1) {
+            LOG_ERROR(c >= plan->cols ? "Unknown or out-of-range CSV column"
+                                      : "CSV column selected twice");
+            return -1;
+        }
+        plan->slot[c] = i;
+        if (c + 1 > plan->last) plan->last = c + 1;
+    }
+    return 0;
+}
+
+/**********************************
+ * Parses the selected fields of one line into row[0 .. width).
+ * Returns 0, -1 for too few (or, keeping every column, too
+ * many) fields, -2 for a malformed field.
+ **********************************/
+static inline int
+mlc_csv_parse_selected_(const MlcCsvPlan_ * plan, const char * p, const char * eol, float * row)
+{
+    for (size_t c = 0; c < plan->last; ++c) {
+        const char * begin, * end;
+        const char * sep = mlc_csv_field_(p, eol, &begin, &end);
+
+        if (sep == NULL) return -2;
+        if (plan->slot[c] != (size_t)-1) {
+            float value = plan->missing;
+
+            if (!mlc_csv_is_missing_(begin, end) && mlc_parse_float_(begin, end, &value) != 0) {
+                return -2;
+            }
+            row[plan->slot[c]] = value;
+        }
+        if (sep == eol) {
+            return (c + 1 == plan->last) ? 0 : -1;
+        }
+        p = sep + 1;
+    }
+    /* Past the last selected column: only a full-width read checks for extra fields */
+    return (plan->last == plan->cols) ? -1 : 0;
+}
+
+typedef struct
+{
+    MlcCsvChunk_ * chunks;
+    const MlcCsvPlan_ * plan;
+    char * out;                         /* rows x width elements of plan->dtype */
+    float * rows;                       /* fp16/bf16: one fp32 row per chunk */
+    size_t first_row[MLC_MAX_THREADS];
+}
+MlcCsvJob_;
+
+static inline void
+mlc_csv_parse_selected_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcCsvJob_ * job = (const MlcCsvJob_ *)ctx;
+    const MlcCsvPlan_ * plan = job->plan;
+    size_t elem = mlc_dtype_size(plan->dtype);
+    (void)part;
+
+    for (size_t t = begin; t < end; ++t) {
+        MlcCsvChunk_ * chunk = &job->chunks[t];
+        char * out = job->out + job->first_row[t] * plan->width * elem;
+        float * row = job->rows ? job->rows + t * plan->width : NULL;
+        const char * p = chunk->begin;
+
+        chunk->status = 0;
+        while (p < chunk->end && chunk->status == 0) {
+            const char * eol = mlc_csv_line_end_(p, chunk->end);
+
+            if (!mlc_csv_blank_line_(p, eol)) {
+                if (plan->dtype == MLC_DTYPE_F32) {
+                    chunk->status = mlc_csv_parse_selected_(plan, p, eol, (float *)out);
+                }
+                else {
+                    chunk->status = mlc_csv_parse_selected_(plan, p, eol, row);
+                    if (plan->dtype == MLC_DTYPE_F16) {
+                        mlc_f32_to_f16_span_(row, (uint16_t *)out, plan->width);
+                    }
+                    else {
+                        mlc_f32_to_bf16_span_(row, (uint16_t *)out, plan->width);
+                    }
+                }
+                out += plan->width * elem;
+            }
+            p = eol + 1;
+        }
+    }
+}
+
+/**********************************
+ * Reads a CSV file with the given options (NULL for the
+ * defaults of mlc_csv_options()).
+ *
+ * Returns:
+ *  - An MlcArray of rows x selected columns, stored as
+ *    options->dtype.
+ *  - If an error occurs (file not found, unknown column,
+ *    malformed field, ...), data = NULL.
+ **********************************/
+static inline MlcArray
+mlc_read_csv_with(const char * filename, const MlcCsvOptions * options)
+{
+    MlcCsvOptions defaults = mlc_csv_options();
+    if (options == NULL) options = &defaults;
+
+    MlcArray result = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, options->dtype};
+    if ((options->name_count && (options->names == NULL || !options->header)) ||
+        (options->index_count && options->indices == NULL) ||
+        (options->name_count && options->index_count) ||
+        (unsigned)options->dtype > MLC_DTYPE_BF16) {
+        LOG_ERROR("Invalid CSV options: names need a header, and not both names and indices");
+        return result;
+    }
+    size_t length, cols;
+    MLC_PROFILE_BEGIN("mlc_read_csv_with");
+
+    char * map = mlc_csv_map_(filename, &length, &cols);
+    if (map == NULL) {
+        return result;
+    }
+    const char * end = map + length;
+    const char * line = map;
+    const char * eol = end;
+
+    /* The first non-empty line: header or first row, it sets the column count */
+    while (line < end) {
+        eol = mlc_csv_line_end_(line, end);
+        if (!mlc_csv_blank_line_(line, eol)) break;
+        line = eol + 1;
+    }
+    MlcCsvPlan_ plan;
+    const char * data = options->header ? ((eol < end) ? eol + 1 : end) : line;
+
+    if (mlc_csv_plan_(&plan, options, line, eol) != 0) {
+        free(plan.slot);
+        munmap(map, length);
+        return result;
+    }
+
+    /* Pass 1: count rows per chunk, then size the output once */
+    MlcCsvJob_ job;
+    MlcCsvChunk_ chunks[MLC_MAX_THREADS];
+    size_t used = mlc_csv_split_(data, end, plan.cols, chunks);
+    size_t elem = mlc_dtype_size(plan.dtype);
+    size_t rows = 0;
+
+    mlc_parallel_for(used, 1, mlc_csv_count_range_, chunks);
+    for (size_t t = 0; t < used; ++t) {
+        job.first_row[t] = rows;
+        rows += chunks[t].rows;
+    }
+    job.chunks = chunks;
+    job.plan = &plan;
+    job.out = (char *)malloc((rows ? rows : 1) * plan.width * elem);
+    job.rows = (plan.dtype == MLC_DTYPE_F32) ? NULL
+             : (float *)malloc(used * plan.width * sizeof(float));
+    result.shape = (size_t *)malloc(2 * sizeof(size_t));
+
+    if (rows == 0 || job.out == NULL || result.shape == NULL ||
+        (plan.dtype != MLC_DTYPE_F32 && job.rows == NULL)) {
+        LOG_ERROR(rows == 0 ? "No data rows in CSV file" : "Memory allocation failed");
+        free(job.out);
+        free(job.rows);
+        free(result.shape);
+        free(plan.slot);
+        result.shape = NULL;
+        munmap(map, length);
+        return result;
+    }
+
+    /* Pass 2: parse the selected fields of every chunk into its rows */
+    mlc_parallel_for(used, 1, mlc_csv_parse_selected_range_, &job);
+    munmap(map, length);
+    free(job.rows);
+    free(plan.slot);
+
+    if (mlc_csv_check_chunks_(chunks, used) != 0) {
+        free(job.out);
+        free(result.shape);
+        result.shape = NULL;
+        return result;
+    }
+    result.data = (float *)job.out;
+    result.size = rows * plan.width;
+    result.shape[0] = rows;
+    result.shape[1] = plan.width;
+    MLC_PROFILE_END(result.size, length + result.size * elem);
+    return result;
+}
+
+#endif /* MLC_CSV_H */
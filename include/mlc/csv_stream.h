@@ -0,0 +1,331 @@
+/* include/mlc/csv_stream.h */
+
+#ifndef MLC_CSV_STREAM_H
+#define MLC_CSV_STREAM_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <mlc/data.h>
+#include <mlc/parallel.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Streaming CSV reader:
+ *
+ * mlc_read_csv() materializes the whole file. For files larger
+ * than memory, an MlcCsvReader reads the file sequentially with
+ * read() and hands it out in mini-batches of rows:
+ *
+ *   MlcCsvReader * reader = mlc_csv_open("train.csv");
+ *   MlcArray batch = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+ *
+ *   while (mlc_csv_next_batch(reader, 256, &batch) > 0) {
+ *       ... batch.shape[0] rows x batch.shape[1] cols ...
+ *   }
+ *   mlc_finish(&batch);
+ *   mlc_csv_close(reader);
+ *
+ * The same `batch` array is refilled on every call: its buffer
+ * is allocated on the first call and reused afterwards, so the
+ * loop does no per-batch allocation. Memory stays bounded by
+ * one batch of floats plus the text of about one batch, however
+ * large the file is.
+ *
+ * Parsing follows mlc_read_csv(): the column count comes from
+ * the first non-empty line, empty lines are skipped, every
+ * other line must have the same number of columns and fields
+ * must be numbers (empty fields read as 0). Large batches are
+ * parsed in parallel on the thread pool (see MLC_CSV_MIN_CHUNK).
+ *************************************************************/
+
+#ifndef MLC_CSV_STREAM_BUFFER
+    #define MLC_CSV_STREAM_BUFFER (1u << 20)    /* initial read buffer, bytes */
+#endif
+
+typedef struct
+{
+    int fd;
+    char * buffer;
+    size_t capacity;        /* bytes allocated for buffer */
+    size_t begin;           /* first unconsumed byte */
+    size_t end;             /* one past the last byte read */
+    int eof;
+    int status;             /* 0, or -1 after an error */
+    size_t cols;
+    size_t rows_read;       /* rows returned so far */
+
+    /* Output buffer handed out by the last batch */
+    float * out_data;
+    size_t out_capacity;    /* floats */
+}
+MlcCsvReader;
+
+/**********************************
+ * Reads more of the file into the buffer, keeping the bytes
+ * from `keep` onwards. Offsets into the buffer that the caller
+ * holds must be adjusted by the returned shift. The buffer is
+ * grown when it is already full of kept bytes.
+ * Returns the shift (bytes moved towards the start), or
+ * (size_t)-1 on error.
+ **********************************/
+static inline size_t
+mlc_csv_stream_fill_(MlcCsvReader * reader, size_t keep)
+{
+    size_t shift = keep;
+
+    if (keep > 0) {
+        memmove(reader->buffer, reader->buffer + keep, reader->end - keep);
+        reader->begin -= keep;
+        reader->end -= keep;
+    }
+    if (reader->end == reader->capacity) {
+        char * grown = (char *)realloc(reader->buffer, reader->capacity * 2);
+        if (grown == NULL) {
+            LOG_ERROR("Memory allocation failed for CSV buffer");
+            return (size_t)-1;
+        }
+        reader->buffer = grown;
+        reader->capacity *= 2;
+    }
+    ssize_t got;
+    do {
+        got = read(reader->fd, reader->buffer + reader->end, reader->capacity - reader->end);
+    } while (got < 0 && errno == EINTR);
+
+    if (got < 0) {
+        LOG_ERROR("Failed to read CSV file");
+        return (size_t)-1;
+    }
+    if (got == 0) reader->eof = 1;
+    reader->end += (size_t)got;
+    return shift;
+}
+
+/**********************************
+ * Opens a CSV file for streaming and reads its first non-empty
+ * line to find the column count (available as reader->cols).
+ *
+ * Returns:
+ *  - A reader to pass to mlc_csv_next_batch()/mlc_csv_close().
+ *  - NULL if the file cannot be opened or has no data.
+ **********************************/
+static inline MlcCsvReader *
+mlc_csv_open(const char * filename)
+{
+    MlcCsvReader * reader = (MlcCsvReader *)calloc(1, sizeof(MlcCsvReader));
+
+    if (reader == NULL) {
+        LOG_ERROR("Memory allocation failed for CSV reader");
+        return NULL;
+    }
+    reader->fd = open(filename, O_RDONLY);
+    reader->capacity = MLC_CSV_STREAM_BUFFER;
+    reader->buffer = (char *)malloc(reader->capacity);
+
+    if (reader->fd < 0 || reader->buffer == NULL) {
+        LOG_ERROR("Cannot open CSV file");
+        if (reader->fd >= 0) close(reader->fd);
+        free(reader->buffer);
+        free(reader);
+        return NULL;
+    }
+    posix_fadvise(reader->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    /* Column count comes from the first non-empty line */
+    size_t p = 0;
+    while (reader->cols == 0) {
+        const char * base = reader->buffer;
+        const char * eol = (const char *)memchr(base + p, '\n', reader->end - p);
+
+        if (eol == NULL && !reader->eof) {
+            if (mlc_csv_stream_fill_(reader, 0) == (size_t)-1) break;
+            continue;
+        }
+        if (eol == NULL) eol = base + reader->end;
+        if (!mlc_csv_blank_line_(base + p, eol)) {
+            reader->cols = mlc_csv_count_fields_(base + p, eol);
+        }
+        else if (eol == base + reader->end) {
+            break;      /* end of file, nothing but blank lines */
+        }
+        p = (size_t)(eol - base) + 1;
+    }
+    if (reader->cols == 0) {
+        LOG_ERROR("Empty or invalid CSV file");
+        close(reader->fd);
+        free(reader->buffer);
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+/* Makes sure `out` is a 2D heap array with room for `floats` values */
+static inline int
+mlc_csv_stream_output_(MlcCsvReader * reader, MlcArray * out, size_t floats)
+{
+    if (out->data != NULL && (out->ndims != 2 || out->shape == NULL ||
+                              out->dtype != MLC_DTYPE_F32)) {
+        LOG_ERROR("Batch array must be 2D fp32");
+        return -1;
+    }
+    if (out->data != NULL && out->data != reader->out_data) {
+        /* caller-allocated buffer: its current size is its capacity */
+        reader->out_data = out->data;
+        reader->out_capacity = out->size;
+    }
+    if (out->data != NULL && reader->out_capacity >= floats) {
+        return 0;
+    }
+    if (out->data != NULL && out->storage != MLC_STORAGE_HEAP) {
+        LOG_ERROR("Batch array too small and not resizable");
+        return -1;
+    }
+    float * data = (float *)realloc(out->data, floats * sizeof(float));
+    size_t * shape = (out->shape != NULL) ? out->shape : (size_t *)malloc(2 * sizeof(size_t));
+
+    if (data == NULL || shape == NULL) {
+        LOG_ERROR("Memory allocation failed for CSV batch");
+        if (data != NULL) out->data = data;
+        return -1;
+    }
+    out->data = data;
+    out->shape = shape;
+    out->ndims = 2;
+    out->storage = MLC_STORAGE_HEAP;
+    reader->out_data = data;
+    reader->out_capacity = floats;
+    return 0;
+}
+
+/**********************************
+ * Reads the next `batch_rows` rows (fewer at the end of the
+ * file) into `out`.
+ *
+ * Arguments:
+ *  - reader: Reader from mlc_csv_open().
+ *  - batch_rows: Maximum rows per batch.
+ *  - out: Batch array. Pass an empty array (data = NULL) on the
+ *    first call; it is allocated as a batch_rows x cols heap
+ *    array and reused by later calls. A caller-allocated 2D
+ *    array with enough room is filled in place.
+ *
+ * Returns:
+ *  - 1 if a batch was read: out->shape = {rows, cols}.
+ *  - 0 at the end of the file (out->size = 0).
+ *  - -1 on error (I/O, allocation, malformed or inconsistent
+ *    rows); the reader then stays in the error state.
+ **********************************/
+static inline int
+mlc_csv_next_batch(MlcCsvReader * reader, size_t batch_rows, MlcArray * out)
+{
+    if (reader == NULL || out == NULL || batch_rows == 0 || reader->status != 0) {
+        LOG_ERROR("Invalid CSV reader or batch");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_csv_next_batch");
+
+    /* Gather the text of up to batch_rows non-empty lines */
+    size_t start = reader->begin;
+    size_t p = start;
+    size_t rows = 0;
+
+    while (rows < batch_rows) {
+        const char * base = reader->buffer;
+        const char * eol = (const char *)memchr(base + p, '\n', reader->end - p);
+
+        if (eol == NULL && !reader->eof) {
+            size_t shift = mlc_csv_stream_fill_(reader, start);
+            if (shift == (size_t)-1) {
+                reader->status = -1;
+                return -1;
+            }
+            start -= shift;
+            p -= shift;
+            continue;
+        }
+        if (eol == NULL) {
+            if (p == reader->end) break;
+            eol = base + reader->end;   /* last line without a newline */
+        }
+        rows += !mlc_csv_blank_line_(base + p, eol);
+        p = (size_t)(eol - base);
+        if (p < reader->end) ++p;
+    }
+    reader->begin = p;
+
+    if (rows == 0) {
+        out->size = 0;
+        if (out->shape != NULL && out->ndims == 2) out->shape[0] = 0;
+        return 0;
+    }
+    if (mlc_csv_stream_output_(reader, out, batch_rows * reader->cols) != 0) {
+        reader->status = -1;
+        return -1;
+    }
+
+    /* Same two passes as mlc_read_csv(), over the batch text */
+    MlcCsvChunk_ chunks[MLC_MAX_THREADS];
+    size_t used = mlc_csv_split_(reader->buffer + start, reader->buffer + p,
+                                 reader->cols, chunks);
+
+    if (used > 1) {
+        mlc_parallel_for(used, 1, mlc_csv_count_range_, chunks);
+    }
+    else {
+        chunks[0].rows = rows;
+    }
+    float * dest = out->data;
+    for (size_t t = 0; t < used; ++t) {
+        chunks[t].out = dest;
+        dest += chunks[t].rows * reader->cols;
+    }
+    mlc_parallel_for(used, 1, mlc_csv_parse_range_, chunks);
+
+    if (mlc_csv_check_chunks_(chunks, used) != 0) {
+        reader->status = -1;
+        return -1;
+    }
+    out->shape[0] = rows;
+    out->shape[1] = reader->cols;
+    out->size = rows * reader->cols;
+    reader->rows_read += rows;
+    MLC_PROFILE_END(out->size, (p - start) + out->size * sizeof(float));
+    return 1;
+}
+
+/**********************************
+ * Restarts the reader at the beginning of the file (e.g. for a
+ * new epoch). Returns -1 if the file cannot be rewound.
+ **********************************/
+static inline int
+mlc_csv_rewind(MlcCsvReader * reader)
+{
+    if (reader == NULL || lseek(reader->fd, 0, SEEK_SET) != 0) {
+        LOG_ERROR("Cannot rewind CSV reader");
+        return -1;
+    }
+    reader->begin = 0;
+    reader->end = 0;
+    reader->eof = 0;
+    reader->status = 0;
+    reader->rows_read = 0;
+    return 0;
+}
+
+/* Closes the file and frees the reader (not the batch array). */
+static inline void
+mlc_csv_close(MlcCsvReader * reader)
+{
+    if (reader != NULL) {
+        close(reader->fd);
+        free(reader->buffer);
+        free(reader);
+    }
+}
+
+#endif /* MLC_CSV_STREAM_H */
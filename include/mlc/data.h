@@ -6,16 +6,82 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mlc/parallel.h>
+#include <mlc/simd_math.h>
+#include <mlc/half.h>
+#include <mlc/dispatch.h>
 #include <mlc/config.h>
 
+/* Input types; TYPE_FP16 and TYPE_BF16 are raw uint16_t bits */
 typedef enum 
 {
     TYPE_INT,
     TYPE_FLOAT,
-    TYPE_DOUBLE
+    TYPE_DOUBLE,
+    TYPE_FP16,
+    TYPE_BF16
 } 
 DataType;
 
+/**********************************
+ * Element type stored behind an MlcArray (zero-initialized =
+ * fp32). Kernels always compute in fp32: on fp16/bf16 arrays
+ * they convert a tile at a time on load and round back on
+ * store (half.h), so the data takes half the memory and half
+ * the bandwidth. `data` then points to uint16_t values.
+ **********************************/
+typedef enum
+{
+    MLC_DTYPE_F32,
+    MLC_DTYPE_F16,
+    MLC_DTYPE_BF16
+}
+MlcDtype;
+
+/**********************************
+ * Where the memory behind an MlcArray comes from, which decides
+ * what mlc_finish() has to do with it.
+ *
+ *  - MLC_STORAGE_HEAP: data and shape were malloc'd (default).
+ *    A reused buffer may record its capacity in bytes in
+ *    base_size when it is larger than size (sampler.h).
+ *  - MLC_STORAGE_MMAP: data points into a file mapping of
+ *    base_size bytes starting at base; shape is malloc'd.
+ *  - MLC_STORAGE_ARENA: data and shape live in one block taken
+ *    from an MlcArena (arena.h); base points to the block.
+ *  - MLC_STORAGE_VIEW: data belongs to another array or to the
+ *    caller and is never freed; shape (followed by strides)
+ *    is one malloc'd block (view.h).
+ **********************************/
+typedef enum
+{
+    MLC_STORAGE_HEAP,
+    MLC_STORAGE_MMAP,
+    MLC_STORAGE_ARENA,
+    MLC_STORAGE_VIEW
+}
+MlcStorage;
+
+/**********************************
+ * Header at the start of every arena block. `release` hands a
+ * pooled block back to its arena; it is NULL for bump-allocated
+ * blocks, which are only reclaimed by mlc_arena_reset().
+ **********************************/
+typedef struct MlcBlockHeader
+{
+    void (*release)(struct MlcBlockHeader * block);
+    void * owner;
+    size_t size_class;
+    struct MlcBlockHeader * next;   /* free-list link while pooled */
+}
+MlcBlockHeader;
+
 /**********************************
  * General-purpose array structure for MLC.
  * Supports 1D vectors, 2D matrices, and higher-dimensional tensors.
@@ -25,6 +91,12 @@ DataType;
  *  - ndims: Number of dimensions (1 for vector, 2 for matrix, etc.).
  *  - shape: Array of dimension sizes (e.g., {rows, cols} for 2D).
  *  - size: Total number of elements (product of shape).
+ *  - storage: Owner of data/shape (zero-initialized = heap).
+ *  - base, base_size: Backing block for non-heap storage
+ *    (base_size: capacity of a reused heap buffer, or 0).
+ *  - strides: Element step of each dimension, or NULL when the
+ *    data is contiguous in row-major order (see view.h).
+ *  - dtype: Element type of data (MLC_DTYPE_F32 by default).
  **********************************/
 typedef struct 
 {
@@ -32,6 +104,11 @@ typedef struct
     size_t ndims;
     size_t * shape;
     size_t size;
+    MlcStorage storage;
+    void * base;
+    size_t base_size;
+    size_t * strides;
+    MlcDtype dtype;
 } 
 MlcArray;
 
@@ -45,23 +122,164 @@ check_inputs(MlcArray * array)
     return 0;
 }
 
+/* Bytes per element of a dtype / of an input type */
+static inline size_t
+mlc_dtype_size(MlcDtype dtype)
+{
+    return (dtype == MLC_DTYPE_F32) ? sizeof(float) : sizeof(uint16_t);
+}
+
+static inline size_t
+mlc_type_size_(DataType type)
+{
+    switch (type)
+    {
+        case TYPE_INT:    return sizeof(int);
+        case TYPE_DOUBLE: return sizeof(double);
+        case TYPE_FP16:
+        case TYPE_BF16:   return sizeof(uint16_t);
+        default:          return sizeof(float);
+    }
+}
+
+/* Address of element `offset` of the array's data, whatever its dtype */
+static inline float *
+mlc_element_(const MlcArray * array, size_t offset)
+{
+    return (float *)((char *)array->data + offset * mlc_dtype_size(array->dtype));
+}
+
+#ifndef MLC_CONVERT_TILE
+    #define MLC_CONVERT_TILE 256    /* floats staged per fp16/bf16 store */
+#endif
+
+/* Converts n values of input type `type` to floats */
+static inline void
+mlc_convert_span_(const void * input, DataType type, float * out, size_t n)
+{
+    switch (type)
+    {
+        case TYPE_INT:
+            mlc_convert_int_span_((const int *)input, out, n);
+            break;
+        case TYPE_FLOAT:
+            memcpy(out, input, n * sizeof(float));
+            break;
+        case TYPE_DOUBLE:
+            mlc_convert_double_span_((const double *)input, out, n);
+            break;
+        case TYPE_FP16:
+            mlc_f16_to_f32_span_((const uint16_t *)input, out, n);
+            break;
+        case TYPE_BF16:
+            mlc_bf16_to_f32_span_((const uint16_t *)input, out, n);
+            break;
+    }
+}
+
+/* Returns 1 if input type `type` is stored as `dtype` (no conversion) */
+static inline int
+mlc_type_is_dtype_(DataType type, MlcDtype dtype)
+{
+    return (type == TYPE_FLOAT && dtype == MLC_DTYPE_F32) ||
+           (type == TYPE_FP16 && dtype == MLC_DTYPE_F16) ||
+           (type == TYPE_BF16 && dtype == MLC_DTYPE_BF16);
+}
+
+typedef struct
+{
+    const void * input;
+    DataType type;
+    void * out;
+    MlcDtype dtype;
+}
+MlcConvertJob_;
+
+static inline void
+mlc_convert_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcConvertJob_ * job = (const MlcConvertJob_ *)ctx;
+    size_t width = mlc_type_size_(job->type);
+    const char * in = (const char *)job->input + begin * width;
+    char * out = (char *)job->out + begin * mlc_dtype_size(job->dtype);
+    size_t n = end - begin;
+    float tile[MLC_CONVERT_TILE];
+    (void)part;
+
+    if (job->dtype == MLC_DTYPE_F32) {
+        mlc_convert_span_(in, job->type, (float *)out, n);
+        return;
+    }
+    if (mlc_type_is_dtype_(job->type, job->dtype)) {
+        memcpy(out, in, n * sizeof(uint16_t));
+        return;
+    }
+    /* Other inputs to fp16/bf16: through a float tile */
+    for (size_t i = 0; i < n; i += MLC_CONVERT_TILE) {
+        size_t m = (n - i < MLC_CONVERT_TILE) ? n - i : MLC_CONVERT_TILE;
+        uint16_t * dst = (uint16_t *)out + i;
+
+        mlc_convert_span_(in + i * width, job->type, tile, m);
+        if (job->dtype == MLC_DTYPE_F16) {
+            mlc_f32_to_f16_span_(tile, dst, m);
+        }
+        else {
+            mlc_f32_to_bf16_span_(tile, dst, m);
+        }
+    }
+}
+
+/**********************************
+ * Converts n values of `input_type` at `input` to elements of
+ * `dtype` at `out`, on the thread pool when n is large
+ * (conversion is bound by memory bandwidth, which one core
+ * rarely saturates).
+ * Returns -1 (and leaves out untouched) for unsupported types.
+ **********************************/
+static inline int
+mlc_convert_(const void * input, DataType input_type, void * out, MlcDtype dtype, size_t n)
+{
+    if ((unsigned)input_type > TYPE_BF16 || (unsigned)dtype > MLC_DTYPE_BF16) {
+        LOG_ERROR("Unsupported input type");
+        return -1;
+    }
+    if ((const void *)out == input && mlc_type_is_dtype_(input_type, dtype)) {
+        return 0;       /* already in place */
+    }
+    MlcConvertJob_ job = {input, input_type, out, dtype};
+
+    mlc_parallel_for(n, mlc_parallel_grain(1), mlc_convert_range_, &job);
+    return 0;
+}
+
+static inline int
+mlc_convert_to_float_(const void * input, DataType input_type, float * out, size_t n)
+{
+    return mlc_convert_(input, input_type, out, MLC_DTYPE_F32, n);
+}
+
 /**********************************
- * Prepares input data into an MlcArray.
+ * Prepares input data into an MlcArray stored as `dtype`.
+ * The data is always copied into a new heap array; to avoid the
+ * allocation, see mlc_borrow() and prepare_data_into().
  *
  * Arguments:
  *  - input: Raw input data (any supported type).
  *  - ndims: Number of dimensions.
  *  - shape: Array of dimension sizes (e.g., {3} for 1D, {2, 3} for 2D).
  *  - input_type: Type of input data.
+ *  - dtype: Element type of the result (MLC_DTYPE_F16 or
+ *    MLC_DTYPE_BF16 halve its footprint).
  *
  * Returns:
- *  - An MlcArray with converted float data.
+ *  - An MlcArray with the converted data.
  *  - If error occurs, data = NULL.
  **********************************/
 static inline MlcArray
-prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type) 
+prepare_data_as(const void * input, size_t ndims, const size_t * shape,
+                DataType input_type, MlcDtype dtype)
 {
-    MlcArray result = {NULL, ndims, NULL, 0};
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, dtype};
 
     if (input == NULL || ndims == 0 || shape == NULL) {
         LOG_ERROR("Invalid input or dimensions");
@@ -77,8 +295,10 @@ prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type)
         }
         result.size *= shape[i];
     }
+    MLC_PROFILE_BEGIN("prepare_data");
+
     /* Allocate data and shape */
-    result.data = (float *)malloc(result.size * sizeof(float));
+    result.data = (float *)malloc(result.size * mlc_dtype_size(dtype));
     result.shape = (size_t *)malloc(ndims * sizeof(size_t));
 
     if (result.data == NULL || result.shape == NULL) {
@@ -86,6 +306,7 @@ prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type)
         free(result.data);
         free(result.shape);
         result.data = NULL;
+        result.shape = NULL;
         return result;
     }
 
@@ -95,40 +316,452 @@ prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type)
     }
 
     /* Convert input */
-    switch (input_type) 
-    {
-        case TYPE_INT: 
-        {
-            int * in = (int *)input;
-            for (size_t i = 0; i < result.size; ++i) {
-                result.data[i] = (float)in[i];
-            }
-            break;
+    if (mlc_convert_(input, input_type, result.data, dtype, result.size) != 0) {
+        free(result.data);
+        free(result.shape);
+        result.data = NULL;
+        result.shape = NULL;
+        return result;
+    }
+    MLC_PROFILE_END(result.size, result.size * (mlc_type_size_(input_type) + mlc_dtype_size(dtype)));
+    return result;
+}
+
+/**********************************
+ * Prepares input data into a float (fp32) MlcArray; see
+ * prepare_data_as().
+ **********************************/
+static inline MlcArray
+prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type) 
+{
+    return prepare_data_as(input, ndims, shape, input_type, MLC_DTYPE_F32);
+}
+
+/**********************************
+ * Wraps caller-owned float data in an MlcArray without copying
+ * it (borrow mode). The array's storage is MLC_STORAGE_VIEW:
+ * mlc_finish() frees only its shape, never `data`, which must
+ * outlive the array. Kernels that work in place modify `data`.
+ *
+ * Arguments:
+ *  - data: Contiguous row-major floats, shape[0] * ... in total.
+ *  - ndims: Number of dimensions.
+ *  - shape: Array of dimension sizes (copied).
+ *
+ * Returns:
+ *  - An MlcArray over `data`.
+ *  - If error occurs, data = NULL.
+ **********************************/
+static inline MlcArray
+mlc_borrow(float * data, size_t ndims, const size_t * shape)
+{
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (data == NULL || ndims == 0 || shape == NULL) {
+        LOG_ERROR("Invalid input or dimensions");
+        return result;
+    }
+    result.size = 1;
+    for (size_t i = 0; i < ndims; ++i) {
+        if (shape[i] == 0) {
+            LOG_ERROR("Zero dimension in shape");
+            return result;
         }
-        case TYPE_FLOAT: 
-        {
-            float * in = (float *)input;
-            for (size_t i = 0; i < result.size; ++i) {
-                result.data[i] = in[i];
+        result.size *= shape[i];
+    }
+    result.shape = (size_t *)malloc(ndims * sizeof(size_t));
+    if (result.shape == NULL) {
+        LOG_ERROR("Memory allocation failed");
+        return result;
+    }
+    memcpy(result.shape, shape, ndims * sizeof(size_t));
+    result.data = data;
+    result.storage = MLC_STORAGE_VIEW;
+    return result;
+}
+
+/**********************************
+ * Converts input data into an existing array, without any
+ * allocation: out->size values of `input_type` are read from
+ * `input` and written to out->data as out->dtype. `out` may be a heap, arena,
+ * mapped or borrowed array, e.g. one batch buffer refilled from
+ * an upstream source, but must be contiguous. When `input_type`
+ * matches out->dtype, `input` may be out->data itself (nothing
+ * is copied).
+ *
+ * Returns:
+ *  - 0 on success.
+ *  - -1 on error (out is left untouched).
+ **********************************/
+static inline int
+prepare_data_into(const void * input, DataType input_type, MlcArray * out)
+{
+    if (input == NULL || check_inputs(out) != 0) {
+        LOG_ERROR("Invalid input or output array");
+        return -1;
+    }
+    if (out->strides != NULL) {
+        LOG_ERROR("Output array must be contiguous");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("prepare_data_into");
+
+    if (mlc_convert_(input, input_type, out->data, out->dtype, out->size) != 0) {
+        return -1;
+    }
+    MLC_PROFILE_END(out->size, out->size * (mlc_type_size_(input_type) + mlc_dtype_size(out->dtype)));
+    return 0;
+}
+
+/**********************************
+ * CSV loading internals.
+ *
+ * mlc_read_csv() memory-maps the file and splits it into
+ * newline-aligned chunks, one per pool thread (parallel.h). Each worker
+ * first counts the rows of its chunk; a prefix sum over those
+ * counts gives every chunk its first output row, so the result
+ * buffer is allocated exactly once and each worker parses its
+ * rows straight into their final position.
+ *
+ * MLC_CSV_MIN_CHUNK (bytes) bounds how small a chunk can get,
+ * so small files are parsed by the calling thread alone.
+ **********************************/
+#ifndef MLC_CSV_MIN_CHUNK
+    #define MLC_CSV_MIN_CHUNK (1u << 20)
+#endif
+
+typedef struct
+{
+    const char * begin;
+    const char * end;
+    size_t cols;
+    size_t rows;
+    float * out;
+    int status;
+}
+MlcCsvChunk_;
+
+static inline int
+mlc_csv_is_blank_(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/* Returns 1 if [p, eol) holds nothing but whitespace. */
+static inline int
+mlc_csv_blank_line_(const char * p, const char * eol)
+{
+    while (p < eol && mlc_csv_is_blank_(*p)) ++p;
+    return p == eol;
+}
+
+static inline const char *
+mlc_csv_line_end_(const char * p, const char * end)
+{
+    const char * eol = (const char *)memchr(p, '\n', (size_t)(end - p));
+    return eol ? eol : end;
+}
+
+/**********************************
+ * Parses the decimal number in [p, end) into `out`.
+ *
+ * Handles an optional sign, integer and fraction digits and an
+ * exponent; the first 19 significant digits are accumulated in
+ * an integer and scaled once by a power of ten. Anything else
+ * (inf, nan, hex floats, ...) goes through strtof(). The whole
+ * range must be consumed. Returns 0 on success.
+ **********************************/
+static inline int
+mlc_parse_float_(const char * p, const char * end, float * out)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char * start = p;
+    int negative = 0;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    int any = 0;
+
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+    for (; p < end && (unsigned)(*p - '0') < 10; ++p, any = 1) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += (mantissa != 0);
+        }
+        else {
+            ++exp10;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && (unsigned)(*p - '0') < 10; ++p, any = 1) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += (mantissa != 0);
+                --exp10;
             }
-            break;
         }
-        case TYPE_DOUBLE: 
-        {
-            double * in = (double *)input;
-            for (size_t i = 0; i < result.size; ++i) {
-                result.data[i] = (float)in[i];
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        int exp_negative = 0;
+        int exp_value = 0;
+
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) {
+            exp_negative = (*p == '-');
+            ++p;
+        }
+        if (p == end || (unsigned)(*p - '0') >= 10) {
+            any = 0;
+        }
+        for (; p < end && (unsigned)(*p - '0') < 10; ++p) {
+            if (exp_value < 10000) exp_value = exp_value * 10 + (*p - '0');
+        }
+        exp10 += exp_negative ? -exp_value : exp_value;
+    }
+
+    if (any && p == end) {
+        double value = (double)mantissa;
+
+        if (mantissa == 0 || exp10 < -400) {
+            value = 0.0;
+        }
+        else if (exp10 > 400) {
+            value = HUGE_VAL;
+        }
+        else {
+            while (exp10 > 22)  { value *= 1e22; exp10 -= 22; }
+            while (exp10 < -22) { value /= 1e22; exp10 += 22; }
+            value = (exp10 >= 0) ? value * pow10[exp10] : value / pow10[-exp10];
+        }
+        *out = (float)(negative ? -value : value);
+        return 0;
+    }
+
+    /* Slow path: let the C library handle the unusual spellings */
+    char buf[64];
+    size_t len = (size_t)(end - start);
+    char * stop;
+
+    if (len == 0 || len >= sizeof(buf)) return -1;
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    *out = strtof(buf, &stop);
+    return (stop == buf + len) ? 0 : -1;
+}
+
+/**********************************
+ * Parses one CSV line [p, eol) into exactly `cols` floats.
+ * Fields may be surrounded by spaces; an empty field reads as 0.
+ * Returns the number of fields found, or (size_t)-1 on a
+ * malformed field.
+ **********************************/
+static inline size_t
+mlc_csv_parse_line_(const char * p, const char * eol, size_t cols, float * out)
+{
+    size_t count = 0;
+
+    for (;;) {
+        const char * field_end = (const char *)memchr(p, ',', (size_t)(eol - p));
+        const char * next;
+        float value = 0.0f;
+
+        if (field_end == NULL) field_end = eol;
+        next = field_end;
+
+        while (p < field_end && mlc_csv_is_blank_(*p)) ++p;
+        while (field_end > p && mlc_csv_is_blank_(field_end[-1])) --field_end;
+
+        if (p < field_end && mlc_parse_float_(p, field_end, &value) != 0) {
+            return (size_t)-1;
+        }
+        if (count < cols) {
+            out[count] = value;
+        }
+        ++count;
+
+        if (next == eol) break;
+        p = next + 1;
+    }
+    return count;
+}
+
+/* Counts the number of comma-separated fields on a line. */
+static inline size_t
+mlc_csv_count_fields_(const char * p, const char * eol)
+{
+    size_t count = 1;
+
+    for (; p < eol; ++p) {
+        count += (*p == ',');
+    }
+    return count;
+}
+
+static inline void
+mlc_csv_count_rows_(MlcCsvChunk_ * chunk)
+{
+    const char * p = chunk->begin;
+    size_t rows = 0;
+
+    while (p < chunk->end) {
+        const char * eol = mlc_csv_line_end_(p, chunk->end);
+        rows += !mlc_csv_blank_line_(p, eol);
+        p = eol + 1;
+    }
+    chunk->rows = rows;
+}
+
+static inline void
+mlc_csv_parse_rows_(MlcCsvChunk_ * chunk)
+{
+    const char * p = chunk->begin;
+    float * out = chunk->out;
+
+    while (p < chunk->end) {
+        const char * eol = mlc_csv_line_end_(p, chunk->end);
+
+        if (!mlc_csv_blank_line_(p, eol)) {
+            size_t found = mlc_csv_parse_line_(p, eol, chunk->cols, out);
+
+            if (found == (size_t)-1) {
+                chunk->status = -2;
+                return;
             }
+            if (found != chunk->cols) {
+                chunk->status = -1;
+                return;
+            }
+            out += chunk->cols;
+        }
+        p = eol + 1;
+    }
+    chunk->status = 0;
+}
+
+/* Pool callbacks over a range of chunks */
+static inline void
+mlc_csv_count_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    (void)part;
+    for (size_t t = begin; t < end; ++t) {
+        mlc_csv_count_rows_((MlcCsvChunk_ *)ctx + t);
+    }
+}
+
+static inline void
+mlc_csv_parse_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    (void)part;
+    for (size_t t = begin; t < end; ++t) {
+        mlc_csv_parse_rows_((MlcCsvChunk_ *)ctx + t);
+    }
+}
+
+/**********************************
+ * Splits [begin, end) into newline-aligned chunks of at least
+ * MLC_CSV_MIN_CHUNK bytes, at most one per pool thread.
+ * Returns the number of chunks written to `chunks`.
+ **********************************/
+static inline size_t
+mlc_csv_split_(const char * begin, const char * end, size_t cols, MlcCsvChunk_ * chunks)
+{
+    size_t length = (size_t)(end - begin);
+    size_t threads = mlc_get_num_threads();
+    size_t nchunks = length / MLC_CSV_MIN_CHUNK;
+
+    if (nchunks > threads) nchunks = threads;
+    if (nchunks == 0) nchunks = 1;
+
+    const char * cursor = begin;
+    size_t used = 0;
+
+    for (size_t t = 0; t < nchunks && cursor < end; ++t) {
+        const char * stop = (t + 1 == nchunks) ? end : begin + (length / nchunks) * (t + 1);
+
+        if (stop < cursor) stop = cursor;
+        stop = (stop < end) ? mlc_csv_line_end_(stop, end) : end;
+        if (stop < end) ++stop;
+
+        chunks[used].begin = cursor;
+        chunks[used].end = stop;
+        chunks[used].cols = cols;
+        chunks[used].rows = 0;
+        chunks[used].out = NULL;
+        chunks[used].status = 0;
+        ++used;
+        cursor = stop;
+    }
+    return used;
+}
+
+/* Reports the first failed chunk; returns -1 if any failed. */
+static inline int
+mlc_csv_check_chunks_(const MlcCsvChunk_ * chunks, size_t used)
+{
+    for (size_t t = 0; t < used; ++t) {
+        if (chunks[t].status != 0) {
+            LOG_ERROR(chunks[t].status == -1 ? "Inconsistent column count in CSV"
+                                             : "Malformed numeric field in CSV");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**********************************
+ * Maps a CSV file for reading and takes its column count from
+ * the first non-empty line. Returns the mapping (*length bytes,
+ * released with munmap()), or NULL with the error logged.
+ **********************************/
+static inline char *
+mlc_csv_map_(const char * filename, size_t * length, size_t * cols)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0) {
+        LOG_ERROR("Cannot open CSV file");
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        LOG_ERROR("Empty or invalid CSV file");
+        close(fd);
+        return NULL;
+    }
+    *length = (size_t)st.st_size;
+    char * map = (char *)mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Cannot map CSV file");
+        return NULL;
+    }
+    madvise(map, *length, MADV_SEQUENTIAL);
+
+    const char * end = map + *length;
+    const char * p = map;
+
+    *cols = 0;
+    while (p < end) {
+        const char * eol = mlc_csv_line_end_(p, end);
+        if (!mlc_csv_blank_line_(p, eol)) {
+            *cols = mlc_csv_count_fields_(p, eol);
             break;
         }
-        default:
-            LOG_ERROR("Unsupported input type");
-            free(result.data);
-            free(result.shape);
-            result.data = NULL;
-            return result;
+        p = eol + 1;
     }
-    return result;
+    if (*cols == 0) {
+        LOG_ERROR("Empty or invalid CSV file");
+        munmap(map, *length);
+        return NULL;
+    }
+    return map;
 }
 
 /**********************************
@@ -143,112 +776,116 @@ prepare_data(void * input, size_t ndims, size_t * shape, DataType input_type)
  * 
  * Notes:
  *  - Assumes CSV contains comma-separated float values.
- *  - Dynamically allocates memory for data and shape, no fixed limits.
- *  - Automatically detects number of rows and columns in a single pass.
+ *  - The file is memory-mapped and parsed in parallel, one
+ *    newline-aligned chunk per thread (see MLC_CSV_MIN_CHUNK).
+ *  - Rows are counted before parsing, so the data buffer is
+ *    allocated once at its final size and never copied.
  *  - Stores data in row-major order (flat float array).
- *  - Ignores empty lines and assumes consistent column counts.
+ *  - Ignores empty lines; every other line must have the same
+ *    number of columns as the first one, and every non-empty
+ *    field must be a number.
  **********************************/
 static inline MlcArray
 mlc_read_csv(const char * filename) 
 {
-    MlcArray result = {NULL, 2, NULL, 0};
-    FILE * file = fopen(filename, "r");
+    MlcArray result = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    size_t length, cols;
+    MLC_PROFILE_BEGIN("mlc_read_csv");
 
-    if (!file) {
-        LOG_ERROR("Cannot open CSV file");
+    char * map = mlc_csv_map_(filename, &length, &cols);
+    if (map == NULL) {
         return result;
     }
-    float * data = NULL;
-    size_t capacity = 0;
-    size_t size = 0;
-    size_t rows = 0;
-    size_t cols = 0;
-
-    char * line = NULL;
-    size_t line_cap = 0;
-    ssize_t line_len;
+    const char * end = map + length;
 
-    while ((line_len = getline(&line, &line_cap, file)) != -1) 
-    {
-        if (line_len <= 1) continue;
+    /* Split into newline-aligned chunks */
+    MlcCsvChunk_ chunks[MLC_MAX_THREADS];
+    size_t used = mlc_csv_split_(map, end, cols, chunks);
 
-        size_t current_cols = 0;
-        char * token = strtok(line, ",");
+    /* Pass 1: count rows per chunk, then size the output once */
+    mlc_parallel_for(used, 1, mlc_csv_count_range_, chunks);
 
-        while (token) 
-        {
-            if (size >= capacity) {
-                capacity = capacity ? capacity * 2 : 1024;
-                float * new_data = (float *)realloc(data, capacity * sizeof(float));
-                
-                if (!new_data) {
-                    LOG_ERROR("Memory reallocation failed");
-                    free(data);
-                    free(line);
-                    fclose(file);
-                    return result;
-                }
-                data = new_data;
-            }
-            data[size++] = atof(token);
-            current_cols++;
-            token = strtok(NULL, ",");
-        }
-
-        if (rows == 0) {
-            cols = current_cols;
-        } 
-
-        else if (current_cols != cols) {
-            LOG_ERROR("Inconsistent column count in CSV");
-            free(data);
-            free(line);
-            fclose(file);
-            return result;
-        }
-        rows++;
+    size_t rows = 0;
+    for (size_t t = 0; t < used; ++t) {
+        rows += chunks[t].rows;
     }
-    free(line);
-    fclose(file);
+    float * data = (float *)malloc(rows * cols * sizeof(float));
+    result.shape = (size_t *)malloc(2 * sizeof(size_t));
 
-    if (rows == 0 || cols == 0) {
-        LOG_ERROR("Empty or invalid CSV file");
+    if (data == NULL || result.shape == NULL) {
+        LOG_ERROR("Memory allocation failed");
         free(data);
+        free(result.shape);
+        result.shape = NULL;
+        munmap(map, length);
         return result;
     }
-    result.size = rows * cols;
-    result.shape = (size_t *)malloc(2 * sizeof(size_t));
 
-    if (!result.shape) {
-        LOG_ERROR("Memory allocation failed for shape");
-        free(data);
-        return result;
+    /* Pass 2: parse every chunk straight into its rows */
+    float * out = data;
+    for (size_t t = 0; t < used; ++t) {
+        chunks[t].out = out;
+        out += chunks[t].rows * cols;
     }
-    result.shape[0] = rows;
-    result.shape[1] = cols;
+    mlc_parallel_for(used, 1, mlc_csv_parse_range_, chunks);
+    munmap(map, length);
 
-    result.data = (float *)realloc(data, result.size * sizeof(float));
-    
-    if (!result.data) {
-        LOG_ERROR("Memory reallocation failed for data");
+    if (mlc_csv_check_chunks_(chunks, used) != 0) {
         free(data);
         free(result.shape);
+        result.shape = NULL;
         return result;
     }
+    result.data = data;
+    result.size = rows * cols;
+    result.shape[0] = rows;
+    result.shape[1] = cols;
+    MLC_PROFILE_END(result.size, length + result.size * sizeof(float));
     return result;
 }
 
 /**********************************
  * Frees an MlcArray's allocated memory.
+ * Memory-mapped arrays are unmapped instead of freed; arena
+ * arrays go back to their arena's pool (or, if bump-allocated,
+ * stay in the arena until mlc_arena_reset()); views only free
+ * their shape, never the data they look at.
  **********************************/
 static inline void
 mlc_finish(MlcArray * array) 
 {
     if (array != NULL) {
-        free(array->data);
-        free(array->shape);
+        switch (array->storage)
+        {
+            case MLC_STORAGE_MMAP:
+                munmap(array->base, array->base_size);
+                free(array->shape);
+                break;
+            case MLC_STORAGE_ARENA:
+            {
+                /* shape is inline in the block */
+                MlcBlockHeader * block = (MlcBlockHeader *)array->base;
+                if (block != NULL && block->release != NULL) {
+                    block->release(block);
+                }
+                break;
+            }
+            case MLC_STORAGE_VIEW:
+                /* borrowed data; strides share the shape block */
+                free(array->shape);
+                break;
+            case MLC_STORAGE_HEAP:
+            default:
+                free(array->data);
+                free(array->shape);
+                break;
+        }
         array->data = NULL;
         array->shape = NULL;
+        array->strides = NULL;
+        array->base = NULL;
+        array->base_size = 0;
+        array->storage = MLC_STORAGE_HEAP;
     }
 }
 
@@ -0,0 +1,547 @@
+/* include/mlc/dispatch.h */
+
+#ifndef MLC_DISPATCH_H
+#define MLC_DISPATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/simd_math.h>
+#include <mlc/half.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Runtime kernel dispatch:
+ *
+ * The span kernels every operation is built on (kernels.h) are
+ * compiled once per instruction-set level, and the best level
+ * the CPU supports is picked the first time a kernel runs. One
+ * binary built with plain -O2 thus runs AVX2 code on AVX2
+ * hosts, and so on, without per-host builds:
+ *
+ *  - MLC_CPU_SCALAR: plain C, no intrinsics.
+ *  - MLC_CPU_SSE2:   SSE2 (every x86-64 CPU; SSE4.2-only hosts
+ *                    run this level).
+ *  - MLC_CPU_AVX2:   AVX2 + FMA + F16C (Haswell, Zen and later).
+ *  - MLC_CPU_AVX512: the AVX2 kernels plus AVX-512 VNNI for the
+ *                    int8 dot products (needs AVX512 F/BW/DQ/VL
+ *                    and VNNI: Cascade Lake, Ice Lake, Zen 4 and
+ *                    later).
+ *
+ * Features are read with cpuid, and the AVX state is checked
+ * with xgetbv so an OS that does not save the registers is not
+ * trusted. The level can be forced, for testing or to compare
+ * levels, with the MLC_CPU_LEVEL environment variable (scalar,
+ * sse2, avx2, avx512, lowercase) or mlc_set_cpu_level(). Either
+ * way a level above the host's is capped to the best level the
+ * host supports, so check mlc_cpu_level() when pinning one. An
+ * unrecognized MLC_CPU_LEVEL value is reported with LOG_ERROR
+ * and ignored.
+ *
+ * Results may differ between levels in the last bits (FMA
+ * contraction, summation order of reductions); each level is
+ * deterministic on its own. The fp16/bf16 conversions are exact
+ * at every level.
+ *
+ * The multi-level build needs GCC on x86 (`#pragma GCC target`
+ * enables the instruction sets per level). Elsewhere, or when
+ * MLC_NO_DISPATCH is defined before including any MLC header,
+ * the kernels are compiled once with the command-line flags
+ * and every level maps to them.
+ *
+ * Note: as with the thread pool, every translation unit has its
+ * own copy of the tables and of the selected level.
+ *************************************************************/
+
+typedef enum
+{
+    MLC_CPU_SCALAR,
+    MLC_CPU_SSE2,
+    MLC_CPU_AVX2,
+    MLC_CPU_AVX512
+}
+MlcCpuLevel;
+
+#if !defined(MLC_NO_DISPATCH) && defined(__GNUC__) && !defined(__clang__) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #include <cpuid.h>
+    #include <immintrin.h>
+    #define MLC_DISPATCH_X86_
+#endif
+
+/* Level the command-line flags alone provide */
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__) && \
+    defined(__AVX512VL__) && defined(__AVX512VNNI__) && defined(__AVX2__) && \
+    defined(__FMA__) && defined(__F16C__)
+    #define MLC_CPU_NATIVE_ 3
+#elif defined(__AVX2__) && defined(__FMA__) && defined(__F16C__)
+    #define MLC_CPU_NATIVE_ 2
+#elif defined(MLC_SIMD_SSE2)
+    #define MLC_CPU_NATIVE_ 1
+#else
+    #define MLC_CPU_NATIVE_ 0
+#endif
+
+/* Register tile of the GEMM micro-kernel (matrix.h) */
+#define MLC_GEMM_MR 6
+#define MLC_GEMM_NR 16
+
+#ifndef MLC_QUANT_BLOCK
+    #define MLC_QUANT_BLOCK (1u << 16)    /* int8 dot: int32 accumulation span, values */
+#endif
+
+/**********************************
+ * One level's kernels; see kernels.h for what each computes.
+ **********************************/
+typedef struct
+{
+    MlcCpuLevel level;
+    void (*relu)(float * x, size_t n);
+    void (*leaky_relu)(float * x, size_t n, float alpha);
+    void (*scale)(float * x, size_t n, float k);
+    void (*add_scalar)(float * x, size_t n, float k);
+    void (*relu_backward)(const float * y, float * g, size_t n);
+    void (*leaky_relu_backward)(const float * y, float * g, size_t n, float alpha);
+    void (*sigmoid_backward)(const float * y, float * g, size_t n);
+    void (*tanh_backward)(const float * y, float * g, size_t n);
+    void (*swish_backward)(const float * x, float * g, size_t n);
+    void (*softmax_backward)(const float * y, float * g, size_t n, float dot);
+    void (*sigmoid)(float * x, size_t n);
+    void (*tanh)(float * x, size_t n);
+    void (*swish)(float * x, size_t n);
+    float (*exp_sum)(float * x, size_t n, float shift);
+    void (*sgd)(float * p, const float * g, size_t n, float lr, float keep);
+    void (*momentum)(float * p, const float * g, float * v, size_t n,
+                     float lr, float mu, float decay);
+    void (*adam)(float * p, const float * g, float * m, float * v, size_t n,
+                 float lr, float b1, float b2, float eps, float keep);
+    void (*add)(const float * a, const float * b, float * out, size_t n);
+    void (*sub)(const float * a, const float * b, float * out, size_t n);
+    void (*scale_into)(const float * a, float k, float * out, size_t n);
+    float (*dot)(const float * a, const float * b, size_t n);
+    void (*axpy)(float a, const float * x, float * y, size_t n);
+    float (*sparse_dot)(const float * values, const uint32_t * indices, const float * x, size_t n);
+    void (*spmm_row)(const float * values, const uint32_t * indices, size_t count,
+                     const float * b, size_t ldb, float * c, size_t n);
+    void (*welford_row)(const float * x, double * mean, double * m2,
+                        float * lo, float * hi, size_t n, double inv_count);
+    void (*affine_row)(float * x, const float * shift, const float * scale, size_t n);
+    void (*conv_direct_row)(const float * in, size_t step, const size_t * offsets,
+                            const float * w, size_t taps, float * out, size_t count);
+    size_t (*argmin)(const float * x, size_t n, float * min);
+    void (*convert_int)(const int * in, float * out, size_t n);
+    void (*convert_double)(const double * in, float * out, size_t n);
+    void (*f16_to_f32)(const uint16_t * in, float * out, size_t n);
+    void (*f32_to_f16)(const float * in, uint16_t * out, size_t n);
+    void (*bf16_to_f32)(const uint16_t * in, float * out, size_t n);
+    void (*f32_to_bf16)(const float * in, uint16_t * out, size_t n);
+    int64_t (*dot_i8)(const int8_t * a, const int8_t * b, size_t n);
+    void (*gemm_micro_kernel)(size_t kc, const float * a, const float * b, float * tile);
+    void (*gemm_row_kernel)(size_t kc, const float * a, const float * b, float * out);
+    void (*gemv_rows)(size_t rows, size_t cols, const float * m, size_t ld,
+                      const float * x, float * out);
+}
+MlcKernels;
+
+#if defined(MLC_DISPATCH_X86_)
+
+#define MLC_KERNEL_LEVEL 0
+#define MLC_KERNEL_(name) name##scalar_
+#include <mlc/kernels.h>
+#undef MLC_KERNEL_
+#undef MLC_KERNEL_LEVEL
+
+#define MLC_KERNEL_LEVEL 1
+#define MLC_KERNEL_(name) name##sse2_
+#include <mlc/kernels.h>
+#undef MLC_KERNEL_
+#undef MLC_KERNEL_LEVEL
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,f16c")
+#define MLC_KERNEL_LEVEL 2
+#define MLC_KERNEL_(name) name##avx2_
+#include <mlc/kernels.h>
+#undef MLC_KERNEL_
+#undef MLC_KERNEL_LEVEL
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,f16c,avx512f,avx512bw,avx512dq,avx512vl,avx512vnni")
+#define MLC_KERNEL_LEVEL 3
+#define MLC_KERNEL_(name) name##avx512_
+#include <mlc/kernels.h>
+#undef MLC_KERNEL_
+#undef MLC_KERNEL_LEVEL
+#pragma GCC pop_options
+
+static const MlcKernels * const mlc_kernel_levels_[] = {
+    &mlc_kernels_scalar_, &mlc_kernels_sse2_, &mlc_kernels_avx2_, &mlc_kernels_avx512_
+};
+
+#else
+
+#define MLC_KERNEL_LEVEL MLC_CPU_NATIVE_
+#define MLC_KERNEL_(name) name##native_
+#include <mlc/kernels.h>
+#undef MLC_KERNEL_
+#undef MLC_KERNEL_LEVEL
+
+static const MlcKernels * const mlc_kernel_levels_[] = {
+    &mlc_kernels_native_, &mlc_kernels_native_, &mlc_kernels_native_, &mlc_kernels_native_
+};
+
+#endif /* MLC_DISPATCH_X86_ */
+
+static const MlcKernels * mlc_kernels_active_ = NULL;
+static int mlc_cpu_detected_ = -1;
+
+static inline const char *
+mlc_cpu_level_name(MlcCpuLevel level)
+{
+    static const char * const names[] = {"scalar", "sse2", "avx2", "avx512"};
+    return ((unsigned)level <= MLC_CPU_AVX512) ? names[level] : "unknown";
+}
+
+#if defined(MLC_DISPATCH_X86_)
+static inline MlcCpuLevel
+mlc_cpu_probe_(void)
+{
+    unsigned a, b, c, d;
+    MlcCpuLevel level = MLC_CPU_SCALAR;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d)) return level;
+    if (d & bit_SSE2) level = MLC_CPU_SSE2;
+
+    int osxsave = (c & bit_OSXSAVE) != 0;
+    int avx = (c & bit_AVX) && (c & bit_FMA) && (c & bit_F16C);
+    unsigned xcr0 = 0;
+
+    if (osxsave) {
+        unsigned hi;
+        __asm__ ("xgetbv" : "=a"(xcr0), "=d"(hi) : "c"(0));
+        (void)hi;
+    }
+    /* XMM and YMM state enabled by the OS */
+    if (!avx || (xcr0 & 0x6) != 0x6) return level;
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return level;
+    if (!(b & bit_AVX2)) return level;
+    level = MLC_CPU_AVX2;
+
+    /* plus opmask and ZMM state */
+    unsigned avx512 = bit_AVX512F | bit_AVX512BW | bit_AVX512DQ | bit_AVX512VL;
+    if ((b & avx512) == avx512 && (c & bit_AVX512VNNI) && (xcr0 & 0xe6) == 0xe6) {
+        level = MLC_CPU_AVX512;
+    }
+    return level;
+}
+#else
+static inline MlcCpuLevel
+mlc_cpu_probe_(void)
+{
+    return (MlcCpuLevel)MLC_CPU_NATIVE_;
+}
+#endif
+
+/* Best level this host supports (probed once). */
+static inline MlcCpuLevel
+mlc_cpu_detect(void)
+{
+    int level = __atomic_load_n(&mlc_cpu_detected_, __ATOMIC_RELAXED);
+
+    if (level < 0) {
+        level = (int)mlc_cpu_probe_();
+        __atomic_store_n(&mlc_cpu_detected_, level, __ATOMIC_RELAXED);
+    }
+    return (MlcCpuLevel)level;
+}
+
+/**********************************
+ * Selects the kernels of `level`, capped at what the host
+ * supports. Returns the level actually selected. Kernels
+ * already running on other threads finish with the old level.
+ **********************************/
+static inline MlcCpuLevel
+mlc_set_cpu_level(MlcCpuLevel level)
+{
+    MlcCpuLevel best = mlc_cpu_detect();
+
+    if ((unsigned)level > (unsigned)best) level = best;
+    __atomic_store_n(&mlc_kernels_active_, mlc_kernel_levels_[level], __ATOMIC_RELEASE);
+    return level;
+}
+
+/* Resolves the level on first use: MLC_CPU_LEVEL, or the best one */
+static inline const MlcKernels *
+mlc_kernels_resolve_(void)
+{
+    const char * env = getenv("MLC_CPU_LEVEL");
+    MlcCpuLevel level = mlc_cpu_detect();
+    int matched = 0;
+
+    for (int l = MLC_CPU_SCALAR; env != NULL && l <= MLC_CPU_AVX512; ++l) {
+        if (strcmp(env, mlc_cpu_level_name((MlcCpuLevel)l)) == 0) {
+            level = (MlcCpuLevel)l;
+            matched = 1;
+        }
+    }
+    if (env != NULL && !matched) {
+        LOG_ERROR("Unknown MLC_CPU_LEVEL (expected scalar, sse2, avx2 or avx512); using the best level");
+    }
+    mlc_set_cpu_level(level);
+    return __atomic_load_n(&mlc_kernels_active_, __ATOMIC_ACQUIRE);
+}
+
+static inline const MlcKernels *
+mlc_kernels(void)
+{
+    const MlcKernels * kernels = __atomic_load_n(&mlc_kernels_active_, __ATOMIC_ACQUIRE);
+    return kernels ? kernels : mlc_kernels_resolve_();
+}
+
+/* Level of the kernels currently in use. */
+static inline MlcCpuLevel
+mlc_cpu_level(void)
+{
+    return mlc_kernels()->level;
+}
+
+/**********************************
+ * Span kernels through the table, under the names the rest of
+ * the library uses.
+ **********************************/
+static inline void
+mlc_relu_span_(float * x, size_t n)
+{
+    mlc_kernels()->relu(x, n);
+}
+
+static inline void
+mlc_leaky_relu_span_(float * x, size_t n, float alpha)
+{
+    mlc_kernels()->leaky_relu(x, n, alpha);
+}
+
+static inline void
+mlc_scale_span_(float * x, size_t n, float k)
+{
+    mlc_kernels()->scale(x, n, k);
+}
+
+static inline void
+mlc_add_scalar_span_(float * x, size_t n, float k)
+{
+    mlc_kernels()->add_scalar(x, n, k);
+}
+
+static inline void
+mlc_relu_backward_span_(const float * y, float * g, size_t n)
+{
+    mlc_kernels()->relu_backward(y, g, n);
+}
+
+static inline void
+mlc_leaky_relu_backward_span_(const float * y, float * g, size_t n, float alpha)
+{
+    mlc_kernels()->leaky_relu_backward(y, g, n, alpha);
+}
+
+static inline void
+mlc_sigmoid_backward_span_(const float * y, float * g, size_t n)
+{
+    mlc_kernels()->sigmoid_backward(y, g, n);
+}
+
+static inline void
+mlc_tanh_backward_span_(const float * y, float * g, size_t n)
+{
+    mlc_kernels()->tanh_backward(y, g, n);
+}
+
+static inline void
+mlc_swish_backward_span_(const float * x, float * g, size_t n)
+{
+    mlc_kernels()->swish_backward(x, g, n);
+}
+
+static inline void
+mlc_softmax_backward_span_(const float * y, float * g, size_t n, float dot)
+{
+    mlc_kernels()->softmax_backward(y, g, n, dot);
+}
+
+static inline void
+mlc_sigmoid_span_(float * x, size_t n)
+{
+    mlc_kernels()->sigmoid(x, n);
+}
+
+static inline void
+mlc_tanh_span_(float * x, size_t n)
+{
+    mlc_kernels()->tanh(x, n);
+}
+
+static inline void
+mlc_swish_span_(float * x, size_t n)
+{
+    mlc_kernels()->swish(x, n);
+}
+
+static inline float
+mlc_exp_sum_span_(float * x, size_t n, float shift)
+{
+    return mlc_kernels()->exp_sum(x, n, shift);
+}
+
+static inline void
+mlc_sgd_span_(float * p, const float * g, size_t n, float lr, float keep)
+{
+    mlc_kernels()->sgd(p, g, n, lr, keep);
+}
+
+static inline void
+mlc_momentum_span_(float * p, const float * g, float * v, size_t n, float lr, float mu, float decay)
+{
+    mlc_kernels()->momentum(p, g, v, n, lr, mu, decay);
+}
+
+static inline void
+mlc_adam_span_(float * p, const float * g, float * m, float * v, size_t n,
+               float lr, float b1, float b2, float eps, float keep)
+{
+    mlc_kernels()->adam(p, g, m, v, n, lr, b1, b2, eps, keep);
+}
+
+static inline void
+mlc_add_span_(const float * a, const float * b, float * out, size_t n)
+{
+    mlc_kernels()->add(a, b, out, n);
+}
+
+static inline void
+mlc_sub_span_(const float * a, const float * b, float * out, size_t n)
+{
+    mlc_kernels()->sub(a, b, out, n);
+}
+
+static inline void
+mlc_scale_into_span_(const float * a, float k, float * out, size_t n)
+{
+    mlc_kernels()->scale_into(a, k, out, n);
+}
+
+static inline float
+mlc_dot_span_(const float * a, const float * b, size_t n)
+{
+    return mlc_kernels()->dot(a, b, n);
+}
+
+static inline void
+mlc_axpy_span_(float a, const float * x, float * y, size_t n)
+{
+    mlc_kernels()->axpy(a, x, y, n);
+}
+
+static inline float
+mlc_sparse_dot_span_(const float * values, const uint32_t * indices, const float * x, size_t n)
+{
+    return mlc_kernels()->sparse_dot(values, indices, x, n);
+}
+
+static inline void
+mlc_spmm_row_(const float * values, const uint32_t * indices, size_t count,
+              const float * b, size_t ldb, float * c, size_t n)
+{
+    mlc_kernels()->spmm_row(values, indices, count, b, ldb, c, n);
+}
+
+static inline void
+mlc_welford_row_(const float * x, double * mean, double * m2,
+                 float * lo, float * hi, size_t n, double inv_count)
+{
+    mlc_kernels()->welford_row(x, mean, m2, lo, hi, n, inv_count);
+}
+
+static inline void
+mlc_affine_row_(float * x, const float * shift, const float * scale, size_t n)
+{
+    mlc_kernels()->affine_row(x, shift, scale, n);
+}
+
+static inline void
+mlc_conv_direct_row_(const float * in, size_t step, const size_t * offsets,
+                     const float * w, size_t taps, float * out, size_t count)
+{
+    mlc_kernels()->conv_direct_row(in, step, offsets, w, taps, out, count);
+}
+
+static inline size_t
+mlc_argmin_span_(const float * x, size_t n, float * min)
+{
+    return mlc_kernels()->argmin(x, n, min);
+}
+
+static inline void
+mlc_convert_int_span_(const int * in, float * out, size_t n)
+{
+    mlc_kernels()->convert_int(in, out, n);
+}
+
+static inline void
+mlc_convert_double_span_(const double * in, float * out, size_t n)
+{
+    mlc_kernels()->convert_double(in, out, n);
+}
+
+static inline void
+mlc_f16_to_f32_span_(const uint16_t * in, float * out, size_t n)
+{
+    mlc_kernels()->f16_to_f32(in, out, n);
+}
+
+static inline void
+mlc_f32_to_f16_span_(const float * in, uint16_t * out, size_t n)
+{
+    mlc_kernels()->f32_to_f16(in, out, n);
+}
+
+static inline void
+mlc_bf16_to_f32_span_(const uint16_t * in, float * out, size_t n)
+{
+    mlc_kernels()->bf16_to_f32(in, out, n);
+}
+
+static inline void
+mlc_f32_to_bf16_span_(const float * in, uint16_t * out, size_t n)
+{
+    mlc_kernels()->f32_to_bf16(in, out, n);
+}
+
+static inline int64_t
+mlc_dot_i8_span_(const int8_t * a, const int8_t * b, size_t n)
+{
+    return mlc_kernels()->dot_i8(a, b, n);
+}
+
+static inline void
+mlc_gemm_micro_kernel_(size_t kc, const float * a, const float * b, float * tile)
+{
+    mlc_kernels()->gemm_micro_kernel(kc, a, b, tile);
+}
+
+static inline void
+mlc_gemm_row_kernel_(size_t kc, const float * a, const float * b, float * out)
+{
+    mlc_kernels()->gemm_row_kernel(kc, a, b, out);
+}
+
+static inline void
+mlc_gemv_rows_(size_t rows, size_t cols, const float * m, size_t ld, const float * x, float * out)
+{
+    mlc_kernels()->gemv_rows(rows, cols, m, ld, x, out);
+}
+
+#endif /* MLC_DISPATCH_H */
@@ -0,0 +1,186 @@
+/* include/mlc/half.h */
+
+#ifndef MLC_HALF_H
+#define MLC_HALF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <mlc/simd_math.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Reduced-precision conversions:
+ *
+ *  - fp16 (IEEE 754 binary16): 1 sign, 5 exponent, 10 mantissa
+ *    bits. Range +-65504; subnormals, infinities and NaN are
+ *    kept.
+ *  - bf16 (bfloat16): the upper 16 bits of an fp32. Same range
+ *    as fp32 with 8 mantissa bits.
+ *
+ * float -> half conversions round to nearest even, overflow to
+ * infinity and turn NaN into a quiet NaN; half -> float is
+ * exact. The span kernels (kernels.h) use F16C for fp16 on
+ * hosts that have it and SSE2/AVX2 integer arithmetic
+ * otherwise; their results are the same as the scalar versions.
+ *************************************************************/
+
+static inline uint32_t
+mlc_f32_bits_(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline float
+mlc_bits_f32_(uint32_t u)
+{
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+/* fp16 bits -> float */
+static inline float
+mlc_f16_to_f32(uint16_t h)
+{
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t o = ((uint32_t)h & 0x7fffu) << 13;
+    uint32_t exp = o & shifted_exp;
+
+    o += (127u - 15u) << 23;
+    if (exp == shifted_exp) {
+        o += (128u - 16u) << 23;            /* Inf/NaN */
+    }
+    else if (exp == 0) {
+        o += 1u << 23;                      /* zero/subnormal: renormalize */
+        o = mlc_f32_bits_(mlc_bits_f32_(o) - mlc_bits_f32_(113u << 23));
+    }
+    return mlc_bits_f32_(o | ((uint32_t)(h & 0x8000u) << 16));
+}
+
+/* float -> fp16 bits, round to nearest even */
+static inline uint16_t
+mlc_f32_to_f16(float x)
+{
+    const uint32_t f32_inf = 255u << 23;
+    const uint32_t f16_max = (127u + 16u) << 23;
+    const uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+    uint32_t f = mlc_f32_bits_(x);
+    uint32_t sign = f & 0x80000000u;
+    uint32_t o;
+
+    f ^= sign;
+    if (f >= f16_max) {
+        o = (f > f32_inf) ? 0x7e00u : 0x7c00u;
+    }
+    else if (f < (113u << 23)) {
+        /* subnormal result: let the FPU round the mantissa */
+        o = mlc_f32_bits_(mlc_bits_f32_(f) + mlc_bits_f32_(denorm_magic)) - denorm_magic;
+    }
+    else {
+        uint32_t mant_odd = (f >> 13) & 1u;
+        f -= (127u - 15u) << 23;
+        f += 0xfffu + mant_odd;
+        o = f >> 13;
+    }
+    return (uint16_t)(o | (sign >> 16));
+}
+
+/* bf16 bits -> float */
+static inline float
+mlc_bf16_to_f32(uint16_t h)
+{
+    return mlc_bits_f32_((uint32_t)h << 16);
+}
+
+/* float -> bf16 bits, round to nearest even */
+static inline uint16_t
+mlc_f32_to_bf16(float x)
+{
+    uint32_t f = mlc_f32_bits_(x);
+
+    if ((f & 0x7fffffffu) > 0x7f800000u) {
+        return (uint16_t)((f >> 16) | 0x40u);     /* quiet NaN */
+    }
+    f += 0x7fffu + ((f >> 16) & 1u);
+    return (uint16_t)(f >> 16);
+}
+
+/**********************************
+ * SSE2 helpers, 4 values at a time: the integer versions of
+ * the scalar conversions above, with the branches turned into
+ * masks. The float -> half helpers return the 16-bit results
+ * sign-extended to 32 bits, so a signed pack (packssdw)
+ * narrows them without saturating.
+ **********************************/
+#if defined(MLC_SIMD_SSE2)
+static inline __m128i
+mlc_select_si128_(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128
+mlc_f16x4_to_f32_(__m128i h)
+{
+    const __m128i shifted_exp = _mm_set1_epi32(0x7c00 << 13);
+    __m128i o = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exp = _mm_and_si128(o, shifted_exp);
+
+    o = _mm_add_epi32(o, _mm_set1_epi32((127 - 15) << 23));
+    o = _mm_add_epi32(o, _mm_and_si128(_mm_cmpeq_epi32(exp, shifted_exp),
+                                       _mm_set1_epi32((128 - 16) << 23)));
+
+    __m128i zero = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    __m128 denorm = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(o, _mm_set1_epi32(1 << 23))),
+                               _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+
+    o = mlc_select_si128_(zero, _mm_castps_si128(denorm), o);
+    o = _mm_or_si128(o, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+    return _mm_castsi128_ps(o);
+}
+
+static inline __m128i
+mlc_f32x4_to_f16_(__m128 x)
+{
+    const __m128i denorm_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    __m128i f = _mm_castps_si128(x);
+    __m128i sign = _mm_and_si128(f, _mm_set1_epi32((int)0x80000000u));
+
+    f = _mm_xor_si128(f, sign);     /* |x|, so signed compares are safe */
+
+    __m128i nan = _mm_cmpgt_epi32(f, _mm_set1_epi32(255 << 23));
+    __m128i big = _mm_cmpgt_epi32(f, _mm_set1_epi32(((127 + 16) << 23) - 1));
+    __m128i small = _mm_cmplt_epi32(f, _mm_set1_epi32(113 << 23));
+    __m128i special = mlc_select_si128_(nan, _mm_set1_epi32(0x7e00), _mm_set1_epi32(0x7c00));
+    __m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f),
+                                                               _mm_castsi128_ps(denorm_magic))),
+                                   denorm_magic);
+    __m128i mant_odd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+    __m128i normal = _mm_sub_epi32(f, _mm_set1_epi32((127 - 15) << 23));
+
+    normal = _mm_add_epi32(normal, _mm_add_epi32(_mm_set1_epi32(0xfff), mant_odd));
+    normal = _mm_srli_epi32(normal, 13);
+
+    __m128i o = mlc_select_si128_(small, denorm, normal);
+    o = mlc_select_si128_(big, special, o);
+    return _mm_or_si128(o, _mm_srai_epi32(sign, 16));
+}
+
+static inline __m128i
+mlc_f32x4_to_bf16_(__m128 x)
+{
+    __m128i f = _mm_castps_si128(x);
+    __m128i abs = _mm_and_si128(f, _mm_set1_epi32(0x7fffffff));
+    __m128i nan = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7f800000));
+    __m128i odd = _mm_and_si128(_mm_srli_epi32(f, 16), _mm_set1_epi32(1));
+    __m128i rounded = _mm_add_epi32(f, _mm_add_epi32(_mm_set1_epi32(0x7fff), odd));
+    __m128i quiet = _mm_or_si128(f, _mm_set1_epi32(0x400000));
+
+    return _mm_srai_epi32(mlc_select_si128_(nan, quiet, rounded), 16);
+}
+#endif
+
+#endif /* MLC_HALF_H */
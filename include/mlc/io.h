@@ -0,0 +1,242 @@
+/* include/mlc/io.h */
+
+#ifndef MLC_IO_H
+#define MLC_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Native binary tensor files:
+ *
+ * A pre-converted dataset can be loaded without parsing, by
+ * mapping the file and pointing MlcArray::data straight at the
+ * payload. Processes mapping the same file share its pages in
+ * the page cache.
+ *
+ * File layout (all fields little-endian):
+ *
+ *   offset  size          field
+ *   0       4             magic "MLCT"
+ *   4       4             version (MLC_TENSOR_VERSION)
+ *   8       4             dtype (MLC_TENSOR_F32/F16/BF16)
+ *   12      4             ndims
+ *   16      8             payload offset (multiple of 64)
+ *   24      8             payload size in bytes
+ *   32      8 * ndims     shape
+ *   ...                   zero padding up to the payload offset
+ *   offset  4 or 2 * size row-major float32, fp16 or bf16 payload
+ *
+ * Functions return -1 (or an MlcArray with data = NULL) on
+ * error, and 0 on success.
+ *************************************************************/
+
+#define MLC_TENSOR_MAGIC "MLCT"
+#define MLC_TENSOR_VERSION 1u
+#define MLC_TENSOR_ALIGN 64u
+#define MLC_TENSOR_F32 0u       /* same values as MlcDtype */
+#define MLC_TENSOR_F16 1u
+#define MLC_TENSOR_BF16 2u
+
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t ndims;
+    uint64_t payload_offset;
+    uint64_t payload_bytes;
+}
+MlcTensorHeader;
+
+/**********************************
+ * How mlc_load_mmap() maps the payload:
+ *
+ *  - MLC_MAP_READONLY: shared read-only mapping. Cheapest and
+ *    shared between processes, but the array must not be
+ *    modified (in-place activations would fault).
+ *  - MLC_MAP_PRIVATE: copy-on-write mapping. The array can be
+ *    modified in place; only touched pages are copied and
+ *    changes never reach the file.
+ **********************************/
+typedef enum
+{
+    MLC_MAP_READONLY,
+    MLC_MAP_PRIVATE
+}
+MlcMapMode;
+
+static inline int
+mlc_io_host_is_little_endian_(void)
+{
+    const uint16_t probe = 1;
+    return *(const uint8_t *)&probe == 1;
+}
+
+/**********************************
+ * Writes an MlcArray to `filename` in the binary tensor format.
+ *
+ * Arguments:
+ *  - filename: Output path (created or truncated).
+ *  - array: Array to store (its dtype is kept).
+ *
+ * Returns:
+ *  - 0 on success, -1 on invalid input or I/O error.
+ **********************************/
+static inline int
+mlc_save(const char * filename, const MlcArray * array)
+{
+    if (filename == NULL || array == NULL || array->data == NULL ||
+        array->size == 0 || array->ndims == 0 || array->shape == NULL) {
+        LOG_ERROR("Invalid array or filename");
+        return -1;
+    }
+    if (array->strides != NULL && !mlc_is_contiguous(array)) {
+        LOG_ERROR("Strided view: save a mlc_contiguous() copy instead");
+        return -1;
+    }
+    if (!mlc_io_host_is_little_endian_()) {
+        LOG_ERROR("Binary tensor files require a little-endian host");
+        return -1;
+    }
+    size_t header_bytes = sizeof(MlcTensorHeader) + array->ndims * sizeof(uint64_t);
+    MlcTensorHeader header;
+    MLC_PROFILE_BEGIN("mlc_save");
+
+    memcpy(header.magic, MLC_TENSOR_MAGIC, 4);
+    header.version = MLC_TENSOR_VERSION;
+    header.dtype = (uint32_t)array->dtype;
+    header.ndims = (uint32_t)array->ndims;
+    header.payload_offset = (header_bytes + MLC_TENSOR_ALIGN - 1) / MLC_TENSOR_ALIGN * MLC_TENSOR_ALIGN;
+    header.payload_bytes = (uint64_t)array->size * mlc_dtype_size(array->dtype);
+
+    FILE * file = fopen(filename, "wb");
+    if (!file) {
+        LOG_ERROR("Cannot open tensor file for writing");
+        return -1;
+    }
+    int ok = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+    for (size_t i = 0; ok && i < array->ndims; ++i) {
+        uint64_t dim = array->shape[i];
+        ok = (fwrite(&dim, sizeof(dim), 1, file) == 1);
+    }
+    for (size_t i = header_bytes; ok && i < header.payload_offset; ++i) {
+        ok = (fputc(0, file) != EOF);
+    }
+    if (ok) {
+        ok = (fwrite(array->data, mlc_dtype_size(array->dtype), array->size, file) == array->size);
+    }
+    if (fclose(file) != 0) ok = 0;
+
+    if (!ok) {
+        LOG_ERROR("Failed to write tensor file");
+        return -1;
+    }
+    MLC_PROFILE_END(array->size, header.payload_offset + header.payload_bytes);
+    return 0;
+}
+
+/**********************************
+ * Maps a binary tensor file into an MlcArray without copying.
+ *
+ * Arguments:
+ *  - filename: Path written by mlc_save().
+ *  - mode: MLC_MAP_READONLY or MLC_MAP_PRIVATE (see MlcMapMode).
+ *
+ * Returns:
+ *  - An MlcArray whose data points into the mapping. Its storage
+ *    is MLC_STORAGE_MMAP, so mlc_finish() unmaps the file, and
+ *    its dtype is the one the file was saved with.
+ *  - If error occurs (missing file, bad header, truncated
+ *    payload, ...), data = NULL.
+ **********************************/
+static inline MlcArray
+mlc_load_mmap(const char * filename, MlcMapMode mode)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0) {
+        LOG_ERROR("Cannot open tensor file");
+        return result;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MlcTensorHeader)) {
+        LOG_ERROR("Tensor file too small");
+        close(fd);
+        return result;
+    }
+    size_t length = (size_t)st.st_size;
+    int prot = (mode == MLC_MAP_PRIVATE) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    int flags = (mode == MLC_MAP_PRIVATE) ? MAP_PRIVATE : MAP_SHARED;
+    char * map = (char *)mmap(NULL, length, prot, flags, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Cannot map tensor file");
+        return result;
+    }
+    MlcTensorHeader header;
+    memcpy(&header, map, sizeof(header));
+
+    int valid = mlc_io_host_is_little_endian_() &&
+                memcmp(header.magic, MLC_TENSOR_MAGIC, 4) == 0 &&
+                header.version == MLC_TENSOR_VERSION &&
+                header.dtype <= MLC_TENSOR_BF16 &&
+                header.ndims > 0 &&
+                header.payload_offset % MLC_TENSOR_ALIGN == 0 &&
+                header.payload_offset >= sizeof(header) + (uint64_t)header.ndims * sizeof(uint64_t) &&
+                header.payload_offset <= length &&
+                header.payload_bytes <= length - header.payload_offset;
+
+    size_t * shape = valid ? (size_t *)malloc(header.ndims * sizeof(size_t)) : NULL;
+    size_t size = 1;
+
+    if (valid && shape == NULL) {
+        LOG_ERROR("Memory allocation failed for shape");
+        munmap(map, length);
+        return result;
+    }
+    for (uint32_t i = 0; valid && i < header.ndims; ++i) {
+        uint64_t dim;
+        memcpy(&dim, map + sizeof(header) + i * sizeof(uint64_t), sizeof(dim));
+        /* A crafted shape must not wrap size around to a payload-sized value */
+        valid = (dim != 0 && dim <= SIZE_MAX / size);
+        if (valid) {
+            shape[i] = (size_t)dim;
+            size *= shape[i];
+        }
+    }
+    size_t elem = valid ? mlc_dtype_size((MlcDtype)header.dtype) : 1;
+    if (!valid || size > SIZE_MAX / elem || (uint64_t)(size * elem) != header.payload_bytes) {
+        LOG_ERROR("Invalid or corrupt tensor file");
+        free(shape);
+        munmap(map, length);
+        return result;
+    }
+    MLC_PROFILE_BEGIN("mlc_load_mmap");
+    madvise(map, length, MADV_WILLNEED);
+
+    result.data = (float *)(map + header.payload_offset);
+    result.ndims = header.ndims;
+    result.shape = shape;
+    result.size = size;
+    result.storage = MLC_STORAGE_MMAP;
+    result.dtype = (MlcDtype)header.dtype;
+    result.base = map;
+    result.base_size = length;
+    MLC_PROFILE_END(size, length);
+    return result;
+}
+
+#endif /* MLC_IO_H */
@@ -0,0 +1,1556 @@
+/* include/mlc/kernels.h */
+
+/*************************************************************
+ * Dispatched span kernels:
+ *
+ * This file has no include guard. dispatch.h includes it once
+ * per instruction-set level, with
+ *
+ *  - MLC_KERNEL_(name): the name of each function at this
+ *    level (e.g. mlc_relu_span_ -> mlc_relu_span_avx2_),
+ *  - MLC_KERNEL_LEVEL: the highest MlcCpuLevel its code may
+ *    use,
+ *
+ * and inside a `#pragma GCC target` region for the AVX2 and
+ * AVX-512 levels, so the intrinsics below are compiled in
+ * whether or not the command line enables them. The SIMD paths
+ * are selected from the compiler's feature macros, capped at
+ * MLC_KERNEL_LEVEL. The result is one MlcKernels table per
+ * level; see dispatch.h.
+ *
+ * The scalar helpers (mlc_expf_(), mlc_f16_to_f32(), ...) and
+ * the SSE2 helpers stay in simd_math.h and half.h and are
+ * inlined into every level.
+ *************************************************************/
+
+#if !defined(MLC_KERNEL_) || !defined(MLC_KERNEL_LEVEL)
+    #error "Include <mlc/dispatch.h> instead of <mlc/kernels.h>"
+#endif
+
+#if MLC_KERNEL_LEVEL >= 1 && defined(MLC_SIMD_SSE2)
+    #define MLC_K_SSE2
+#endif
+#if MLC_KERNEL_LEVEL >= 2 && defined(__AVX2__)
+    #define MLC_K_AVX2
+#endif
+#if defined(MLC_K_AVX2) && defined(__FMA__)
+    #define MLC_K_FMA
+    #define MLC_K_FMA256_(a, b, c) _mm256_fmadd_ps((a), (b), (c))
+#else
+    #define MLC_K_FMA256_(a, b, c) _mm256_add_ps(_mm256_mul_ps((a), (b)), (c))
+#endif
+#if defined(MLC_K_AVX2) && defined(__F16C__)
+    #define MLC_K_F16C
+#endif
+#if defined(MLC_K_AVX2) && MLC_MATH_ACCURACY != MLC_MATH_EXACT
+    #define MLC_K_MATH_AVX2
+#endif
+#if defined(MLC_K_SSE2) && defined(MLC_MATH_SSE2)
+    #define MLC_K_MATH_SSE2
+#endif
+
+/**********************************
+ * AVX2 math kernels (8 floats), see simd_math.h
+ **********************************/
+#ifdef MLC_K_MATH_AVX2
+
+static inline __m256
+MLC_KERNEL_(mlc_exp256_)(__m256 x)
+{
+    const __m256 hi = _mm256_set1_ps(MLC_EXP_HI);
+    const __m256 lo = _mm256_set1_ps(MLC_EXP_LO);
+    __m256 c = _mm256_min_ps(_mm256_max_ps(x, lo), hi);
+
+    __m256i n = _mm256_cvtps_epi32(_mm256_mul_ps(c, _mm256_set1_ps(MLC_LOG2E)));
+    __m256 nf = _mm256_cvtepi32_ps(n);
+    __m256 r = MLC_K_FMA256_(nf, _mm256_set1_ps(-MLC_LN2_HI), c);
+    r = MLC_K_FMA256_(nf, _mm256_set1_ps(-MLC_LN2_LO), r);
+
+#if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    __m256 p = _mm256_set1_ps(MLC_EXP_P2);
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P3));
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P4));
+#else
+    __m256 p = _mm256_set1_ps(MLC_EXP_P0);
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P1));
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P2));
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P3));
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P4));
+    p = MLC_K_FMA256_(p, r, _mm256_set1_ps(MLC_EXP_P5));
+#endif
+    p = MLC_K_FMA256_(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+
+    __m256i n1 = _mm256_srai_epi32(n, 1);
+    __m256i n2 = _mm256_sub_epi32(n, n1);
+    __m256i bias = _mm256_set1_epi32(127);
+    __m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n1, bias), 23));
+    __m256 s2 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(n2, bias), 23));
+    __m256 y = _mm256_mul_ps(_mm256_mul_ps(p, s1), s2);
+
+    /* Saturate outside the range and let NaN through */
+    y = _mm256_blendv_ps(y, _mm256_set1_ps(HUGE_VALF), _mm256_cmp_ps(x, hi, _CMP_GT_OQ));
+    y = _mm256_andnot_ps(_mm256_cmp_ps(x, lo, _CMP_LT_OQ), y);
+    return _mm256_blendv_ps(y, x, _mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+}
+
+/* 1 / d, exact division or a refined reciprocal estimate */
+static inline __m256
+MLC_KERNEL_(mlc_recip256_)(__m256 d)
+{
+#if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    __m256 r = _mm256_rcp_ps(d);
+    return _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(d, r)));
+#else
+    return _mm256_div_ps(_mm256_set1_ps(1.0f), d);
+#endif
+}
+
+static inline __m256
+MLC_KERNEL_(mlc_tanh256_)(__m256 x)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    __m256 c = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-MLC_TANH_CLAMP)),
+                             _mm256_set1_ps(MLC_TANH_CLAMP));
+    __m256 x2 = _mm256_mul_ps(c, c);
+
+    __m256 p = _mm256_set1_ps(MLC_TANH_A13);
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A11));
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A9));
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A7));
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A5));
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A3));
+    p = MLC_K_FMA256_(p, x2, _mm256_set1_ps(MLC_TANH_A1));
+    __m256 q = _mm256_set1_ps(MLC_TANH_B6);
+    q = MLC_K_FMA256_(q, x2, _mm256_set1_ps(MLC_TANH_B4));
+    q = MLC_K_FMA256_(q, x2, _mm256_set1_ps(MLC_TANH_B2));
+    q = MLC_K_FMA256_(q, x2, _mm256_set1_ps(MLC_TANH_B0));
+
+    __m256 t = _mm256_mul_ps(_mm256_mul_ps(c, p), MLC_KERNEL_(mlc_recip256_)(q));
+    t = _mm256_min_ps(_mm256_max_ps(t, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+
+    /* tanh(x) = x for tiny |x|, and NaN stays NaN */
+    __m256 tiny = _mm256_cmp_ps(_mm256_andnot_ps(sign, x), _mm256_set1_ps(MLC_TANH_TINY), _CMP_LT_OQ);
+    __m256 nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+    return _mm256_blendv_ps(t, x, _mm256_or_ps(tiny, nan));
+}
+
+#endif /* MLC_K_MATH_AVX2 */
+
+/**********************************
+ * Math spans: apply in-place to x[0..n).
+ **********************************/
+
+/* x[i] = e^(x[i] - shift); returns Σ x[i] (used by softmax) */
+static inline float
+MLC_KERNEL_(mlc_exp_sum_span_)(float * x, size_t n, float shift)
+{
+    size_t i = 0;
+    float sum = 0.0f;
+
+#if defined(MLC_K_MATH_AVX2)
+    __m256 s8 = _mm256_setzero_ps();
+    __m256 sh8 = _mm256_set1_ps(shift);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 e = MLC_KERNEL_(mlc_exp256_)(_mm256_sub_ps(_mm256_loadu_ps(x + i), sh8));
+        _mm256_storeu_ps(x + i, e);
+        s8 = _mm256_add_ps(s8, e);
+    }
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s8), _mm256_extractf128_ps(s8, 1));
+#elif defined(MLC_K_MATH_SSE2)
+    __m128 s4 = _mm_setzero_ps();
+#endif
+#if defined(MLC_K_MATH_SSE2)
+    __m128 sh4 = _mm_set1_ps(shift);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 e = mlc_exp128_(_mm_sub_ps(_mm_loadu_ps(x + i), sh4));
+        _mm_storeu_ps(x + i, e);
+        s4 = _mm_add_ps(s4, e);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, s4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i) {
+        x[i] = mlc_expf_(x[i] - shift);
+        sum += x[i];
+    }
+    return sum;
+}
+
+/* x[i] = 1 / (1 + e^(-x[i])) */
+static inline void
+MLC_KERNEL_(mlc_sigmoid_span_)(float * x, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_MATH_AVX2)
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 e = MLC_KERNEL_(mlc_exp256_)(_mm256_sub_ps(_mm256_setzero_ps(), v));
+        _mm256_storeu_ps(x + i, MLC_KERNEL_(mlc_recip256_)(_mm256_add_ps(one8, e)));
+    }
+#endif
+#if defined(MLC_K_MATH_SSE2)
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 e = mlc_exp128_(_mm_sub_ps(_mm_setzero_ps(), v));
+        _mm_storeu_ps(x + i, mlc_recip128_(_mm_add_ps(one4, e)));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = 1.0f / (1.0f + mlc_expf_(-x[i]));
+    }
+}
+
+/* x[i] = x[i] / (1 + e^(-x[i])) */
+static inline void
+MLC_KERNEL_(mlc_swish_span_)(float * x, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_MATH_AVX2)
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 e = MLC_KERNEL_(mlc_exp256_)(_mm256_sub_ps(_mm256_setzero_ps(), v));
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(v, MLC_KERNEL_(mlc_recip256_)(_mm256_add_ps(one8, e))));
+    }
+#endif
+#if defined(MLC_K_MATH_SSE2)
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 e = mlc_exp128_(_mm_sub_ps(_mm_setzero_ps(), v));
+        _mm_storeu_ps(x + i, _mm_mul_ps(v, mlc_recip128_(_mm_add_ps(one4, e))));
+    }
+#endif
+    for (; i < n; ++i) {
+        float v = x[i];
+        x[i] = v * (1.0f / (1.0f + mlc_expf_(-v)));
+    }
+}
+
+/* x[i] = tanh(x[i]) */
+static inline void
+MLC_KERNEL_(mlc_tanh_span_)(float * x, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_MATH_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(x + i, MLC_KERNEL_(mlc_tanh256_)(_mm256_loadu_ps(x + i)));
+    }
+#endif
+#if defined(MLC_K_MATH_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(x + i, mlc_tanh128_(_mm_loadu_ps(x + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = mlc_tanhf_(x[i]);
+    }
+}
+
+/**********************************
+ * Activation spans (activations.h, pipeline.h)
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_relu_span_)(float * x, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 zero8 = _mm256_setzero_ps();
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_max_ps(_mm256_loadu_ps(x + i), zero8));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 zero4 = _mm_setzero_ps();
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(x + i, _mm_max_ps(_mm_loadu_ps(x + i), zero4));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = (x[i] > 0.0f) ? x[i] : 0.0f;
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_leaky_relu_span_)(float * x, size_t n, float alpha)
+{
+    size_t i = 0;
+
+    /* Written out by hand: GCC does not if-convert this at -O2 */
+#if defined(MLC_K_AVX2)
+    const __m256 zero8 = _mm256_setzero_ps();
+    const __m256 alpha8 = _mm256_set1_ps(alpha);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 positive = _mm256_cmp_ps(v, zero8, _CMP_GT_OQ);
+        _mm256_storeu_ps(x + i, _mm256_blendv_ps(_mm256_mul_ps(v, alpha8), v, positive));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 zero4 = _mm_setzero_ps();
+    const __m128 alpha4 = _mm_set1_ps(alpha);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 positive = _mm_cmpgt_ps(v, zero4);
+        _mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(positive, v),
+                                       _mm_andnot_ps(positive, _mm_mul_ps(v, alpha4))));
+    }
+#endif
+    for (; i < n; ++i) {
+        float v = x[i];
+        x[i] = (v > 0.0f) ? v : alpha * v;
+    }
+}
+
+/* Scales x[0..n) by k */
+static inline void
+MLC_KERNEL_(mlc_scale_span_)(float * x, size_t n, float k)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 k8 = _mm256_set1_ps(k);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), k8));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 k4 = _mm_set1_ps(k);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), k4));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] *= k;
+    }
+}
+
+/* Adds k to x[0..n) */
+static inline void
+MLC_KERNEL_(mlc_add_scalar_span_)(float * x, size_t n, float k)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 k8 = _mm256_set1_ps(k);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), k8));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 k4 = _mm_set1_ps(k);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), k4));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] += k;
+    }
+}
+
+/**********************************
+ * Backward spans (activations.h): g[i] *= f'(.) for i < n,
+ * where f' is read from the saved forward output y (or, for
+ * swish, the forward input x).
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_relu_backward_span_)(const float * y, float * g, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 zero8 = _mm256_setzero_ps();
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 positive = _mm256_cmp_ps(_mm256_loadu_ps(y + i), zero8, _CMP_GT_OQ);
+        _mm256_storeu_ps(g + i, _mm256_and_ps(positive, _mm256_loadu_ps(g + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 zero4 = _mm_setzero_ps();
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 positive = _mm_cmpgt_ps(_mm_loadu_ps(y + i), zero4);
+        _mm_storeu_ps(g + i, _mm_and_ps(positive, _mm_loadu_ps(g + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        g[i] = (y[i] > 0.0f) ? g[i] : 0.0f;
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_leaky_relu_backward_span_)(const float * y, float * g, size_t n, float alpha)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 zero8 = _mm256_setzero_ps();
+    const __m256 alpha8 = _mm256_set1_ps(alpha);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(g + i);
+        __m256 positive = _mm256_cmp_ps(_mm256_loadu_ps(y + i), zero8, _CMP_GT_OQ);
+        _mm256_storeu_ps(g + i, _mm256_blendv_ps(_mm256_mul_ps(v, alpha8), v, positive));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 zero4 = _mm_setzero_ps();
+    const __m128 alpha4 = _mm_set1_ps(alpha);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(g + i);
+        __m128 positive = _mm_cmpgt_ps(_mm_loadu_ps(y + i), zero4);
+        _mm_storeu_ps(g + i, _mm_or_ps(_mm_and_ps(positive, v),
+                                       _mm_andnot_ps(positive, _mm_mul_ps(v, alpha4))));
+    }
+#endif
+    for (; i < n; ++i) {
+        g[i] = (y[i] > 0.0f) ? g[i] : alpha * g[i];
+    }
+}
+
+/* g[i] *= y[i] * (1 - y[i]) */
+static inline void
+MLC_KERNEL_(mlc_sigmoid_backward_span_)(const float * y, float * g, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(y + i);
+        __m256 d = _mm256_mul_ps(v, _mm256_sub_ps(one8, v));
+        _mm256_storeu_ps(g + i, _mm256_mul_ps(_mm256_loadu_ps(g + i), d));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(y + i);
+        __m128 d = _mm_mul_ps(v, _mm_sub_ps(one4, v));
+        _mm_storeu_ps(g + i, _mm_mul_ps(_mm_loadu_ps(g + i), d));
+    }
+#endif
+    for (; i < n; ++i) {
+        g[i] *= y[i] * (1.0f - y[i]);
+    }
+}
+
+/* g[i] *= 1 - y[i]^2 */
+static inline void
+MLC_KERNEL_(mlc_tanh_backward_span_)(const float * y, float * g, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(y + i);
+        __m256 d = _mm256_sub_ps(one8, _mm256_mul_ps(v, v));
+        _mm256_storeu_ps(g + i, _mm256_mul_ps(_mm256_loadu_ps(g + i), d));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(y + i);
+        __m128 d = _mm_sub_ps(one4, _mm_mul_ps(v, v));
+        _mm_storeu_ps(g + i, _mm_mul_ps(_mm_loadu_ps(g + i), d));
+    }
+#endif
+    for (; i < n; ++i) {
+        g[i] *= 1.0f - y[i] * y[i];
+    }
+}
+
+/* g[i] *= s + x[i] * s * (1 - s), s = sigmoid(x[i]) */
+static inline void
+MLC_KERNEL_(mlc_swish_backward_span_)(const float * x, float * g, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_MATH_AVX2)
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 e = MLC_KERNEL_(mlc_exp256_)(_mm256_sub_ps(_mm256_setzero_ps(), v));
+        __m256 s = MLC_KERNEL_(mlc_recip256_)(_mm256_add_ps(one8, e));
+        __m256 d = _mm256_mul_ps(s, MLC_K_FMA256_(v, _mm256_sub_ps(one8, s), one8));
+        _mm256_storeu_ps(g + i, _mm256_mul_ps(_mm256_loadu_ps(g + i), d));
+    }
+#endif
+#if defined(MLC_K_MATH_SSE2)
+    const __m128 one4 = _mm_set1_ps(1.0f);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128 e = mlc_exp128_(_mm_sub_ps(_mm_setzero_ps(), v));
+        __m128 s = mlc_recip128_(_mm_add_ps(one4, e));
+        __m128 d = _mm_mul_ps(s, _mm_add_ps(_mm_mul_ps(v, _mm_sub_ps(one4, s)), one4));
+        _mm_storeu_ps(g + i, _mm_mul_ps(_mm_loadu_ps(g + i), d));
+    }
+#endif
+    for (; i < n; ++i) {
+        float s = 1.0f / (1.0f + mlc_expf_(-x[i]));
+        g[i] *= s * (1.0f + x[i] * (1.0f - s));
+    }
+}
+
+/* g[i] = y[i] * (g[i] - dot), dot = Σ y[j] * g[j] over the row */
+static inline void
+MLC_KERNEL_(mlc_softmax_backward_span_)(const float * y, float * g, size_t n, float dot)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 dot8 = _mm256_set1_ps(dot);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(g + i), dot8);
+        _mm256_storeu_ps(g + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), d));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 dot4 = _mm_set1_ps(dot);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(g + i), dot4);
+        _mm_storeu_ps(g + i, _mm_mul_ps(_mm_loadu_ps(y + i), d));
+    }
+#endif
+    for (; i < n; ++i) {
+        g[i] = y[i] * (g[i] - dot);
+    }
+}
+
+/**********************************
+ * Optimizer spans (optim.h): one fused pass over n parameters
+ * p, their gradients g and the optimizer moments. `keep` is the
+ * weight decay factor p *= keep (1 for none).
+ **********************************/
+
+/* p = keep * p - lr * g */
+static inline void
+MLC_KERNEL_(mlc_sgd_span_)(float * p, const float * g, size_t n, float lr, float keep)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 lr8 = _mm256_set1_ps(lr);
+    const __m256 keep8 = _mm256_set1_ps(keep);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 step = _mm256_mul_ps(lr8, _mm256_loadu_ps(g + i));
+        _mm256_storeu_ps(p + i, _mm256_sub_ps(_mm256_mul_ps(keep8, _mm256_loadu_ps(p + i)), step));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 lr4 = _mm_set1_ps(lr);
+    const __m128 keep4 = _mm_set1_ps(keep);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 step = _mm_mul_ps(lr4, _mm_loadu_ps(g + i));
+        _mm_storeu_ps(p + i, _mm_sub_ps(_mm_mul_ps(keep4, _mm_loadu_ps(p + i)), step));
+    }
+#endif
+    for (; i < n; ++i) {
+        p[i] = keep * p[i] - lr * g[i];
+    }
+}
+
+/* v = mu * v + g + decay * p;  p = p - lr * v */
+static inline void
+MLC_KERNEL_(mlc_momentum_span_)(float * p, const float * g, float * v, size_t n,
+                                float lr, float mu, float decay)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 lr8 = _mm256_set1_ps(lr);
+    const __m256 mu8 = _mm256_set1_ps(mu);
+    const __m256 decay8 = _mm256_set1_ps(decay);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 pv = _mm256_loadu_ps(p + i);
+        __m256 grad = MLC_K_FMA256_(decay8, pv, _mm256_loadu_ps(g + i));
+        __m256 vel = MLC_K_FMA256_(mu8, _mm256_loadu_ps(v + i), grad);
+        _mm256_storeu_ps(v + i, vel);
+        _mm256_storeu_ps(p + i, _mm256_sub_ps(pv, _mm256_mul_ps(lr8, vel)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 lr4 = _mm_set1_ps(lr);
+    const __m128 mu4 = _mm_set1_ps(mu);
+    const __m128 decay4 = _mm_set1_ps(decay);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 pv = _mm_loadu_ps(p + i);
+        __m128 grad = _mm_add_ps(_mm_mul_ps(decay4, pv), _mm_loadu_ps(g + i));
+        __m128 vel = _mm_add_ps(_mm_mul_ps(mu4, _mm_loadu_ps(v + i)), grad);
+        _mm_storeu_ps(v + i, vel);
+        _mm_storeu_ps(p + i, _mm_sub_ps(pv, _mm_mul_ps(lr4, vel)));
+    }
+#endif
+    for (; i < n; ++i) {
+        v[i] = mu * v[i] + (g[i] + decay * p[i]);
+        p[i] -= lr * v[i];
+    }
+}
+
+/**********************************
+ * m = b1 * m + (1 - b1) * g
+ * v = b2 * v + (1 - b2) * g^2
+ * p = keep * p - lr * m / (sqrt(v) + eps)
+ *
+ * with the bias corrections already folded into lr and eps.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_adam_span_)(float * p, const float * g, float * m, float * v, size_t n,
+                            float lr, float b1, float b2, float eps, float keep)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 lr8 = _mm256_set1_ps(lr);
+    const __m256 b18 = _mm256_set1_ps(b1), c18 = _mm256_set1_ps(1.0f - b1);
+    const __m256 b28 = _mm256_set1_ps(b2), c28 = _mm256_set1_ps(1.0f - b2);
+    const __m256 eps8 = _mm256_set1_ps(eps);
+    const __m256 keep8 = _mm256_set1_ps(keep);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 grad = _mm256_loadu_ps(g + i);
+        __m256 m1 = MLC_K_FMA256_(b18, _mm256_loadu_ps(m + i), _mm256_mul_ps(c18, grad));
+        __m256 m2 = MLC_K_FMA256_(b28, _mm256_loadu_ps(v + i),
+                                  _mm256_mul_ps(c28, _mm256_mul_ps(grad, grad)));
+        __m256 step = _mm256_div_ps(_mm256_mul_ps(lr8, m1), _mm256_add_ps(_mm256_sqrt_ps(m2), eps8));
+        _mm256_storeu_ps(m + i, m1);
+        _mm256_storeu_ps(v + i, m2);
+        _mm256_storeu_ps(p + i, _mm256_sub_ps(_mm256_mul_ps(keep8, _mm256_loadu_ps(p + i)), step));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 lr4 = _mm_set1_ps(lr);
+    const __m128 b14 = _mm_set1_ps(b1), c14 = _mm_set1_ps(1.0f - b1);
+    const __m128 b24 = _mm_set1_ps(b2), c24 = _mm_set1_ps(1.0f - b2);
+    const __m128 eps4 = _mm_set1_ps(eps);
+    const __m128 keep4 = _mm_set1_ps(keep);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 grad = _mm_loadu_ps(g + i);
+        __m128 m1 = _mm_add_ps(_mm_mul_ps(b14, _mm_loadu_ps(m + i)), _mm_mul_ps(c14, grad));
+        __m128 m2 = _mm_add_ps(_mm_mul_ps(b24, _mm_loadu_ps(v + i)),
+                               _mm_mul_ps(c24, _mm_mul_ps(grad, grad)));
+        __m128 step = _mm_div_ps(_mm_mul_ps(lr4, m1), _mm_add_ps(_mm_sqrt_ps(m2), eps4));
+        _mm_storeu_ps(m + i, m1);
+        _mm_storeu_ps(v + i, m2);
+        _mm_storeu_ps(p + i, _mm_sub_ps(_mm_mul_ps(keep4, _mm_loadu_ps(p + i)), step));
+    }
+#endif
+    for (; i < n; ++i) {
+        m[i] = b1 * m[i] + (1.0f - b1) * g[i];
+        v[i] = b2 * v[i] + (1.0f - b2) * (g[i] * g[i]);
+        p[i] = keep * p[i] - (lr * m[i]) / (sqrtf(v[i]) + eps);
+    }
+}
+
+/**********************************
+ * Vector spans (vector.h): out[i] = a[i] op b[i] for i < n
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_add_span_)(const float * a, const float * b, float * out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_sub_span_)(const float * a, const float * b, float * out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(out + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_scale_into_span_)(const float * a, float k, float * out, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 k8 = _mm256_set1_ps(k);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), k8));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 k4 = _mm_set1_ps(k);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), k4));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = k * a[i];
+    }
+}
+
+/* Returns Σ a[i] * b[i], accumulated in several independent lanes */
+static inline float
+MLC_KERNEL_(mlc_dot_span_)(const float * a, const float * b, size_t n)
+{
+    size_t i = 0;
+    float sum = 0.0f;
+
+#if defined(MLC_K_AVX2)
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    for (; i < (n & ~(size_t)15); i += 16) {
+        s0 = MLC_K_FMA256_(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+        s1 = MLC_K_FMA256_(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+    }
+    s0 = _mm256_add_ps(s0, s1);
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s0), _mm256_extractf128_ps(s0, 1));
+#elif defined(MLC_K_SSE2)
+    __m128 s4 = _mm_setzero_ps();
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        s4 = _mm_add_ps(s4, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, s4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**********************************
+ * Sparse spans (sparse.h)
+ **********************************/
+
+/* y[i] += a * x[i] for i < n: one nonzero times a dense row */
+static inline void
+MLC_KERNEL_(mlc_axpy_span_)(float a, const float * x, float * y, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256 a8 = _mm256_set1_ps(a);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        _mm256_storeu_ps(y + i, MLC_K_FMA256_(a8, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 a4 = _mm_set1_ps(a);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(a4, _mm_loadu_ps(x + i)), _mm_loadu_ps(y + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+/* Σ values[i] * x[indices[i]] for i < n: one sparse row times a dense vector */
+static inline float
+MLC_KERNEL_(mlc_sparse_dot_span_)(const float * values, const uint32_t * indices,
+                                  const float * x, size_t n)
+{
+    size_t i = 0;
+    float sum = 0.0f;
+
+#if defined(MLC_K_AVX2)
+    /* Indices are below 2^31 (sparse.h), so the signed gather is safe */
+    __m256 s0 = _mm256_setzero_ps();
+    __m256 s1 = _mm256_setzero_ps();
+    for (; i < (n & ~(size_t)15); i += 16) {
+        __m256i i0 = _mm256_loadu_si256((const __m256i *)(indices + i));
+        __m256i i1 = _mm256_loadu_si256((const __m256i *)(indices + i + 8));
+        s0 = MLC_K_FMA256_(_mm256_loadu_ps(values + i), _mm256_i32gather_ps(x, i0, 4), s0);
+        s1 = MLC_K_FMA256_(_mm256_loadu_ps(values + i + 8), _mm256_i32gather_ps(x, i1, 4), s1);
+    }
+    s0 = _mm256_add_ps(s0, s1);
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(s0), _mm256_extractf128_ps(s0, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, s4);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    /* Four independent sums hide the latency of the scattered loads */
+    float s[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; i < (n & ~(size_t)3); i += 4) {
+        s[0] += values[i] * x[indices[i]];
+        s[1] += values[i + 1] * x[indices[i + 1]];
+        s[2] += values[i + 2] * x[indices[i + 2]];
+        s[3] += values[i + 3] * x[indices[i + 3]];
+    }
+    sum += (s[0] + s[1]) + (s[2] + s[3]);
+    for (; i < n; ++i) {
+        sum += values[i] * x[indices[i]];
+    }
+    return sum;
+}
+
+/**********************************
+ * c[0..n) = Σ_k values[k] * b[indices[k] * ldb + 0..n): one
+ * sparse row times a dense matrix (SpMM). Blocks of c stay in
+ * registers across all the nonzeros of the row.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_spmm_row_)(const float * values, const uint32_t * indices, size_t count,
+                           const float * b, size_t ldb, float * c, size_t n)
+{
+    size_t j = 0;
+
+#if defined(MLC_K_AVX2)
+    for (; j + 32 <= n; j += 32) {
+        __m256 c0 = _mm256_setzero_ps(), c1 = _mm256_setzero_ps();
+        __m256 c2 = _mm256_setzero_ps(), c3 = _mm256_setzero_ps();
+
+        for (size_t k = 0; k < count; ++k) {
+            const float * row = b + (size_t)indices[k] * ldb + j;
+            __m256 v = _mm256_set1_ps(values[k]);
+
+            c0 = MLC_K_FMA256_(v, _mm256_loadu_ps(row), c0);
+            c1 = MLC_K_FMA256_(v, _mm256_loadu_ps(row + 8), c1);
+            c2 = MLC_K_FMA256_(v, _mm256_loadu_ps(row + 16), c2);
+            c3 = MLC_K_FMA256_(v, _mm256_loadu_ps(row + 24), c3);
+        }
+        _mm256_storeu_ps(c + j, c0);
+        _mm256_storeu_ps(c + j + 8, c1);
+        _mm256_storeu_ps(c + j + 16, c2);
+        _mm256_storeu_ps(c + j + 24, c3);
+    }
+    for (; j + 8 <= n; j += 8) {
+        __m256 c0 = _mm256_setzero_ps();
+
+        for (size_t k = 0; k < count; ++k) {
+            c0 = MLC_K_FMA256_(_mm256_set1_ps(values[k]),
+                               _mm256_loadu_ps(b + (size_t)indices[k] * ldb + j), c0);
+        }
+        _mm256_storeu_ps(c + j, c0);
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; j + 16 <= n; j += 16) {
+        __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps();
+        __m128 c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+
+        for (size_t k = 0; k < count; ++k) {
+            const float * row = b + (size_t)indices[k] * ldb + j;
+            __m128 v = _mm_set1_ps(values[k]);
+
+            c0 = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(row)), c0);
+            c1 = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(row + 4)), c1);
+            c2 = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(row + 8)), c2);
+            c3 = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(row + 12)), c3);
+        }
+        _mm_storeu_ps(c + j, c0);
+        _mm_storeu_ps(c + j + 4, c1);
+        _mm_storeu_ps(c + j + 8, c2);
+        _mm_storeu_ps(c + j + 12, c3);
+    }
+    for (; j + 4 <= n; j += 4) {
+        __m128 c0 = _mm_setzero_ps();
+
+        for (size_t k = 0; k < count; ++k) {
+            c0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(values[k]),
+                                       _mm_loadu_ps(b + (size_t)indices[k] * ldb + j)), c0);
+        }
+        _mm_storeu_ps(c + j, c0);
+    }
+#endif
+    if (j < n) {
+        memset(c + j, 0, (n - j) * sizeof(float));
+        for (size_t k = 0; k < count; ++k) {
+            const float * row = b + (size_t)indices[k] * ldb;
+
+            for (size_t i = j; i < n; ++i) {
+                c[i] += values[k] * row[i];
+            }
+        }
+    }
+}
+
+/**********************************
+ * Column statistics (stats.h): one Welford step for a row of n
+ * columns, with inv_count = 1 / (rows seen, this one included):
+ *
+ *   d = x - mean,  mean += d * inv_count,  m2 += d * (x - mean)
+ *
+ * and the running min / max. Moments are kept in double.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_welford_row_)(const float * x, double * mean, double * m2,
+                              float * lo, float * hi, size_t n, double inv_count)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    const __m256d inv4 = _mm256_set1_pd(inv_count);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m256d xd = _mm256_cvtps_pd(v);
+        __m256d mu = _mm256_loadu_pd(mean + i);
+        __m256d d = _mm256_sub_pd(xd, mu);
+
+        mu = _mm256_add_pd(mu, _mm256_mul_pd(d, inv4));
+        _mm256_storeu_pd(mean + i, mu);
+        _mm256_storeu_pd(m2 + i, _mm256_add_pd(_mm256_loadu_pd(m2 + i),
+                                               _mm256_mul_pd(d, _mm256_sub_pd(xd, mu))));
+        _mm_storeu_ps(lo + i, _mm_min_ps(v, _mm_loadu_ps(lo + i)));
+        _mm_storeu_ps(hi + i, _mm_max_ps(v, _mm_loadu_ps(hi + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128d inv2 = _mm_set1_pd(inv_count);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        __m128d xd[2] = {_mm_cvtps_pd(v), _mm_cvtps_pd(_mm_movehl_ps(v, v))};
+
+        for (size_t h = 0; h < 2; ++h) {
+            __m128d mu = _mm_loadu_pd(mean + i + 2 * h);
+            __m128d d = _mm_sub_pd(xd[h], mu);
+
+            mu = _mm_add_pd(mu, _mm_mul_pd(d, inv2));
+            _mm_storeu_pd(mean + i + 2 * h, mu);
+            _mm_storeu_pd(m2 + i + 2 * h, _mm_add_pd(_mm_loadu_pd(m2 + i + 2 * h),
+                                                     _mm_mul_pd(d, _mm_sub_pd(xd[h], mu))));
+        }
+        _mm_storeu_ps(lo + i, _mm_min_ps(v, _mm_loadu_ps(lo + i)));
+        _mm_storeu_ps(hi + i, _mm_max_ps(v, _mm_loadu_ps(hi + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        double d = (double)x[i] - mean[i];
+
+        mean[i] += d * inv_count;
+        m2[i] += d * ((double)x[i] - mean[i]);
+        lo[i] = (x[i] < lo[i]) ? x[i] : lo[i];
+        hi[i] = (x[i] > hi[i]) ? x[i] : hi[i];
+    }
+}
+
+/* x[i] = (x[i] - shift[i]) * scale[i]: per-column affine transform of one row */
+static inline void
+MLC_KERNEL_(mlc_affine_row_)(float * x, const float * shift, const float * scale, size_t n)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(shift + i));
+        _mm256_storeu_ps(x + i, _mm256_mul_ps(d, _mm256_loadu_ps(scale + i)));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(shift + i));
+        _mm_storeu_ps(x + i, _mm_mul_ps(d, _mm_loadu_ps(scale + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = (x[i] - shift[i]) * scale[i];
+    }
+}
+
+/**********************************
+ * Direct convolution (conv.h): a run of `count` outputs of
+ * one output row for a block of 8 output channels,
+ *
+ *   out[q * 8 + l] = Σ_t in[offsets[t] + q * step] * w[t * 8 + l]
+ *
+ * over the taps t (input channel, kernel row, kernel column)
+ * of the packed weights w. Eight outputs share each weight
+ * load, their sums stay in registers across all the taps.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_conv_direct_row_)(const float * in, size_t step, const size_t * offsets,
+                                  const float * w, size_t taps, float * out, size_t count)
+{
+    size_t q = 0;
+
+#if defined(MLC_K_AVX2)
+    for (; q + 8 <= count; q += 8) {
+        const float * x = in + q * step;
+        __m256 acc[8];
+
+        for (size_t j = 0; j < 8; ++j) acc[j] = _mm256_setzero_ps();
+        for (size_t t = 0; t < taps; ++t) {
+            const __m256 wv = _mm256_loadu_ps(w + t * 8);
+            const float * p = x + offsets[t];
+
+            for (size_t j = 0; j < 8; ++j) {
+                acc[j] = MLC_K_FMA256_(_mm256_broadcast_ss(p + j * step), wv, acc[j]);
+            }
+        }
+        for (size_t j = 0; j < 8; ++j) _mm256_storeu_ps(out + (q + j) * 8, acc[j]);
+    }
+    for (; q < count; ++q) {
+        const float * x = in + q * step;
+        __m256 acc = _mm256_setzero_ps();
+
+        for (size_t t = 0; t < taps; ++t) {
+            acc = MLC_K_FMA256_(_mm256_broadcast_ss(x + offsets[t]), _mm256_loadu_ps(w + t * 8), acc);
+        }
+        _mm256_storeu_ps(out + q * 8, acc);
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; q + 4 <= count; q += 4) {
+        const float * x = in + q * step;
+        __m128 lo[4], hi[4];
+
+        for (size_t j = 0; j < 4; ++j) lo[j] = hi[j] = _mm_setzero_ps();
+        for (size_t t = 0; t < taps; ++t) {
+            const __m128 w0 = _mm_loadu_ps(w + t * 8);
+            const __m128 w1 = _mm_loadu_ps(w + t * 8 + 4);
+            const float * p = x + offsets[t];
+
+            for (size_t j = 0; j < 4; ++j) {
+                __m128 v = _mm_set1_ps(p[j * step]);
+                lo[j] = _mm_add_ps(lo[j], _mm_mul_ps(v, w0));
+                hi[j] = _mm_add_ps(hi[j], _mm_mul_ps(v, w1));
+            }
+        }
+        for (size_t j = 0; j < 4; ++j) {
+            _mm_storeu_ps(out + (q + j) * 8, lo[j]);
+            _mm_storeu_ps(out + (q + j) * 8 + 4, hi[j]);
+        }
+    }
+#endif
+    for (; q < count; ++q) {
+        const float * x = in + q * step;
+        float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+        for (size_t t = 0; t < taps; ++t) {
+            float v = x[offsets[t]];
+            for (size_t l = 0; l < 8; ++l) acc[l] += v * w[t * 8 + l];
+        }
+        memcpy(out + q * 8, acc, sizeof(acc));
+    }
+}
+
+/**********************************
+ * Index of the first smallest of x[0 .. n), n >= 1, stored in
+ * *min (kmeans.h: the nearest centroid of a row of distances).
+ * Two passes over the (cached) span: a vector min with two
+ * independent chains, then a compare/movemask scan for its
+ * first occurrence. NaNs are skipped unless x[0] is one.
+ **********************************/
+static inline size_t
+MLC_KERNEL_(mlc_argmin_span_)(const float * x, size_t n, float * min)
+{
+    size_t i = 0;
+    float best = x[0];
+
+#if defined(MLC_K_AVX2)
+    __m256 m0 = _mm256_set1_ps(best);
+    __m256 m1 = m0;
+    for (; i < (n & ~(size_t)15); i += 16) {
+        m0 = _mm256_min_ps(_mm256_loadu_ps(x + i), m0);
+        m1 = _mm256_min_ps(_mm256_loadu_ps(x + i + 8), m1);
+    }
+    m0 = _mm256_min_ps(m0, m1);
+    __m128 m4 = _mm_min_ps(_mm256_castps256_ps128(m0), _mm256_extractf128_ps(m0, 1));
+#elif defined(MLC_K_SSE2)
+    __m128 m4 = _mm_set1_ps(best);
+    __m128 m5 = m4;
+    for (; i < (n & ~(size_t)7); i += 8) {
+        m4 = _mm_min_ps(_mm_loadu_ps(x + i), m4);
+        m5 = _mm_min_ps(_mm_loadu_ps(x + i + 4), m5);
+    }
+    m4 = _mm_min_ps(m4, m5);
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        m4 = _mm_min_ps(_mm_loadu_ps(x + i), m4);
+    }
+    m4 = _mm_min_ps(m4, _mm_shuffle_ps(m4, m4, _MM_SHUFFLE(1, 0, 3, 2)));
+    m4 = _mm_min_ps(m4, _mm_shuffle_ps(m4, m4, _MM_SHUFFLE(2, 3, 0, 1)));
+    best = _mm_cvtss_f32(m4);
+#endif
+    for (; i < n; ++i) {
+        best = (x[i] < best) ? x[i] : best;
+    }
+    *min = best;
+
+    i = 0;
+#if defined(MLC_K_AVX2)
+    const __m256 b8 = _mm256_set1_ps(best);
+    for (; i < (n & ~(size_t)7); i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + i), b8, _CMP_EQ_OQ));
+        if (mask != 0) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    const __m128 b4 = _mm_set1_ps(best);
+    for (; i < (n & ~(size_t)3); i += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(x + i), b4));
+        if (mask != 0) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+    for (; i < n; ++i) {
+        if (x[i] == best) return i;
+    }
+    return 0;   /* x[0] is NaN */
+}
+
+/**********************************
+ * Conversion spans (data.h): n int32 or double values at `in`
+ * to floats at `out`. The packed conversions (8 values per
+ * AVX2 instruction, 4 with SSE2) round to nearest exactly like
+ * the scalar casts of the tail; all levels give the same
+ * results.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_convert_int_span_)(const int * in, float * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(v));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_ps(out + i, _mm_cvtepi32_ps(v));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = (float)in[i];
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_convert_double_span_)(const double * in, float * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(in + i));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(in + i + 4));
+        _mm256_storeu_ps(out + i, _mm256_set_m128(hi, lo));
+    }
+#endif
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)3); i += 4) {
+        __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+        __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = (float)in[i];
+    }
+}
+
+/**********************************
+ * fp16/bf16 conversion spans (half.h): n values from `in` to
+ * `out`. F16C when available, SSE2 integer arithmetic
+ * otherwise; all levels give the same results.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_f16_to_f32_span_)(const uint16_t * in, float * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_F16C)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#elif defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i zero = _mm_setzero_si128();
+        _mm_storeu_ps(out + i, mlc_f16x4_to_f32_(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(out + i + 4, mlc_f16x4_to_f32_(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = mlc_f16_to_f32(in[i]);
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_f32_to_f16_span_)(const float * in, uint16_t * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_F16C)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(out + i), h);
+    }
+#elif defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i lo = mlc_f32x4_to_f16_(_mm_loadu_ps(in + i));
+        __m128i hi = mlc_f32x4_to_f16_(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = mlc_f32_to_f16(in[i]);
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_bf16_to_f32_span_)(const uint16_t * in, float * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_AVX2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m256i h = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_castsi256_ps(_mm256_slli_epi32(h, 16)));
+    }
+#elif defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i zero = _mm_setzero_si128();
+        _mm_storeu_ps(out + i, _mm_castsi128_ps(_mm_unpacklo_epi16(zero, h)));
+        _mm_storeu_ps(out + i + 4, _mm_castsi128_ps(_mm_unpackhi_epi16(zero, h)));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = mlc_bf16_to_f32(in[i]);
+    }
+}
+
+static inline void
+MLC_KERNEL_(mlc_f32_to_bf16_span_)(const float * in, uint16_t * out, size_t n)
+{
+    size_t i = 0;
+#if defined(MLC_K_SSE2)
+    for (; i < (n & ~(size_t)7); i += 8) {
+        __m128i lo = mlc_f32x4_to_bf16_(_mm_loadu_ps(in + i));
+        __m128i hi = mlc_f32x4_to_bf16_(_mm_loadu_ps(in + i + 4));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = mlc_f32_to_bf16(in[i]);
+    }
+}
+
+/**********************************
+ * Int8 dot product (quant.h): Σ a[i] * b[i] over values in
+ * [-127, 127], int32 lanes per MLC_QUANT_BLOCK values.
+ **********************************/
+static inline int64_t
+MLC_KERNEL_(mlc_dot_i8_span_)(const int8_t * a, const int8_t * b, size_t n)
+{
+    int64_t total = 0;
+    size_t i = 0;
+
+    while (i < n) {
+        size_t end = (n - i > MLC_QUANT_BLOCK) ? i + MLC_QUANT_BLOCK : n;
+        int32_t sum = 0;
+
+#if defined(MLC_K_AVX2)
+        __m256i acc = _mm256_setzero_si256();
+        size_t end32 = i + ((end - i) & ~(size_t)31);
+
+        for (; i < end32; i += 32) {
+            __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+            /* |a| (unsigned) times b with a's sign: vpmaddubsw operand order */
+            __m256i ua = _mm256_abs_epi8(va);
+            __m256i sb = _mm256_sign_epi8(vb, va);
+#if defined(__AVXVNNI__)
+            acc = _mm256_dpbusd_avx_epi32(acc, ua, sb);
+#elif MLC_KERNEL_LEVEL >= 3 && defined(__AVX512VNNI__) && defined(__AVX512VL__)
+            acc = _mm256_dpbusd_epi32(acc, ua, sb);
+#else
+            __m256i pairs = _mm256_maddubs_epi16(ua, sb);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+#endif
+        }
+        __m128i acc4 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+#elif defined(MLC_K_SSE2)
+        __m128i acc4 = _mm_setzero_si128();
+#endif
+#if defined(MLC_K_SSE2)
+        size_t end16 = i + ((end - i) & ~(size_t)15);
+
+        for (; i < end16; i += 16) {
+            __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+            __m128i zero = _mm_setzero_si128();
+            __m128i sa = _mm_cmpgt_epi8(zero, va);
+            __m128i sb = _mm_cmpgt_epi8(zero, vb);
+
+            acc4 = _mm_add_epi32(acc4, _mm_madd_epi16(_mm_unpacklo_epi8(va, sa),
+                                                      _mm_unpacklo_epi8(vb, sb)));
+            acc4 = _mm_add_epi32(acc4, _mm_madd_epi16(_mm_unpackhi_epi8(va, sa),
+                                                      _mm_unpackhi_epi8(vb, sb)));
+        }
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc4);
+        sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+        for (; i < end; ++i) {
+            sum += (int32_t)a[i] * (int32_t)b[i];
+        }
+        total += sum;
+    }
+    return total;
+}
+
+/**********************************
+ * GEMM micro-kernel (matrix.h): computes the full MR x NR tile
+ *
+ * tile = Σ_p a[p][0..MR) ⊗ b[p][0..NR)
+ *
+ * into `tile` (row stride NR). `a` and `b` are packed panels.
+ * A 6x16 FMA kernel with AVX2 + FMA, otherwise a portable C
+ * kernel with the same packing.
+ **********************************/
+#if defined(MLC_K_FMA)
+static inline void
+MLC_KERNEL_(mlc_gemm_micro_kernel_)(size_t kc, const float * a, const float * b, float * tile)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (size_t p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+        __m256 ai;
+
+        ai = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+
+        a += MLC_GEMM_MR;
+        b += MLC_GEMM_NR;
+    }
+    _mm256_storeu_ps(tile + 0 * 16, c00); _mm256_storeu_ps(tile + 0 * 16 + 8, c01);
+    _mm256_storeu_ps(tile + 1 * 16, c10); _mm256_storeu_ps(tile + 1 * 16 + 8, c11);
+    _mm256_storeu_ps(tile + 2 * 16, c20); _mm256_storeu_ps(tile + 2 * 16 + 8, c21);
+    _mm256_storeu_ps(tile + 3 * 16, c30); _mm256_storeu_ps(tile + 3 * 16 + 8, c31);
+    _mm256_storeu_ps(tile + 4 * 16, c40); _mm256_storeu_ps(tile + 4 * 16 + 8, c41);
+    _mm256_storeu_ps(tile + 5 * 16, c50); _mm256_storeu_ps(tile + 5 * 16 + 8, c51);
+}
+#else
+static inline void
+MLC_KERNEL_(mlc_gemm_micro_kernel_)(size_t kc, const float * a, const float * b, float * tile)
+{
+    float acc[MLC_GEMM_MR][MLC_GEMM_NR] = {{0.0f}};
+
+    for (size_t p = 0; p < kc; ++p) {
+        for (size_t r = 0; r < MLC_GEMM_MR; ++r) {
+            float ar = a[r];
+            for (size_t c = 0; c < MLC_GEMM_NR; ++c) {
+                acc[r][c] += ar * b[c];
+            }
+        }
+        a += MLC_GEMM_MR;
+        b += MLC_GEMM_NR;
+    }
+    memcpy(tile, acc, sizeof(acc));
+}
+#endif
+
+/**********************************
+ * GEMM row kernel (matrix.h): one row of the tile,
+ *
+ * out[0..NR) = Σ_p a[p * MR] * b[p][0..NR)
+ *
+ * for the edge tiles of matrices with fewer than MR rows left
+ * (a batch of one), where the full micro-kernel would spend
+ * most of its FMAs on zero padding.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_gemm_row_kernel_)(size_t kc, const float * a, const float * b, float * out)
+{
+#if defined(MLC_K_FMA)
+    /* Two steps of p per pass, so four independent FMA chains */
+    __m256 c0 = _mm256_setzero_ps(), c1 = _mm256_setzero_ps();
+    __m256 d0 = _mm256_setzero_ps(), d1 = _mm256_setzero_ps();
+    size_t p = 0;
+
+    for (; p + 1 < kc; p += 2) {
+        __m256 a0 = _mm256_broadcast_ss(a);
+        __m256 a1 = _mm256_broadcast_ss(a + MLC_GEMM_MR);
+        c0 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(b), c0);
+        c1 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(b + 8), c1);
+        d0 = _mm256_fmadd_ps(a1, _mm256_loadu_ps(b + MLC_GEMM_NR), d0);
+        d1 = _mm256_fmadd_ps(a1, _mm256_loadu_ps(b + MLC_GEMM_NR + 8), d1);
+        a += 2 * MLC_GEMM_MR;
+        b += 2 * MLC_GEMM_NR;
+    }
+    if (p < kc) {
+        __m256 a0 = _mm256_broadcast_ss(a);
+        c0 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(b), c0);
+        c1 = _mm256_fmadd_ps(a0, _mm256_loadu_ps(b + 8), c1);
+    }
+    _mm256_storeu_ps(out, _mm256_add_ps(c0, d0));
+    _mm256_storeu_ps(out + 8, _mm256_add_ps(c1, d1));
+#else
+    float acc[MLC_GEMM_NR] = {0.0f};
+
+    for (size_t p = 0; p < kc; ++p) {
+        float ap = a[p * MLC_GEMM_MR];
+        for (size_t c = 0; c < MLC_GEMM_NR; ++c) {
+            acc[c] += ap * b[c];
+        }
+        b += MLC_GEMM_NR;
+    }
+    memcpy(out, acc, sizeof(acc));
+#endif
+}
+
+/**********************************
+ * Matrix-vector rows (matrix.h): out[i] = Σ_j m[i][j] * x[j]
+ * for i < rows, with row stride ld. With AVX2 + FMA, four rows
+ * are processed per pass so each load of x is reused four times.
+ **********************************/
+static inline void
+MLC_KERNEL_(mlc_gemv_rows_)(size_t rows, size_t cols, const float * base, size_t ld,
+                            const float * x, float * result)
+{
+    size_t i = 0;
+
+#if defined(MLC_K_FMA)
+    for (; i < (rows & ~(size_t)3); i += 4) {
+        const float * r0 = base + (i + 0) * ld;
+        const float * r1 = base + (i + 1) * ld;
+        const float * r2 = base + (i + 2) * ld;
+        const float * r3 = base + (i + 3) * ld;
+        __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+        size_t j = 0;
+
+        for (; j < (cols & ~(size_t)7); j += 8) {
+            __m256 xv = _mm256_loadu_ps(x + j);
+            s0 = _mm256_fmadd_ps(_mm256_loadu_ps(r0 + j), xv, s0);
+            s1 = _mm256_fmadd_ps(_mm256_loadu_ps(r1 + j), xv, s1);
+            s2 = _mm256_fmadd_ps(_mm256_loadu_ps(r2 + j), xv, s2);
+            s3 = _mm256_fmadd_ps(_mm256_loadu_ps(r3 + j), xv, s3);
+        }
+        /* Horizontal reduction of the four accumulators at once */
+        __m256 t01 = _mm256_hadd_ps(s0, s1);
+        __m256 t23 = _mm256_hadd_ps(s2, s3);
+        __m256 t = _mm256_hadd_ps(t01, t23);
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(t), _mm256_extractf128_ps(t, 1));
+        float out[4];
+        _mm_storeu_ps(out, sum);
+
+        for (; j < cols; ++j) {
+            out[0] += r0[j] * x[j];
+            out[1] += r1[j] * x[j];
+            out[2] += r2[j] * x[j];
+            out[3] += r3[j] * x[j];
+        }
+        result[i + 0] = out[0];
+        result[i + 1] = out[1];
+        result[i + 2] = out[2];
+        result[i + 3] = out[3];
+    }
+#endif
+
+    for (; i < rows; ++i) {
+        const float * row = base + i * ld;
+        float acc[8] = {0.0f};
+        size_t j = 0;
+
+        /* Eight independent partial sums keep the loop vectorizable */
+        for (; j < (cols & ~(size_t)7); j += 8) {
+            for (size_t l = 0; l < 8; ++l) {
+                acc[l] += row[j + l] * x[j + l];
+            }
+        }
+        float sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) +
+                    ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+        for (; j < cols; ++j) {
+            sum += row[j] * x[j];
+        }
+        result[i] = sum;
+    }
+}
+
+/* The kernel table of this level */
+static const MlcKernels MLC_KERNEL_(mlc_kernels_) = {
+    (MlcCpuLevel)MLC_KERNEL_LEVEL,
+    MLC_KERNEL_(mlc_relu_span_),
+    MLC_KERNEL_(mlc_leaky_relu_span_),
+    MLC_KERNEL_(mlc_scale_span_),
+    MLC_KERNEL_(mlc_add_scalar_span_),
+    MLC_KERNEL_(mlc_relu_backward_span_),
+    MLC_KERNEL_(mlc_leaky_relu_backward_span_),
+    MLC_KERNEL_(mlc_sigmoid_backward_span_),
+    MLC_KERNEL_(mlc_tanh_backward_span_),
+    MLC_KERNEL_(mlc_swish_backward_span_),
+    MLC_KERNEL_(mlc_softmax_backward_span_),
+    MLC_KERNEL_(mlc_sigmoid_span_),
+    MLC_KERNEL_(mlc_tanh_span_),
+    MLC_KERNEL_(mlc_swish_span_),
+    MLC_KERNEL_(mlc_exp_sum_span_),
+    MLC_KERNEL_(mlc_sgd_span_),
+    MLC_KERNEL_(mlc_momentum_span_),
+    MLC_KERNEL_(mlc_adam_span_),
+    MLC_KERNEL_(mlc_add_span_),
+    MLC_KERNEL_(mlc_sub_span_),
+    MLC_KERNEL_(mlc_scale_into_span_),
+    MLC_KERNEL_(mlc_dot_span_),
+    MLC_KERNEL_(mlc_axpy_span_),
+    MLC_KERNEL_(mlc_sparse_dot_span_),
+    MLC_KERNEL_(mlc_spmm_row_),
+    MLC_KERNEL_(mlc_welford_row_),
+    MLC_KERNEL_(mlc_affine_row_),
+    MLC_KERNEL_(mlc_conv_direct_row_),
+    MLC_KERNEL_(mlc_argmin_span_),
+    MLC_KERNEL_(mlc_convert_int_span_),
+    MLC_KERNEL_(mlc_convert_double_span_),
+    MLC_KERNEL_(mlc_f16_to_f32_span_),
+    MLC_KERNEL_(mlc_f32_to_f16_span_),
+    MLC_KERNEL_(mlc_bf16_to_f32_span_),
+    MLC_KERNEL_(mlc_f32_to_bf16_span_),
+    MLC_KERNEL_(mlc_dot_i8_span_),
+    MLC_KERNEL_(mlc_gemm_micro_kernel_),
+    MLC_KERNEL_(mlc_gemm_row_kernel_),
+    MLC_KERNEL_(mlc_gemv_rows_)
+};
+
+#undef MLC_K_SSE2
+#undef MLC_K_AVX2
+#undef MLC_K_FMA
+#undef MLC_K_FMA256_
+#undef MLC_K_F16C
+#undef MLC_K_MATH_AVX2
+#undef MLC_K_MATH_SSE2
@@ -0,0 +1,511 @@
+/* include/mlc/kmeans.h */
+
+#ifndef MLC_KMEANS_H
+#define MLC_KMEANS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <mlc/data.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/matrix.h>
+#include <mlc/sampler.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * k-means clustering of the rows of a (rows x cols) MlcArray:
+ * k-means++ seeding followed by Lloyd iterations.
+ *
+ * All row-centroid distances of a block of rows come from one
+ * GEMM (matrix.h) through
+ *
+ *   ||x - c||^2 = ||x||^2 - 2 x.c + ||c||^2
+ *
+ * The centroids are packed once per iteration as -2 C^T, with
+ * ||c||^2 added by the GEMM epilogue; ||x||^2 is computed once
+ * per fit. The nearest centroid of each row is then found by
+ * mlc_argmin_span_() (kernels.h) on the cache-resident block of
+ * distances. Blocks of rows are split across the thread pool;
+ * each thread adds its rows into its own per-cluster sums and
+ * counts, merged once per iteration, so the assignment pass
+ * stays compute-bound with no shared writes.
+ *
+ * Seeding draws each new centroid with probability proportional
+ * to the squared distance to the nearest centroid chosen so far
+ * (one GEMV pass over the data per centroid). Per-block sums of
+ * those distances keep the draw itself from being a serial scan
+ * of all rows.
+ *
+ * Iterations stop when no label changes, when the inertia
+ * improves by less than `tol` (relative), or after `max_iter`.
+ * A cluster that loses all its rows keeps its previous
+ * centroid. Distances are fp32: for data far from the origin,
+ * centre it first (stats.h) to keep the expansion accurate.
+ *
+ * Functions return -1 on invalid input or allocation failure
+ * and 0 on success.
+ *************************************************************/
+
+#ifndef MLC_KMEANS_TILE_BYTES
+    #define MLC_KMEANS_TILE_BYTES (64u << 10)  /* distance block per thread */
+#endif
+#define MLC_KMEANS_SEED_ROWS 1024               /* rows per seeding block */
+
+typedef struct
+{
+    size_t clusters;
+    size_t max_iter;
+    double tol;                 /* relative inertia improvement to continue */
+    uint64_t seed;
+}
+MlcKMeansOptions;
+
+typedef struct
+{
+    MlcArray centroids;         /* (clusters x cols) */
+    size_t * labels;            /* cluster of each row */
+    size_t rows;
+    double inertia;             /* Σ squared distance to the assigned centroid */
+    size_t iterations;
+}
+MlcKMeans;
+
+static inline MlcKMeansOptions
+mlc_kmeans_options(size_t clusters)
+{
+    MlcKMeansOptions options = {clusters, 100, 1e-4, 0};
+    return options;
+}
+
+static inline void
+mlc_kmeans_finish(MlcKMeans * model)
+{
+    if (model == NULL) return;
+    mlc_finish(&model->centroids);
+    free(model->labels);
+    model->labels = NULL;
+    model->rows = 0;
+}
+
+typedef struct
+{
+    const float * x;
+    size_t ld, rows, cols, clusters;
+    float * norms;              /* ||x||^2 per row */
+    float * cnorms;             /* ||c||^2 per centroid */
+    float * packed;             /* -2 C^T, mlc_gemm_pack() layout */
+    size_t block;               /* rows per assignment item */
+    float * scratch;            /* per part: distances and GEMM workspace */
+    size_t scratch_floats;
+    size_t * labels;
+
+    /* Fitting only: per-part cluster sums and counts */
+    double * sums;
+    size_t * counts;
+    double inertia[MLC_MAX_THREADS];
+    size_t changed[MLC_MAX_THREADS];
+
+    /* Seeding only */
+    const float * seed;         /* newest centroid */
+    float seed_norm;
+    float * d2;                 /* squared distance to the nearest centroid */
+    double * block_d2;          /* Σ d2 per MLC_KMEANS_SEED_ROWS block */
+}
+MlcKMeansJob_;
+
+static inline void
+mlc_kmeans_norms_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcKMeansJob_ * job = (const MlcKMeansJob_ *)ctx;
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        const float * row = job->x + r * job->ld;
+        job->norms[r] = mlc_dot_span_(row, row, job->cols);
+    }
+}
+
+/* Packs -2 C^T and ||c||^2 for the next assignment pass */
+static inline void
+mlc_kmeans_prepare_(MlcKMeansJob_ * job, const float * centroids)
+{
+    size_t k = job->clusters, cols = job->cols;
+    float * transposed = job->scratch;      /* free between passes */
+
+    for (size_t j = 0; j < k; ++j) {
+        const float * c = centroids + j * cols;
+
+        job->cnorms[j] = mlc_dot_span_(c, c, cols);
+        for (size_t i = 0; i < cols; ++i) transposed[i * k + j] = -2.0f * c[i];
+    }
+    mlc_gemm_pack(cols, k, transposed, k, job->packed);
+}
+
+static inline void
+mlc_kmeans_assign_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcKMeansJob_ * job = (MlcKMeansJob_ *)ctx;
+    size_t k = job->clusters, cols = job->cols;
+    float * dist = job->scratch + part * job->scratch_floats;
+    float * workspace = dist + mlc_gemm_round_up_(job->block * k, 16);
+    double * sums = job->sums ? job->sums + part * k * cols : NULL;
+    size_t * counts = job->counts ? job->counts + part * k : NULL;
+    MlcGemmEpilogue epilogue = {job->cnorms, MLC_ACT_NONE, 0.0f};
+    double inertia = 0.0;
+    size_t changed = 0;
+
+    for (size_t item = begin; item < end; ++item) {
+        size_t r0 = item * job->block;
+        size_t count = (job->rows - r0 < job->block) ? job->rows - r0 : job->block;
+        const float * x = job->x + r0 * job->ld;
+
+        /* dist[i][j] = ||c_j||^2 - 2 x_i.c_j */
+        mlc_sgemm_packed(count, k, cols, x, job->ld, job->packed, dist, k, workspace, &epilogue);
+
+        for (size_t i = 0; i < count; ++i) {
+            float nearest;
+            size_t j = mlc_argmin_span_(dist + i * k, k, &nearest);
+            float d = job->norms[r0 + i] + nearest;
+
+            inertia += (d > 0.0f) ? d : 0.0f;
+            if (sums != NULL) {
+                const float * row = x + i * job->ld;
+                double * sum = sums + j * cols;
+
+                changed += (job->labels[r0 + i] != j);
+                counts[j]++;
+                for (size_t c = 0; c < cols; ++c) sum[c] += row[c];
+            }
+            job->labels[r0 + i] = j;
+        }
+    }
+    job->inertia[part] = inertia;
+    job->changed[part] = changed;
+}
+
+/* One assignment pass; returns the inertia, *changed labels when fitting */
+static inline double
+mlc_kmeans_assign_(MlcKMeansJob_ * job, const float * centroids, size_t * changed)
+{
+    size_t items = (job->rows + job->block - 1) / job->block;
+    size_t parts = mlc_get_num_threads();
+    double inertia = 0.0;
+
+    mlc_kmeans_prepare_(job, centroids);
+    memset(job->inertia, 0, sizeof(job->inertia));
+    memset(job->changed, 0, sizeof(job->changed));
+    if (job->sums != NULL) {
+        memset(job->sums, 0, parts * job->clusters * job->cols * sizeof(double));
+        memset(job->counts, 0, parts * job->clusters * sizeof(size_t));
+    }
+    mlc_parallel_for(items, 1, mlc_kmeans_assign_range_, job);
+
+    if (changed != NULL) *changed = 0;
+    for (size_t p = 0; p < parts; ++p) {
+        inertia += job->inertia[p];
+        if (changed != NULL) *changed += job->changed[p];
+    }
+    return inertia;
+}
+
+/* New centroids from the per-part sums; empty clusters keep theirs */
+static inline void
+mlc_kmeans_update_(const MlcKMeansJob_ * job, float * centroids)
+{
+    size_t k = job->clusters, cols = job->cols;
+    size_t parts = mlc_get_num_threads();
+
+    for (size_t j = 0; j < k; ++j) {
+        size_t count = 0;
+
+        for (size_t p = 0; p < parts; ++p) count += job->counts[p * k + j];
+        if (count == 0) continue;
+
+        for (size_t c = 0; c < cols; ++c) {
+            double sum = 0.0;
+
+            for (size_t p = 0; p < parts; ++p) sum += job->sums[(p * k + j) * cols + c];
+            centroids[j * cols + c] = (float)(sum / (double)count);
+        }
+    }
+}
+
+/**********************************
+ * k-means++ seeding
+ **********************************/
+static inline void
+mlc_kmeans_seed_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcKMeansJob_ * job = (const MlcKMeansJob_ *)ctx;
+    float * dots = job->scratch + part * job->scratch_floats;
+
+    for (size_t item = begin; item < end; ++item) {
+        size_t r0 = item * MLC_KMEANS_SEED_ROWS;
+        size_t count = (job->rows - r0 < MLC_KMEANS_SEED_ROWS) ? job->rows - r0 : MLC_KMEANS_SEED_ROWS;
+        double sum = 0.0;
+
+        mlc_gemv_rows_(count, job->cols, job->x + r0 * job->ld, job->ld, job->seed, dots);
+        for (size_t i = 0; i < count; ++i) {
+            float d = job->norms[r0 + i] + job->seed_norm - 2.0f * dots[i];
+            float * nearest = &job->d2[r0 + i];
+
+            d = (d > 0.0f) ? d : 0.0f;
+            if (d < *nearest) *nearest = d;
+            sum += *nearest;
+        }
+        job->block_d2[item] = sum;
+    }
+}
+
+/* Row drawn with probability d2[row] / Σ d2: first the block, then the row */
+static inline size_t
+mlc_kmeans_draw_(const MlcKMeansJob_ * job, size_t blocks, uint64_t * rng)
+{
+    double total = 0.0;
+
+    for (size_t b = 0; b < blocks; ++b) total += job->block_d2[b];
+    if (!(total > 0.0)) {
+        /* Every row sits on a centroid already */
+        return (size_t)(mlc_rand_unit_(rng) * (double)job->rows);
+    }
+    double target = mlc_rand_unit_(rng) * total;
+    size_t b = 0;
+
+    while (b + 1 < blocks && (target >= job->block_d2[b] || job->block_d2[b] <= 0.0)) {
+        target -= job->block_d2[b++];
+    }
+    size_t r = b * MLC_KMEANS_SEED_ROWS;
+    size_t end = (job->rows - r < MLC_KMEANS_SEED_ROWS) ? job->rows : r + MLC_KMEANS_SEED_ROWS;
+    size_t last = r;
+
+    for (; r < end; ++r) {
+        if (job->d2[r] <= 0.0f) continue;
+        last = r;
+        if (target < job->d2[r]) break;
+        target -= job->d2[r];
+    }
+    /* Rounding can run past the end: take the last row with weight */
+    return last;
+}
+
+static inline void
+mlc_kmeans_seed_(MlcKMeansJob_ * job, float * centroids, uint64_t * rng)
+{
+    size_t blocks = (job->rows + MLC_KMEANS_SEED_ROWS - 1) / MLC_KMEANS_SEED_ROWS;
+    size_t row = (size_t)(mlc_rand_unit_(rng) * (double)job->rows);
+
+    for (size_t r = 0; r < job->rows; ++r) job->d2[r] = FLT_MAX;
+
+    for (size_t j = 0; j < job->clusters; ++j) {
+        float * c = centroids + j * job->cols;
+
+        if (j > 0) row = mlc_kmeans_draw_(job, blocks, rng);
+        memcpy(c, job->x + row * job->ld, job->cols * sizeof(float));
+        if (j + 1 == job->clusters) break;
+
+        job->seed = c;
+        job->seed_norm = job->norms[row];
+        mlc_parallel_for(blocks, 1, mlc_kmeans_seed_range_, job);
+    }
+}
+
+static inline void
+mlc_kmeans_job_finish_(MlcKMeansJob_ * job)
+{
+    free(job->norms);
+    free(job->cnorms);
+    free(job->packed);
+    free(job->scratch);
+    free(job->sums);
+    free(job->counts);
+}
+
+/* Buffers for rows of x against `clusters` centroids; sums and counts when fitting */
+static inline int
+mlc_kmeans_job_init_(MlcKMeansJob_ * job, const MlcArray * x, size_t clusters, int fitting)
+{
+    size_t parts = mlc_get_num_threads();
+    size_t cols = x->shape[1];
+
+    memset(job, 0, sizeof(*job));
+    job->x = x->data;
+    job->ld = mlc_stride_(x, 0);
+    job->rows = x->shape[0];
+    job->cols = cols;
+    job->clusters = clusters;
+
+    /* Row blocks of whole micro-kernel heights whose distances fit MLC_KMEANS_TILE_BYTES */
+    job->block = MLC_KMEANS_TILE_BYTES / sizeof(float) / clusters / MLC_GEMM_MR * MLC_GEMM_MR;
+    if (job->block < MLC_GEMM_MR) job->block = MLC_GEMM_MR;
+    if (job->block > 256) job->block = 256;
+
+    job->scratch_floats = mlc_gemm_round_up_(job->block * clusters, 16) +
+                          mlc_gemm_round_up_(mlc_gemm_packed_workspace_size(job->block, cols), 16);
+    if (job->scratch_floats < MLC_KMEANS_SEED_ROWS) job->scratch_floats = MLC_KMEANS_SEED_ROWS;
+    /* The first part's scratch also holds C^T while packing */
+    size_t scratch = parts * job->scratch_floats;
+    if (scratch < clusters * cols) scratch = clusters * cols;
+
+    job->norms = (float *)malloc(job->rows * sizeof(float));
+    job->cnorms = (float *)malloc(clusters * sizeof(float));
+    job->packed = (float *)aligned_alloc(64, mlc_gemm_round_up_(mlc_gemm_packed_size(cols, clusters) *
+                                                                sizeof(float), 64));
+    job->scratch = (float *)aligned_alloc(64, mlc_gemm_round_up_(scratch * sizeof(float), 64));
+    if (fitting) {
+        job->sums = (double *)malloc(parts * clusters * cols * sizeof(double));
+        job->counts = (size_t *)malloc(parts * clusters * sizeof(size_t));
+    }
+    if (job->norms == NULL || job->cnorms == NULL || job->packed == NULL || job->scratch == NULL ||
+        (fitting && (job->sums == NULL || job->counts == NULL))) {
+        LOG_ERROR("Memory allocation failed for k-means workspace");
+        mlc_kmeans_job_finish_(job);
+        return -1;
+    }
+    mlc_parallel_for(job->rows, mlc_parallel_grain(cols), mlc_kmeans_norms_range_, job);
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of k-means:
+ *
+ * Finds centroids c_0 .. c_{k-1} (locally) minimizing the
+ * inertia Σ_r min_j ||x_r - c_j||^2, by alternating
+ *   labels[r] = argmin_j ||x_r - c_j||^2
+ *   c_j       = mean of the rows with labels[r] == j
+ * from k-means++ seeds. On return model->labels and
+ * model->inertia match model->centroids.
+ *
+ * Shapes: data is (rows x cols) with rows >= clusters, of any
+ * dtype; model->centroids is (clusters x cols).
+ * Release the model with mlc_kmeans_finish().
+ **********************************/
+static inline int
+mlc_kmeans(const MlcArray * data, const MlcKMeansOptions * options, MlcKMeans * model)
+{
+    MlcArray empty = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (model == NULL) return -1;
+    memset(model, 0, sizeof(*model));
+    model->centroids = empty;
+    if (options == NULL || check_inputs((MlcArray *)data) != 0 || data->ndims != 2 ||
+        data->shape[1] == 0 || options->clusters == 0 || data->shape[0] < options->clusters) {
+        LOG_ERROR("Invalid k-means input (need a matrix with at least `clusters` rows)");
+        return -1;
+    }
+    size_t rows = data->shape[0], cols = data->shape[1], k = options->clusters;
+    MLC_PROFILE_BEGIN("mlc_kmeans");
+
+    MlcArray copy;
+    const MlcArray * x = mlc_matrix_operand_(data, &copy);
+    MlcKMeansJob_ job;
+    float * centroids = (float *)malloc(k * cols * sizeof(float));
+    float * d2 = (float *)malloc(rows * sizeof(float));
+    double * block_d2 = (double *)malloc((rows / MLC_KMEANS_SEED_ROWS + 1) * sizeof(double));
+
+    model->labels = (size_t *)malloc(rows * sizeof(size_t));
+    if (x->data == NULL || centroids == NULL || d2 == NULL || block_d2 == NULL ||
+        model->labels == NULL || mlc_kmeans_job_init_(&job, x, k, 1) != 0) {
+        LOG_ERROR("Memory allocation failed for k-means");
+        free(centroids);
+        free(d2);
+        free(block_d2);
+        free(model->labels);
+        model->labels = NULL;
+        mlc_finish(&copy);
+        return -1;
+    }
+    model->rows = rows;
+    job.labels = model->labels;
+    job.d2 = d2;
+    job.block_d2 = block_d2;
+
+    uint64_t rng = options->seed;
+    mlc_kmeans_seed_(&job, centroids, &rng);
+    free(d2);
+    free(block_d2);
+
+    /* No row is in any cluster yet: the first pass changes them all */
+    memset(model->labels, 0xff, rows * sizeof(size_t));
+    double previous = 0.0;
+    int settled = 0;
+
+    while (model->iterations < options->max_iter) {
+        size_t changed;
+
+        model->inertia = mlc_kmeans_assign_(&job, centroids, &changed);
+        model->iterations++;
+        if (changed == 0) {
+            /* The update would give the same centroids */
+            settled = 1;
+            break;
+        }
+        mlc_kmeans_update_(&job, centroids);
+        if (model->iterations > 1 && previous - model->inertia <= options->tol * previous) break;
+        previous = model->inertia;
+    }
+    if (!settled) {
+        /* Labels and inertia for the last centroids */
+        double * sums = job.sums;
+
+        job.sums = NULL;
+        model->inertia = mlc_kmeans_assign_(&job, centroids, NULL);
+        job.sums = sums;
+    }
+
+    size_t shape[2] = {k, cols};
+    model->centroids = prepare_data(centroids, 2, shape, TYPE_FLOAT);
+    free(centroids);
+    mlc_kmeans_job_finish_(&job);
+    mlc_finish(&copy);
+    MLC_PROFILE_END(rows * cols * k * model->iterations, rows * cols * sizeof(float) * model->iterations);
+
+    if (model->centroids.data == NULL) {
+        LOG_ERROR("Memory allocation failed for k-means centroids");
+        mlc_kmeans_finish(model);
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of k-means prediction:
+ *
+ * labels[r] = argmin_j ||data_r - centroids_j||^2
+ *
+ * Shapes: data is (rows x cols) with the model's cols, of any
+ * dtype; labels holds rows values.
+ **********************************/
+static inline int
+mlc_kmeans_predict(const MlcKMeans * model, const MlcArray * data, size_t * labels)
+{
+    if (model == NULL || model->centroids.data == NULL || labels == NULL ||
+        check_inputs((MlcArray *)data) != 0 || data->ndims != 2 ||
+        data->shape[1] != model->centroids.shape[1]) {
+        LOG_ERROR("Invalid or mismatched k-means input");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_kmeans_predict");
+
+    MlcArray copy;
+    const MlcArray * x = mlc_matrix_operand_(data, &copy);
+    MlcKMeansJob_ job;
+
+    if (x->data == NULL || mlc_kmeans_job_init_(&job, x, model->centroids.shape[0], 0) != 0) {
+        LOG_ERROR("Memory allocation failed for k-means");
+        mlc_finish(&copy);
+        return -1;
+    }
+    job.labels = labels;
+    mlc_kmeans_assign_(&job, model->centroids.data, NULL);
+
+    mlc_kmeans_job_finish_(&job);
+    mlc_finish(&copy);
+    MLC_PROFILE_END(data->size * model->centroids.shape[0], data->size * sizeof(float));
+    return 0;
+}
+
+#endif /* MLC_KMEANS_H */
@@ -0,0 +1,337 @@
+/* include/mlc/layers.h */
+
+#ifndef MLC_LAYERS_H
+#define MLC_LAYERS_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/activations.h>
+#include <mlc/matrix.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Dense layers and multi-layer perceptrons:
+ *
+ * An MlcDense holds the weights W (inputs x outputs), the bias
+ * b (outputs) and the activation of one fully connected layer,
+ *
+ *   y = act(x W + b)
+ *
+ * for a batch x of row vectors. An MlcMlp chains up to
+ * MLC_MLP_MAX_LAYERS of them and runs batched forward passes:
+ *
+ *   MlcMlp mlp;
+ *   mlc_mlp_init(&mlp, 64);                       (max batch)
+ *   mlc_mlp_add(&mlp, &w1, &b1, MLC_ACT_RELU, 0.0f);
+ *   mlc_mlp_add(&mlp, &w2, &b2, MLC_ACT_SOFTMAX, 0.0f);
+ *   mlc_mlp_forward(&mlp, &input, &output);       (any batch)
+ *   mlc_mlp_finish(&mlp);
+ *
+ * Forward passes are built for low, steady latency:
+ *
+ *  - The weights are packed once, when the layer is added, into
+ *    the panel layout of the GEMM micro-kernel (matrix.h), so a
+ *    pass never repacks them.
+ *  - Bias add and activation are fused into the GEMM epilogue:
+ *    each tile of the output is finished while it is in L1.
+ *    Softmax needs whole rows and runs after the GEMM instead.
+ *  - Hidden activations and GEMM scratch live in one workspace,
+ *    sized by mlc_mlp_add() for max_batch rows; forward passes
+ *    do not allocate. Larger batches run max_batch rows at a
+ *    time.
+ *  - A pass runs on the calling thread. Handing small batches
+ *    to the thread pool costs more than it saves and adds
+ *    wake-up jitter; for throughput, run one MlcMlp (and so one
+ *    workspace) per thread.
+ *
+ * Layers copy their weights (any storage type) to fp32. After
+ * changing layer->weights directly, call mlc_dense_pack().
+ * Input and output of a forward pass must be fp32 with
+ * contiguous rows.
+ *
+ * Functions return -1 on invalid input or allocation failure,
+ * and 0 on success.
+ *************************************************************/
+
+#ifndef MLC_MLP_MAX_LAYERS
+    #define MLC_MLP_MAX_LAYERS 16
+#endif
+
+typedef struct
+{
+    size_t inputs;
+    size_t outputs;
+    MlcArray weights;           /* (inputs x outputs), fp32 */
+    MlcArray bias;              /* (outputs), fp32 */
+    MlcActivation activation;
+    float alpha;                /* leaky ReLU slope */
+    float * packed;             /* weights in GEMM panel order */
+}
+MlcDense;
+
+typedef struct
+{
+    MlcDense layers[MLC_MLP_MAX_LAYERS];
+    size_t count;
+    size_t max_batch;
+    float * workspace;
+    size_t workspace_size;      /* floats */
+}
+MlcMlp;
+
+static inline void *
+mlc_layers_alloc_(size_t floats)
+{
+    size_t bytes = mlc_gemm_round_up_(floats * sizeof(float), 64);
+    return aligned_alloc(64, bytes ? bytes : 64);
+}
+
+/* Repacks the layer's weights, after they were changed in place. */
+static inline void
+mlc_dense_pack(MlcDense * layer)
+{
+    mlc_gemm_pack(layer->inputs, layer->outputs, layer->weights.data, layer->outputs,
+                  layer->packed);
+}
+
+static inline void
+mlc_dense_finish(MlcDense * layer)
+{
+    if (layer == NULL) return;
+    mlc_finish(&layer->weights);
+    mlc_finish(&layer->bias);
+    free(layer->packed);
+    layer->packed = NULL;
+}
+
+/**********************************
+ * Sets up a dense layer.
+ *
+ * Arguments:
+ *  - layer: Layer to initialize.
+ *  - weights: (inputs x outputs) matrix, copied to fp32.
+ *  - bias: `outputs` values, copied; NULL for no bias.
+ *  - activation: Applied after the bias (MLC_ACT_NONE for a
+ *    linear layer).
+ *  - alpha: Leaky ReLU slope, ignored by other activations.
+ **********************************/
+static inline int
+mlc_dense_init(MlcDense * layer, const MlcArray * weights, const MlcArray * bias,
+               MlcActivation activation, float alpha)
+{
+    if (layer == NULL || weights == NULL || weights->data == NULL || weights->ndims != 2 ||
+        weights->size == 0 ||
+        (bias != NULL && (bias->data == NULL || bias->size != weights->shape[1]))) {
+        LOG_ERROR("Invalid dense layer weights or bias");
+        return -1;
+    }
+    size_t outputs = weights->shape[1];
+
+    memset(layer, 0, sizeof(*layer));
+    layer->inputs = weights->shape[0];
+    layer->outputs = outputs;
+    layer->activation = activation;
+    layer->alpha = alpha;
+    layer->weights = mlc_cast(weights, MLC_DTYPE_F32);
+    if (bias != NULL) {
+        layer->bias = mlc_cast(bias, MLC_DTYPE_F32);
+    }
+    else {
+        float * zeros = (float *)calloc(outputs, sizeof(float));
+
+        if (zeros != NULL) layer->bias = prepare_data(zeros, 1, &outputs, TYPE_FLOAT);
+        free(zeros);
+    }
+    layer->packed = (float *)mlc_layers_alloc_(mlc_gemm_packed_size(layer->inputs, outputs));
+
+    if (layer->weights.data == NULL || layer->bias.data == NULL || layer->packed == NULL) {
+        LOG_ERROR("Memory allocation failed for dense layer");
+        mlc_dense_finish(layer);
+        return -1;
+    }
+    mlc_dense_pack(layer);
+    return 0;
+}
+
+/**********************************
+ * Forward pass of m rows: y = act(x W + b), x with row stride
+ * ldx, y with row stride ldy. `workspace` holds
+ * mlc_gemm_packed_workspace_size(m, inputs) floats.
+ **********************************/
+static inline void
+mlc_dense_forward_(const MlcDense * layer, size_t m, const float * x, size_t ldx,
+                   float * y, size_t ldy, float * workspace)
+{
+    MlcGemmEpilogue epilogue;
+
+    epilogue.bias = layer->bias.data;
+    epilogue.activation = (layer->activation == MLC_ACT_SOFTMAX) ? MLC_ACT_NONE
+                                                                 : layer->activation;
+    epilogue.alpha = layer->alpha;
+    mlc_sgemm_packed(m, layer->outputs, layer->inputs, x, ldx, layer->packed,
+                     y, ldy, workspace, &epilogue);
+
+    for (size_t i = 0; layer->activation == MLC_ACT_SOFTMAX && i < m; ++i) {
+        mlc_softmax_span_(y + i * ldy, layer->outputs);
+    }
+}
+
+static inline void
+mlc_mlp_finish(MlcMlp * mlp)
+{
+    if (mlp == NULL) return;
+    for (size_t l = 0; l < mlp->count; ++l) {
+        mlc_dense_finish(&mlp->layers[l]);
+    }
+    free(mlp->workspace);
+    mlp->workspace = NULL;
+    mlp->workspace_size = 0;
+    mlp->count = 0;
+}
+
+/**********************************
+ * Initializes an empty MLP whose forward passes process up to
+ * max_batch rows at a time.
+ **********************************/
+static inline int
+mlc_mlp_init(MlcMlp * mlp, size_t max_batch)
+{
+    if (mlp == NULL || max_batch == 0) {
+        LOG_ERROR("Invalid MLP or batch size");
+        return -1;
+    }
+    memset(mlp, 0, sizeof(*mlp));
+    mlp->max_batch = max_batch;
+    return 0;
+}
+
+/**********************************
+ * Workspace of an MLP, in floats: two buffers for the hidden
+ * activations of max_batch rows, plus the GEMM scratch of the
+ * widest layer input.
+ **********************************/
+static inline size_t
+mlc_mlp_workspace_size_(const MlcMlp * mlp, size_t * hidden)
+{
+    size_t widest = 0, inputs = 0;
+
+    for (size_t l = 0; l < mlp->count; ++l) {
+        const MlcDense * layer = &mlp->layers[l];
+
+        if (l + 1 < mlp->count && layer->outputs > widest) widest = layer->outputs;
+        if (layer->inputs > inputs) inputs = layer->inputs;
+    }
+    /* keep each buffer 64-byte aligned */
+    *hidden = mlc_gemm_round_up_(mlp->max_batch * widest, 16);
+    return 2 * *hidden + mlc_gemm_packed_workspace_size(mlp->max_batch, inputs);
+}
+
+/**********************************
+ * Appends a dense layer (see mlc_dense_init()); its inputs must
+ * match the outputs of the previous layer. Grows the workspace
+ * as needed.
+ **********************************/
+static inline int
+mlc_mlp_add(MlcMlp * mlp, const MlcArray * weights, const MlcArray * bias,
+            MlcActivation activation, float alpha)
+{
+    if (mlp == NULL || mlp->count >= MLC_MLP_MAX_LAYERS || weights == NULL ||
+        (mlp->count > 0 && weights->ndims == 2 &&
+         weights->shape[0] != mlp->layers[mlp->count - 1].outputs)) {
+        LOG_ERROR("Invalid MLP or mismatched layer shapes");
+        return -1;
+    }
+    if (mlc_dense_init(&mlp->layers[mlp->count], weights, bias, activation, alpha) != 0) {
+        return -1;
+    }
+    mlp->count++;
+
+    size_t hidden;
+    size_t size = mlc_mlp_workspace_size_(mlp, &hidden);
+    if (size > mlp->workspace_size) {
+        float * workspace = (float *)mlc_layers_alloc_(size);
+
+        if (workspace == NULL) {
+            LOG_ERROR("Memory allocation failed for MLP workspace");
+            mlp->count--;
+            mlc_dense_finish(&mlp->layers[mlp->count]);
+            return -1;
+        }
+        free(mlp->workspace);
+        mlp->workspace = workspace;
+        mlp->workspace_size = size;
+    }
+    return 0;
+}
+
+/* Forward pass of m <= max_batch rows, from x (row stride ldx) into y (row stride ldy) */
+static inline void
+mlc_mlp_forward_rows_(const MlcMlp * mlp, size_t m, const float * x, size_t ldx,
+                      float * y, size_t ldy)
+{
+    size_t hidden;
+    mlc_mlp_workspace_size_(mlp, &hidden);
+    float * buffers[2] = {mlp->workspace, mlp->workspace + hidden};
+    float * scratch = mlp->workspace + 2 * hidden;
+
+    for (size_t l = 0; l < mlp->count; ++l) {
+        const MlcDense * layer = &mlp->layers[l];
+        int last = (l + 1 == mlp->count);
+        float * out = last ? y : buffers[l % 2];
+        size_t ldo = last ? ldy : layer->outputs;
+
+        mlc_dense_forward_(layer, m, x, ldx, out, ldo, scratch);
+        x = out;
+        ldx = ldo;
+    }
+}
+
+/**********************************
+ * Mathematical synopsis of the MLP forward pass:
+ *
+ * h_0 = input,  h_l = act_l(h_(l-1) W_l + b_l),  output = h_L
+ *
+ * Shapes: input is (batch x inputs) of the first layer, or a
+ * vector of `inputs` values for a batch of one; output holds
+ * batch x outputs of the last layer (any ndims, contiguous).
+ * Note: Does not allocate; batches larger than max_batch are
+ * processed max_batch rows at a time.
+ **********************************/
+static inline int
+mlc_mlp_forward(MlcMlp * mlp, MlcArray * input, MlcArray * output)
+{
+    if (mlp == NULL || mlp->count == 0 ||
+        check_inputs(input) != 0 ||
+        check_inputs(output) != 0 ||
+        !(input->ndims == 2 ? mlc_matrix_rows_ok_(input) : mlc_is_direct_(input)) ||
+        !mlc_is_direct_(output)
+        ) {
+        LOG_ERROR("Invalid MLP, input or output");
+        return -1;
+    }
+    size_t inputs = mlp->layers[0].inputs;
+    size_t outputs = mlp->layers[mlp->count - 1].outputs;
+    size_t batch = (input->ndims == 2) ? input->shape[0] : 1;
+    size_t ldx = (input->ndims == 2) ? mlc_stride_(input, 0) : inputs;
+
+    if ((input->ndims == 2 ? input->shape[1] : input->size) != inputs ||
+        output->size != batch * outputs) {
+        LOG_ERROR("Mismatched MLP input or output shape");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_mlp_forward");
+
+    for (size_t i = 0; i < batch; i += mlp->max_batch) {
+        size_t m = (batch - i < mlp->max_batch) ? batch - i : mlp->max_batch;
+
+        mlc_mlp_forward_rows_(mlp, m, input->data + i * ldx, ldx,
+                              output->data + i * outputs, outputs);
+    }
+    MLC_PROFILE_END(batch * inputs, (batch * (inputs + outputs)) * sizeof(float));
+    return 0;
+}
+
+#endif /* MLC_LAYERS_H */
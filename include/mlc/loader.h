@@ -0,0 +1,459 @@
+/* include/mlc/loader.h */
+
+#ifndef MLC_LOADER_H
+#define MLC_LOADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <mlc/data.h>
+#include <mlc/csv_stream.h>
+#include <mlc/sampler.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/matrix.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Background data loader:
+ *
+ * An MlcLoader hands out mini-batches while a background thread
+ * reads and parses the following ones, so the caller's compute
+ * overlaps the loading instead of alternating with it. In the
+ * steady state a loop costs max(load, compute) per batch rather
+ * than load + compute.
+ *
+ *   MlcLoaderOptions options = mlc_loader_options(256);
+ *   options.shuffle = 1;
+ *   MlcLoader * loader = mlc_loader_open_csv("train.csv", &options);
+ *   MlcArray * batch;
+ *
+ *   for (int epoch = 0; epoch < epochs; ++epoch) {
+ *       while (mlc_loader_next(loader, &batch) > 0) {
+ *           ... batch->shape[0] rows x batch->shape[1] cols ...
+ *       }
+ *   }
+ *   mlc_loader_close(loader);
+ *
+ * Batches come from a ring of `depth` preallocated buffers:
+ * the caller holds one (valid, and writable, until its next
+ * call to mlc_loader_next()) while the thread fills up to
+ * depth - 1 others ahead of it. depth = 2 is double buffering;
+ * more absorbs uneven load times. Memory stays bounded by the
+ * ring, and the thread waits whenever the ring is full.
+ *
+ * Sources:
+ *
+ *  - mlc_loader_open_csv(): a CSV file streamed with an
+ *    MlcCsvReader (csv_stream.h). With shuffle, rows pass
+ *    through a window of MLC_LOADER_SHUFFLE_BATCHES batches
+ *    and each batch is drawn at random from it: a local
+ *    shuffle, as the file is only read sequentially.
+ *  - mlc_loader_open_array(): the rows of an fp32 matrix (e.g.
+ *    from mlc_read_csv() or mlc_load_mmap()), gathered into the
+ *    batches by an MlcSampler (sampler.h). With shuffle, each
+ *    epoch visits the rows in a new random order. The array is
+ *    only read, and must outlive the loader.
+ *
+ * Both sources repeat: mlc_loader_next() returns 0 at the end
+ * of every epoch, and the next call starts the next epoch
+ * (already being prefetched). The last batch of an epoch may
+ * be short.
+ *
+ * The loader thread parses on its own, without the thread
+ * pool, so it never takes pool threads from the caller.
+ *************************************************************/
+
+#ifndef MLC_LOADER_SHUFFLE_BATCHES
+    #define MLC_LOADER_SHUFFLE_BATCHES 8    /* CSV shuffle window, in batches */
+#endif
+
+typedef struct
+{
+    size_t batch_rows;
+    size_t depth;           /* batches in the ring, at least 2 */
+    int shuffle;
+    uint64_t seed;          /* shuffle seed: equal seeds give equal orders */
+}
+MlcLoaderOptions;
+
+/* Defaults: double buffering, file order */
+static inline MlcLoaderOptions
+mlc_loader_options(size_t batch_rows)
+{
+    MlcLoaderOptions options = {batch_rows, 2, 0, 0};
+    return options;
+}
+
+typedef struct
+{
+    MlcLoaderOptions options;
+    size_t cols;
+
+    /* CSV source */
+    MlcCsvReader * reader;
+    float * window;             /* shuffle window, window_rows x cols */
+    size_t window_rows;
+    size_t window_fill;
+    int source_done;            /* reader at the end of the file */
+
+    /* Array source */
+    const MlcArray * data;
+    MlcSampler sampler;
+
+    uint64_t rng;
+
+    /* Ring of batches; slots [tail, tail + ready) are filled */
+    MlcArray * slots;
+    int * slot_status;          /* 1 batch, 0 end of epoch, -1 error */
+    size_t head;                /* next slot to fill */
+    size_t tail;                /* next slot to hand out */
+    size_t ready;
+    int held;                   /* the caller holds slots[tail] */
+    int stop;
+    int finished;               /* the thread has exited */
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t freed;
+    pthread_t thread;
+}
+MlcLoader;
+
+/* Sets a slot to `rows` rows of the batch buffer */
+static inline void
+mlc_loader_set_rows_(const MlcLoader * loader, MlcArray * slot, size_t rows)
+{
+    slot->shape[0] = rows;
+    slot->shape[1] = loader->cols;
+    slot->size = rows * loader->cols;
+}
+
+/**********************************
+ * Next batch of the CSV source into `slot`, drawn at random
+ * from the shuffle window when shuffling. At the end of the
+ * file the reader is rewound for the next epoch.
+ * Returns 1, 0 (end of epoch) or -1.
+ **********************************/
+static inline int
+mlc_loader_produce_csv_(MlcLoader * loader, MlcArray * slot)
+{
+    size_t batch_rows = loader->options.batch_rows;
+    size_t cols = loader->cols;
+
+    if (!loader->options.shuffle) {
+        /* Parse straight into the slot */
+        slot->size = batch_rows * cols;
+        int status = mlc_csv_next_batch(loader->reader, batch_rows, slot);
+
+        if (status == 0 && mlc_csv_rewind(loader->reader) != 0) return -1;
+        return status;
+    }
+
+    /* Top up the window, parsing straight into its free rows */
+    while (!loader->source_done && loader->window_fill < loader->window_rows) {
+        size_t shape[2] = {loader->window_rows - loader->window_fill, cols};
+        MlcArray free_rows = {loader->window + loader->window_fill * cols, 2, shape,
+                              shape[0] * cols, MLC_STORAGE_VIEW, NULL, 0, NULL, MLC_DTYPE_F32};
+        int status = mlc_csv_next_batch(loader->reader, shape[0], &free_rows);
+
+        if (status < 0) return -1;
+        if (status == 0) loader->source_done = 1;
+        else loader->window_fill += free_rows.shape[0];
+    }
+
+    size_t rows = (loader->window_fill < batch_rows) ? loader->window_fill : batch_rows;
+    if (rows == 0) {
+        loader->source_done = 0;
+        return (mlc_csv_rewind(loader->reader) == 0) ? 0 : -1;
+    }
+
+    /* Draw rows at random; the window's last row fills each hole */
+    for (size_t i = 0; i < rows; ++i) {
+        size_t j = (size_t)(mlc_rand_u64_(&loader->rng) % loader->window_fill);
+        float * row = loader->window + j * cols;
+        float * last = loader->window + (loader->window_fill - 1) * cols;
+
+        memcpy(slot->data + i * cols, row, cols * sizeof(float));
+        if (row != last) memcpy(row, last, cols * sizeof(float));
+        loader->window_fill--;
+    }
+    mlc_loader_set_rows_(loader, slot, rows);
+    return 1;
+}
+
+/**********************************
+ * Next batch of the array source into `slot`: the sampler's
+ * next batch of rows, gathered. Returns 1, 0 (end of epoch,
+ * the sampler has drawn the next order) or -1.
+ **********************************/
+static inline int
+mlc_loader_produce_array_(MlcLoader * loader, MlcArray * slot)
+{
+    size_t count = mlc_sampler_next(&loader->sampler);
+
+    if (count == 0 || count == (size_t)-1) {
+        return (count == 0) ? 0 : -1;
+    }
+    /* The whole preallocated slot, even after a short batch: never regrown */
+    slot->size = loader->options.batch_rows * loader->cols;
+    return (mlc_sampler_gather(&loader->sampler, loader->data, slot) == 0) ? 1 : -1;
+}
+
+/* Loader thread: fills free slots until stopped or failed */
+static inline void *
+mlc_loader_main_(void * arg)
+{
+    MlcLoader * loader = (MlcLoader *)arg;
+    size_t depth = loader->options.depth;
+
+    /* Nested mlc_parallel_for() calls run serially on this thread */
+    mlc_in_worker_ = 1;
+
+    for (;;) {
+        pthread_mutex_lock(&loader->lock);
+        while (!loader->stop && loader->ready + (size_t)loader->held == depth) {
+            pthread_cond_wait(&loader->freed, &loader->lock);
+        }
+        if (loader->stop) {
+            pthread_mutex_unlock(&loader->lock);
+            break;
+        }
+        size_t slot = loader->head;
+        pthread_mutex_unlock(&loader->lock);
+
+        /* The slot is not visible to the caller until it is counted as ready */
+        int status = loader->reader ? mlc_loader_produce_csv_(loader, &loader->slots[slot])
+                                    : mlc_loader_produce_array_(loader, &loader->slots[slot]);
+
+        pthread_mutex_lock(&loader->lock);
+        loader->slot_status[slot] = status;
+        loader->head = (slot + 1) % depth;
+        loader->ready++;
+        pthread_cond_signal(&loader->filled);
+        pthread_mutex_unlock(&loader->lock);
+
+        if (status < 0) break;
+    }
+
+    pthread_mutex_lock(&loader->lock);
+    loader->finished = 1;
+    pthread_cond_signal(&loader->filled);
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+/* Frees everything but the thread (not started, or joined) */
+static inline void
+mlc_loader_free_(MlcLoader * loader)
+{
+    if (loader->slots != NULL) {
+        for (size_t s = 0; s < loader->options.depth; ++s) {
+            mlc_finish(&loader->slots[s]);
+        }
+    }
+    mlc_csv_close(loader->reader);
+    free(loader->slots);
+    free(loader->slot_status);
+    free(loader->window);
+    mlc_sampler_finish(&loader->sampler);
+    free(loader);
+}
+
+/**********************************
+ * Allocates the ring (and the source buffers) once `cols` and
+ * the source are set, then starts the thread. Frees the loader
+ * and returns NULL on failure.
+ **********************************/
+static inline MlcLoader *
+mlc_loader_start_(MlcLoader * loader)
+{
+    size_t depth = loader->options.depth;
+    size_t floats = loader->options.batch_rows * loader->cols;
+    int ok;
+
+    loader->slots = (MlcArray *)calloc(depth, sizeof(MlcArray));
+    loader->slot_status = (int *)calloc(depth, sizeof(int));
+    ok = (loader->slots != NULL && loader->slot_status != NULL);
+
+    for (size_t s = 0; ok && s < depth; ++s) {
+        MlcArray * slot = &loader->slots[s];
+
+        slot->ndims = 2;
+        slot->storage = MLC_STORAGE_HEAP;
+        slot->dtype = MLC_DTYPE_F32;
+        slot->data = (float *)malloc(floats * sizeof(float));
+        slot->shape = (size_t *)malloc(2 * sizeof(size_t));
+        ok = (slot->data != NULL && slot->shape != NULL);
+        if (ok) mlc_loader_set_rows_(loader, slot, loader->options.batch_rows);
+    }
+    if (ok && loader->reader != NULL && loader->options.shuffle) {
+        loader->window_rows = MLC_LOADER_SHUFFLE_BATCHES * loader->options.batch_rows;
+        loader->window = (float *)malloc(loader->window_rows * loader->cols * sizeof(float));
+        ok = (loader->window != NULL);
+    }
+    if (ok && loader->reader == NULL) {
+        ok = (mlc_sampler_init(&loader->sampler, loader->data->shape[0], loader->options.batch_rows,
+                               loader->options.shuffle ? MLC_SAMPLE_SHUFFLE : MLC_SAMPLE_SEQUENTIAL,
+                               NULL, loader->options.seed) == 0);
+    }
+    if (!ok) {
+        LOG_ERROR("Memory allocation failed for loader");
+        mlc_loader_free_(loader);
+        return NULL;
+    }
+
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->filled, NULL);
+    pthread_cond_init(&loader->freed, NULL);
+    if (pthread_create(&loader->thread, NULL, mlc_loader_main_, loader) != 0) {
+        LOG_ERROR("Cannot start loader thread");
+        pthread_mutex_destroy(&loader->lock);
+        pthread_cond_destroy(&loader->filled);
+        pthread_cond_destroy(&loader->freed);
+        mlc_loader_free_(loader);
+        return NULL;
+    }
+    return loader;
+}
+
+/* Checks the options and allocates a loader around them */
+static inline MlcLoader *
+mlc_loader_new_(const MlcLoaderOptions * options)
+{
+    if (options == NULL || options->batch_rows == 0 || options->depth < 2) {
+        LOG_ERROR("Invalid loader options: batch_rows > 0 and depth >= 2 required");
+        return NULL;
+    }
+    MlcLoader * loader = (MlcLoader *)calloc(1, sizeof(MlcLoader));
+
+    if (loader == NULL) {
+        LOG_ERROR("Memory allocation failed for loader");
+        return NULL;
+    }
+    loader->options = *options;
+    loader->rng = options->seed;
+    return loader;
+}
+
+/**********************************
+ * Opens a loader that streams batches of a CSV file (format of
+ * mlc_csv_next_batch()).
+ *
+ * Returns:
+ *  - A loader to pass to mlc_loader_next()/mlc_loader_close().
+ *  - NULL on invalid options or if the file cannot be opened.
+ **********************************/
+static inline MlcLoader *
+mlc_loader_open_csv(const char * filename, const MlcLoaderOptions * options)
+{
+    MlcLoader * loader = mlc_loader_new_(options);
+    if (loader == NULL) return NULL;
+
+    loader->reader = mlc_csv_open(filename);
+    if (loader->reader == NULL) {
+        mlc_loader_free_(loader);
+        return NULL;
+    }
+    loader->cols = loader->reader->cols;
+    return mlc_loader_start_(loader);
+}
+
+/**********************************
+ * Opens a loader over the rows of `data`, a 2D fp32 array with
+ * contiguous rows that must stay alive and unchanged until
+ * mlc_loader_close().
+ *
+ * Returns:
+ *  - A loader to pass to mlc_loader_next()/mlc_loader_close().
+ *  - NULL on invalid options or array.
+ **********************************/
+static inline MlcLoader *
+mlc_loader_open_array(const MlcArray * data, const MlcLoaderOptions * options)
+{
+    if (check_inputs((MlcArray *)data) != 0 || !mlc_matrix_rows_ok_(data)) {
+        LOG_ERROR("Loader source must be a 2D fp32 array with contiguous rows");
+        return NULL;
+    }
+    MlcLoader * loader = mlc_loader_new_(options);
+    if (loader == NULL) return NULL;
+
+    loader->data = data;
+    loader->cols = data->shape[1];
+    return mlc_loader_start_(loader);
+}
+
+/**********************************
+ * Hands out the next batch, waiting for it if the loader thread
+ * is behind. The batch from the previous call goes back to the
+ * loader.
+ *
+ * Returns:
+ *  - 1 with *batch set to a (rows x cols) fp32 array, owned by
+ *    the loader and valid until the next call.
+ *  - 0 at the end of an epoch; the next call starts the next
+ *    epoch.
+ *  - -1 on error (invalid arguments, or the loader failed to
+ *    read or parse its source).
+ **********************************/
+static inline int
+mlc_loader_next(MlcLoader * loader, MlcArray ** batch)
+{
+    if (loader == NULL || batch == NULL) {
+        LOG_ERROR("Invalid loader or batch");
+        return -1;
+    }
+    size_t depth = loader->options.depth;
+    int status;
+
+    *batch = NULL;
+    pthread_mutex_lock(&loader->lock);
+    if (loader->held) {
+        loader->held = 0;
+        loader->tail = (loader->tail + 1) % depth;
+        pthread_cond_signal(&loader->freed);
+    }
+    while (loader->ready == 0 && !loader->finished) {
+        pthread_cond_wait(&loader->filled, &loader->lock);
+    }
+    if (loader->ready == 0) {
+        pthread_mutex_unlock(&loader->lock);
+        LOG_ERROR("Loader failed");
+        return -1;
+    }
+    status = loader->slot_status[loader->tail];
+    loader->ready--;
+    if (status == 1) {
+        loader->held = 1;
+        *batch = &loader->slots[loader->tail];
+    }
+    else {
+        loader->tail = (loader->tail + 1) % depth;
+        pthread_cond_signal(&loader->freed);
+    }
+    pthread_mutex_unlock(&loader->lock);
+
+    if (status < 0) LOG_ERROR("Loader failed to read its source");
+    return status;
+}
+
+/* Stops the loader thread and frees the loader and its batches */
+static inline void
+mlc_loader_close(MlcLoader * loader)
+{
+    if (loader == NULL) return;
+
+    pthread_mutex_lock(&loader->lock);
+    loader->stop = 1;
+    pthread_cond_signal(&loader->freed);
+    pthread_mutex_unlock(&loader->lock);
+    pthread_join(loader->thread, NULL);
+
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->filled);
+    pthread_cond_destroy(&loader->freed);
+    mlc_loader_free_(loader);
+}
+
+#endif /* MLC_LOADER_H */
@@ -4,18 +4,490 @@
 #define MLC_MATRIX_H
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <mlc/vector.h>
+#include <mlc/activations.h>
+#include <mlc/dispatch.h>
 #include <mlc/config.h>
 
+/*************************************************************
+ * Matrix operations:
+ *
+ * Matrices are 2D MlcArrays stored in row-major order, i.e.
+ * element (i, j) of an (shape[0] x shape[1]) matrix lives at
+ * data[i * shape[1] + j]. Results are written into a caller
+ * provided array of the right shape, the same way vector_add()
+ * does; the result must not alias any of the inputs.
+ *
+ * Row-slice views (view.h) are used in place, with their row
+ * stride as leading dimension. Operands whose columns are not
+ * contiguous (transposed views) are first copied with
+ * mlc_contiguous(), and fp16/bf16 operands are widened with
+ * mlc_cast(); the result must be fp32 with contiguous rows.
+ *
+ * matrix_mult() is a blocked GEMM in the style of GotoBLAS/BLIS:
+ *
+ *  - B is packed into KC x NC panels (kept in L3/L2),
+ *  - A is packed into MC x KC panels (kept in L2),
+ *  - a MR x NR micro-kernel keeps the C tile in registers and
+ *    streams one MR column of A and one NR row of B per step.
+ *
+ * On AVX2 hosts (dispatch.h) the micro-kernel is a 6x16 FMA
+ * kernel, otherwise a portable C kernel with the same packing
+ * is used. Edge tiles of one or two rows (small batches) are
+ * computed a row at a time instead of padded to six.
+ * The blocking sizes can be overridden by defining MLC_GEMM_MC,
+ * MLC_GEMM_KC and MLC_GEMM_NC before including this header.
+ *
+ * For repeated products with the same B (layer weights, see
+ * layers.h), mlc_gemm_pack() packs B once and
+ * mlc_sgemm_packed() reuses it, optionally fusing a bias add
+ * and an activation into the store of each C tile.
+ *
+ * Functions return -1 if an input is NULL, empty, not 2D, or
+ * if the shapes do not match. Otherwise, they return 0.
+ *************************************************************/
+
 /***********************************************
  * TO DO:
- * 
- * static inline int matrix_vector_mult(...)
+ *
  * static inline int matrix_add(...)
- * static inline int matrix_mult(...)
  * static inline int matrix_transpose(...)
  * static inline int matrix_apply(...)
- * 
+ *
  * *********************************************/
 
+#ifndef MLC_GEMM_MC
+    #define MLC_GEMM_MC 144    /* multiple of MLC_GEMM_MR */
+#endif
+#ifndef MLC_GEMM_KC
+    #define MLC_GEMM_KC 256
+#endif
+#ifndef MLC_GEMM_NC
+    #define MLC_GEMM_NC 4096   /* multiple of MLC_GEMM_NR */
+#endif
+#ifndef MLC_GEMM_ROW_MAX
+    #define MLC_GEMM_ROW_MAX 2 /* edge tiles of up to this many rows use the row kernel */
+#endif
+
+static inline size_t
+mlc_gemm_round_up_(size_t x, size_t to)
+{
+    return (x + to - 1) / to * to;
+}
+
+/**********************************
+ * Number of floats of packing workspace needed by mlc_sgemm()
+ * for an (m x k) * (k x n) product.
+ **********************************/
+static inline size_t
+mlc_gemm_workspace_size(size_t m, size_t n, size_t k)
+{
+    size_t mc = mlc_gemm_round_up_(m < MLC_GEMM_MC ? m : MLC_GEMM_MC, MLC_GEMM_MR);
+    size_t nc = mlc_gemm_round_up_(n < MLC_GEMM_NC ? n : MLC_GEMM_NC, MLC_GEMM_NR);
+    size_t kc = k < MLC_GEMM_KC ? k : MLC_GEMM_KC;
+
+    return (mc + nc) * kc;
+}
+
+/* Packs an (mc x kc) block of A into MR-row panels, zero padded. */
+static inline void
+mlc_gemm_pack_a_(size_t mc, size_t kc, const float * a, size_t lda, float * packed)
+{
+    for (size_t i = 0; i < mc; i += MLC_GEMM_MR) {
+        size_t mr = (mc - i < MLC_GEMM_MR) ? mc - i : MLC_GEMM_MR;
+
+        for (size_t p = 0; p < kc; ++p) {
+            size_t r = 0;
+            for (; r < mr; ++r) {
+                packed[r] = a[(i + r) * lda + p];
+            }
+            for (; r < MLC_GEMM_MR; ++r) {
+                packed[r] = 0.0f;
+            }
+            packed += MLC_GEMM_MR;
+        }
+    }
+}
+
+/* Packs a (kc x nc) block of B into NR-column panels, zero padded. */
+static inline void
+mlc_gemm_pack_b_(size_t kc, size_t nc, const float * b, size_t ldb, float * packed)
+{
+    for (size_t j = 0; j < nc; j += MLC_GEMM_NR) {
+        size_t nr = (nc - j < MLC_GEMM_NR) ? nc - j : MLC_GEMM_NR;
+
+        for (size_t p = 0; p < kc; ++p) {
+            const float * row = b + p * ldb + j;
+            if (nr == MLC_GEMM_NR) {
+                memcpy(packed, row, MLC_GEMM_NR * sizeof(float));
+            }
+            else {
+                size_t c = 0;
+                for (; c < nr; ++c) {
+                    packed[c] = row[c];
+                }
+                for (; c < MLC_GEMM_NR; ++c) {
+                    packed[c] = 0.0f;
+                }
+            }
+            packed += MLC_GEMM_NR;
+        }
+    }
+}
+
+/**********************************
+ * Writes (or accumulates into) the valid mr x nr corner of a
+ * micro-kernel tile into C.
+ **********************************/
+static inline void
+mlc_gemm_store_tile_(const float * tile, float * c, size_t ldc,
+                     size_t mr, size_t nr, int accumulate)
+{
+    for (size_t r = 0; r < mr; ++r) {
+        const float * src = tile + r * MLC_GEMM_NR;
+        float * dst = c + r * ldc;
+
+        if (accumulate) {
+            for (size_t j = 0; j < nr; ++j) {
+                dst[j] += src[j];
+            }
+        }
+        else {
+            memcpy(dst, src, nr * sizeof(float));
+        }
+    }
+}
+
+/**********************************
+ * GEMM epilogue: applied to each tile of C right after its
+ * last K block is stored, while the tile is still in L1:
+ *
+ * C[i][j] = act(C[i][j] + bias[j])
+ *
+ * `bias` (n values) may be NULL. `activation` must be an
+ * element-wise one (not MLC_ACT_SOFTMAX); `alpha` is the leaky
+ * ReLU slope.
+ **********************************/
+typedef struct
+{
+    const float * bias;
+    MlcActivation activation;
+    float alpha;
+}
+MlcGemmEpilogue;
+
+/* Stores a tile into C, then applies the epilogue when given */
+static inline void
+mlc_gemm_finish_tile_(const float * tile, float * c, size_t ldc, size_t mr, size_t nr,
+                      int accumulate, const MlcGemmEpilogue * epilogue, size_t col)
+{
+    mlc_gemm_store_tile_(tile, c, ldc, mr, nr, accumulate);
+    if (epilogue == NULL) return;
+
+    for (size_t r = 0; r < mr; ++r) {
+        float * row = c + r * ldc;
+
+        if (epilogue->bias != NULL) {
+            mlc_add_span_(row, epilogue->bias + col, row, nr);
+        }
+        mlc_activation_span_(epilogue->activation, epilogue->alpha, row, nr);
+    }
+}
+
+/* C = epilogue(0) for k == 0, where the blocked loops never store */
+static inline void
+mlc_gemm_empty_(size_t m, size_t n, float * c, size_t ldc, const MlcGemmEpilogue * epilogue)
+{
+    for (size_t i = 0; i < m; ++i) {
+        float * row = c + i * ldc;
+
+        memset(row, 0, n * sizeof(float));
+        if (epilogue == NULL) continue;
+        if (epilogue->bias != NULL) mlc_add_span_(row, epilogue->bias, row, n);
+        mlc_activation_span_(epilogue->activation, epilogue->alpha, row, n);
+    }
+}
+
+/**********************************
+ * Macro-kernel: C[0..m)[0..nc) (+)= A[0..m)[0..kc) * B for one
+ * packed (kc x nc) block of B. `epilogue` is only passed with
+ * the last K block; `col` is the block's first column in C.
+ **********************************/
+static inline void
+mlc_gemm_macro_(size_t m, size_t nc, size_t kc, const float * a, size_t lda,
+                const float * packed_b, float * c, size_t ldc, float * packed_a,
+                int accumulate, const MlcGemmEpilogue * epilogue, size_t col,
+                const MlcKernels * kernels)
+{
+    float tile[MLC_GEMM_MR * MLC_GEMM_NR];
+
+    for (size_t ic = 0; ic < m; ic += MLC_GEMM_MC) {
+        size_t mc = (m - ic < MLC_GEMM_MC) ? m - ic : MLC_GEMM_MC;
+
+        mlc_gemm_pack_a_(mc, kc, a + ic * lda, lda, packed_a);
+
+        for (size_t jr = 0; jr < nc; jr += MLC_GEMM_NR) {
+            size_t nr = (nc - jr < MLC_GEMM_NR) ? nc - jr : MLC_GEMM_NR;
+
+            for (size_t ir = 0; ir < mc; ir += MLC_GEMM_MR) {
+                size_t mr = (mc - ir < MLC_GEMM_MR) ? mc - ir : MLC_GEMM_MR;
+
+                if (mr <= MLC_GEMM_ROW_MAX) {
+                    for (size_t r = 0; r < mr; ++r) {
+                        kernels->gemm_row_kernel(kc, packed_a + ir * kc + r, packed_b + jr * kc,
+                                                 tile + r * MLC_GEMM_NR);
+                    }
+                }
+                else {
+                    kernels->gemm_micro_kernel(kc, packed_a + ir * kc, packed_b + jr * kc, tile);
+                }
+                mlc_gemm_finish_tile_(tile, c + (ic + ir) * ldc + jr, ldc, mr, nr,
+                                      accumulate, epilogue, col + jr);
+            }
+        }
+    }
+}
+
+/**********************************
+ * Mathematical synopsis of the raw GEMM kernel:
+ *
+ * C[i][j] = Σ_p A[i][p] * B[p][j]      (i < m, j < n, p < k)
+ *
+ * Operates on raw row-major buffers with leading dimensions
+ * lda, ldb and ldc. `workspace` must hold at least
+ * mlc_gemm_workspace_size(m, n, k) floats.
+ * C is overwritten (zeroed when k == 0). This is the building
+ * block used by matrix_mult() and by higher-level code that
+ * wants to manage its own workspace.
+ **********************************/
+static inline void
+mlc_sgemm(size_t m, size_t n, size_t k,
+          const float * a, size_t lda,
+          const float * b, size_t ldb,
+          float * c, size_t ldc,
+          float * workspace)
+{
+    size_t mc_max = mlc_gemm_round_up_(m < MLC_GEMM_MC ? m : MLC_GEMM_MC, MLC_GEMM_MR);
+    size_t kc_max = k < MLC_GEMM_KC ? k : MLC_GEMM_KC;
+    float * packed_a = workspace;
+    float * packed_b = workspace + mc_max * kc_max;
+    const MlcKernels * kernels = mlc_kernels();
+    MLC_PROFILE_BEGIN("mlc_sgemm");
+
+    if (k == 0) mlc_gemm_empty_(m, n, c, ldc, NULL);
+
+    for (size_t jc = 0; jc < n; jc += MLC_GEMM_NC) {
+        size_t nc = (n - jc < MLC_GEMM_NC) ? n - jc : MLC_GEMM_NC;
+
+        for (size_t pc = 0; pc < k; pc += MLC_GEMM_KC) {
+            size_t kc = (k - pc < MLC_GEMM_KC) ? k - pc : MLC_GEMM_KC;
+
+            mlc_gemm_pack_b_(kc, nc, b + pc * ldb + jc, ldb, packed_b);
+            mlc_gemm_macro_(m, nc, kc, a + pc, lda, packed_b, c + jc, ldc, packed_a,
+                            pc != 0, NULL, jc, kernels);
+        }
+    }
+    MLC_PROFILE_END(m * n * k, (m * k + k * n + m * n) * sizeof(float));
+}
+
+/**********************************
+ * Pre-packed B: a (k x n) matrix that is multiplied many times
+ * (the weights of a layer) can be packed once into the panel
+ * layout the micro-kernel reads, instead of on every call.
+ *
+ * mlc_gemm_packed_size() is the number of floats of the packed
+ * matrix, mlc_gemm_pack() fills it, and
+ * mlc_gemm_packed_workspace_size() is the workspace (floats)
+ * mlc_sgemm_packed() needs for up to m rows of A.
+ **********************************/
+static inline size_t
+mlc_gemm_packed_size(size_t k, size_t n)
+{
+    size_t full = n / MLC_GEMM_NC * MLC_GEMM_NC;
+    return (full + mlc_gemm_round_up_(n - full, MLC_GEMM_NR)) * k;
+}
+
+static inline void
+mlc_gemm_pack(size_t k, size_t n, const float * b, size_t ldb, float * packed)
+{
+    for (size_t jc = 0; jc < n; jc += MLC_GEMM_NC) {
+        size_t nc = (n - jc < MLC_GEMM_NC) ? n - jc : MLC_GEMM_NC;
+
+        for (size_t pc = 0; pc < k; pc += MLC_GEMM_KC) {
+            size_t kc = (k - pc < MLC_GEMM_KC) ? k - pc : MLC_GEMM_KC;
+
+            mlc_gemm_pack_b_(kc, nc, b + pc * ldb + jc, ldb, packed);
+            packed += mlc_gemm_round_up_(nc, MLC_GEMM_NR) * kc;
+        }
+    }
+}
+
+static inline size_t
+mlc_gemm_packed_workspace_size(size_t m, size_t k)
+{
+    size_t mc = mlc_gemm_round_up_(m < MLC_GEMM_MC ? m : MLC_GEMM_MC, MLC_GEMM_MR);
+    return mc * (k < MLC_GEMM_KC ? k : MLC_GEMM_KC);
+}
+
+/**********************************
+ * mlc_sgemm() with B from mlc_gemm_pack() and an optional
+ * epilogue (NULL for none):
+ *
+ * C[i][j] = act(Σ_p A[i][p] * B[p][j] + bias[j])
+ *
+ * `workspace` must hold mlc_gemm_packed_workspace_size(m, k)
+ * floats. No memory is allocated. With k == 0 the sum is 0, so
+ * C[i][j] = act(bias[j]).
+ **********************************/
+static inline void
+mlc_sgemm_packed(size_t m, size_t n, size_t k,
+                 const float * a, size_t lda,
+                 const float * packed_b,
+                 float * c, size_t ldc,
+                 float * workspace,
+                 const MlcGemmEpilogue * epilogue)
+{
+    const MlcKernels * kernels = mlc_kernels();
+    MLC_PROFILE_BEGIN("mlc_sgemm_packed");
+
+    if (k == 0) mlc_gemm_empty_(m, n, c, ldc, epilogue);
+
+    for (size_t jc = 0; jc < n; jc += MLC_GEMM_NC) {
+        size_t nc = (n - jc < MLC_GEMM_NC) ? n - jc : MLC_GEMM_NC;
+
+        for (size_t pc = 0; pc < k; pc += MLC_GEMM_KC) {
+            size_t kc = (k - pc < MLC_GEMM_KC) ? k - pc : MLC_GEMM_KC;
+
+            mlc_gemm_macro_(m, nc, kc, a + pc, lda, packed_b, c + jc, ldc, workspace,
+                            pc != 0, (pc + kc == k) ? epilogue : NULL, jc, kernels);
+            packed_b += mlc_gemm_round_up_(nc, MLC_GEMM_NR) * kc;
+        }
+    }
+    MLC_PROFILE_END(m * n * k, (m * k + k * n + m * n) * sizeof(float));
+}
+
+/* Returns 1 if x is a matrix whose rows are contiguous */
+static inline int
+mlc_matrix_rows_ok_(const MlcArray * x)
+{
+    return x->ndims == 2 && x->dtype == MLC_DTYPE_F32 && mlc_stride_(x, 1) == 1;
+}
+
+/**********************************
+ * fp32 operand with contiguous rows: x itself, or a contiguous
+ * fp32 copy of it in *copy (data = NULL if the copy failed). The caller
+ * releases *copy with mlc_finish().
+ **********************************/
+static inline const MlcArray *
+mlc_matrix_operand_(const MlcArray * x, MlcArray * copy)
+{
+    MlcArray empty = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    *copy = empty;
+    if (x->ndims == 2 ? mlc_matrix_rows_ok_(x) : mlc_is_direct_(x)) {
+        return x;
+    }
+    *copy = mlc_cast(x, MLC_DTYPE_F32);
+    return copy;
+}
+
+/**********************************
+ * Mathematical synopsis of matrix multiplication:
+ *
+ * result[i][j] = Σ_p a[i][p] * b[p][j]
+ *
+ * Shapes: a is (m x k), b is (k x n), result is (m x n).
+ * Note: Allocates one packing workspace per call; use mlc_sgemm()
+ * with a preallocated workspace in hot loops.
+ **********************************/
+static inline int
+matrix_mult(MlcArray * a, MlcArray * b, MlcArray * result)
+{
+    if (check_inputs(a) != 0 ||
+        check_inputs(b) != 0 ||
+        check_inputs(result) != 0 ||
+        a->ndims != 2 || b->ndims != 2 || result->ndims != 2 ||
+        a->shape[1] != b->shape[0] ||
+        result->shape[0] != a->shape[0] ||
+        result->shape[1] != b->shape[1] ||
+        !mlc_matrix_rows_ok_(result)
+        ) {
+        LOG_ERROR("Invalid or mismatched matrix shapes");
+        return -1;
+    }
+    size_t m = a->shape[0];
+    size_t k = a->shape[1];
+    size_t n = b->shape[1];
+    MLC_PROFILE_BEGIN("matrix_mult");
+
+    MlcArray a_copy, b_copy;
+    const MlcArray * lhs = mlc_matrix_operand_(a, &a_copy);
+    const MlcArray * rhs = mlc_matrix_operand_(b, &b_copy);
+    size_t bytes = mlc_gemm_round_up_(mlc_gemm_workspace_size(m, n, k) * sizeof(float), 64);
+    float * workspace = (float *)aligned_alloc(64, bytes);
+
+    if (workspace == NULL || lhs->data == NULL || rhs->data == NULL) {
+        LOG_ERROR("Memory allocation failed for GEMM workspace");
+        free(workspace);
+        mlc_finish(&a_copy);
+        mlc_finish(&b_copy);
+        return -1;
+    }
+    mlc_sgemm(m, n, k, lhs->data, mlc_stride_(lhs, 0), rhs->data, mlc_stride_(rhs, 0),
+              result->data, mlc_stride_(result, 0), workspace);
+
+    free(workspace);
+    mlc_finish(&a_copy);
+    mlc_finish(&b_copy);
+    MLC_PROFILE_END(m * n * k, (m * k + k * n + m * n) * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of matrix-vector multiplication:
+ *
+ * result[i] = Σ_j m[i][j] * v[j]
+ *
+ * Shapes: m is (rows x cols), v has cols elements and result
+ * has rows elements (any ndims).
+ * Note: On AVX2 hosts four rows are processed per pass so each
+ * load of v is reused four times (mlc_gemv_rows_() in kernels.h).
+ **********************************/
+static inline int
+matrix_vector_mult(MlcArray * m, MlcArray * v, MlcArray * result)
+{
+    if (check_inputs(m) != 0 ||
+        check_inputs(v) != 0 ||
+        check_inputs(result) != 0 ||
+        m->ndims != 2 ||
+        v->size != m->shape[1] ||
+        result->size != m->shape[0] ||
+        !mlc_is_direct_(result)
+        ) {
+        LOG_ERROR("Invalid or mismatched matrix/vector shapes");
+        return -1;
+    }
+    size_t rows = m->shape[0];
+    size_t cols = m->shape[1];
+    MLC_PROFILE_BEGIN("matrix_vector_mult");
+
+    MlcArray m_copy, v_copy;
+    const MlcArray * mat = mlc_matrix_operand_(m, &m_copy);
+    const MlcArray * vec = mlc_matrix_operand_(v, &v_copy);
+
+    if (mat->data == NULL || vec->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        mlc_finish(&m_copy);
+        mlc_finish(&v_copy);
+        return -1;
+    }
+    mlc_gemv_rows_(rows, cols, mat->data, mlc_stride_(mat, 0), vec->data, result->data);
+    mlc_finish(&m_copy);
+    mlc_finish(&v_copy);
+    MLC_PROFILE_END(rows * cols, (rows * cols + cols + rows) * sizeof(float));
+    return 0;
+}
+
 #endif /* MLC_MATRIX_H */
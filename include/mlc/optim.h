@@ -0,0 +1,249 @@
+/* include/mlc/optim.h */
+
+#ifndef MLC_OPTIM_H
+#define MLC_OPTIM_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Optimizers:
+ *
+ * An MlcOptimizer holds the hyperparameters of SGD, momentum
+ * or Adam; an MlcOptimState holds the moments of one parameter
+ * buffer and its step count. mlc_optim_update() then updates
+ * the parameters in a single fused pass that reads the
+ * gradient, updates the moments, applies weight decay and
+ * writes the parameters back, instead of one vector_scale() /
+ * vector_add() pass per term:
+ *
+ *  - SGD:      p -= lr * (g + wd * p)
+ *  - Momentum: v = mu * v + g + wd * p,  p -= lr * v
+ *  - Adam:     m = b1 m + (1 - b1) g,  v = b2 v + (1 - b2) g^2,
+ *              p -= lr * m^ / (sqrt(v^) + eps) + lr * wd * p
+ *
+ * where m^ and v^ are the bias-corrected moments. Weight decay
+ * is an L2 term for SGD and momentum, and decoupled (AdamW)
+ * for Adam.
+ *
+ * Example:
+ *
+ *   MlcOptimizer opt = mlc_adam(1e-3f, 0.9f, 0.999f, 1e-8f, 0.0f);
+ *   MlcOptimState state;
+ *   mlc_optim_state_init(&state, &opt, weights.size);
+ *   for (each step) {
+ *       ... compute grad ...
+ *       mlc_optim_update(&opt, &state, &weights, &grad);
+ *   }
+ *   mlc_optim_state_finish(&state);
+ *
+ * Large buffers are split across the thread pool. Parameters
+ * and gradients must be contiguous fp32 arrays.
+ *
+ * Functions return -1 on invalid input or allocation failure,
+ * and 0 on success.
+ *************************************************************/
+
+typedef enum
+{
+    MLC_OPTIM_SGD,
+    MLC_OPTIM_MOMENTUM,
+    MLC_OPTIM_ADAM
+}
+MlcOptimKind;
+
+typedef struct
+{
+    MlcOptimKind kind;
+    float lr;
+    float beta1;            /* momentum mu, or Adam b1 */
+    float beta2;            /* Adam b2 */
+    float eps;              /* Adam */
+    float weight_decay;
+}
+MlcOptimizer;
+
+typedef struct
+{
+    float * m;              /* momentum velocity, or Adam first moment */
+    float * v;              /* Adam second moment */
+    size_t size;
+    size_t step;            /* updates applied so far */
+}
+MlcOptimState;
+
+static inline MlcOptimizer
+mlc_sgd(float lr, float weight_decay)
+{
+    MlcOptimizer opt = {MLC_OPTIM_SGD, lr, 0.0f, 0.0f, 0.0f, weight_decay};
+    return opt;
+}
+
+static inline MlcOptimizer
+mlc_momentum(float lr, float mu, float weight_decay)
+{
+    MlcOptimizer opt = {MLC_OPTIM_MOMENTUM, lr, mu, 0.0f, 0.0f, weight_decay};
+    return opt;
+}
+
+static inline MlcOptimizer
+mlc_adam(float lr, float beta1, float beta2, float eps, float weight_decay)
+{
+    MlcOptimizer opt = {MLC_OPTIM_ADAM, lr, beta1, beta2, eps, weight_decay};
+    return opt;
+}
+
+static inline void
+mlc_optim_state_finish(MlcOptimState * state)
+{
+    if (state == NULL) return;
+    free(state->m);
+    free(state->v);
+    state->m = NULL;
+    state->v = NULL;
+    state->size = 0;
+    state->step = 0;
+}
+
+/**********************************
+ * Allocates zeroed moments for `size` parameters: none for
+ * SGD, one buffer for momentum, two for Adam.
+ **********************************/
+static inline int
+mlc_optim_state_init(MlcOptimState * state, const MlcOptimizer * opt, size_t size)
+{
+    if (state == NULL || opt == NULL || size == 0) {
+        LOG_ERROR("Invalid optimizer state");
+        return -1;
+    }
+    memset(state, 0, sizeof(*state));
+    state->size = size;
+    if (opt->kind != MLC_OPTIM_SGD) {
+        state->m = (float *)calloc(size, sizeof(float));
+    }
+    if (opt->kind == MLC_OPTIM_ADAM) {
+        state->v = (float *)calloc(size, sizeof(float));
+    }
+    if ((opt->kind != MLC_OPTIM_SGD && state->m == NULL) ||
+        (opt->kind == MLC_OPTIM_ADAM && state->v == NULL)) {
+        LOG_ERROR("Memory allocation failed for optimizer state");
+        mlc_optim_state_finish(state);
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************
+ * Parallel driver: the step's scalars are computed once, each
+ * thread runs the fused span kernel over its range.
+ **********************************/
+typedef struct
+{
+    MlcOptimKind kind;
+    float * p;
+    const float * g;
+    float * m;
+    float * v;
+    float lr, beta1, beta2, eps, keep, decay;
+}
+MlcOptimJob_;
+
+static inline void
+mlc_optim_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcOptimJob_ * job = (const MlcOptimJob_ *)ctx;
+    size_t n = end - begin;
+    (void)part;
+
+    switch (job->kind)
+    {
+        case MLC_OPTIM_SGD:
+            mlc_sgd_span_(job->p + begin, job->g + begin, n, job->lr, job->keep);
+            break;
+        case MLC_OPTIM_MOMENTUM:
+            mlc_momentum_span_(job->p + begin, job->g + begin, job->m + begin, n,
+                               job->lr, job->beta1, job->decay);
+            break;
+        case MLC_OPTIM_ADAM:
+            mlc_adam_span_(job->p + begin, job->g + begin, job->m + begin, job->v + begin, n,
+                           job->lr, job->beta1, job->beta2, job->eps, job->keep);
+            break;
+    }
+}
+
+/* One update of n parameters from raw buffers; the checks are the caller's */
+static inline void
+mlc_optim_apply_(const MlcOptimizer * opt, MlcOptimState * state, float * p, const float * g, size_t n)
+{
+    MlcOptimJob_ job;
+
+    state->step++;
+    job.kind = opt->kind;
+    job.p = p;
+    job.g = g;
+    job.m = state->m;
+    job.v = state->v;
+    job.lr = opt->lr;
+    job.beta1 = opt->beta1;
+    job.beta2 = opt->beta2;
+    job.eps = opt->eps;
+    job.keep = 1.0f - opt->lr * opt->weight_decay;
+    job.decay = opt->weight_decay;
+
+    if (opt->kind == MLC_OPTIM_ADAM) {
+        /* Bias corrections folded into the step size and epsilon */
+        double c1 = 1.0 - pow((double)opt->beta1, (double)state->step);
+        double c2 = sqrt(1.0 - pow((double)opt->beta2, (double)state->step));
+
+        job.lr = (float)(opt->lr * c2 / c1);
+        job.eps = (float)(opt->eps * c2);
+    }
+    mlc_parallel_for(n, mlc_parallel_grain(1), mlc_optim_range_, &job);
+}
+
+/**********************************
+ * Mathematical synopsis of an optimizer update (see the top of
+ * this file for each rule):
+ *
+ * param = update(param, grad, state)
+ *
+ * Arguments:
+ *  - opt: Hyperparameters.
+ *  - state: Moments of `param`, from mlc_optim_state_init()
+ *    with the same optimizer and size.
+ *  - param: Parameters, updated in place.
+ *  - grad: Gradient of the loss with respect to param.
+ **********************************/
+static inline int
+mlc_optim_update(const MlcOptimizer * opt, MlcOptimState * state, MlcArray * param, MlcArray * grad)
+{
+    if (opt == NULL || state == NULL ||
+        check_inputs(param) != 0 ||
+        check_inputs(grad) != 0 ||
+        param->size != grad->size ||
+        param->size != state->size ||
+        !mlc_is_direct_(param) ||
+        !mlc_is_direct_(grad) ||
+        (opt->kind != MLC_OPTIM_SGD && state->m == NULL) ||
+        (opt->kind == MLC_OPTIM_ADAM && state->v == NULL)
+        ) {
+        LOG_ERROR("Invalid optimizer state or mismatched array sizes");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_optim_update");
+
+    mlc_optim_apply_(opt, state, param->data, grad->data, param->size);
+    MLC_PROFILE_END(param->size, (opt->kind == MLC_OPTIM_ADAM ? 7 :
+                                  opt->kind == MLC_OPTIM_MOMENTUM ? 5 : 3) *
+                                 param->size * sizeof(float));
+    return 0;
+}
+
+#endif /* MLC_OPTIM_H */
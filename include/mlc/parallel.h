@@ -0,0 +1,285 @@
+/* include/mlc/parallel.h */
+
+#ifndef MLC_PARALLEL_H
+#define MLC_PARALLEL_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Thread pool:
+ *
+ * A persistent pool of worker threads that the element-wise
+ * kernels (activations.h, vector.h, pipeline.h) and the CSV
+ * loader hand their ranges to. The pool is started lazily on
+ * the first call that is large enough to be split, and the
+ * calling thread always takes part in the work.
+ *
+ * Thread count:
+ *  - mlc_set_num_threads(n) at run time (0 = automatic), or
+ *  - the MLC_NUM_THREADS environment variable, or
+ *  - the number of online CPUs,
+ * capped at MLC_MAX_THREADS.
+ *
+ * Work on fewer than mlc_get_parallel_threshold() elements
+ * (MLC_PARALLEL_THRESHOLD by default) stays on the calling
+ * thread, where the cost of waking the pool would dominate.
+ *
+ * Ranges are split statically into one contiguous part per
+ * thread, so reductions combine their partial results in a
+ * fixed order. Calls made from inside a worker, or while the
+ * pool is busy with another caller, simply run serially.
+ *
+ * Note: as with the rest of this header-only library, every
+ * translation unit gets its own pool and settings.
+ *************************************************************/
+
+#ifndef MLC_MAX_THREADS
+    #define MLC_MAX_THREADS 64
+#endif
+#ifndef MLC_PARALLEL_THRESHOLD
+    #define MLC_PARALLEL_THRESHOLD (1u << 15)
+#endif
+
+/**********************************
+ * Range callback: process [begin, end) of the work. `part` is
+ * the index (0 .. parts-1) of this slice, used to address
+ * per-thread partial results.
+ **********************************/
+typedef void (*MlcRangeFn)(void * ctx, size_t begin, size_t end, size_t part);
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_mutex_t dispatch;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_t threads[MLC_MAX_THREADS];
+    size_t started;         /* worker threads running (excluding the caller) */
+    size_t requested;       /* 0 = automatic */
+    size_t automatic;       /* cached automatic count, 0 = not probed yet */
+    size_t threshold;
+    unsigned long generation;
+    unsigned long start_generation; /* generation when workers were started */
+    size_t pending;
+    int stop;
+
+    /* current job */
+    MlcRangeFn fn;
+    void * ctx;
+    size_t n;
+    size_t parts;
+    size_t chunk;
+}
+MlcThreadPool_;
+
+static MlcThreadPool_ mlc_pool_ = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    {0}, 0, 0, 0, MLC_PARALLEL_THRESHOLD, 0, 0, 0, 0,
+    NULL, NULL, 0, 0, 0
+};
+
+static __thread int mlc_in_worker_ = 0;
+
+/* Threads the pool would use, the caller included. */
+static inline size_t
+mlc_get_num_threads(void)
+{
+    size_t n = mlc_pool_.requested;
+
+    if (n == 0) n = mlc_pool_.automatic;
+    if (n == 0) {
+        /* Probed once: sysconf() reads /sys and costs microseconds */
+        const char * env = getenv("MLC_NUM_THREADS");
+        long value = env ? strtol(env, NULL, 10) : 0;
+
+        if (value <= 0) value = sysconf(_SC_NPROCESSORS_ONLN);
+        n = (value > 0) ? (size_t)value : 1;
+        mlc_pool_.automatic = n;
+    }
+    return (n > MLC_MAX_THREADS) ? MLC_MAX_THREADS : n;
+}
+
+static inline void
+mlc_set_parallel_threshold(size_t elements)
+{
+    mlc_pool_.threshold = elements;
+}
+
+static inline size_t
+mlc_get_parallel_threshold(void)
+{
+    return mlc_pool_.threshold;
+}
+
+static inline void
+mlc_pool_run_part_(size_t part)
+{
+    size_t begin = part * mlc_pool_.chunk;
+    size_t end = begin + mlc_pool_.chunk;
+
+    if (end > mlc_pool_.n) end = mlc_pool_.n;
+    if (begin < end) {
+        mlc_pool_.fn(mlc_pool_.ctx, begin, end, part);
+    }
+}
+
+static inline void *
+mlc_pool_worker_(void * arg)
+{
+    size_t part = (size_t)arg;
+    unsigned long seen;
+
+    mlc_in_worker_ = 1;
+    pthread_mutex_lock(&mlc_pool_.lock);
+    /* A job may already have been posted before this thread ran */
+    seen = mlc_pool_.start_generation;
+
+    for (;;) {
+        while (mlc_pool_.generation == seen && !mlc_pool_.stop) {
+            pthread_cond_wait(&mlc_pool_.wake, &mlc_pool_.lock);
+        }
+        if (mlc_pool_.stop) break;
+        seen = mlc_pool_.generation;
+        pthread_mutex_unlock(&mlc_pool_.lock);
+
+        if (part < mlc_pool_.parts) {
+            mlc_pool_run_part_(part);
+        }
+
+        pthread_mutex_lock(&mlc_pool_.lock);
+        if (--mlc_pool_.pending == 0) {
+            pthread_cond_signal(&mlc_pool_.done);
+        }
+    }
+    pthread_mutex_unlock(&mlc_pool_.lock);
+    return NULL;
+}
+
+/**********************************
+ * Stops and joins the worker threads. The pool restarts on the
+ * next parallel call; this is mainly useful before fork() or
+ * to leave no threads behind for leak checkers.
+ **********************************/
+static inline void
+mlc_parallel_shutdown(void)
+{
+    pthread_mutex_lock(&mlc_pool_.dispatch);
+    pthread_mutex_lock(&mlc_pool_.lock);
+    mlc_pool_.stop = 1;
+    pthread_cond_broadcast(&mlc_pool_.wake);
+    pthread_mutex_unlock(&mlc_pool_.lock);
+
+    for (size_t t = 0; t < mlc_pool_.started; ++t) {
+        pthread_join(mlc_pool_.threads[t], NULL);
+    }
+    mlc_pool_.started = 0;
+    mlc_pool_.stop = 0;
+    pthread_mutex_unlock(&mlc_pool_.dispatch);
+}
+
+/**********************************
+ * Sets the number of threads (caller included) used from now
+ * on; 0 restores the automatic choice. Running workers are
+ * stopped and the pool restarts lazily at the new size.
+ **********************************/
+static inline void
+mlc_set_num_threads(size_t n)
+{
+    mlc_parallel_shutdown();
+    mlc_pool_.requested = n;
+}
+
+/* Starts workers 1 .. threads-1; called with `dispatch` held. */
+static inline void
+mlc_pool_start_(size_t threads)
+{
+    pthread_mutex_lock(&mlc_pool_.lock);
+    mlc_pool_.start_generation = mlc_pool_.generation;
+    while (mlc_pool_.started + 1 < threads) {
+        size_t part = mlc_pool_.started + 1;
+
+        if (pthread_create(&mlc_pool_.threads[mlc_pool_.started], NULL,
+                           mlc_pool_worker_, (void *)part) != 0) {
+            LOG_ERROR("Failed to start worker thread");
+            break;
+        }
+        mlc_pool_.started++;
+    }
+    pthread_mutex_unlock(&mlc_pool_.lock);
+}
+
+/**********************************
+ * Runs fn over [0, n), split into at most one contiguous part
+ * per thread of at least `grain` items each. Returns once every
+ * part has finished. With a single part, fn runs directly on
+ * the calling thread as fn(ctx, 0, n, 0).
+ **********************************/
+static inline void
+mlc_parallel_for(size_t n, size_t grain, MlcRangeFn fn, void * ctx)
+{
+    size_t threads = 1;
+    size_t parts;
+
+    if (grain == 0) grain = 1;
+    parts = (n + grain - 1) / grain;
+    if (parts > 1 && !mlc_in_worker_) threads = mlc_get_num_threads();
+    if (parts > threads) parts = threads;
+
+    if (parts <= 1 || pthread_mutex_trylock(&mlc_pool_.dispatch) != 0) {
+        if (n > 0) fn(ctx, 0, n, 0);
+        return;
+    }
+    if (mlc_pool_.started + 1 < threads) {
+        mlc_pool_start_(threads);
+    }
+    if (parts > mlc_pool_.started + 1) {
+        parts = mlc_pool_.started + 1;
+    }
+    size_t chunk = (n + parts - 1) / parts;
+
+    /* Keep large slices on separate cache lines */
+    if (chunk >= 64) chunk = (chunk + 15) & ~(size_t)15;
+
+    pthread_mutex_lock(&mlc_pool_.lock);
+    mlc_pool_.fn = fn;
+    mlc_pool_.ctx = ctx;
+    mlc_pool_.n = n;
+    mlc_pool_.parts = parts;
+    mlc_pool_.chunk = chunk;
+    mlc_pool_.pending = mlc_pool_.started;
+    mlc_pool_.generation++;
+    pthread_cond_broadcast(&mlc_pool_.wake);
+    pthread_mutex_unlock(&mlc_pool_.lock);
+
+    mlc_in_worker_ = 1;
+    mlc_pool_run_part_(0);
+    mlc_in_worker_ = 0;
+
+    pthread_mutex_lock(&mlc_pool_.lock);
+    while (mlc_pool_.pending > 0) {
+        pthread_cond_wait(&mlc_pool_.done, &mlc_pool_.lock);
+    }
+    pthread_mutex_unlock(&mlc_pool_.lock);
+    pthread_mutex_unlock(&mlc_pool_.dispatch);
+}
+
+/**********************************
+ * Grain (in items) for work over items of `item_size` elements
+ * each, so that every part gets at least one threshold's worth
+ * of elements.
+ **********************************/
+static inline size_t
+mlc_parallel_grain(size_t item_size)
+{
+    size_t threshold = mlc_pool_.threshold;
+
+    if (item_size == 0) item_size = 1;
+    return (threshold + item_size - 1) / item_size;
+}
+
+#endif /* MLC_PARALLEL_H */
@@ -0,0 +1,296 @@
+/* include/mlc/pipeline.h */
+
+#ifndef MLC_PIPELINE_H
+#define MLC_PIPELINE_H
+
+#include <stddef.h>
+#include <mlc/data.h>
+#include <mlc/activations.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Fused element-wise pipelines:
+ *
+ * Calling relu(), vector_scale() and sigmoid() one after the
+ * other streams the whole array through memory once per call.
+ * An MlcChain records a short list of element-wise operations
+ * and mlc_chain_run() applies all of them tile by tile, so each
+ * tile of MLC_CHAIN_TILE floats is loaded once, transformed by
+ * every op while it sits in L1, and written back once. For
+ * arrays larger than the caches this turns N passes into one.
+ * Large arrays are additionally split across the thread pool
+ * (parallel.h), each thread running the chain on its own tiles.
+ *
+ * Example (scale -> add bias -> leaky_relu -> sigmoid):
+ *
+ *   MlcChain chain;
+ *   mlc_chain_init(&chain);
+ *   mlc_chain_push(&chain, MLC_OP_SCALE, 0.5f);
+ *   mlc_chain_push_bias(&chain, &bias);
+ *   mlc_chain_push(&chain, MLC_OP_LEAKY_RELU, 0.01f);
+ *   mlc_chain_push(&chain, MLC_OP_SIGMOID, 0.0f);
+ *   mlc_chain_run(&chain, &array);
+ *
+ * Functions return -1 on invalid input (NULL chain or array,
+ * full chain, mismatched bias). Otherwise, they return 0.
+ *************************************************************/
+
+#ifndef MLC_CHAIN_MAX_OPS
+    #define MLC_CHAIN_MAX_OPS 16
+#endif
+#ifndef MLC_CHAIN_TILE
+    #define MLC_CHAIN_TILE 2048    /* floats per tile (8 KB) */
+#endif
+
+/**********************************
+ * Element-wise operations and the meaning of `param`:
+ *
+ *  - MLC_OP_SCALE:      x = param * x
+ *  - MLC_OP_ADD:        x = x + param
+ *  - MLC_OP_BIAS:       x = x + bias[j]  (see mlc_chain_push_bias)
+ *  - MLC_OP_RELU:       relu(x)
+ *  - MLC_OP_LEAKY_RELU: leaky_relu(x), alpha = param
+ *  - MLC_OP_SIGMOID:    sigmoid(x)
+ *  - MLC_OP_TANH:       tanh(x)
+ *  - MLC_OP_SWISH:      swish(x)
+ **********************************/
+typedef enum
+{
+    MLC_OP_SCALE,
+    MLC_OP_ADD,
+    MLC_OP_BIAS,
+    MLC_OP_RELU,
+    MLC_OP_LEAKY_RELU,
+    MLC_OP_SIGMOID,
+    MLC_OP_TANH,
+    MLC_OP_SWISH
+}
+MlcOpType;
+
+typedef struct
+{
+    MlcOpType type;
+    float param;
+    const MlcArray * operand;
+}
+MlcOp;
+
+typedef struct
+{
+    MlcOp ops[MLC_CHAIN_MAX_OPS];
+    size_t count;
+}
+MlcChain;
+
+static inline void
+mlc_chain_init(MlcChain * chain)
+{
+    if (chain != NULL) {
+        chain->count = 0;
+    }
+}
+
+/**********************************
+ * Appends a scalar operation to the chain.
+ *
+ * Arguments:
+ *  - chain: Chain to extend.
+ *  - type: Any MlcOpType except MLC_OP_BIAS.
+ *  - param: Scale factor, addend or leaky ReLU alpha (ignored
+ *    by the other ops).
+ **********************************/
+static inline int
+mlc_chain_push(MlcChain * chain, MlcOpType type, float param)
+{
+    if (chain == NULL || chain->count >= MLC_CHAIN_MAX_OPS || type == MLC_OP_BIAS) {
+        LOG_ERROR("Invalid chain or operation");
+        return -1;
+    }
+    chain->ops[chain->count].type = type;
+    chain->ops[chain->count].param = param;
+    chain->ops[chain->count].operand = NULL;
+    chain->count++;
+    return 0;
+}
+
+/**********************************
+ * Appends a bias addition to the chain.
+ *
+ * The bias is broadcast along the flat data: element i of the
+ * array gets bias[i % bias->size]. A bias with as many elements
+ * as the last dimension is therefore added to every row, and a
+ * bias of the same size as the array is added element-wise.
+ * mlc_chain_run() rejects any other size unless it divides the
+ * last dimension (repeated along each row).
+ * The bias must be a contiguous fp32 array, and stay alive
+ * until the chain has run.
+ **********************************/
+static inline int
+mlc_chain_push_bias(MlcChain * chain, const MlcArray * bias)
+{
+    if (chain == NULL || chain->count >= MLC_CHAIN_MAX_OPS ||
+        bias == NULL || bias->data == NULL || bias->size == 0 || !mlc_is_direct_(bias)) {
+        LOG_ERROR("Invalid chain or bias");
+        return -1;
+    }
+    chain->ops[chain->count].type = MLC_OP_BIAS;
+    chain->ops[chain->count].param = 0.0f;
+    chain->ops[chain->count].operand = bias;
+    chain->count++;
+    return 0;
+}
+
+/* x[0..n) += bias[(offset + i) % bias_size], without a modulo per element */
+static inline void
+mlc_bias_span_(float * x, size_t n, size_t offset, const float * bias, size_t bias_size)
+{
+    size_t j = offset % bias_size;
+
+    while (n > 0) {
+        size_t run = bias_size - j;
+        if (run > n) run = n;
+
+        mlc_add_span_(x, bias + j, x, run);
+        x += run;
+        n -= run;
+        j = 0;
+    }
+}
+
+/**********************************
+ * Applies every op of the chain to x[0..n), where x starts at
+ * flat index `offset` of the array (used to line up biases).
+ **********************************/
+static inline void
+mlc_chain_apply_span_(const MlcChain * chain, float * x, size_t n, size_t offset)
+{
+    for (size_t o = 0; o < chain->count; ++o) {
+        const MlcOp * op = &chain->ops[o];
+        const float param = op->param;    /* local copy, x may alias the chain */
+
+        switch (op->type)
+        {
+            case MLC_OP_SCALE:
+                mlc_scale_span_(x, n, param);
+                break;
+            case MLC_OP_ADD:
+                mlc_add_scalar_span_(x, n, param);
+                break;
+            case MLC_OP_BIAS:
+                mlc_bias_span_(x, n, offset, op->operand->data, op->operand->size);
+                break;
+            case MLC_OP_RELU:
+                mlc_relu_span_(x, n);
+                break;
+            case MLC_OP_LEAKY_RELU:
+                mlc_leaky_relu_span_(x, n, param);
+                break;
+            case MLC_OP_SIGMOID:
+                mlc_sigmoid_span_(x, n);
+                break;
+            case MLC_OP_TANH:
+                mlc_tanh_span_(x, n);
+                break;
+            case MLC_OP_SWISH:
+                mlc_swish_span_(x, n);
+                break;
+        }
+    }
+}
+
+typedef struct
+{
+    const MlcChain * chain;
+    float * data;
+    const MlcArray * array;     /* strided path */
+}
+MlcChainJob_;
+
+static inline void
+mlc_chain_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcChainJob_ * job = (MlcChainJob_ *)ctx;
+    (void)part;
+
+    for (size_t start = begin; start < end; start += MLC_CHAIN_TILE) {
+        size_t n = end - start;
+        if (n > MLC_CHAIN_TILE) n = MLC_CHAIN_TILE;
+
+        mlc_chain_apply_span_(job->chain, job->data + start, n, start);
+    }
+}
+
+/* Same over logical positions [begin, end) of a strided or fp16/bf16 array */
+static inline void
+mlc_chain_strided_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcChainJob_ * job = (MlcChainJob_ *)ctx;
+    const MlcArray * array = job->array;
+    float tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t pos = begin; pos < end;) {
+        size_t n, stride;
+        float * x = mlc_view_run_(array, pos, end, &n, &stride);
+
+        for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+            size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+            float * xi = mlc_view_advance_(array, x, i * stride);
+
+            if (stride == 1 && array->dtype == MLC_DTYPE_F32) {
+                mlc_chain_apply_span_(job->chain, xi, m, pos + i);
+                continue;
+            }
+            mlc_view_load_(array, xi, m, stride, tile);
+            mlc_chain_apply_span_(job->chain, tile, m, pos + i);
+            mlc_view_store_(array, xi, m, stride, tile);
+        }
+        pos += n;
+    }
+}
+
+/* Returns 1 if every bias of the chain lines up with the rows of array */
+static inline int
+mlc_chain_bias_ok_(const MlcChain * chain, const MlcArray * array)
+{
+    size_t last = array->shape[array->ndims - 1];
+
+    for (size_t i = 0; i < chain->count; ++i) {
+        const MlcArray * bias = chain->ops[i].operand;
+
+        if (chain->ops[i].type == MLC_OP_BIAS &&
+            bias->size != array->size && last % bias->size != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**********************************
+ * Runs the chain over the array in-place, one cache-resident
+ * tile at a time. Strided views are walked row by row, biases
+ * lining up with the logical (row-major) position.
+ **********************************/
+static inline int
+mlc_chain_run(const MlcChain * chain, MlcArray * array)
+{
+    if (chain == NULL || check_inputs(array) != 0) {
+        LOG_ERROR("Invalid chain or array");
+        return -1;
+    }
+    if (!mlc_chain_bias_ok_(chain, array)) {
+        LOG_ERROR("Chain bias size must divide the last dimension or match the array size");
+        return -1;
+    }
+    MlcChainJob_ job = {chain, array->data, array};
+    MLC_PROFILE_BEGIN("mlc_chain_run");
+
+    mlc_parallel_for(array->size, mlc_parallel_grain(1),
+                     mlc_is_direct_(array) ? mlc_chain_range_ : mlc_chain_strided_range_, &job);
+    MLC_PROFILE_END(array->size, 2 * array->size * sizeof(float));
+    return 0;
+}
+
+#endif /* MLC_PIPELINE_H */
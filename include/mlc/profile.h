@@ -0,0 +1,275 @@
+/* include/mlc/profile.h */
+
+#ifndef MLC_PROFILE_H
+#define MLC_PROFILE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*************************************************************
+ * Opt-in profiling hooks:
+ *
+ * Define MLC_PROFILE before including any MLC header (or pass
+ * -DMLC_PROFILE) and every public kernel records, per
+ * operation name:
+ *  - the number of successful calls,
+ *  - the elements processed and nominal bytes touched,
+ *  - the cumulative wall time in nanoseconds.
+ *
+ * Counters are thread-local, so recording never takes a lock;
+ * mlc_profile_report() and mlc_profile_get() sum them over
+ * every thread that has called a kernel (threads that have
+ * exited included). Call them while no kernel is running.
+ *
+ * Timings are inclusive: a kernel that calls another public
+ * kernel (matrix_mult() calling mlc_sgemm(), for instance)
+ * counts the inner call's time in both entries.
+ *
+ * Without MLC_PROFILE the hooks expand to nothing, and
+ * mlc_profile_report()/mlc_profile_reset() are empty, so
+ * application code can call them unconditionally.
+ *
+ * Example:
+ *   #define MLC_PROFILE
+ *   #include <mlc/activations.h>
+ *   ...
+ *   mlc_profile_report(stderr);
+ *************************************************************/
+
+typedef struct
+{
+    unsigned long long calls;
+    unsigned long long elements;
+    unsigned long long bytes;
+    unsigned long long nanoseconds;
+}
+MlcProfileCounter;
+
+#ifdef MLC_PROFILE
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#ifndef MLC_PROFILE_MAX_OPS
+    #define MLC_PROFILE_MAX_OPS 64
+#endif
+
+/* One block of counters per thread, linked into a global list */
+typedef struct MlcProfileThread_
+{
+    MlcProfileCounter counters[MLC_PROFILE_MAX_OPS];
+    struct MlcProfileThread_ * next;
+}
+MlcProfileThread_;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    const char * names[MLC_PROFILE_MAX_OPS];
+    int count;
+    MlcProfileThread_ * threads;
+}
+MlcProfileRegistry_;
+
+static MlcProfileRegistry_ mlc_profile_ = {PTHREAD_MUTEX_INITIALIZER, {NULL}, 0, NULL};
+static __thread MlcProfileThread_ * mlc_profile_local_ = NULL;
+
+static inline unsigned long long
+mlc_profile_now_(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+/* Looks up (or adds) `name` once per call site; -1 if the table is full */
+static inline int
+mlc_profile_slot_(int * slot, const char * name)
+{
+    int id = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+    if (id >= 0) return id;
+
+    pthread_mutex_lock(&mlc_profile_.lock);
+    for (int i = 0; i < mlc_profile_.count; ++i) {
+        if (strcmp(mlc_profile_.names[i], name) == 0) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0 && mlc_profile_.count < MLC_PROFILE_MAX_OPS) {
+        id = mlc_profile_.count++;
+        mlc_profile_.names[id] = name;
+    }
+    if (id >= 0) __atomic_store_n(slot, id, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&mlc_profile_.lock);
+    return id;
+}
+
+static inline MlcProfileThread_ *
+mlc_profile_thread_(void)
+{
+    if (mlc_profile_local_ == NULL) {
+        MlcProfileThread_ * block = (MlcProfileThread_ *)calloc(1, sizeof(MlcProfileThread_));
+        if (block == NULL) return NULL;
+
+        pthread_mutex_lock(&mlc_profile_.lock);
+        block->next = mlc_profile_.threads;
+        mlc_profile_.threads = block;
+        pthread_mutex_unlock(&mlc_profile_.lock);
+        mlc_profile_local_ = block;
+    }
+    return mlc_profile_local_;
+}
+
+static inline unsigned long long
+mlc_profile_begin_(int * slot, const char * name)
+{
+    mlc_profile_slot_(slot, name);
+    return mlc_profile_now_();
+}
+
+static inline void
+mlc_profile_end_(int slot, unsigned long long start, size_t elements, size_t bytes)
+{
+    unsigned long long elapsed = mlc_profile_now_() - start;
+    MlcProfileThread_ * local = mlc_profile_thread_();
+
+    if (slot < 0 || local == NULL) return;
+
+    MlcProfileCounter * counter = &local->counters[slot];
+    counter->calls++;
+    counter->elements += elements;
+    counter->bytes += bytes;
+    counter->nanoseconds += elapsed;
+}
+
+/**********************************
+ * Hooks placed in the kernels: BEGIN at the start of the work,
+ * END on the successful return path.
+ **********************************/
+#define MLC_PROFILE_BEGIN(name) \
+    static int mlc_profile_site_ = -1; \
+    unsigned long long mlc_profile_start_ = mlc_profile_begin_(&mlc_profile_site_, name)
+
+#define MLC_PROFILE_END(elements, bytes) \
+    mlc_profile_end_(mlc_profile_site_, mlc_profile_start_, (size_t)(elements), (size_t)(bytes))
+
+/**********************************
+ * Sums the counters of operation `name` over all threads.
+ * Returns -1 if the operation has not been called yet.
+ **********************************/
+static inline int
+mlc_profile_get(const char * name, MlcProfileCounter * out)
+{
+    int id = -1;
+
+    if (name == NULL || out == NULL) return -1;
+    memset(out, 0, sizeof(*out));
+
+    pthread_mutex_lock(&mlc_profile_.lock);
+    for (int i = 0; i < mlc_profile_.count; ++i) {
+        if (strcmp(mlc_profile_.names[i], name) == 0) id = i;
+    }
+    for (MlcProfileThread_ * t = mlc_profile_.threads; id >= 0 && t != NULL; t = t->next) {
+        out->calls += t->counters[id].calls;
+        out->elements += t->counters[id].elements;
+        out->bytes += t->counters[id].bytes;
+        out->nanoseconds += t->counters[id].nanoseconds;
+    }
+    pthread_mutex_unlock(&mlc_profile_.lock);
+    return (id >= 0) ? 0 : -1;
+}
+
+/* Zeroes every counter; operation names stay registered. */
+static inline void
+mlc_profile_reset(void)
+{
+    pthread_mutex_lock(&mlc_profile_.lock);
+    for (MlcProfileThread_ * t = mlc_profile_.threads; t != NULL; t = t->next) {
+        memset(t->counters, 0, sizeof(t->counters));
+    }
+    pthread_mutex_unlock(&mlc_profile_.lock);
+}
+
+/**********************************
+ * Prints one line per operation that has been called, sorted
+ * by total time: calls, elements, MB touched, total and mean
+ * time, ns/element and GB/s.
+ **********************************/
+static inline void
+mlc_profile_report(FILE * out)
+{
+    MlcProfileCounter totals[MLC_PROFILE_MAX_OPS];
+    int order[MLC_PROFILE_MAX_OPS];
+    int count;
+
+    if (out == NULL) out = stderr;
+
+    pthread_mutex_lock(&mlc_profile_.lock);
+    count = mlc_profile_.count;
+    memset(totals, 0, sizeof(totals));
+    for (MlcProfileThread_ * t = mlc_profile_.threads; t != NULL; t = t->next) {
+        for (int i = 0; i < count; ++i) {
+            totals[i].calls += t->counters[i].calls;
+            totals[i].elements += t->counters[i].elements;
+            totals[i].bytes += t->counters[i].bytes;
+            totals[i].nanoseconds += t->counters[i].nanoseconds;
+        }
+    }
+    pthread_mutex_unlock(&mlc_profile_.lock);
+
+    /* Insertion sort by total time, largest first */
+    for (int i = 0; i < count; ++i) {
+        int j = i;
+        while (j > 0 && totals[order[j - 1]].nanoseconds < totals[i].nanoseconds) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    fprintf(out, "%-20s %10s %14s %12s %12s %10s %10s %8s\n",
+            "operation", "calls", "elements", "MB", "total ms", "mean us", "ns/elem", "GB/s");
+    for (int r = 0; r < count; ++r) {
+        const MlcProfileCounter * c = &totals[order[r]];
+        double ns = (double)c->nanoseconds;
+
+        if (c->calls == 0) continue;
+        fprintf(out, "%-20s %10llu %14llu %12.1f %12.3f %10.2f %10.3f %8.2f\n",
+                mlc_profile_.names[order[r]], c->calls, c->elements,
+                (double)c->bytes / 1e6, ns / 1e6, ns / 1e3 / (double)c->calls,
+                c->elements ? ns / (double)c->elements : 0.0,
+                ns > 0.0 ? (double)c->bytes / ns : 0.0);
+    }
+}
+
+#else /* !MLC_PROFILE */
+
+#define MLC_PROFILE_BEGIN(name) do {} while (0)
+#define MLC_PROFILE_END(elements, bytes) do {} while (0)
+
+static inline int
+mlc_profile_get(const char * name, MlcProfileCounter * out)
+{
+    (void)name;
+    (void)out;
+    return -1;
+}
+
+static inline void
+mlc_profile_reset(void)
+{
+}
+
+static inline void
+mlc_profile_report(FILE * out)
+{
+    (void)out;
+}
+
+#endif /* MLC_PROFILE */
+
+#endif /* MLC_PROFILE_H */
@@ -0,0 +1,712 @@
+/* include/mlc/quant.h */
+
+#ifndef MLC_QUANT_H
+#define MLC_QUANT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/simd_math.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Int8 quantization:
+ *
+ * An MlcQuantArray stores a tensor as int8 values q with a
+ * scale s and a zero point z per group, x ~= (q - z) * s:
+ *
+ *  - MLC_QUANT_PER_TENSOR: one group for the whole tensor.
+ *  - MLC_QUANT_PER_ROW: one group per row along the last
+ *    dimension (one per output channel for a weight matrix).
+ *
+ *  - MLC_QUANT_SYMMETRIC: z = 0, s = max|x| / 127.
+ *  - MLC_QUANT_ASYMMETRIC: [min(x, 0), max(x, 0)] is mapped
+ *    onto [-127, 127]; suits one-sided data such as the output
+ *    of relu().
+ *
+ * Values are kept in [-127, 127] (never -128), so the int8
+ * products can use the AVX2 vpmaddubsw sign trick without
+ * saturating. At the AVX-512 level (dispatch.h) the products
+ * are summed with vpdpbusd (VNNI); the SSE2 path widens to
+ * int16 and uses pmaddwd. Products are accumulated in int32 per
+ * block of MLC_QUANT_BLOCK values and in int64 across blocks,
+ * so no length can overflow.
+ *
+ *   MlcQuantArray w = mlc_quantize(&weights, MLC_QUANT_SYMMETRIC, MLC_QUANT_PER_ROW);
+ *   MlcQuantArray x = mlc_quantize(&input, MLC_QUANT_ASYMMETRIC, MLC_QUANT_PER_TENSOR);
+ *   mlc_quant_matvec(&w, &x, &output);       // fp32 output
+ *   ...
+ *   mlc_quant_finish(&w);
+ *
+ * The input of mlc_quantize() may be any MlcArray, strided
+ * views and fp16/bf16 storage included. Functions return -1
+ * (-1.0f for mlc_quant_dot(), data = NULL for arrays) on error.
+ *************************************************************/
+
+#define MLC_QUANT_MAX 127
+
+typedef enum
+{
+    MLC_QUANT_SYMMETRIC,
+    MLC_QUANT_ASYMMETRIC
+}
+MlcQuantMode;
+
+typedef enum
+{
+    MLC_QUANT_PER_TENSOR,
+    MLC_QUANT_PER_ROW
+}
+MlcQuantGranularity;
+
+/**********************************
+ * Quantized tensor.
+ *
+ * Fields:
+ *  - data: size int8 values, row-major.
+ *  - ndims, shape, size: As in MlcArray.
+ *  - rows, cols: size / shape[ndims - 1] rows of shape[ndims - 1].
+ *  - groups: 1 (per tensor) or rows (per row).
+ *  - scales, zero_points: One entry per group.
+ *  - row_sums: Σ q over each row, used for zero-point
+ *    corrections in the dot products.
+ **********************************/
+typedef struct
+{
+    int8_t * data;
+    size_t ndims;
+    size_t * shape;
+    size_t size;
+    size_t rows;
+    size_t cols;
+    size_t groups;
+    float * scales;
+    int32_t * zero_points;
+    int64_t * row_sums;
+}
+MlcQuantArray;
+
+/**********************************
+ * Allocates an uninitialized quantized tensor: scales are 1,
+ * zero points and row sums 0. Used for the outputs of
+ * mlc_quant_matvec_requant(), whose scale and zero point the
+ * caller then sets. Release with mlc_quant_finish().
+ **********************************/
+static inline MlcQuantArray
+mlc_quant_alloc(size_t ndims, const size_t * shape, MlcQuantGranularity granularity)
+{
+    MlcQuantArray q;
+    size_t size = 1;
+
+    memset(&q, 0, sizeof(q));
+    if (ndims == 0 || shape == NULL) {
+        LOG_ERROR("Invalid dimensions");
+        return q;
+    }
+    for (size_t d = 0; d < ndims; ++d) {
+        size *= shape[d];
+    }
+    if (size == 0) {
+        LOG_ERROR("Zero dimension in shape");
+        return q;
+    }
+    size_t cols = shape[ndims - 1];
+    size_t rows = size / cols;
+    size_t groups = (granularity == MLC_QUANT_PER_ROW) ? rows : 1;
+
+    /* shape, row sums, scales and zero points share one block */
+    size_t bytes = ndims * sizeof(size_t) + rows * sizeof(int64_t) +
+                   groups * (sizeof(float) + sizeof(int32_t));
+    char * block = (char *)malloc(bytes);
+
+    q.data = (int8_t *)malloc(size);
+    if (block == NULL || q.data == NULL) {
+        LOG_ERROR("Memory allocation failed for quantized tensor");
+        free(block);
+        free(q.data);
+        q.data = NULL;
+        return q;
+    }
+    q.shape = (size_t *)block;
+    q.row_sums = (int64_t *)(block + ndims * sizeof(size_t));
+    q.scales = (float *)(q.row_sums + rows);
+    q.zero_points = (int32_t *)(q.scales + groups);
+
+    memcpy(q.shape, shape, ndims * sizeof(size_t));
+    for (size_t g = 0; g < groups; ++g) {
+        q.scales[g] = 1.0f;
+        q.zero_points[g] = 0;
+    }
+    memset(q.row_sums, 0, rows * sizeof(int64_t));
+    q.ndims = ndims;
+    q.size = size;
+    q.rows = rows;
+    q.cols = cols;
+    q.groups = groups;
+    return q;
+}
+
+/* Frees a quantized tensor and resets it. */
+static inline void
+mlc_quant_finish(MlcQuantArray * q)
+{
+    if (q == NULL) return;
+    free(q->data);
+    free(q->shape);
+    memset(q, 0, sizeof(*q));
+}
+
+/**********************************
+ * Span kernels
+ **********************************/
+
+/* Σ q[i] */
+static inline int64_t
+mlc_sum_i8_span_(const int8_t * q, size_t n)
+{
+    int64_t sum = 0;
+    size_t i = 0;
+
+#if defined(MLC_SIMD_SSE2)
+    /* psadbw sums unsigned bytes: bias by 128 and remove it after */
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i acc = _mm_setzero_si128();
+
+    for (; i < (n & ~(size_t)15); i += 16) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(q + i)), bias);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    sum = lanes[0] + lanes[1] - 128 * (int64_t)i;
+#endif
+    for (; i < n; ++i) sum += q[i];
+    return sum;
+}
+
+/* Minimum and maximum of x[0..n), folded into *lo / *hi (NaN ignored) */
+static inline void
+mlc_minmax_span_(const float * x, size_t n, float * lo, float * hi)
+{
+    float mn = *lo, mx = *hi;
+    size_t i = 0;
+
+#if defined(MLC_SIMD_SSE2)
+    if (n >= 8) {
+        /* two accumulators each, to hide the latency; NaN is skipped
+           (minps/maxps return the second operand) */
+        __m128 vmin = _mm_set1_ps(mn), vmax = _mm_set1_ps(mx);
+        __m128 vmin2 = vmin, vmax2 = vmax;
+        for (; i < (n & ~(size_t)7); i += 8) {
+            __m128 v = _mm_loadu_ps(x + i);
+            __m128 v2 = _mm_loadu_ps(x + i + 4);
+            vmin = _mm_min_ps(v, vmin);
+            vmax = _mm_max_ps(v, vmax);
+            vmin2 = _mm_min_ps(v2, vmin2);
+            vmax2 = _mm_max_ps(v2, vmax2);
+        }
+        vmin = _mm_min_ps(vmin, vmin2);
+        vmax = _mm_max_ps(vmax, vmax2);
+        float l[4], h[4];
+        _mm_storeu_ps(l, vmin);
+        _mm_storeu_ps(h, vmax);
+        for (int k = 0; k < 4; ++k) {
+            mn = (l[k] < mn) ? l[k] : mn;
+            mx = (h[k] > mx) ? h[k] : mx;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        mn = (x[i] < mn) ? x[i] : mn;
+        mx = (x[i] > mx) ? x[i] : mx;
+    }
+    *lo = mn;
+    *hi = mx;
+}
+
+/**********************************
+ * q[i] = clamp(round(x[i] * inv_scale) + zero_point, -127, 127),
+ * rounding to nearest even. The product is clamped before the
+ * conversion so that huge values and NaN cannot wrap around.
+ **********************************/
+static inline void
+mlc_quantize_span_(const float * x, size_t n, float inv_scale, int32_t zero_point, int8_t * q)
+{
+    size_t i = 0;
+
+#if defined(MLC_SIMD_SSE2)
+    const __m128 inv = _mm_set1_ps(inv_scale);
+    const __m128 top = _mm_set1_ps(255.0f), bottom = _mm_set1_ps(-255.0f);
+    const __m128i zp = _mm_set1_epi32(zero_point);
+    const __m128i qmax = _mm_set1_epi16(MLC_QUANT_MAX), qmin = _mm_set1_epi16(-MLC_QUANT_MAX);
+
+    for (; i < (n & ~(size_t)15); i += 16) {
+        __m128i v[4];
+        for (int k = 0; k < 4; ++k) {
+            __m128 t = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(x + i + 4 * k), inv), top);
+            v[k] = _mm_add_epi32(_mm_cvtps_epi32(_mm_max_ps(t, bottom)), zp);
+        }
+        __m128i lo = _mm_packs_epi32(v[0], v[1]);
+        __m128i hi = _mm_packs_epi32(v[2], v[3]);
+        lo = _mm_max_epi16(_mm_min_epi16(lo, qmax), qmin);
+        hi = _mm_max_epi16(_mm_min_epi16(hi, qmax), qmin);
+        _mm_storeu_si128((__m128i *)(q + i), _mm_packs_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        float t = x[i] * inv_scale;
+        t = (t < 255.0f) ? t : 255.0f;
+        t = (t > -255.0f) ? t : -255.0f;
+
+        long v = lrintf(t) + zero_point;
+        v = (v < MLC_QUANT_MAX) ? v : MLC_QUANT_MAX;
+        q[i] = (int8_t)((v > -MLC_QUANT_MAX) ? v : -MLC_QUANT_MAX);
+    }
+}
+
+/* x[i] = (q[i] - zero_point) * scale */
+static inline void
+mlc_dequantize_span_(const int8_t * q, size_t n, float scale, int32_t zero_point, float * x)
+{
+    size_t i = 0;
+
+#if defined(MLC_SIMD_SSE2)
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128i zp = _mm_set1_epi32(zero_point);
+
+    for (; i < (n & ~(size_t)15); i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(q + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        __m128i w[4] = {
+            _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16),
+            _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+            _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16),
+            _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)
+        };
+        for (int k = 0; k < 4; ++k) {
+            __m128 f = _mm_cvtepi32_ps(_mm_sub_epi32(w[k], zp));
+            _mm_storeu_ps(x + i + 4 * k, _mm_mul_ps(f, s));
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] = (float)((int32_t)q[i] - zero_point) * scale;
+    }
+}
+
+/* Scale and zero point mapping [lo, hi] onto the int8 range */
+static inline void
+mlc_quant_params_(float lo, float hi, MlcQuantMode mode, float * scale, int32_t * zero_point)
+{
+    lo = (lo < 0.0f) ? lo : 0.0f;
+    hi = (hi > 0.0f) ? hi : 0.0f;
+
+    if (mode == MLC_QUANT_SYMMETRIC) {
+        float amax = (-lo > hi) ? -lo : hi;
+        *scale = (amax > 0.0f && isfinite(amax)) ? amax / MLC_QUANT_MAX : 1.0f;
+        *zero_point = 0;
+    }
+    else {
+        float range = hi - lo;
+        *scale = (range > 0.0f && isfinite(range)) ? range / (2 * MLC_QUANT_MAX) : 1.0f;
+        *zero_point = (int32_t)lrintf(-MLC_QUANT_MAX - lo / *scale);
+        if (*zero_point > MLC_QUANT_MAX) *zero_point = MLC_QUANT_MAX;
+        if (*zero_point < -MLC_QUANT_MAX) *zero_point = -MLC_QUANT_MAX;
+    }
+}
+
+/**********************************
+ * Parallel drivers. Rows of the source array are single runs
+ * (mlc_view_run_()), processed through a float tile unless
+ * they are unit-stride fp32.
+ **********************************/
+typedef struct
+{
+    const MlcArray * x;
+    MlcQuantArray * q;
+    float * lo;             /* per-row minimum / maximum */
+    float * hi;
+}
+MlcQuantJob_;
+
+static inline void
+mlc_quant_stats_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcQuantJob_ * job = (MlcQuantJob_ *)ctx;
+    size_t cols = job->q->cols;
+    float tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        size_t n, stride;
+        const float * x = mlc_view_run_(job->x, r * cols, (r + 1) * cols, &n, &stride);
+        float lo = HUGE_VALF, hi = -HUGE_VALF;
+
+        for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+            size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+            const float * xi = mlc_view_advance_(job->x, x, i * stride);
+
+            if (stride == 1 && job->x->dtype == MLC_DTYPE_F32) {
+                mlc_minmax_span_(xi, m, &lo, &hi);
+                continue;
+            }
+            mlc_view_load_(job->x, xi, m, stride, tile);
+            mlc_minmax_span_(tile, m, &lo, &hi);
+        }
+        job->lo[r] = lo;
+        job->hi[r] = hi;
+    }
+}
+
+static inline void
+mlc_quant_rows_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcQuantJob_ * job = (MlcQuantJob_ *)ctx;
+    MlcQuantArray * q = job->q;
+    size_t cols = q->cols;
+    float tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        size_t n, stride;
+        const float * x = mlc_view_run_(job->x, r * cols, (r + 1) * cols, &n, &stride);
+        size_t g = (q->groups == 1) ? 0 : r;
+        float inv_scale = 1.0f / q->scales[g];
+        int8_t * out = q->data + r * cols;
+
+        for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+            size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+            const float * xi = mlc_view_advance_(job->x, x, i * stride);
+
+            if (stride != 1 || job->x->dtype != MLC_DTYPE_F32) {
+                mlc_view_load_(job->x, xi, m, stride, tile);
+                xi = tile;
+            }
+            mlc_quantize_span_(xi, m, inv_scale, q->zero_points[g], out + i);
+        }
+        q->row_sums[r] = mlc_sum_i8_span_(out, cols);
+    }
+}
+
+/**********************************
+ * Quantizes an array to int8.
+ *
+ * Arguments:
+ *  - x: Array or view to quantize (any dtype).
+ *  - mode: MLC_QUANT_SYMMETRIC or MLC_QUANT_ASYMMETRIC.
+ *  - granularity: MLC_QUANT_PER_TENSOR or MLC_QUANT_PER_ROW.
+ *
+ * Returns:
+ *  - A new MlcQuantArray of the same shape (release it with
+ *    mlc_quant_finish()).
+ *  - If error occurs, data = NULL.
+ **********************************/
+static inline MlcQuantArray
+mlc_quantize(const MlcArray * x, MlcQuantMode mode, MlcQuantGranularity granularity)
+{
+    MlcQuantArray q;
+
+    memset(&q, 0, sizeof(q));
+    if (x == NULL || x->data == NULL || x->size == 0 || x->ndims == 0 || x->shape == NULL) {
+        LOG_ERROR("Invalid array to quantize");
+        return q;
+    }
+    MLC_PROFILE_BEGIN("mlc_quantize");
+
+    q = mlc_quant_alloc(x->ndims, x->shape, granularity);
+    float * bounds = (float *)malloc(2 * q.rows * sizeof(float));
+
+    if (q.data == NULL || bounds == NULL) {
+        LOG_ERROR("Memory allocation failed for quantization");
+        free(bounds);
+        mlc_quant_finish(&q);
+        return q;
+    }
+    MlcQuantJob_ job = {x, &q, bounds, bounds + q.rows};
+    size_t grain = mlc_parallel_grain(q.cols);
+
+    /* Pass 1: range of every row */
+    mlc_parallel_for(q.rows, grain, mlc_quant_stats_range_, &job);
+
+    if (q.groups == 1) {
+        float lo = job.lo[0], hi = job.hi[0];
+        for (size_t r = 1; r < q.rows; ++r) {
+            lo = (job.lo[r] < lo) ? job.lo[r] : lo;
+            hi = (job.hi[r] > hi) ? job.hi[r] : hi;
+        }
+        mlc_quant_params_(lo, hi, mode, &q.scales[0], &q.zero_points[0]);
+    }
+    else {
+        for (size_t r = 0; r < q.rows; ++r) {
+            mlc_quant_params_(job.lo[r], job.hi[r], mode, &q.scales[r], &q.zero_points[r]);
+        }
+    }
+
+    /* Pass 2: quantize */
+    mlc_parallel_for(q.rows, grain, mlc_quant_rows_range_, &job);
+    free(bounds);
+    MLC_PROFILE_END(q.size, q.size * (mlc_dtype_size(x->dtype) + 1));
+    return q;
+}
+
+typedef struct
+{
+    const MlcQuantArray * q;
+    const MlcArray * out;
+}
+MlcDequantJob_;
+
+static inline void
+mlc_dequant_rows_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcDequantJob_ * job = (MlcDequantJob_ *)ctx;
+    const MlcQuantArray * q = job->q;
+    size_t cols = q->cols;
+    float tile[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        size_t g = (q->groups == 1) ? 0 : r;
+
+        for (size_t pos = r * cols; pos < (r + 1) * cols;) {
+            size_t n, stride;
+            float * x = mlc_view_run_(job->out, pos, (r + 1) * cols, &n, &stride);
+
+            for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+                size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+                float * xi = mlc_view_advance_(job->out, x, i * stride);
+                int direct = (stride == 1 && job->out->dtype == MLC_DTYPE_F32);
+
+                mlc_dequantize_span_(q->data + pos + i, m, q->scales[g], q->zero_points[g],
+                                     direct ? xi : tile);
+                if (!direct) mlc_view_store_(job->out, xi, m, stride, tile);
+            }
+            pos += n;
+        }
+    }
+}
+
+/**********************************
+ * Dequantizes into `out`, an array or view (any dtype) with
+ * the same number of elements, filled in row-major order.
+ **********************************/
+static inline int
+mlc_dequantize(const MlcQuantArray * q, MlcArray * out)
+{
+    if (q == NULL || q->data == NULL || check_inputs(out) != 0 || out->size != q->size) {
+        LOG_ERROR("Invalid or mismatched quantized tensor");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_dequantize");
+    MlcDequantJob_ job = {q, out};
+
+    mlc_parallel_for(q->rows, mlc_parallel_grain(q->cols), mlc_dequant_rows_range_, &job);
+    MLC_PROFILE_END(q->size, q->size * (mlc_dtype_size(out->dtype) + 1));
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of the quantized dot product:
+ *
+ * dot(a, b) = sa * sb * Σ (qa[i] - za) * (qb[i] - zb)
+ *
+ * computed as one int8 x int8 -> int32 dot product plus
+ * zero-point corrections from the row sums. Both tensors must
+ * be quantized per tensor.
+ * Note: Returns -1.0f if an error occurs.
+ **********************************/
+typedef struct
+{
+    const int8_t * a;
+    const int8_t * b;
+    int64_t partial[MLC_MAX_THREADS];
+}
+MlcQuantDotJob_;
+
+static inline void
+mlc_quant_dot_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcQuantDotJob_ * job = (MlcQuantDotJob_ *)ctx;
+    job->partial[part] = mlc_dot_i8_span_(job->a + begin, job->b + begin, end - begin);
+}
+
+/* Σ row_sums: Σ q over the whole tensor */
+static inline int64_t
+mlc_quant_total_(const MlcQuantArray * q)
+{
+    int64_t total = 0;
+    for (size_t r = 0; r < q->rows; ++r) total += q->row_sums[r];
+    return total;
+}
+
+static inline float
+mlc_quant_dot(const MlcQuantArray * a, const MlcQuantArray * b)
+{
+    if (a == NULL || b == NULL || a->data == NULL || b->data == NULL ||
+        a->size != b->size || a->groups != 1 || b->groups != 1) {
+        LOG_ERROR("Invalid or mismatched quantized tensors");
+        return -1.0f;
+    }
+    MLC_PROFILE_BEGIN("mlc_quant_dot");
+    MlcQuantDotJob_ job;
+    int64_t raw = 0;
+    int64_t za = a->zero_points[0], zb = b->zero_points[0];
+
+    job.a = a->data;
+    job.b = b->data;
+    memset(job.partial, 0, sizeof(job.partial));
+    mlc_parallel_for(a->size, mlc_parallel_grain(1), mlc_quant_dot_range_, &job);
+    for (size_t t = 0; t < MLC_MAX_THREADS; ++t) {
+        raw += job.partial[t];
+    }
+    raw += -zb * mlc_quant_total_(a) - za * mlc_quant_total_(b) + (int64_t)a->size * za * zb;
+
+    MLC_PROFILE_END(a->size, 2 * a->size);
+    return (float)raw * a->scales[0] * b->scales[0];
+}
+
+/**********************************
+ * Matrix-vector kernels: row i of w against x, with the
+ * zero-point corrections, as an int64 accumulator scaled by
+ * sw[i] * sx.
+ **********************************/
+typedef struct
+{
+    const MlcQuantArray * w;
+    const MlcQuantArray * x;
+    int64_t x_sum;
+    float * out;                /* fp32 output, or */
+    MlcQuantArray * q_out;      /* requantized output */
+    const float * bias;
+    int relu;
+}
+MlcQuantMatvecJob_;
+
+static inline float
+mlc_quant_row_(const MlcQuantMatvecJob_ * job, size_t i)
+{
+    const MlcQuantArray * w = job->w;
+    size_t g = (w->groups == 1) ? 0 : i;
+    int64_t zw = w->zero_points[g], zx = job->x->zero_points[0];
+    int64_t acc = mlc_dot_i8_span_(w->data + i * w->cols, job->x->data, w->cols);
+
+    acc += -zx * w->row_sums[i] - zw * job->x_sum + (int64_t)w->cols * zw * zx;
+    return (float)acc * (w->scales[g] * job->x->scales[0]);
+}
+
+static inline void
+mlc_quant_matvec_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcQuantMatvecJob_ * job = (MlcQuantMatvecJob_ *)ctx;
+    (void)part;
+
+    for (size_t i = begin; i < end; ++i) {
+        job->out[i] = mlc_quant_row_(job, i);
+    }
+}
+
+/* Requantize epilogue: bias, rounding to the output scale, relu */
+static inline void
+mlc_quant_requant_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcQuantMatvecJob_ * job = (MlcQuantMatvecJob_ *)ctx;
+    float inv_scale = 1.0f / job->q_out->scales[0];
+    int32_t zero_point = job->q_out->zero_points[0];
+    float y[MLC_VIEW_TILE];
+    (void)part;
+
+    for (size_t i = begin; i < end; i += MLC_VIEW_TILE) {
+        size_t m = (end - i < MLC_VIEW_TILE) ? end - i : MLC_VIEW_TILE;
+        int8_t * q = job->q_out->data + i;
+
+        for (size_t k = 0; k < m; ++k) {
+            y[k] = mlc_quant_row_(job, i + k) + (job->bias ? job->bias[i + k] : 0.0f);
+        }
+        mlc_quantize_span_(y, m, inv_scale, zero_point, q);
+
+        /* relu(y) quantized is max(q, z): zero maps to the zero point */
+        for (size_t k = 0; job->relu && k < m; ++k) {
+            q[k] = (q[k] > zero_point) ? q[k] : (int8_t)zero_point;
+        }
+    }
+}
+
+static inline int
+mlc_quant_matvec_check_(const MlcQuantArray * w, const MlcQuantArray * x)
+{
+    if (w == NULL || x == NULL || w->data == NULL || x->data == NULL ||
+        w->ndims != 2 || x->size != w->cols || x->groups != 1) {
+        LOG_ERROR("Invalid or mismatched quantized matrix/vector");
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of quantized matrix-vector
+ * multiplication:
+ *
+ * out[i] = Σ_j w[i][j] * x[j]
+ *
+ * with w (rows x cols) quantized per tensor or per row and x
+ * (cols elements) per tensor. The products are int8 x int8 ->
+ * int32; out is a contiguous fp32 array of rows elements.
+ **********************************/
+static inline int
+mlc_quant_matvec(const MlcQuantArray * w, const MlcQuantArray * x, MlcArray * out)
+{
+    if (mlc_quant_matvec_check_(w, x) != 0) return -1;
+    if (check_inputs(out) != 0 || out->size != w->rows || !mlc_is_direct_(out)) {
+        LOG_ERROR("Output must be contiguous fp32 with one element per row");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_quant_matvec");
+    MlcQuantMatvecJob_ job = {w, x, mlc_quant_total_(x), out->data, NULL, NULL, 0};
+
+    mlc_parallel_for(w->rows, mlc_parallel_grain(w->cols), mlc_quant_matvec_range_, &job);
+    MLC_PROFILE_END(w->size, w->size + x->size + w->rows * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Same, with a fused epilogue: out = quantize(relu(w x + bias))
+ * straight from the int32 accumulators, so layers can chain in
+ * int8 without materializing fp32 activations.
+ *
+ * Arguments:
+ *  - w, x: As for mlc_quant_matvec().
+ *  - bias: Contiguous fp32 array of rows elements, or NULL.
+ *  - relu: Non-zero to clamp negative outputs to zero.
+ *  - out: Per-tensor quantized array of rows elements (see
+ *    mlc_quant_alloc()); its scale and zero point set the
+ *    output quantization, and its row sums are updated.
+ **********************************/
+static inline int
+mlc_quant_matvec_requant(const MlcQuantArray * w, const MlcQuantArray * x,
+                         const MlcArray * bias, int relu, MlcQuantArray * out)
+{
+    if (mlc_quant_matvec_check_(w, x) != 0) return -1;
+    if (out == NULL || out->data == NULL || out->size != w->rows || out->groups != 1 ||
+        (bias != NULL && (bias->data == NULL || bias->size != w->rows || !mlc_is_direct_(bias)))) {
+        LOG_ERROR("Invalid output or bias for requantization");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_quant_matvec_requant");
+    MlcQuantMatvecJob_ job = {w, x, mlc_quant_total_(x), NULL, out, bias ? bias->data : NULL, relu};
+
+    mlc_parallel_for(w->rows, mlc_parallel_grain(w->cols), mlc_quant_requant_range_, &job);
+    for (size_t r = 0; r < out->rows; ++r) {
+        out->row_sums[r] = mlc_sum_i8_span_(out->data + r * out->cols, out->cols);
+    }
+    MLC_PROFILE_END(w->size, w->size + x->size + w->rows);
+    return 0;
+}
+
+#endif /* MLC_QUANT_H */
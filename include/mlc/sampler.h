@@ -0,0 +1,476 @@
+/* include/mlc/sampler.h */
+
+#ifndef MLC_SAMPLER_H
+#define MLC_SAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mlc/data.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Index sampling and batch gathering:
+ *
+ * Shuffling a dataset does not need to move it. An MlcSampler
+ * keeps a permutation of the row indices and hands it out one
+ * mini-batch of indices at a time; mlc_sampler_gather() then
+ * copies those rows into a reusable contiguous batch buffer.
+ * An epoch costs one index permutation plus batch-sized copies,
+ * and the dataset itself is only read, so it can be shared or
+ * memory-mapped (mlc_load_mmap() in io.h).
+ *
+ *   MlcSampler sampler;
+ *   MlcArray x = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+ *   MlcArray y = x;
+ *
+ *   mlc_sampler_init(&sampler, rows, 64, MLC_SAMPLE_SHUFFLE, NULL, seed);
+ *   for (each epoch) {
+ *       while (mlc_sampler_next(&sampler) > 0) {
+ *           mlc_sampler_gather(&sampler, &features, &x);
+ *           mlc_sampler_gather(&sampler, &targets, &y);
+ *           ... x.shape[0] rows ...
+ *       }
+ *   }
+ *   mlc_finish(&x);
+ *   mlc_finish(&y);
+ *   mlc_sampler_finish(&sampler);
+ *
+ * Orders:
+ *
+ *  - MLC_SAMPLE_SEQUENTIAL: rows in order.
+ *  - MLC_SAMPLE_SHUFFLE: a new uniform permutation per epoch.
+ *  - MLC_SAMPLE_STRATIFIED: shuffled within each class, and
+ *    the classes interleaved so that every batch holds them in
+ *    about their overall proportions. Rows of a class with
+ *    share p sit at evenly spaced, jittered positions, p of
+ *    every row on average; equal seeds give equal orders.
+ *
+ * Random gathers miss the cache on every row, so the gather
+ * prefetches MLC_GATHER_PREFETCH rows ahead, running on into
+ * the next batch's rows near the end of a batch.
+ *************************************************************/
+
+#ifndef MLC_GATHER_PREFETCH
+    #define MLC_GATHER_PREFETCH 8       /* rows prefetched ahead of the copy */
+#endif
+
+typedef enum
+{
+    MLC_SAMPLE_SEQUENTIAL,
+    MLC_SAMPLE_SHUFFLE,
+    MLC_SAMPLE_STRATIFIED
+}
+MlcSampleMode;
+
+typedef struct
+{
+    MlcSampleMode mode;
+    size_t rows;
+    size_t batch_rows;
+    size_t * order;             /* row order of the current epoch */
+    size_t cursor;              /* position of the next batch in order */
+    const size_t * batch;       /* indices of the current batch ... */
+    size_t count;               /* ... and their number */
+    size_t epoch;
+    uint64_t rng;
+
+    /* Stratified: rows grouped by class */
+    size_t classes;
+    size_t * class_rows;
+    size_t * class_start;       /* classes + 1 offsets into class_rows */
+}
+MlcSampler;
+
+/* splitmix64 step: a fast, well-mixed 64-bit generator */
+static inline uint64_t
+mlc_rand_u64_(uint64_t * state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* Uniform double in [0, 1) */
+static inline double
+mlc_rand_unit_(uint64_t * state)
+{
+    return (double)(mlc_rand_u64_(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Fisher-Yates shuffle of indices[0 .. n) */
+static inline void
+mlc_shuffle_indices_(size_t * indices, size_t n, uint64_t * state)
+{
+    for (size_t i = n; i > 1; --i) {
+        size_t j = (size_t)(mlc_rand_u64_(state) % i);
+        size_t t = indices[i - 1];
+
+        indices[i - 1] = indices[j];
+        indices[j] = t;
+    }
+}
+
+typedef struct
+{
+    double key;
+    size_t cls;
+    size_t rank;
+}
+MlcStrataHead_;
+
+/* Restores the min-heap on key below `i` */
+static inline void
+mlc_strata_sift_(MlcStrataHead_ * heap, size_t n, size_t i)
+{
+    for (;;) {
+        size_t l = 2 * i + 1, m = i;
+
+        if (l < n && heap[l].key < heap[m].key) m = l;
+        if (l + 1 < n && heap[l + 1].key < heap[m].key) m = l + 1;
+        if (m == i) return;
+
+        MlcStrataHead_ t = heap[i];
+        heap[i] = heap[m];
+        heap[m] = t;
+        i = m;
+    }
+}
+
+/**********************************
+ * Stratified epoch order: each class is shuffled, its i-th row
+ * (of n_c) gets the key (i + u) / n_c with u uniform in [0, 1),
+ * and the classes are merged by key. Keys grow along each
+ * class, so a k-way heap merge orders all rows in O(n log k).
+ * `heap` has room for one entry per class.
+ **********************************/
+static inline void
+mlc_sampler_stratify_(MlcSampler * s, MlcStrataHead_ * heap)
+{
+    size_t n = 0;
+
+    for (size_t c = 0; c < s->classes; ++c) {
+        size_t count = s->class_start[c + 1] - s->class_start[c];
+
+        if (count == 0) continue;
+        mlc_shuffle_indices_(s->class_rows + s->class_start[c], count, &s->rng);
+        heap[n].key = mlc_rand_unit_(&s->rng) / (double)count;
+        heap[n].cls = c;
+        heap[n].rank = 0;
+        ++n;
+    }
+    for (size_t i = n / 2; i-- > 0;) {
+        mlc_strata_sift_(heap, n, i);
+    }
+
+    for (size_t out = 0; n > 0; ++out) {
+        MlcStrataHead_ * top = &heap[0];
+        size_t begin = s->class_start[top->cls];
+        size_t count = s->class_start[top->cls + 1] - begin;
+
+        s->order[out] = s->class_rows[begin + top->rank];
+        if (++top->rank < count) {
+            top->key = ((double)top->rank + mlc_rand_unit_(&s->rng)) / (double)count;
+        }
+        else {
+            heap[0] = heap[--n];
+        }
+        mlc_strata_sift_(heap, n, 0);
+    }
+}
+
+/* Order of the next epoch; returns -1 if stratifying runs out of memory */
+static inline int
+mlc_sampler_reorder_(MlcSampler * s)
+{
+    if (s->mode == MLC_SAMPLE_SHUFFLE) {
+        mlc_shuffle_indices_(s->order, s->rows, &s->rng);
+    }
+    else if (s->mode == MLC_SAMPLE_STRATIFIED) {
+        MlcStrataHead_ * heap = (MlcStrataHead_ *)malloc(s->classes * sizeof(MlcStrataHead_));
+
+        if (heap == NULL) {
+            LOG_ERROR("Memory allocation failed for stratified sampling");
+            return -1;
+        }
+        mlc_sampler_stratify_(s, heap);
+        free(heap);
+    }
+    return 0;
+}
+
+static inline void
+mlc_sampler_finish(MlcSampler * s)
+{
+    if (s == NULL) return;
+    free(s->order);
+    free(s->class_rows);
+    free(s->class_start);
+    memset(s, 0, sizeof(*s));
+}
+
+/* Groups the rows by class label (labels[r] a whole number >= 0) */
+static inline int
+mlc_sampler_classes_(MlcSampler * s, const MlcArray * labels)
+{
+    MlcArray copy = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    const MlcArray * y = labels;
+    float top = 0.0f;
+
+    if (!mlc_is_direct_(labels)) {
+        copy = mlc_cast(labels, MLC_DTYPE_F32);
+        if (copy.data == NULL) return -1;
+        y = &copy;
+    }
+    for (size_t r = 0; r < s->rows; ++r) {
+        float v = y->data[r];
+
+        if (!(v >= 0.0f && v < 16777216.0f && v == (float)(size_t)v)) {
+            LOG_ERROR("Stratified labels must be whole numbers >= 0");
+            mlc_finish(&copy);
+            return -1;
+        }
+        if (v > top) top = v;
+    }
+    s->classes = (size_t)top + 1;
+    s->class_rows = (size_t *)malloc(s->rows * sizeof(size_t));
+    s->class_start = (size_t *)calloc(s->classes + 1, sizeof(size_t));
+
+    if (s->class_rows == NULL || s->class_start == NULL) {
+        LOG_ERROR("Memory allocation failed for stratified sampling");
+        mlc_finish(&copy);
+        return -1;
+    }
+
+    /* Counting sort of the rows by class */
+    for (size_t r = 0; r < s->rows; ++r) {
+        s->class_start[(size_t)y->data[r] + 1]++;
+    }
+    for (size_t c = 0; c < s->classes; ++c) {
+        s->class_start[c + 1] += s->class_start[c];
+    }
+    for (size_t r = 0; r < s->rows; ++r) {
+        size_t c = (size_t)y->data[r];
+        s->class_rows[s->class_start[c]++] = r;
+    }
+    for (size_t c = s->classes; c > 0; --c) {
+        s->class_start[c] = s->class_start[c - 1];
+    }
+    s->class_start[0] = 0;
+    mlc_finish(&copy);
+    return 0;
+}
+
+/**********************************
+ * Sets up a sampler over `rows` rows in batches of up to
+ * `batch_rows` and draws the order of the first epoch.
+ *
+ * Arguments:
+ *  - labels: MLC_SAMPLE_STRATIFIED only: one class label per
+ *    row (size == rows), whole numbers from 0. Not kept.
+ *  - seed: Seed of the shuffles; equal seeds give equal orders.
+ **********************************/
+static inline int
+mlc_sampler_init(MlcSampler * s, size_t rows, size_t batch_rows, MlcSampleMode mode,
+                 const MlcArray * labels, uint64_t seed)
+{
+    if (s == NULL || rows == 0 || batch_rows == 0 ||
+        (mode != MLC_SAMPLE_SEQUENTIAL && mode != MLC_SAMPLE_SHUFFLE &&
+         mode != MLC_SAMPLE_STRATIFIED) ||
+        (mode == MLC_SAMPLE_STRATIFIED && (check_inputs((MlcArray *)labels) != 0 ||
+                                           labels->size != rows))) {
+        LOG_ERROR("Invalid sampler: rows, batch_rows and one label per row required");
+        return -1;
+    }
+    memset(s, 0, sizeof(*s));
+    s->mode = mode;
+    s->rows = rows;
+    s->batch_rows = batch_rows;
+    s->rng = seed;
+    s->order = (size_t *)malloc(rows * sizeof(size_t));
+
+    if (s->order == NULL) {
+        LOG_ERROR("Memory allocation failed for sampler");
+        return -1;
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        s->order[r] = r;
+    }
+    if ((mode == MLC_SAMPLE_STRATIFIED && mlc_sampler_classes_(s, labels) != 0) ||
+        mlc_sampler_reorder_(s) != 0) {
+        mlc_sampler_finish(s);
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************
+ * Moves to the next batch: s->batch[0 .. s->count) are its row
+ * indices.
+ *
+ * Returns:
+ *  - The number of rows in the batch (the last of an epoch may
+ *    be short).
+ *  - 0 at the end of an epoch; the order of the next one is
+ *    drawn and the following call starts it.
+ *  - (size_t)-1 if the sampler is invalid or out of memory.
+ **********************************/
+static inline size_t
+mlc_sampler_next(MlcSampler * s)
+{
+    if (s == NULL || s->order == NULL) {
+        LOG_ERROR("Invalid sampler");
+        return (size_t)-1;
+    }
+    if (s->cursor == s->rows) {
+        s->cursor = 0;
+        s->batch = NULL;
+        s->count = 0;
+        s->epoch++;
+        return (mlc_sampler_reorder_(s) == 0) ? 0 : (size_t)-1;
+    }
+    size_t count = s->rows - s->cursor;
+    if (count > s->batch_rows) count = s->batch_rows;
+
+    s->batch = s->order + s->cursor;
+    s->count = count;
+    s->cursor += count;
+    return count;
+}
+
+typedef struct
+{
+    const char * src;
+    char * dst;
+    size_t ld;                  /* bytes between source rows */
+    size_t row;                 /* bytes per row */
+    const size_t * indices;
+    size_t count;
+    size_t ahead;               /* valid indices past count, for prefetching */
+}
+MlcGatherJob_;
+
+static inline void
+mlc_gather_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcGatherJob_ * job = (const MlcGatherJob_ *)ctx;
+    size_t limit = job->count + job->ahead;
+    (void)part;
+
+    for (size_t i = begin; i < end; ++i) {
+#if defined(__GNUC__)
+        if (i + MLC_GATHER_PREFETCH < limit) {
+            const char * next = job->src + job->indices[i + MLC_GATHER_PREFETCH] * job->ld;
+
+            /* The first lines of the row; the hardware prefetcher follows the rest */
+            for (size_t b = 0; b < job->row && b < 256; b += 64) {
+                __builtin_prefetch(next + b, 0, 0);
+            }
+        }
+#endif
+        memcpy(job->dst + i * job->row, job->src + job->indices[i] * job->ld, job->row);
+    }
+}
+
+/* Gathers with `ahead` more valid indices after indices[count) to prefetch */
+static inline int
+mlc_gather_rows_(const MlcArray * data, const size_t * indices, size_t count, size_t ahead,
+                 MlcArray * out)
+{
+    if (check_inputs((MlcArray *)data) != 0 || out == NULL || (count > 0 && indices == NULL) ||
+        (data->ndims == 2 ? mlc_stride_(data, 1) != 1 : !mlc_is_contiguous(data))) {
+        LOG_ERROR("Gather source must have contiguous rows");
+        return -1;
+    }
+    size_t rows = data->shape[0];
+    size_t width = data->size / rows;
+    size_t elem = mlc_dtype_size(data->dtype);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (indices[i] >= rows) {
+            LOG_ERROR("Gather index out of range");
+            return -1;
+        }
+    }
+
+    /* Output: allocated on first use, grown when too small, reused otherwise */
+    if (out->data != NULL && (out->ndims != data->ndims || out->dtype != data->dtype ||
+                              !mlc_is_contiguous(out) ||
+                              memcmp(out->shape + 1, data->shape + 1,
+                                     (data->ndims - 1) * sizeof(size_t)) != 0)) {
+        LOG_ERROR("Batch array does not match the gathered rows");
+        return -1;
+    }
+    /* A heap batch remembers its capacity (bytes) in base_size across short batches */
+    size_t capacity = out->size * elem;
+    if (out->storage == MLC_STORAGE_HEAP && out->base_size > capacity) {
+        capacity = out->base_size;
+    }
+    if (out->data == NULL || capacity < count * width * elem) {
+        if (out->data != NULL && out->storage != MLC_STORAGE_HEAP) {
+            LOG_ERROR("Batch array too small and not resizable");
+            return -1;
+        }
+        capacity = (count ? count : 1) * width * elem;
+        float * grown = (float *)realloc(out->data, capacity);
+        size_t * shape = out->shape ? out->shape : (size_t *)malloc(data->ndims * sizeof(size_t));
+
+        if (grown == NULL || shape == NULL) {
+            LOG_ERROR("Memory allocation failed for batch");
+            if (grown != NULL) out->data = grown;
+            return -1;
+        }
+        memcpy(shape, data->shape, data->ndims * sizeof(size_t));
+        out->data = grown;
+        out->shape = shape;
+        out->ndims = data->ndims;
+        out->dtype = data->dtype;
+        out->storage = MLC_STORAGE_HEAP;
+    }
+    MLC_PROFILE_BEGIN("mlc_gather_rows");
+
+    MlcGatherJob_ job = {(const char *)data->data, (char *)out->data,
+                         mlc_stride_(data, 0) * elem, width * elem, indices, count, ahead};
+    mlc_parallel_for(count, mlc_parallel_grain(width), mlc_gather_range_, &job);
+
+    out->shape[0] = count;
+    out->size = count * width;
+    if (out->storage == MLC_STORAGE_HEAP) out->base_size = capacity;
+    MLC_PROFILE_END(out->size, 2 * out->size * elem);
+    return 0;
+}
+
+/**********************************
+ * Copies rows indices[0 .. count) of data (rows along the first
+ * dimension, any dtype) into out, in that order.
+ *
+ * out: an empty array (data = NULL) is allocated on first use
+ * and then reused: later calls overwrite it and only reallocate
+ * to grow past the largest batch so far (a short batch keeps
+ * the buffer). A caller-allocated array must match data's dtype and
+ * trailing dimensions.
+ **********************************/
+static inline int
+mlc_gather_rows(const MlcArray * data, const size_t * indices, size_t count, MlcArray * out)
+{
+    return mlc_gather_rows_(data, indices, count, 0, out);
+}
+
+/* Gathers the current batch of s from data into out (see mlc_gather_rows()) */
+static inline int
+mlc_sampler_gather(const MlcSampler * s, const MlcArray * data, MlcArray * out)
+{
+    if (s == NULL || s->batch == NULL || data == NULL || data->shape == NULL ||
+        data->shape[0] != s->rows) {
+        LOG_ERROR("No current batch, or data rows do not match the sampler");
+        return -1;
+    }
+    return mlc_gather_rows_(data, s->batch, s->count, s->rows - s->cursor, out);
+}
+
+#endif /* MLC_SAMPLER_H */
@@ -0,0 +1,260 @@
+/* include/mlc/simd_math.h */
+
+#ifndef MLC_SIMD_MATH_H
+#define MLC_SIMD_MATH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/config.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define MLC_SIMD_AVX2
+#endif
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define MLC_SIMD_SSE2
+#endif
+
+/*************************************************************
+ * Vectorized transcendental kernels:
+ *
+ * exp() is computed by range reduction, x = n * ln2 + r with
+ * |r| <= ln2 / 2, a polynomial for e^r and a scaling by 2^n
+ * built directly in the exponent bits (as two factors, so the
+ * largest floats and the subnormal range come out right). tanh() is an odd/even
+ * rational polynomial on a clamped input. Each kernel has an
+ * AVX2 path (8 floats, in kernels.h), an SSE2 path (4 floats)
+ * and a scalar path using the same polynomials for tails and
+ * other targets.
+ *
+ * Accuracy is selected at compile time by defining
+ * MLC_MATH_ACCURACY before including any MLC header:
+ *
+ *  - MLC_MATH_EXACT: plain expf()/tanhf() from libm.
+ *  - MLC_MATH_ULP:   polynomials within a few ULP (default).
+ *  - MLC_MATH_FAST:  ~1e-4 relative error, shorter polynomials
+ *                    and reciprocal estimates.
+ *
+ * Inputs beyond the float range saturate the way libm does
+ * (exp gives 0 / +inf, tanh gives -1 / +1) and NaN propagates.
+ *
+ * The span kernels built on them (mlc_sigmoid_span_(), ...)
+ * apply a kernel to n contiguous floats in-place; they live in
+ * kernels.h and are selected at run time by dispatch.h.
+ *
+ * MLC_SIMD_AVX2 / MLC_SIMD_SSE2 tell other headers which
+ * instruction sets the command-line flags enable.
+ *************************************************************/
+
+#define MLC_MATH_EXACT 0
+#define MLC_MATH_ULP 1
+#define MLC_MATH_FAST 2
+
+#ifndef MLC_MATH_ACCURACY
+    #define MLC_MATH_ACCURACY MLC_MATH_ULP
+#endif
+
+#if MLC_MATH_ACCURACY != MLC_MATH_EXACT && defined(MLC_SIMD_SSE2)
+    #define MLC_MATH_SSE2
+#endif
+
+/* exp() range and Cody-Waite split of ln2 */
+#define MLC_EXP_HI 88.7228393554687f
+#define MLC_EXP_LO -103.972076416015f
+#define MLC_LOG2E 1.44269504088896341f
+#define MLC_LN2_HI 0.693359375f
+#define MLC_LN2_LO -2.12194440e-4f
+
+/* e^r on |r| <= ln2/2: minimax (~1 ULP) or Taylor (~5e-5) */
+#if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    #define MLC_EXP_P2 4.1666666667e-2f
+    #define MLC_EXP_P3 1.6666666667e-1f
+    #define MLC_EXP_P4 5.0e-1f
+#else
+    #define MLC_EXP_P0 1.9875691500e-4f
+    #define MLC_EXP_P1 1.3981999507e-3f
+    #define MLC_EXP_P2 8.3334519073e-3f
+    #define MLC_EXP_P3 4.1665795894e-2f
+    #define MLC_EXP_P4 1.6666665459e-1f
+    #define MLC_EXP_P5 5.0000001201e-1f
+#endif
+
+/* tanh(x) = x * P(x^2) / Q(x^2) on |x| <= 9 */
+#define MLC_TANH_CLAMP 9.0f
+#define MLC_TANH_TINY 0.0004f
+#define MLC_TANH_A1 4.89352455891786e-03f
+#define MLC_TANH_A3 6.37261928875436e-04f
+#define MLC_TANH_A5 1.48572235717979e-05f
+#define MLC_TANH_A7 5.12229709037114e-08f
+#define MLC_TANH_A9 -8.60467152213735e-11f
+#define MLC_TANH_A11 2.00018790482477e-13f
+#define MLC_TANH_A13 -2.76076847742355e-16f
+#define MLC_TANH_B0 4.89352518554385e-03f
+#define MLC_TANH_B2 2.26843463243900e-03f
+#define MLC_TANH_B4 1.18534705686654e-04f
+#define MLC_TANH_B6 1.19825839466702e-06f
+
+/**********************************
+ * Scalar kernels
+ **********************************/
+static inline float
+mlc_expf_(float x)
+{
+#if MLC_MATH_ACCURACY == MLC_MATH_EXACT
+    return expf(x);
+#else
+    if (x != x) return x;
+    if (x > MLC_EXP_HI) return HUGE_VALF;
+    if (x < MLC_EXP_LO) return 0.0f;
+
+    float n = rintf(x * MLC_LOG2E);
+    float r = x - n * MLC_LN2_HI;
+    r = r - n * MLC_LN2_LO;
+
+    #if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    float p = MLC_EXP_P2;
+    p = p * r + MLC_EXP_P3;
+    p = p * r + MLC_EXP_P4;
+    #else
+    float p = MLC_EXP_P0;
+    p = p * r + MLC_EXP_P1;
+    p = p * r + MLC_EXP_P2;
+    p = p * r + MLC_EXP_P3;
+    p = p * r + MLC_EXP_P4;
+    p = p * r + MLC_EXP_P5;
+    #endif
+    p = p * (r * r) + r + 1.0f;
+
+    int32_t n1 = (int32_t)n / 2;
+    int32_t bits1 = (n1 + 127) << 23;
+    int32_t bits2 = ((int32_t)n - n1 + 127) << 23;
+    float scale1, scale2;
+    memcpy(&scale1, &bits1, sizeof(scale1));
+    memcpy(&scale2, &bits2, sizeof(scale2));
+    return p * scale1 * scale2;
+#endif
+}
+
+static inline float
+mlc_tanhf_(float x)
+{
+#if MLC_MATH_ACCURACY == MLC_MATH_EXACT
+    return tanhf(x);
+#else
+    if (x != x) return x;
+    if (fabsf(x) < MLC_TANH_TINY) return x;
+
+    float c = fminf(fmaxf(x, -MLC_TANH_CLAMP), MLC_TANH_CLAMP);
+    float x2 = c * c;
+    float p = MLC_TANH_A13;
+    p = p * x2 + MLC_TANH_A11;
+    p = p * x2 + MLC_TANH_A9;
+    p = p * x2 + MLC_TANH_A7;
+    p = p * x2 + MLC_TANH_A5;
+    p = p * x2 + MLC_TANH_A3;
+    p = p * x2 + MLC_TANH_A1;
+    float q = MLC_TANH_B6;
+    q = q * x2 + MLC_TANH_B4;
+    q = q * x2 + MLC_TANH_B2;
+    q = q * x2 + MLC_TANH_B0;
+
+    float t = (c * p) / q;
+    return fminf(fmaxf(t, -1.0f), 1.0f);
+#endif
+}
+
+/**********************************
+ * SSE2 kernels (4 floats)
+ **********************************/
+#ifdef MLC_MATH_SSE2
+
+static inline __m128
+mlc_select128_(__m128 mask, __m128 a, __m128 b)
+{
+    /* mask ? a : b */
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128
+mlc_exp128_(__m128 x)
+{
+    const __m128 hi = _mm_set1_ps(MLC_EXP_HI);
+    const __m128 lo = _mm_set1_ps(MLC_EXP_LO);
+    __m128 c = _mm_min_ps(_mm_max_ps(x, lo), hi);
+
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(c, _mm_set1_ps(MLC_LOG2E)));
+    __m128 nf = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(c, _mm_mul_ps(nf, _mm_set1_ps(MLC_LN2_HI)));
+    r = _mm_sub_ps(r, _mm_mul_ps(nf, _mm_set1_ps(MLC_LN2_LO)));
+
+#if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    __m128 p = _mm_set1_ps(MLC_EXP_P2);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P3));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P4));
+#else
+    __m128 p = _mm_set1_ps(MLC_EXP_P0);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P1));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P2));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P3));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P4));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(MLC_EXP_P5));
+#endif
+    p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+    __m128i n1 = _mm_srai_epi32(n, 1);
+    __m128i n2 = _mm_sub_epi32(n, n1);
+    __m128i bias = _mm_set1_epi32(127);
+    __m128 s1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n1, bias), 23));
+    __m128 s2 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n2, bias), 23));
+    __m128 y = _mm_mul_ps(_mm_mul_ps(p, s1), s2);
+
+    y = mlc_select128_(_mm_cmpgt_ps(x, hi), _mm_set1_ps(HUGE_VALF), y);
+    y = _mm_andnot_ps(_mm_cmplt_ps(x, lo), y);
+    return mlc_select128_(_mm_cmpunord_ps(x, x), x, y);
+}
+
+static inline __m128
+mlc_recip128_(__m128 d)
+{
+#if MLC_MATH_ACCURACY == MLC_MATH_FAST
+    __m128 r = _mm_rcp_ps(d);
+    return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(d, r)));
+#else
+    return _mm_div_ps(_mm_set1_ps(1.0f), d);
+#endif
+}
+
+static inline __m128
+mlc_tanh128_(__m128 x)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 c = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-MLC_TANH_CLAMP)),
+                          _mm_set1_ps(MLC_TANH_CLAMP));
+    __m128 x2 = _mm_mul_ps(c, c);
+
+    __m128 p = _mm_set1_ps(MLC_TANH_A13);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A11));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A9));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A3));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(MLC_TANH_A1));
+    __m128 q = _mm_set1_ps(MLC_TANH_B6);
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(MLC_TANH_B4));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(MLC_TANH_B2));
+    q = _mm_add_ps(_mm_mul_ps(q, x2), _mm_set1_ps(MLC_TANH_B0));
+
+    __m128 t = _mm_mul_ps(_mm_mul_ps(c, p), mlc_recip128_(q));
+    t = _mm_min_ps(_mm_max_ps(t, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+
+    __m128 tiny = _mm_cmplt_ps(_mm_andnot_ps(sign, x), _mm_set1_ps(MLC_TANH_TINY));
+    __m128 nan = _mm_cmpunord_ps(x, x);
+    return mlc_select128_(_mm_or_ps(tiny, nan), x, t);
+}
+
+#endif /* MLC_MATH_SSE2 */
+
+#endif /* MLC_SIMD_MATH_H */
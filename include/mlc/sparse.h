@@ -0,0 +1,903 @@
+/* include/mlc/sparse.h */
+
+#ifndef MLC_SPARSE_H
+#define MLC_SPARSE_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/matrix.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Sparse matrices:
+ *
+ * An MlcSparse stores a (rows x cols) fp32 matrix in compressed
+ * sparse row (CSR) or column (CSC) form: only the nonzero
+ * values and their indices, so memory and the cost of every
+ * operation grow with the number of nonzeros (nnz) rather than
+ * rows x cols.
+ *
+ *  - CSR: row r holds values[indptr[r] .. indptr[r + 1]), at
+ *    columns indices[...], in increasing column order.
+ *  - CSC: the same with rows and columns swapped.
+ *
+ * Indices are 32-bit (half the bytes of size_t, and the width
+ * AVX2 gathers take), so both dimensions must be below 2^31.
+ *
+ *   MlcSparse a = mlc_read_csv_sparse("features.csv");
+ *   mlc_spmv(&a, &x, &y);               (y = A x)
+ *   mlc_spmm(&a, &b, &c);               (C = A B)
+ *   mlc_sparse_finish(&a);
+ *
+ * Parallelism (parallel.h):
+ *  - CSR products split the nonzeros evenly across threads,
+ *    each thread taking the rows that start in its share, so a
+ *    few heavy rows do not leave threads idle.
+ *  - CSC SpMV gives each thread a block of columns and its own
+ *    partial y, summed at the end in a fixed order; CSC SpMM
+ *    gives each thread a block of columns of C instead.
+ *  - mlc_sparse_from_dense() counts and fills rows in parallel,
+ *    and mlc_read_csv_sparse() parses newline-aligned chunks of
+ *    the file in parallel, like mlc_read_csv().
+ *
+ * Functions returning MlcSparse signal errors with indptr =
+ * NULL; the others return -1 on error and 0 on success.
+ *************************************************************/
+
+#define MLC_SPARSE_MAX_INDEX ((size_t)INT32_MAX)
+
+typedef enum
+{
+    MLC_SPARSE_CSR,
+    MLC_SPARSE_CSC
+}
+MlcSparseFormat;
+
+typedef struct
+{
+    MlcSparseFormat format;
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t * indptr;        /* CSR: rows + 1 row starts; CSC: cols + 1 column starts */
+    uint32_t * indices;     /* CSR: column of each value; CSC: row */
+    float * values;
+}
+MlcSparse;
+
+/* Number of rows (CSR) or columns (CSC) indexed by indptr */
+static inline size_t
+mlc_sparse_outer_(const MlcSparse * a)
+{
+    return (a->format == MLC_SPARSE_CSR) ? a->rows : a->cols;
+}
+
+static inline void
+mlc_sparse_finish(MlcSparse * a)
+{
+    if (a == NULL) return;
+    free(a->indptr);
+    free(a->indices);
+    free(a->values);
+    a->indptr = NULL;
+    a->indices = NULL;
+    a->values = NULL;
+    a->nnz = 0;
+}
+
+/* Allocates an uninitialized matrix; indptr = NULL on failure */
+static inline MlcSparse
+mlc_sparse_alloc_(MlcSparseFormat format, size_t rows, size_t cols, size_t nnz)
+{
+    MlcSparse a = {format, rows, cols, nnz, NULL, NULL, NULL};
+
+    if (rows > MLC_SPARSE_MAX_INDEX || cols > MLC_SPARSE_MAX_INDEX) {
+        LOG_ERROR("Sparse matrix dimensions must be below 2^31");
+        return a;
+    }
+    a.indptr = (size_t *)malloc((mlc_sparse_outer_(&a) + 1) * sizeof(size_t));
+    a.indices = (uint32_t *)malloc((nnz ? nnz : 1) * sizeof(uint32_t));
+    a.values = (float *)malloc((nnz ? nnz : 1) * sizeof(float));
+
+    if (a.indptr == NULL || a.indices == NULL || a.values == NULL) {
+        LOG_ERROR("Memory allocation failed for sparse matrix");
+        mlc_sparse_finish(&a);
+    }
+    return a;
+}
+
+static inline int
+mlc_sparse_check_(const MlcSparse * a)
+{
+    return (a == NULL || a->indptr == NULL || a->indices == NULL || a->values == NULL ||
+            a->rows == 0 || a->cols == 0) ? -1 : 0;
+}
+
+/* First outer index r in [0, outer] with indptr[r] >= k */
+static inline size_t
+mlc_sparse_find_(const size_t * indptr, size_t outer, size_t k)
+{
+    size_t lo = 0, hi = outer;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (indptr[mid] < k) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/**********************************
+ * Parallel drivers. Work over the nonzeros [begin, end) goes
+ * to the outer indices (rows, for CSR) that start inside it;
+ * the last range also takes the empty ones at the end.
+ **********************************/
+typedef struct
+{
+    const MlcSparse * a;
+    const float * x;            /* dense input: vector, or matrix with row stride ldx */
+    size_t ldx;
+    float * y;                  /* dense output: vector, or matrix with row stride ldy */
+    size_t ldy;
+    size_t n;                   /* columns of the dense matrices (1 for SpMV) */
+    size_t blocks;              /* CSC SpMV: column blocks */
+    float * partial;            /* CSC SpMV: (blocks - 1) x rows partial sums */
+}
+MlcSparseJob_;
+
+static inline void
+mlc_sparse_outer_range_(const MlcSparse * a, size_t begin, size_t end,
+                        size_t * first, size_t * last)
+{
+    size_t outer = mlc_sparse_outer_(a);
+
+    *first = mlc_sparse_find_(a->indptr, outer, begin);
+    *last = (end >= a->nnz) ? outer : mlc_sparse_find_(a->indptr, outer, end);
+}
+
+/* CSR SpMV: y[r] = Σ values * x[indices] for the rows of this range */
+static inline void
+mlc_spmv_csr_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseJob_ * job = (const MlcSparseJob_ *)ctx;
+    const MlcSparse * a = job->a;
+    size_t first, last;
+    (void)part;
+
+    mlc_sparse_outer_range_(a, begin, end, &first, &last);
+    for (size_t r = first; r < last; ++r) {
+        size_t k = a->indptr[r];
+
+        job->y[r] = mlc_sparse_dot_span_(a->values + k, a->indices + k, job->x,
+                                         a->indptr[r + 1] - k);
+    }
+}
+
+/* CSC SpMV, one block of columns: scatters x[c] * column c into its own y */
+static inline void
+mlc_spmv_csc_block_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseJob_ * job = (const MlcSparseJob_ *)ctx;
+    const MlcSparse * a = job->a;
+    (void)part;
+
+    for (size_t b = begin; b < end; ++b) {
+        float * y = (b == 0) ? job->y : job->partial + (b - 1) * a->rows;
+        size_t first, last;
+
+        mlc_sparse_outer_range_(a, a->nnz * b / job->blocks, a->nnz * (b + 1) / job->blocks,
+                                &first, &last);
+        memset(y, 0, a->rows * sizeof(float));
+        for (size_t c = first; c < last; ++c) {
+            float xc = job->x[c];
+
+            for (size_t k = a->indptr[c]; k < a->indptr[c + 1]; ++k) {
+                y[a->indices[k]] += a->values[k] * xc;
+            }
+        }
+    }
+}
+
+/* CSC SpMV: y[begin, end) += the partial sums of blocks 1 .. blocks-1, in order */
+static inline void
+mlc_spmv_csc_reduce_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseJob_ * job = (const MlcSparseJob_ *)ctx;
+    (void)part;
+
+    for (size_t b = 1; b < job->blocks; ++b) {
+        const float * partial = job->partial + (b - 1) * job->a->rows;
+
+        mlc_add_span_(job->y + begin, partial + begin, job->y + begin, end - begin);
+    }
+}
+
+/* CSR SpMM: row r of C = Σ values * (rows `indices` of B), for the rows of this range */
+static inline void
+mlc_spmm_csr_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseJob_ * job = (const MlcSparseJob_ *)ctx;
+    const MlcSparse * a = job->a;
+    size_t first, last;
+    (void)part;
+
+    mlc_sparse_outer_range_(a, begin, end, &first, &last);
+    for (size_t r = first; r < last; ++r) {
+        size_t k = a->indptr[r];
+
+        mlc_spmm_row_(a->values + k, a->indices + k, a->indptr[r + 1] - k,
+                      job->x, job->ldx, job->y + r * job->ldy, job->n);
+    }
+}
+
+/* CSC SpMM over columns [begin, end) of C: every nonzero a[i][p] adds a[i][p] * B[p][begin, end) */
+static inline void
+mlc_spmm_csc_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseJob_ * job = (const MlcSparseJob_ *)ctx;
+    const MlcSparse * a = job->a;
+    size_t n = end - begin;
+    const MlcKernels * kernels = mlc_kernels();
+    (void)part;
+
+    for (size_t i = 0; i < a->rows; ++i) {
+        memset(job->y + i * job->ldy + begin, 0, n * sizeof(float));
+    }
+    for (size_t p = 0; p < a->cols; ++p) {
+        const float * b = job->x + p * job->ldx + begin;
+
+        for (size_t k = a->indptr[p]; k < a->indptr[p + 1]; ++k) {
+            kernels->axpy(a->values[k], b, job->y + (size_t)a->indices[k] * job->ldy + begin, n);
+        }
+    }
+}
+
+/**********************************
+ * Dense to CSR: each range of rows is counted into indptr[r + 1]
+ * first, then, after a prefix sum, filled in place.
+ **********************************/
+typedef struct
+{
+    const float * data;
+    size_t ld;
+    MlcSparse * a;
+}
+MlcSparseDenseJob_;
+
+static inline void
+mlc_sparse_count_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseDenseJob_ * job = (const MlcSparseDenseJob_ *)ctx;
+    size_t cols = job->a->cols;
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        const float * row = job->data + r * job->ld;
+        size_t count = 0;
+
+        for (size_t c = 0; c < cols; ++c) {
+            count += (row[c] != 0.0f);
+        }
+        job->a->indptr[r + 1] = count;
+    }
+}
+
+static inline void
+mlc_sparse_fill_rows_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseDenseJob_ * job = (const MlcSparseDenseJob_ *)ctx;
+    MlcSparse * a = job->a;
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        const float * row = job->data + r * job->ld;
+        size_t k = a->indptr[r];
+
+        for (size_t c = 0; c < a->cols; ++c) {
+            if (row[c] != 0.0f) {
+                a->indices[k] = (uint32_t)c;
+                a->values[k] = row[c];
+                ++k;
+            }
+        }
+    }
+}
+
+/**********************************
+ * Copy of `a` in the given format. Converting between CSR and
+ * CSC is a transpose of the index structure: one counting pass
+ * and one scatter pass over the nonzeros, which leaves the
+ * indices of every row/column sorted.
+ **********************************/
+static inline MlcSparse
+mlc_sparse_convert(const MlcSparse * a, MlcSparseFormat format)
+{
+    MlcSparse out = {format, 0, 0, 0, NULL, NULL, NULL};
+
+    if (mlc_sparse_check_(a) != 0) {
+        LOG_ERROR("Invalid sparse matrix");
+        return out;
+    }
+    out = mlc_sparse_alloc_(format, a->rows, a->cols, a->nnz);
+    if (out.indptr == NULL) {
+        return out;
+    }
+    size_t outer = mlc_sparse_outer_(a);
+    size_t inner = mlc_sparse_outer_(&out);
+
+    if (format == a->format) {
+        memcpy(out.indptr, a->indptr, (outer + 1) * sizeof(size_t));
+        memcpy(out.indices, a->indices, a->nnz * sizeof(uint32_t));
+        memcpy(out.values, a->values, a->nnz * sizeof(float));
+        return out;
+    }
+
+    /* Count the entries of each new outer index, then turn counts into starts */
+    memset(out.indptr, 0, (inner + 1) * sizeof(size_t));
+    for (size_t k = 0; k < a->nnz; ++k) {
+        out.indptr[a->indices[k] + 1]++;
+    }
+    for (size_t i = 0; i < inner; ++i) {
+        out.indptr[i + 1] += out.indptr[i];
+    }
+    /* Scatter, using indptr[i] as the next free slot of i and restoring it after */
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t k = a->indptr[o]; k < a->indptr[o + 1]; ++k) {
+            size_t slot = out.indptr[a->indices[k]]++;
+
+            out.indices[slot] = (uint32_t)o;
+            out.values[slot] = a->values[k];
+        }
+    }
+    memmove(out.indptr + 1, out.indptr, inner * sizeof(size_t));
+    out.indptr[0] = 0;
+    return out;
+}
+
+/**********************************
+ * Builds a sparse matrix from the nonzeros of a 2D MlcArray
+ * (any storage type or view). NaN counts as nonzero.
+ **********************************/
+static inline MlcSparse
+mlc_sparse_from_dense(const MlcArray * dense, MlcSparseFormat format)
+{
+    MlcSparse a = {format, 0, 0, 0, NULL, NULL, NULL};
+
+    if (dense == NULL || dense->data == NULL || dense->size == 0 || dense->ndims != 2) {
+        LOG_ERROR("Invalid dense matrix");
+        return a;
+    }
+    size_t rows = dense->shape[0], cols = dense->shape[1];
+    MLC_PROFILE_BEGIN("mlc_sparse_from_dense");
+
+    MlcArray copy;
+    const MlcArray * src = mlc_matrix_operand_(dense, &copy);
+    if (src->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        return a;
+    }
+
+    /* Pass 1: nonzeros per row, which sizes the arrays exactly */
+    a = mlc_sparse_alloc_(MLC_SPARSE_CSR, rows, cols, 0);
+    if (a.indptr == NULL) {
+        mlc_finish(&copy);
+        return a;
+    }
+    MlcSparseDenseJob_ job = {src->data, mlc_stride_(src, 0), &a};
+    size_t grain = mlc_parallel_grain(cols);
+
+    mlc_parallel_for(rows, grain, mlc_sparse_count_rows_, &job);
+    a.indptr[0] = 0;
+    for (size_t r = 0; r < rows; ++r) {
+        a.indptr[r + 1] += a.indptr[r];
+    }
+    a.nnz = a.indptr[rows];
+
+    uint32_t * indices = (uint32_t *)realloc(a.indices, (a.nnz ? a.nnz : 1) * sizeof(uint32_t));
+    float * values = (float *)realloc(a.values, (a.nnz ? a.nnz : 1) * sizeof(float));
+    if (indices != NULL) a.indices = indices;
+    if (values != NULL) a.values = values;
+    if (indices == NULL || values == NULL) {
+        LOG_ERROR("Memory allocation failed for sparse matrix");
+        mlc_sparse_finish(&a);
+        mlc_finish(&copy);
+        return a;
+    }
+
+    /* Pass 2: each row writes its own slice */
+    mlc_parallel_for(rows, grain, mlc_sparse_fill_rows_, &job);
+    mlc_finish(&copy);
+
+    if (format == MLC_SPARSE_CSC) {
+        MlcSparse csc = mlc_sparse_convert(&a, MLC_SPARSE_CSC);
+
+        mlc_sparse_finish(&a);
+        a = csc;
+    }
+    MLC_PROFILE_END(rows * cols, rows * cols * sizeof(float) +
+                                 a.nnz * (sizeof(float) + sizeof(uint32_t)));
+    return a;
+}
+
+/**********************************
+ * Expands a sparse matrix into a dense (rows x cols) MlcArray;
+ * data = NULL on error.
+ **********************************/
+static inline MlcArray
+mlc_sparse_to_dense(const MlcSparse * a)
+{
+    MlcArray result = {NULL, 2, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (mlc_sparse_check_(a) != 0) {
+        LOG_ERROR("Invalid sparse matrix");
+        return result;
+    }
+    float * data = (float *)calloc(a->rows * a->cols, sizeof(float));
+    result.shape = (size_t *)malloc(2 * sizeof(size_t));
+
+    if (data == NULL || result.shape == NULL) {
+        LOG_ERROR("Memory allocation failed");
+        free(data);
+        free(result.shape);
+        result.shape = NULL;
+        return result;
+    }
+    size_t outer = mlc_sparse_outer_(a);
+    int csr = (a->format == MLC_SPARSE_CSR);
+
+    for (size_t o = 0; o < outer; ++o) {
+        for (size_t k = a->indptr[o]; k < a->indptr[o + 1]; ++k) {
+            size_t i = a->indices[k];
+
+            data[csr ? o * a->cols + i : i * a->cols + o] = a->values[k];
+        }
+    }
+    result.data = data;
+    result.size = a->rows * a->cols;
+    result.shape[0] = a->rows;
+    result.shape[1] = a->cols;
+    return result;
+}
+
+/**********************************
+ * Mathematical synopsis of sparse matrix-vector multiplication:
+ *
+ * y[i] = Σ_j A[i][j] * x[j]        (nonzero A[i][j] only)
+ *
+ * Shapes: A is (rows x cols), x has cols elements and y has
+ * rows elements (any ndims; y contiguous fp32).
+ * Note: Costs O(nnz + rows), whatever the density; a CSC
+ * matrix split across threads also needs one partial y per
+ * extra thread, allocated per call.
+ **********************************/
+static inline int
+mlc_spmv(const MlcSparse * a, MlcArray * x, MlcArray * y)
+{
+    if (mlc_sparse_check_(a) != 0 ||
+        check_inputs(x) != 0 ||
+        check_inputs(y) != 0 ||
+        x->size != a->cols ||
+        y->size != a->rows ||
+        !mlc_is_direct_(y)
+        ) {
+        LOG_ERROR("Invalid sparse matrix, or mismatched vector sizes");
+        return -1;
+    }
+    MLC_PROFILE_BEGIN("mlc_spmv");
+
+    MlcArray x_copy;
+    const MlcArray * vec = mlc_matrix_operand_(x, &x_copy);
+    if (vec->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        return -1;
+    }
+    MlcSparseJob_ job = {a, vec->data, 0, y->data, 0, 1, 1, NULL};
+    size_t grain = mlc_parallel_grain(1);
+
+    if (a->format == MLC_SPARSE_CSR) {
+        if (a->nnz == 0) memset(y->data, 0, a->rows * sizeof(float));
+        mlc_parallel_for(a->nnz, grain, mlc_spmv_csr_range_, &job);
+    }
+    else {
+        size_t threads = mlc_get_num_threads();
+
+        job.blocks = (a->nnz + grain - 1) / grain;
+        if (job.blocks > threads) job.blocks = threads;
+        if (job.blocks < 1) job.blocks = 1;
+        if (job.blocks > 1) {
+            job.partial = (float *)malloc((job.blocks - 1) * a->rows * sizeof(float));
+            if (job.partial == NULL) job.blocks = 1;
+        }
+        mlc_parallel_for(job.blocks, 1, mlc_spmv_csc_block_, &job);
+        if (job.blocks > 1) {
+            mlc_parallel_for(a->rows, mlc_parallel_grain(job.blocks), mlc_spmv_csc_reduce_, &job);
+        }
+        free(job.partial);
+    }
+    mlc_finish(&x_copy);
+    MLC_PROFILE_END(a->nnz, a->nnz * (2 * sizeof(float) + sizeof(uint32_t)) +
+                            (a->rows + a->cols) * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Mathematical synopsis of sparse matrix-matrix multiplication:
+ *
+ * C[i][j] = Σ_p A[i][p] * B[p][j]  (nonzero A[i][p] only)
+ *
+ * Shapes: A is (rows x cols), B is dense (cols x n), C is dense
+ * (rows x n) with contiguous rows.
+ * Note: Each nonzero adds a scaled row of B to a row of C, so
+ * the cost is O(nnz * n + rows * n).
+ **********************************/
+static inline int
+mlc_spmm(const MlcSparse * a, MlcArray * b, MlcArray * c)
+{
+    if (mlc_sparse_check_(a) != 0 ||
+        check_inputs(b) != 0 ||
+        check_inputs(c) != 0 ||
+        b->ndims != 2 || c->ndims != 2 ||
+        b->shape[0] != a->cols ||
+        c->shape[0] != a->rows ||
+        c->shape[1] != b->shape[1] ||
+        !mlc_matrix_rows_ok_(c)
+        ) {
+        LOG_ERROR("Invalid sparse matrix, or mismatched matrix shapes");
+        return -1;
+    }
+    size_t n = b->shape[1];
+    MLC_PROFILE_BEGIN("mlc_spmm");
+
+    MlcArray b_copy;
+    const MlcArray * rhs = mlc_matrix_operand_(b, &b_copy);
+    if (rhs->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        return -1;
+    }
+    MlcSparseJob_ job = {a, rhs->data, mlc_stride_(rhs, 0), c->data, mlc_stride_(c, 0), n, 1, NULL};
+
+    if (a->format == MLC_SPARSE_CSR) {
+        for (size_t r = 0; a->nnz == 0 && r < a->rows; ++r) {
+            memset(c->data + r * job.ldy, 0, n * sizeof(float));
+        }
+        mlc_parallel_for(a->nnz, mlc_parallel_grain(n), mlc_spmm_csr_range_, &job);
+    }
+    else {
+        mlc_parallel_for(n, mlc_parallel_grain(a->nnz + a->rows), mlc_spmm_csc_range_, &job);
+    }
+    mlc_finish(&b_copy);
+    MLC_PROFILE_END(a->nnz * n, a->nnz * (sizeof(float) + sizeof(uint32_t)) +
+                                (a->nnz + a->rows) * n * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Sparse CSV loading: the chunks of mlc_read_csv() (data.h),
+ * each parsed into its own growing list of nonzeros. The chunk
+ * lists are then concatenated in parallel, so the dense matrix
+ * is never materialized.
+ **********************************/
+typedef struct
+{
+    size_t first_row;
+    size_t base;            /* offset of the chunk's first nonzero in the result */
+    size_t nnz;
+    size_t capacity;
+    uint32_t * indices;
+    float * values;
+    int failed;             /* allocation failure */
+}
+MlcSparseCsvChunk_;
+
+typedef struct
+{
+    MlcCsvChunk_ * text;
+    MlcSparseCsvChunk_ * chunks;
+    MlcSparse * a;
+}
+MlcSparseCsvJob_;
+
+static inline int
+mlc_sparse_csv_push_(MlcSparseCsvChunk_ * chunk, uint32_t col, float value)
+{
+    if (chunk->nnz == chunk->capacity) {
+        size_t capacity = chunk->capacity ? 2 * chunk->capacity : 1024;
+        uint32_t * indices = (uint32_t *)realloc(chunk->indices, capacity * sizeof(uint32_t));
+        if (indices == NULL) return -1;
+        chunk->indices = indices;
+
+        float * values = (float *)realloc(chunk->values, capacity * sizeof(float));
+        if (values == NULL) return -1;
+        chunk->values = values;
+        chunk->capacity = capacity;
+    }
+    chunk->indices[chunk->nnz] = col;
+    chunk->values[chunk->nnz] = value;
+    chunk->nnz++;
+    return 0;
+}
+
+/* Parses the rows of one chunk; indptr[row + 1] gets the chunk-local end of each row */
+static inline void
+mlc_sparse_csv_parse_(MlcCsvChunk_ * text, MlcSparseCsvChunk_ * chunk, size_t * indptr)
+{
+    const char * p = text->begin;
+    size_t row = chunk->first_row;
+
+    while (p < text->end) {
+        const char * eol = mlc_csv_line_end_(p, text->end);
+
+        if (!mlc_csv_blank_line_(p, eol)) {
+            size_t count = 0;
+
+            /* Fields as in mlc_csv_parse_line_(): trimmed, empty reads as 0 */
+            for (const char * field = p;; ) {
+                const char * field_end = (const char *)memchr(field, ',', (size_t)(eol - field));
+                const char * next;
+                float value = 0.0f;
+
+                if (field_end == NULL) field_end = eol;
+                next = field_end;
+                while (field < field_end && mlc_csv_is_blank_(*field)) ++field;
+                while (field_end > field && mlc_csv_is_blank_(field_end[-1])) --field_end;
+
+                if (field < field_end && mlc_parse_float_(field, field_end, &value) != 0) {
+                    text->status = -2;
+                    return;
+                }
+                if (value != 0.0f && count < text->cols &&
+                    mlc_sparse_csv_push_(chunk, (uint32_t)count, value) != 0) {
+                    chunk->failed = 1;
+                    return;
+                }
+                ++count;
+                if (next == eol) break;
+                field = next + 1;
+            }
+            if (count != text->cols) {
+                text->status = -1;
+                return;
+            }
+            indptr[++row] = chunk->nnz;
+        }
+        p = eol + 1;
+    }
+    text->status = 0;
+}
+
+static inline void
+mlc_sparse_csv_parse_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseCsvJob_ * job = (const MlcSparseCsvJob_ *)ctx;
+    (void)part;
+
+    for (size_t t = begin; t < end; ++t) {
+        mlc_sparse_csv_parse_(&job->text[t], &job->chunks[t], job->a->indptr);
+    }
+}
+
+/* Moves each chunk's nonzeros to their final offset and rebases its rows */
+static inline void
+mlc_sparse_csv_merge_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcSparseCsvJob_ * job = (const MlcSparseCsvJob_ *)ctx;
+    MlcSparse * a = job->a;
+    (void)part;
+
+    for (size_t t = begin; t < end; ++t) {
+        const MlcSparseCsvChunk_ * chunk = &job->chunks[t];
+
+        memcpy(a->indices + chunk->base, chunk->indices, chunk->nnz * sizeof(uint32_t));
+        memcpy(a->values + chunk->base, chunk->values, chunk->nnz * sizeof(float));
+        for (size_t r = 1; r <= job->text[t].rows; ++r) {
+            a->indptr[chunk->first_row + r] += chunk->base;
+        }
+    }
+}
+
+/**********************************
+ * Reads a CSV file straight into CSR form.
+ *
+ * Parsing follows mlc_read_csv(): the column count comes from
+ * the first non-empty line, empty lines are skipped and empty
+ * fields read as 0. Only the nonzeros are stored, so memory
+ * grows with nnz; the dense (rows x cols) matrix never exists.
+ *
+ * Returns:
+ *  - A CSR matrix, or indptr = NULL on error.
+ **********************************/
+static inline MlcSparse
+mlc_read_csv_sparse(const char * filename)
+{
+    MlcSparse a = {MLC_SPARSE_CSR, 0, 0, 0, NULL, NULL, NULL};
+    size_t length, cols;
+    MLC_PROFILE_BEGIN("mlc_read_csv_sparse");
+
+    char * map = mlc_csv_map_(filename, &length, &cols);
+    if (map == NULL) {
+        return a;
+    }
+    MlcCsvChunk_ text[MLC_MAX_THREADS];
+    MlcSparseCsvChunk_ chunks[MLC_MAX_THREADS];
+    size_t used = mlc_csv_split_(map, map + length, cols, text);
+
+    /* Pass 1: rows per chunk give each chunk its first row */
+    mlc_parallel_for(used, 1, mlc_csv_count_range_, text);
+
+    size_t rows = 0;
+    memset(chunks, 0, sizeof(chunks));
+    for (size_t t = 0; t < used; ++t) {
+        chunks[t].first_row = rows;
+        rows += text[t].rows;
+    }
+    a = mlc_sparse_alloc_(MLC_SPARSE_CSR, rows, cols, 0);
+    if (a.indptr == NULL) {
+        munmap(map, length);
+        return a;
+    }
+
+    /* Pass 2: parse the chunks into their own nonzero lists */
+    MlcSparseCsvJob_ job = {text, chunks, &a};
+    int failed = 0;
+
+    mlc_parallel_for(used, 1, mlc_sparse_csv_parse_range_, &job);
+    munmap(map, length);
+    for (size_t t = 0; t < used; ++t) {
+        failed |= chunks[t].failed;
+    }
+    if (failed) {
+        LOG_ERROR("Memory allocation failed for sparse CSV");
+    }
+    else if (mlc_csv_check_chunks_(text, used) != 0) {
+        failed = 1;
+    }
+
+    /* Pass 3: chunk offsets, then concatenate (a single chunk's lists are kept) */
+    size_t nnz = 0;
+    for (size_t t = 0; t < used; ++t) {
+        chunks[t].base = nnz;
+        nnz += chunks[t].nnz;
+    }
+    a.indptr[0] = 0;
+    if (!failed && used == 1 && nnz > 0) {
+        free(a.indices);
+        free(a.values);
+        a.indices = chunks[0].indices;
+        a.values = chunks[0].values;
+        chunks[0].indices = NULL;
+        chunks[0].values = NULL;
+        a.nnz = nnz;
+    }
+    else if (!failed) {
+        uint32_t * indices = (uint32_t *)realloc(a.indices, (nnz ? nnz : 1) * sizeof(uint32_t));
+        float * values = (float *)realloc(a.values, (nnz ? nnz : 1) * sizeof(float));
+
+        if (indices != NULL) a.indices = indices;
+        if (values != NULL) a.values = values;
+        failed = (indices == NULL || values == NULL);
+        if (failed) LOG_ERROR("Memory allocation failed for sparse matrix");
+    }
+    if (!failed && a.nnz != nnz) {
+        a.nnz = nnz;
+        mlc_parallel_for(used, 1, mlc_sparse_csv_merge_range_, &job);
+    }
+    for (size_t t = 0; t < used; ++t) {
+        free(chunks[t].indices);
+        free(chunks[t].values);
+    }
+    if (failed) {
+        mlc_sparse_finish(&a);
+        return a;
+    }
+    MLC_PROFILE_END(rows * cols, length + nnz * (sizeof(float) + sizeof(uint32_t)));
+    return a;
+}
+
+#ifndef MLC_CSV_AUTO_SAMPLE
+    #define MLC_CSV_AUTO_SAMPLE (1u << 20)     /* bytes sampled by mlc_read_csv_auto() */
+#endif
+
+/* Fraction of zeros in the whole lines of the first MLC_CSV_AUTO_SAMPLE bytes, or -1 */
+static inline double
+mlc_csv_sample_zeros_(const char * filename)
+{
+    size_t length, cols;
+    char * map = mlc_csv_map_(filename, &length, &cols);
+
+    if (map == NULL) return -1.0;
+    float * row = (float *)malloc(cols * sizeof(float));
+    if (row == NULL) {
+        LOG_ERROR("Memory allocation failed for CSV sample");
+        munmap(map, length);
+        return -1.0;
+    }
+    const char * end = map + length;
+    const char * limit = map + ((length < MLC_CSV_AUTO_SAMPLE) ? length : MLC_CSV_AUTO_SAMPLE);
+    size_t values = 0, zeros = 0;
+
+    for (const char * p = map; p < end; ) {
+        const char * eol = mlc_csv_line_end_(p, end);
+
+        /* At least one line, however long */
+        if (eol > limit && values > 0) break;
+        if (!mlc_csv_blank_line_(p, eol)) {
+            /* A malformed line ends the sample; the full read reports it */
+            if (mlc_csv_parse_line_(p, eol, cols, row) != cols) break;
+            for (size_t c = 0; c < cols; ++c) zeros += (row[c] == 0.0f);
+            values += cols;
+        }
+        p = eol + 1;
+    }
+    free(row);
+    munmap(map, length);
+    return values ? (double)zeros / (double)values : 0.0;
+}
+
+/**********************************
+ * Reads a CSV file into whichever form suits it: CSR if at
+ * least `min_sparsity` of its values (0.95 = 95%) are zero,
+ * dense otherwise.
+ *
+ * The form is guessed from the first MLC_CSV_AUTO_SAMPLE bytes,
+ * and the file is parsed once, straight into that form: dense
+ * files skip the CSR lists, and sparse ones do not take
+ * rows x cols memory unless the sample misleads the guess. The
+ * decision is then checked on all the values; a file whose
+ * head misled the guess is converted to the other form, after
+ * being read whole in the guessed one.
+ *
+ * Returns:
+ *  - 1 with *sparse filled, 0 with *dense filled, -1 on error.
+ **********************************/
+static inline int
+mlc_read_csv_auto(const char * filename, float min_sparsity, MlcArray * dense, MlcSparse * sparse)
+{
+    if (dense == NULL || sparse == NULL) {
+        LOG_ERROR("Invalid output arrays");
+        return -1;
+    }
+    double sampled = mlc_csv_sample_zeros_(filename);
+    if (sampled < 0.0) {
+        return -1;
+    }
+
+    if (sampled >= (double)min_sparsity) {
+        MlcSparse a = mlc_read_csv_sparse(filename);
+        if (a.indptr == NULL) {
+            return -1;
+        }
+        double zeros = 1.0 - (double)a.nnz / ((double)a.rows * (double)a.cols);
+
+        if (zeros >= (double)min_sparsity) {
+            *sparse = a;
+            return 1;
+        }
+        *dense = mlc_sparse_to_dense(&a);
+        mlc_sparse_finish(&a);
+        return (dense->data != NULL) ? 0 : -1;
+    }
+
+    MlcArray x = mlc_read_csv(filename);
+    if (x.data == NULL) {
+        return -1;
+    }
+    size_t zeros = 0;
+    for (size_t i = 0; i < x.size; ++i) zeros += (x.data[i] == 0.0f);
+
+    if ((double)zeros / (double)x.size < (double)min_sparsity) {
+        *dense = x;
+        return 0;
+    }
+    *sparse = mlc_sparse_from_dense(&x, MLC_SPARSE_CSR);
+    mlc_finish(&x);
+    return (sparse->indptr != NULL) ? 1 : -1;
+}
+
+#endif /* MLC_SPARSE_H */
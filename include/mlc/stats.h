@@ -0,0 +1,361 @@
+/* include/mlc/stats.h */
+
+#ifndef MLC_STATS_H
+#define MLC_STATS_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mlc/data.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
+#include <mlc/matrix.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Column statistics and feature normalization:
+ *
+ * An MlcColumnStats holds, per column of a (rows x cols)
+ * matrix, the running count, mean, sum of squared deviations
+ * (m2), min and max. mlc_stats_update() adds the rows of a
+ * batch in one row-major pass (Welford's algorithm): every row
+ * updates all the columns at once, so the matrix is read
+ * exactly once and in memory order, rather than once per
+ * statistic and column by column.
+ *
+ * Large batches are split across the thread pool; each part
+ * accumulates its own partial statistics, merged at the end
+ * with Chan et al.'s pairwise formula:
+ *
+ *   n = na + nb,  d = mean_b - mean_a
+ *   mean = mean_a + d * nb / n
+ *   m2   = m2_a + m2_b + d^2 * na * nb / n
+ *
+ * Because of that merge, statistics also accumulate across
+ * batches, e.g. the batches of an MlcCsvReader (csv_stream.h):
+ *
+ *   MlcColumnStats stats;
+ *   mlc_stats_init(&stats, cols);
+ *   while (mlc_csv_next_batch(reader, 256, &batch) > 0) {
+ *       mlc_stats_update(&stats, &batch);
+ *   }
+ *   ... later, for every batch:
+ *   mlc_normalize(&batch, &stats, MLC_NORM_ZSCORE);
+ *   mlc_stats_finish(&stats);
+ *
+ * mlc_normalize() applies z-score or min-max scaling in place
+ * in a second, fused pass (one subtract and one multiply per
+ * element). mlc_fit_normalize() does both passes on one array.
+ *
+ * Moments are accumulated in double. A NaN in a column (e.g. a
+ * missing CSV value) makes its statistics NaN; fill missing
+ * values first (MlcCsvOptions.missing in csv.h).
+ *
+ * Functions return -1 on invalid input or allocation failure,
+ * and 0 on success.
+ *************************************************************/
+
+typedef enum
+{
+    MLC_NORM_ZSCORE,        /* (x - mean) / std */
+    MLC_NORM_MINMAX         /* (x - min) / (max - min) */
+}
+MlcNormKind;
+
+typedef struct
+{
+    size_t cols;
+    size_t count;           /* rows seen so far */
+    double * mean;
+    double * m2;            /* Σ (x - mean)^2 */
+    float * min;
+    float * max;
+}
+MlcColumnStats;
+
+/* Empties the statistics, keeping their buffers */
+static inline void
+mlc_stats_reset(MlcColumnStats * stats)
+{
+    stats->count = 0;
+    for (size_t c = 0; c < stats->cols; ++c) {
+        stats->mean[c] = 0.0;
+        stats->m2[c] = 0.0;
+        stats->min[c] = INFINITY;
+        stats->max[c] = -INFINITY;
+    }
+}
+
+static inline void
+mlc_stats_finish(MlcColumnStats * stats)
+{
+    if (stats == NULL) return;
+    free(stats->mean);
+    free(stats->m2);
+    free(stats->min);
+    free(stats->max);
+    memset(stats, 0, sizeof(*stats));
+}
+
+static inline int
+mlc_stats_init(MlcColumnStats * stats, size_t cols)
+{
+    if (stats == NULL || cols == 0) {
+        LOG_ERROR("Invalid column statistics");
+        return -1;
+    }
+    stats->cols = cols;
+    stats->mean = (double *)malloc(cols * sizeof(double));
+    stats->m2 = (double *)malloc(cols * sizeof(double));
+    stats->min = (float *)malloc(cols * sizeof(float));
+    stats->max = (float *)malloc(cols * sizeof(float));
+
+    if (stats->mean == NULL || stats->m2 == NULL || stats->min == NULL || stats->max == NULL) {
+        LOG_ERROR("Memory allocation failed for column statistics");
+        mlc_stats_finish(stats);
+        return -1;
+    }
+    mlc_stats_reset(stats);
+    return 0;
+}
+
+/**********************************
+ * Adds the statistics of `from` to `into` (same columns), as
+ * if into had also seen from's rows.
+ **********************************/
+static inline int
+mlc_stats_merge(MlcColumnStats * into, const MlcColumnStats * from)
+{
+    if (into == NULL || from == NULL || into->cols != from->cols) {
+        LOG_ERROR("Mismatched column statistics");
+        return -1;
+    }
+    if (from->count == 0) return 0;
+
+    double na = (double)into->count;
+    double nb = (double)from->count;
+    double n = na + nb;
+
+    for (size_t c = 0; c < into->cols; ++c) {
+        double d = from->mean[c] - into->mean[c];
+
+        into->mean[c] += d * (nb / n);
+        into->m2[c] += from->m2[c] + d * d * (na * nb / n);
+        if (from->min[c] < into->min[c]) into->min[c] = from->min[c];
+        if (from->max[c] > into->max[c]) into->max[c] = from->max[c];
+    }
+    into->count += from->count;
+    return 0;
+}
+
+/* Population variance of a column (m2 / count); -1 if there is none */
+static inline double
+mlc_stats_variance(const MlcColumnStats * stats, size_t col)
+{
+    if (stats == NULL || col >= stats->cols || stats->count == 0) {
+        LOG_ERROR("Invalid column or empty statistics");
+        return -1.0;
+    }
+    return stats->m2[col] / (double)stats->count;
+}
+
+typedef struct
+{
+    const float * data;
+    size_t ld;
+    size_t cols;
+    MlcColumnStats * part[MLC_MAX_THREADS];     /* part[0] is the running statistics */
+}
+MlcStatsJob_;
+
+static inline void
+mlc_stats_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcStatsJob_ * job = (const MlcStatsJob_ *)ctx;
+    MlcColumnStats * stats = job->part[part];
+
+    for (size_t r = begin; r < end; ++r) {
+        stats->count++;
+        mlc_welford_row_(job->data + r * job->ld, stats->mean, stats->m2,
+                         stats->min, stats->max, job->cols, 1.0 / (double)stats->count);
+    }
+}
+
+/**********************************
+ * Mathematical synopsis of the statistics update:
+ *
+ * For every column c over the rows r of batch (and the rows
+ * seen before):
+ *   count  += rows
+ *   mean[c] = Σ_r x[r][c] / count
+ *   m2[c]   = Σ_r (x[r][c] - mean[c])^2
+ *   min[c], max[c] = min_r, max_r x[r][c]
+ *
+ * Shapes: batch is (rows x stats->cols), of any dtype.
+ **********************************/
+static inline int
+mlc_stats_update(MlcColumnStats * stats, const MlcArray * batch)
+{
+    if (stats == NULL || stats->mean == NULL || check_inputs((MlcArray *)batch) != 0 ||
+        batch->ndims != 2 || batch->shape[1] != stats->cols) {
+        LOG_ERROR("Invalid or mismatched statistics input");
+        return -1;
+    }
+    size_t rows = batch->shape[0];
+    size_t cols = stats->cols;
+    MLC_PROFILE_BEGIN("mlc_stats_update");
+
+    MlcArray copy;
+    const MlcArray * x = mlc_matrix_operand_(batch, &copy);
+    if (x->data == NULL) {
+        LOG_ERROR("Memory allocation failed for operand copy");
+        return -1;
+    }
+
+    /* One partial per extra part, all in one block */
+    size_t grain = mlc_parallel_grain(cols);
+    size_t parts = (rows + grain - 1) / grain;
+    size_t threads = mlc_get_num_threads();
+    if (parts > threads) parts = threads;
+    if (parts == 0) parts = 1;
+
+    MlcStatsJob_ job;
+    MlcColumnStats partials[MLC_MAX_THREADS];
+    char * block = NULL;
+
+    job.data = x->data;
+    job.ld = mlc_stride_(x, 0);
+    job.cols = cols;
+    job.part[0] = stats;
+    if (parts > 1) {
+        size_t bytes = cols * (2 * sizeof(double) + 2 * sizeof(float));
+
+        block = (char *)malloc((parts - 1) * bytes);
+        if (block == NULL) {
+            LOG_ERROR("Memory allocation failed for partial statistics");
+            mlc_finish(&copy);
+            return -1;
+        }
+        for (size_t p = 1; p < parts; ++p) {
+            char * base = block + (p - 1) * bytes;
+
+            partials[p].cols = cols;
+            partials[p].mean = (double *)base;
+            partials[p].m2 = (double *)(base + cols * sizeof(double));
+            partials[p].min = (float *)(base + 2 * cols * sizeof(double));
+            partials[p].max = (float *)(base + 2 * cols * sizeof(double) + cols * sizeof(float));
+            mlc_stats_reset(&partials[p]);
+            job.part[p] = &partials[p];
+        }
+    }
+    mlc_parallel_for(rows, grain, mlc_stats_range_, &job);
+
+    /* Parts cover consecutive rows; merge them in order */
+    for (size_t p = 1; p < parts; ++p) {
+        mlc_stats_merge(stats, &partials[p]);
+    }
+    free(block);
+    mlc_finish(&copy);
+    MLC_PROFILE_END(rows * cols, rows * cols * sizeof(float));
+    return 0;
+}
+
+typedef struct
+{
+    float * data;
+    size_t ld;
+    size_t cols;
+    const float * shift;
+    const float * scale;
+}
+MlcNormalizeJob_;
+
+static inline void
+mlc_normalize_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcNormalizeJob_ * job = (const MlcNormalizeJob_ *)ctx;
+    (void)part;
+
+    for (size_t r = begin; r < end; ++r) {
+        mlc_affine_row_(job->data + r * job->ld, job->shift, job->scale, job->cols);
+    }
+}
+
+/**********************************
+ * Mathematical synopsis of normalization (in place):
+ *
+ * z-score: x[r][c] = (x[r][c] - mean[c]) / std[c]
+ * min-max: x[r][c] = (x[r][c] - min[c]) / (max[c] - min[c])
+ *
+ * with std[c] = sqrt(m2[c] / count). A constant column (zero
+ * std or range) is only shifted.
+ * Shapes: array is (rows x stats->cols), fp32 with contiguous
+ * rows; the statistics may come from other data (e.g. the
+ * training set).
+ **********************************/
+static inline int
+mlc_normalize(MlcArray * array, const MlcColumnStats * stats, MlcNormKind kind)
+{
+    if (stats == NULL || stats->count == 0 || check_inputs(array) != 0 ||
+        !mlc_matrix_rows_ok_(array) || array->shape[1] != stats->cols ||
+        (kind != MLC_NORM_ZSCORE && kind != MLC_NORM_MINMAX)) {
+        LOG_ERROR("Invalid or mismatched normalization input");
+        return -1;
+    }
+    size_t rows = array->shape[0];
+    size_t cols = stats->cols;
+    MLC_PROFILE_BEGIN("mlc_normalize");
+
+    float * shift = (float *)malloc(2 * cols * sizeof(float));
+    if (shift == NULL) {
+        LOG_ERROR("Memory allocation failed for normalization");
+        return -1;
+    }
+    float * scale = shift + cols;
+
+    for (size_t c = 0; c < cols; ++c) {
+        double spread = (kind == MLC_NORM_ZSCORE) ? sqrt(stats->m2[c] / (double)stats->count)
+                                                  : (double)stats->max[c] - (double)stats->min[c];
+
+        shift[c] = (kind == MLC_NORM_ZSCORE) ? (float)stats->mean[c] : stats->min[c];
+        scale[c] = (spread > 0.0) ? (float)(1.0 / spread) : 1.0f;
+    }
+    MlcNormalizeJob_ job = {array->data, mlc_stride_(array, 0), cols, shift, scale};
+    mlc_parallel_for(rows, mlc_parallel_grain(cols), mlc_normalize_range_, &job);
+
+    free(shift);
+    MLC_PROFILE_END(rows * cols, 2 * rows * cols * sizeof(float));
+    return 0;
+}
+
+/**********************************
+ * Adds the rows of array to stats (NULL: temporary statistics
+ * of array alone), then normalizes array in place with them:
+ * one read pass and one read-write pass.
+ **********************************/
+static inline int
+mlc_fit_normalize(MlcArray * array, MlcColumnStats * stats, MlcNormKind kind)
+{
+    MlcColumnStats local;
+    int status;
+
+    if (stats == NULL) {
+        if (check_inputs(array) != 0 || array->ndims != 2 ||
+            mlc_stats_init(&local, array->shape[1]) != 0) {
+            LOG_ERROR("Invalid normalization input");
+            return -1;
+        }
+    }
+    status = mlc_stats_update(stats ? stats : &local, array);
+    if (status == 0) {
+        status = mlc_normalize(array, stats ? stats : &local, kind);
+    }
+    if (stats == NULL) {
+        mlc_stats_finish(&local);
+    }
+    return status;
+}
+
+#endif /* MLC_STATS_H */
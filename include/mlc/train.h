@@ -0,0 +1,522 @@
+/* include/mlc/train.h */
+
+#ifndef MLC_TRAIN_H
+#define MLC_TRAIN_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <mlc/data.h>
+#include <mlc/view.h>
+#include <mlc/activations.h>
+#include <mlc/matrix.h>
+#include <mlc/layers.h>
+#include <mlc/optim.h>
+#include <mlc/parallel.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Data-parallel training of an MlcMlp (layers.h):
+ *
+ * An MlcTrainer runs mini-batch steps of backpropagation and
+ * an optimizer (optim.h) over the layers of an MLP, updating
+ * its weights in place:
+ *
+ *   MlcTrainer trainer;
+ *   MlcOptimizer opt = mlc_adam(1e-3f, 0.9f, 0.999f, 1e-8f, 0.0f);
+ *   mlc_trainer_init(&trainer, &mlp, &opt, MLC_LOSS_CROSS_ENTROPY, 128);
+ *   for (each batch) {
+ *       float loss = mlc_train_step(&trainer, &x, &y);
+ *   }
+ *   mlc_trainer_finish(&trainer);
+ *
+ * Each step splits the mini-batch into contiguous shards of
+ * rows, one per thread of the pool (parallel.h). A shard runs
+ * the forward pass, the loss and the backward pass of its rows
+ * on its own buffers and accumulates its own copy of every
+ * weight and bias gradient; no locks, no shared writes. The
+ * shard gradients are then summed into the first shard's, in
+ * shard order and split by element across the pool, and the
+ * optimizer applies one fused update per parameter buffer.
+ *
+ *  - Per layer, the backward pass is two GEMMs: dW = h^T dZ,
+ *    and dH = dZ W^T against a packed copy of W^T, refreshed
+ *    with the forward packing after each update.
+ *  - Shards have at least MLC_TRAIN_SHARD_ROWS rows; smaller
+ *    batches use fewer threads, since a few rows per thread do
+ *    not amortize the gradient reduction.
+ *  - All buffers are allocated by mlc_trainer_init() for up
+ *    to max_batch rows; steps do not allocate.
+ *  - Results do not depend on scheduling, only on the number
+ *    of threads (which sets the shard boundaries).
+ *
+ * Losses, averaged over the batch:
+ *  - MLC_LOSS_MSE: mean of (y - target)^2 over all outputs.
+ *  - MLC_LOSS_CROSS_ENTROPY: -Σ target log y per row, for a
+ *    softmax output layer, or the binary cross-entropy of each
+ *    output for a sigmoid output layer.
+ *
+ * Functions return -1 on invalid input or allocation failure,
+ * and 0 on success; mlc_train_step() returns the loss, or -1.0f
+ * on error.
+ *************************************************************/
+
+#ifndef MLC_TRAIN_SHARD_ROWS
+    #define MLC_TRAIN_SHARD_ROWS 16
+#endif
+
+typedef enum
+{
+    MLC_LOSS_MSE,
+    MLC_LOSS_CROSS_ENTROPY
+}
+MlcLoss;
+
+/* Buffers of one shard, for up to shard_rows rows */
+typedef struct
+{
+    float * outputs[MLC_MLP_MAX_LAYERS];    /* h_l, rows x outputs */
+    float * inputs[MLC_MLP_MAX_LAYERS];     /* z_l = h_(l-1) W_l + b_l, swish layers only */
+    float * delta[2];                       /* dZ / dH, rows x widest */
+    float * transposed;                     /* h_(l-1)^T, inputs x rows */
+    float * grads;                          /* weight and bias gradients of all layers */
+    float * workspace;                      /* GEMM scratch */
+    double loss;                            /* summed loss of the shard's rows */
+}
+MlcTrainShard_;
+
+typedef struct
+{
+    MlcMlp * mlp;
+    MlcOptimizer optimizer;
+    MlcLoss loss;
+    size_t max_batch;
+    size_t shard_count;
+    size_t shard_rows;                      /* rows each shard can hold */
+    size_t grad_size;                       /* floats of gradients per shard */
+    size_t weight_offset[MLC_MLP_MAX_LAYERS];
+    size_t bias_offset[MLC_MLP_MAX_LAYERS];
+    MlcOptimState weight_states[MLC_MLP_MAX_LAYERS];
+    MlcOptimState bias_states[MLC_MLP_MAX_LAYERS];
+    float * packed_t[MLC_MLP_MAX_LAYERS];   /* W_l^T in GEMM panel order */
+    float * transpose;                      /* W_l^T before packing */
+    MlcTrainShard_ * shards;
+    float * memory;                         /* buffers of all shards */
+}
+MlcTrainer;
+
+/* out (cols x rows) = a^T, for a (rows x cols) with row stride lda */
+static inline void
+mlc_train_transpose_(size_t rows, size_t cols, const float * a, size_t lda, float * out)
+{
+    for (size_t i0 = 0; i0 < rows; i0 += 16) {
+        size_t i1 = (rows - i0 < 16) ? rows : i0 + 16;
+
+        for (size_t j = 0; j < cols; ++j) {
+            for (size_t i = i0; i < i1; ++i) {
+                out[j * rows + i] = a[i * lda + j];
+            }
+        }
+    }
+}
+
+/* Packs W^T of every layer for the dH = dZ W^T products */
+static inline void
+mlc_train_pack_transposed_(MlcTrainer * t)
+{
+    for (size_t l = 0; l < t->mlp->count; ++l) {
+        const MlcDense * layer = &t->mlp->layers[l];
+
+        mlc_train_transpose_(layer->inputs, layer->outputs, layer->weights.data,
+                             layer->outputs, t->transpose);
+        mlc_gemm_pack(layer->outputs, layer->inputs, t->transpose, layer->inputs,
+                      t->packed_t[l]);
+    }
+}
+
+static inline void
+mlc_trainer_finish(MlcTrainer * t)
+{
+    if (t == NULL) return;
+    for (size_t l = 0; l < MLC_MLP_MAX_LAYERS; ++l) {
+        mlc_optim_state_finish(&t->weight_states[l]);
+        mlc_optim_state_finish(&t->bias_states[l]);
+        free(t->packed_t[l]);
+        t->packed_t[l] = NULL;
+    }
+    free(t->transpose);
+    free(t->shards);
+    free(t->memory);
+    t->transpose = NULL;
+    t->shards = NULL;
+    t->memory = NULL;
+    t->mlp = NULL;
+}
+
+/**********************************
+ * Sets up training of `mlp` with mini-batches of up to
+ * max_batch rows. The MLP must outlive the trainer and keep its
+ * layers; its weights are updated by mlc_train_step(). Cross-
+ * entropy requires a softmax or sigmoid output layer.
+ **********************************/
+static inline int
+mlc_trainer_init(MlcTrainer * t, MlcMlp * mlp, const MlcOptimizer * opt,
+                 MlcLoss loss, size_t max_batch)
+{
+    if (t == NULL || mlp == NULL || mlp->count == 0 || opt == NULL || max_batch == 0) {
+        LOG_ERROR("Invalid trainer, MLP, optimizer or batch size");
+        return -1;
+    }
+    MlcActivation last = mlp->layers[mlp->count - 1].activation;
+    if (loss == MLC_LOSS_CROSS_ENTROPY && last != MLC_ACT_SOFTMAX && last != MLC_ACT_SIGMOID) {
+        LOG_ERROR("Cross-entropy needs a softmax or sigmoid output layer");
+        return -1;
+    }
+    memset(t, 0, sizeof(*t));
+    t->mlp = mlp;
+    t->optimizer = *opt;
+    t->loss = loss;
+    t->max_batch = max_batch;
+
+    size_t threads = mlc_get_num_threads();
+    size_t shards = (max_batch + MLC_TRAIN_SHARD_ROWS - 1) / MLC_TRAIN_SHARD_ROWS;
+    t->shard_count = (shards < threads) ? shards : threads;
+    t->shard_rows = (max_batch + t->shard_count - 1) / t->shard_count;
+    if (t->shard_rows < MLC_TRAIN_SHARD_ROWS) t->shard_rows = MLC_TRAIN_SHARD_ROWS;
+
+    /* Sizes of the per-shard buffers; each starts 64-byte aligned */
+    size_t rows = t->shard_rows, widest = 0, widest_in = 0, widest_w = 0, scratch = 0;
+    size_t shard_floats = 0;
+
+    for (size_t l = 0; l < mlp->count; ++l) {
+        const MlcDense * layer = &mlp->layers[l];
+        size_t in = layer->inputs, out = layer->outputs;
+        size_t sizes[3];
+
+        t->weight_offset[l] = t->grad_size;
+        t->bias_offset[l] = t->grad_size + in * out;
+        t->grad_size += in * out + out;
+        if (out > widest) widest = out;
+        if (in > widest_in) widest_in = in;
+        if (in * out > widest_w) widest_w = in * out;
+
+        sizes[0] = mlc_gemm_packed_workspace_size(rows, in);    /* forward */
+        sizes[1] = mlc_gemm_packed_workspace_size(rows, out);   /* dH */
+        sizes[2] = mlc_gemm_workspace_size(in, out, rows);      /* dW */
+        for (size_t i = 0; i < 3; ++i) {
+            if (sizes[i] > scratch) scratch = sizes[i];
+        }
+        shard_floats += mlc_gemm_round_up_(rows * out, 16) *
+                        (layer->activation == MLC_ACT_SWISH ? 2 : 1);
+    }
+    shard_floats += 2 * mlc_gemm_round_up_(rows * widest, 16) +
+                    mlc_gemm_round_up_(widest_in * rows, 16) +
+                    mlc_gemm_round_up_(t->grad_size, 16) +
+                    mlc_gemm_round_up_(scratch, 16);
+
+    t->shards = (MlcTrainShard_ *)calloc(t->shard_count, sizeof(MlcTrainShard_));
+    t->memory = (float *)mlc_layers_alloc_(t->shard_count * shard_floats);
+    t->transpose = (float *)mlc_layers_alloc_(widest_w);
+    int failed = (t->shards == NULL || t->memory == NULL || t->transpose == NULL);
+
+    for (size_t l = 0; !failed && l < mlp->count; ++l) {
+        const MlcDense * layer = &mlp->layers[l];
+
+        t->packed_t[l] = (float *)mlc_layers_alloc_(mlc_gemm_packed_size(layer->outputs,
+                                                                          layer->inputs));
+        failed = (t->packed_t[l] == NULL ||
+                  mlc_optim_state_init(&t->weight_states[l], opt, layer->weights.size) != 0 ||
+                  mlc_optim_state_init(&t->bias_states[l], opt, layer->bias.size) != 0);
+    }
+    if (failed) {
+        LOG_ERROR("Memory allocation failed for trainer");
+        mlc_trainer_finish(t);
+        return -1;
+    }
+
+    for (size_t s = 0; s < t->shard_count; ++s) {
+        MlcTrainShard_ * shard = &t->shards[s];
+        float * next = t->memory + s * shard_floats;
+
+        for (size_t l = 0; l < mlp->count; ++l) {
+            size_t size = mlc_gemm_round_up_(rows * mlp->layers[l].outputs, 16);
+
+            shard->outputs[l] = next;
+            next += size;
+            if (mlp->layers[l].activation == MLC_ACT_SWISH) {
+                shard->inputs[l] = next;
+                next += size;
+            }
+        }
+        shard->delta[0] = next;
+        next += mlc_gemm_round_up_(rows * widest, 16);
+        shard->delta[1] = next;
+        next += mlc_gemm_round_up_(rows * widest, 16);
+        shard->transposed = next;
+        next += mlc_gemm_round_up_(widest_in * rows, 16);
+        shard->grads = next;
+        next += mlc_gemm_round_up_(t->grad_size, 16);
+        shard->workspace = next;
+    }
+    mlc_train_pack_transposed_(t);
+    return 0;
+}
+
+/* Forward pass of m rows, keeping every layer's output (and z, for swish) */
+static inline void
+mlc_train_forward_(const MlcTrainer * t, MlcTrainShard_ * shard, size_t m,
+                   const float * x, size_t ldx)
+{
+    for (size_t l = 0; l < t->mlp->count; ++l) {
+        const MlcDense * layer = &t->mlp->layers[l];
+        size_t out = layer->outputs;
+        float * y = shard->outputs[l];
+        MlcGemmEpilogue epilogue;
+
+        epilogue.bias = layer->bias.data;
+        epilogue.activation = (layer->activation == MLC_ACT_SOFTMAX ||
+                               layer->activation == MLC_ACT_SWISH) ? MLC_ACT_NONE
+                                                                   : layer->activation;
+        epilogue.alpha = layer->alpha;
+
+        if (layer->activation == MLC_ACT_SWISH) {
+            mlc_sgemm_packed(m, out, layer->inputs, x, ldx, layer->packed,
+                             shard->inputs[l], out, shard->workspace, &epilogue);
+            memcpy(y, shard->inputs[l], m * out * sizeof(float));
+            mlc_swish_span_(y, m * out);
+        }
+        else {
+            mlc_sgemm_packed(m, out, layer->inputs, x, ldx, layer->packed,
+                             y, out, shard->workspace, &epilogue);
+        }
+        for (size_t i = 0; layer->activation == MLC_ACT_SOFTMAX && i < m; ++i) {
+            mlc_softmax_span_(y + i * out, out);
+        }
+        x = y;
+        ldx = out;
+    }
+}
+
+/* dH of layer l (m rows) times the derivative of its activation: dZ, in place */
+static inline void
+mlc_train_activation_backward_(const MlcDense * layer, const MlcTrainShard_ * shard,
+                               size_t l, size_t m, float * delta)
+{
+    size_t out = layer->outputs;
+    const float * saved = (layer->activation == MLC_ACT_SWISH) ? shard->inputs[l]
+                                                               : shard->outputs[l];
+
+    if (layer->activation == MLC_ACT_SOFTMAX) {
+        for (size_t i = 0; i < m; ++i) {
+            mlc_activation_backward_span_(MLC_ACT_SOFTMAX, 0.0f, saved + i * out,
+                                          delta + i * out, out);
+        }
+    }
+    else {
+        mlc_activation_backward_span_(layer->activation, layer->alpha, saved, delta, m * out);
+    }
+}
+
+/**********************************
+ * Loss of m rows against their targets, and its gradient with
+ * respect to the last layer's pre-activation, dZ, written to
+ * delta[0]. `scale` is 1 / batch (1 / (batch * outputs) for
+ * MSE). Returns the summed, unscaled loss.
+ **********************************/
+static inline double
+mlc_train_loss_(const MlcTrainer * t, MlcTrainShard_ * shard, size_t m,
+                const float * target, float scale)
+{
+    const MlcDense * layer = &t->mlp->layers[t->mlp->count - 1];
+    size_t n = m * layer->outputs;
+    const float * y = shard->outputs[t->mlp->count - 1];
+    float * delta = shard->delta[0];
+    double loss = 0.0;
+
+    if (t->loss == MLC_LOSS_MSE) {
+        for (size_t i = 0; i < n; ++i) {
+            float e = y[i] - target[i];
+
+            loss += (double)e * e;
+            delta[i] = 2.0f * scale * e;
+        }
+        mlc_train_activation_backward_(layer, shard, t->mlp->count - 1, m, delta);
+        return loss;
+    }
+
+    /* Cross-entropy through softmax or sigmoid: dZ = y - target */
+    for (size_t i = 0; i < n; ++i) {
+        float p = (y[i] > FLT_MIN) ? y[i] : FLT_MIN;
+
+        loss -= (double)target[i] * logf(p);
+        if (layer->activation == MLC_ACT_SIGMOID) {
+            float q = (1.0f - y[i] > FLT_MIN) ? 1.0f - y[i] : FLT_MIN;
+
+            loss -= (double)(1.0f - target[i]) * logf(q);
+        }
+        delta[i] = scale * (y[i] - target[i]);
+    }
+    return loss;
+}
+
+/* Backward pass of m rows into the shard's gradients, from dZ of the last layer in delta[0] */
+static inline void
+mlc_train_backward_(const MlcTrainer * t, MlcTrainShard_ * shard, size_t m,
+                    const float * x, size_t ldx)
+{
+    size_t cur = 0;
+
+    for (size_t l = t->mlp->count; l-- > 0;) {
+        const MlcDense * layer = &t->mlp->layers[l];
+        size_t in = layer->inputs, out = layer->outputs;
+        const float * h = (l > 0) ? shard->outputs[l - 1] : x;
+        size_t ldh = (l > 0) ? in : ldx;
+        float * dz = shard->delta[cur];
+        float * dw = shard->grads + t->weight_offset[l];
+        float * db = shard->grads + t->bias_offset[l];
+
+        /* dW = h^T dZ */
+        mlc_train_transpose_(m, in, h, ldh, shard->transposed);
+        mlc_sgemm(in, out, m, shard->transposed, m, dz, out, dw, out, shard->workspace);
+
+        /* db = column sums of dZ */
+        memcpy(db, dz, out * sizeof(float));
+        for (size_t i = 1; i < m; ++i) {
+            mlc_add_span_(db, dz + i * out, db, out);
+        }
+        if (l == 0) break;
+
+        /* dH = dZ W^T, then through the previous layer's activation */
+        float * dh = shard->delta[cur ^ 1];
+        mlc_sgemm_packed(m, in, out, dz, out, t->packed_t[l], dh, in, shard->workspace, NULL);
+        mlc_train_activation_backward_(&t->mlp->layers[l - 1], shard, l - 1, m, dh);
+        cur ^= 1;
+    }
+}
+
+typedef struct
+{
+    MlcTrainer * trainer;
+    const float * input;
+    size_t ldx;
+    const float * target;
+    size_t batch;
+    size_t rows;                /* rows per shard in this step */
+    size_t used;                /* shards in this step */
+    float scale;
+}
+MlcTrainJob_;
+
+/* Shards [begin, end): forward, loss and backward of their rows */
+static inline void
+mlc_train_shard_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcTrainJob_ * job = (const MlcTrainJob_ *)ctx;
+    const MlcTrainer * t = job->trainer;
+    size_t outputs = t->mlp->layers[t->mlp->count - 1].outputs;
+    (void)part;
+
+    for (size_t s = begin; s < end; ++s) {
+        MlcTrainShard_ * shard = &t->shards[s];
+        size_t row = s * job->rows;
+        size_t m = (job->batch - row < job->rows) ? job->batch - row : job->rows;
+        const float * x = job->input + row * job->ldx;
+
+        mlc_train_forward_(t, shard, m, x, job->ldx);
+        shard->loss = mlc_train_loss_(t, shard, m, job->target + row * outputs, job->scale);
+        mlc_train_backward_(t, shard, m, x, job->ldx);
+    }
+}
+
+/* Gradient elements [begin, end): sum of every shard into shard 0, in shard order */
+static inline void
+mlc_train_reduce_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    const MlcTrainJob_ * job = (const MlcTrainJob_ *)ctx;
+    const MlcTrainShard_ * shards = job->trainer->shards;
+    float * sum = shards[0].grads + begin;
+    (void)part;
+
+    for (size_t s = 1; s < job->used; ++s) {
+        mlc_add_span_(sum, shards[s].grads + begin, sum, end - begin);
+    }
+}
+
+/**********************************
+ * Mathematical synopsis of a training step:
+ *
+ * y = mlp(input),  L = loss(y, target)
+ * W_l, b_l = update(W_l, b_l, dL/dW_l, dL/db_l)   for each layer
+ *
+ * Shapes: input as for mlc_mlp_forward() (batch x inputs, or a
+ * vector for a batch of one), batch <= max_batch; target holds
+ * batch x outputs values (any ndims, contiguous).
+ * Returns the mean loss of the batch before the update, or
+ * -1.0f on error.
+ **********************************/
+static inline float
+mlc_train_step(MlcTrainer * t, MlcArray * input, MlcArray * target)
+{
+    if (t == NULL || t->mlp == NULL ||
+        check_inputs(input) != 0 ||
+        check_inputs(target) != 0 ||
+        !(input->ndims == 2 ? mlc_matrix_rows_ok_(input) : mlc_is_direct_(input)) ||
+        !mlc_is_direct_(target)
+        ) {
+        LOG_ERROR("Invalid trainer, input or target");
+        return -1.0f;
+    }
+    MlcMlp * mlp = t->mlp;
+    size_t inputs = mlp->layers[0].inputs;
+    size_t outputs = mlp->layers[mlp->count - 1].outputs;
+    size_t batch = (input->ndims == 2) ? input->shape[0] : 1;
+
+    if ((input->ndims == 2 ? input->shape[1] : input->size) != inputs ||
+        target->size != batch * outputs || batch > t->max_batch) {
+        LOG_ERROR("Mismatched input or target shape, or batch larger than max_batch");
+        return -1.0f;
+    }
+    MLC_PROFILE_BEGIN("mlc_train_step");
+
+    MlcTrainJob_ job;
+    job.trainer = t;
+    job.input = input->data;
+    job.ldx = (input->ndims == 2) ? mlc_stride_(input, 0) : inputs;
+    job.target = target->data;
+    job.batch = batch;
+    job.rows = (batch + t->shard_count - 1) / t->shard_count;
+    if (job.rows < MLC_TRAIN_SHARD_ROWS) job.rows = MLC_TRAIN_SHARD_ROWS;
+    job.used = (batch + job.rows - 1) / job.rows;
+    job.scale = 1.0f / (float)(t->loss == MLC_LOSS_MSE ? batch * outputs : batch);
+
+    mlc_parallel_for(job.used, 1, mlc_train_shard_range_, &job);
+    if (job.used > 1) {
+        mlc_parallel_for(t->grad_size, mlc_parallel_grain(job.used), mlc_train_reduce_range_, &job);
+    }
+
+    double loss = 0.0;
+    for (size_t s = 0; s < job.used; ++s) {
+        loss += t->shards[s].loss;
+    }
+
+    /* Update, then refresh both packed copies of the weights */
+    const float * grads = t->shards[0].grads;
+    for (size_t l = 0; l < mlp->count; ++l) {
+        MlcDense * layer = &mlp->layers[l];
+
+        mlc_optim_apply_(&t->optimizer, &t->weight_states[l], layer->weights.data,
+                         grads + t->weight_offset[l], layer->weights.size);
+        mlc_optim_apply_(&t->optimizer, &t->bias_states[l], layer->bias.data,
+                         grads + t->bias_offset[l], layer->bias.size);
+        mlc_dense_pack(layer);
+    }
+    mlc_train_pack_transposed_(t);
+
+    MLC_PROFILE_END(batch * inputs, (t->grad_size * job.used + batch * (inputs + outputs)) *
+                                    sizeof(float));
+    return (float)(loss * job.scale);
+}
+
+#endif /* MLC_TRAIN_H */
@@ -5,6 +5,10 @@
 
 #include <stddef.h>
 #include <mlc/data.h>
+#include <mlc/simd_math.h>
+#include <mlc/dispatch.h>
+#include <mlc/parallel.h>
+#include <mlc/view.h>
 #include <mlc/config.h>
 
 /*************************************************************
@@ -23,8 +27,158 @@
  * Functions return -1 (or -1.0f for dot product) if an input 
  * array is NULL or its size is 0. Otherwise, they return 0 upon 
  * successful completion.
+ *
+ * Large arrays are split across the thread pool (parallel.h);
+ * vector_dot combines per-thread partial sums in a fixed order.
+ * Operands may be strided views (view.h) as long as every
+ * non-contiguous operand has the same shape as the others, and
+ * each may be stored as fp32, fp16 or bf16 (the arithmetic is
+ * fp32 either way).
  *************************************************************/
 
+/* Span kernels (kernels.h): out[i] = a[i] op b[i] for i < n */
+typedef enum
+{
+    MLC_VEC_ADD,
+    MLC_VEC_SUB,
+    MLC_VEC_SCALE,
+    MLC_VEC_DOT
+}
+MlcVectorOp_;
+
+typedef struct
+{
+    MlcVectorOp_ op;
+    const MlcArray * a;
+    const MlcArray * b;
+    const MlcArray * out;
+    float k;
+    float partial[MLC_MAX_THREADS];
+}
+MlcVectorJob_;
+
+/* Applies the job's op to n contiguous elements; returns the dot partial */
+static inline float
+mlc_vector_apply_(const MlcVectorJob_ * job, const float * a, const float * b, float * out, size_t n)
+{
+    switch (job->op)
+    {
+        case MLC_VEC_ADD:
+            mlc_add_span_(a, b, out, n);
+            break;
+        case MLC_VEC_SUB:
+            mlc_sub_span_(a, b, out, n);
+            break;
+        case MLC_VEC_SCALE:
+            mlc_scale_into_span_(a, job->k, out, n);
+            break;
+        case MLC_VEC_DOT:
+            return mlc_dot_span_(a, b, n);
+    }
+    return 0.0f;
+}
+
+static inline void
+mlc_vector_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcVectorJob_ * job = (MlcVectorJob_ *)ctx;
+
+    job->partial[part] = mlc_vector_apply_(job, job->a->data + begin,
+                                           job->b ? job->b->data + begin : NULL,
+                                           job->out ? job->out->data + begin : NULL,
+                                           end - begin);
+}
+
+/**********************************
+ * Strided path, also taken when an operand is fp16/bf16: the
+ * operands are walked run by run (a run ends with the shortest
+ * last-dimension row among them). Runs that are unit-stride
+ * fp32 everywhere go straight to the span kernels; others are
+ * loaded into fp32 tiles first and the output is stored back.
+ **********************************/
+static inline void
+mlc_vector_strided_range_(void * ctx, size_t begin, size_t end, size_t part)
+{
+    MlcVectorJob_ * job = (MlcVectorJob_ *)ctx;
+    float a_tile[MLC_VIEW_TILE], b_tile[MLC_VIEW_TILE], out_tile[MLC_VIEW_TILE];
+    float sum = 0.0f;
+
+    for (size_t pos = begin; pos < end;) {
+        size_t n, m, a_stride, b_stride = 1, out_stride = 1;
+        const float * a = mlc_view_run_(job->a, pos, end, &n, &a_stride);
+        const float * b = NULL;
+        float * out = NULL;
+        int direct = (a_stride == 1 && job->a->dtype == MLC_DTYPE_F32);
+
+        if (job->b) {
+            b = mlc_view_run_(job->b, pos, end, &m, &b_stride);
+            n = (m < n) ? m : n;
+            direct = direct && b_stride == 1 && job->b->dtype == MLC_DTYPE_F32;
+        }
+        if (job->out) {
+            out = mlc_view_run_(job->out, pos, end, &m, &out_stride);
+            n = (m < n) ? m : n;
+            direct = direct && out_stride == 1 && job->out->dtype == MLC_DTYPE_F32;
+        }
+
+        if (direct) {
+            sum += mlc_vector_apply_(job, a, b, out, n);
+        }
+        else {
+            for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+                m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+
+                mlc_view_load_(job->a, mlc_view_advance_(job->a, a, i * a_stride), m, a_stride, a_tile);
+                if (b) {
+                    mlc_view_load_(job->b, mlc_view_advance_(job->b, b, i * b_stride), m, b_stride, b_tile);
+                }
+                sum += mlc_vector_apply_(job, a_tile, b_tile, out_tile, m);
+                if (out) {
+                    mlc_view_store_(job->out, mlc_view_advance_(job->out, out, i * out_stride),
+                                    m, out_stride, out_tile);
+                }
+            }
+        }
+        pos += n;
+    }
+    job->partial[part] = sum;
+}
+
+/* Runs op over a (and b, out when not NULL); returns the dot product for MLC_VEC_DOT */
+static inline float
+mlc_vector_run_(MlcVectorOp_ op, const MlcArray * a, const MlcArray * b, float k, const MlcArray * out)
+{
+    MlcVectorJob_ job;
+    int contiguous = mlc_is_direct_(a) &&
+                     (b == NULL || mlc_is_direct_(b)) &&
+                     (out == NULL || mlc_is_direct_(out));
+    float sum = 0.0f;
+
+    job.op = op;
+    job.a = a;
+    job.b = b;
+    job.out = out;
+    job.k = k;
+    for (size_t t = 0; t < MLC_MAX_THREADS; ++t) {
+        job.partial[t] = 0.0f;
+    }
+    mlc_parallel_for(a->size, mlc_parallel_grain(1),
+                     contiguous ? mlc_vector_range_ : mlc_vector_strided_range_, &job);
+
+    for (size_t t = 0; op == MLC_VEC_DOT && t < MLC_MAX_THREADS; ++t) {
+        sum += job.partial[t];
+    }
+    return sum;
+}
+
+/* Strided operands are paired by position, so their shapes must match */
+static inline int
+mlc_vector_shapes_ok_(const MlcArray * a, const MlcArray * b)
+{
+    if (mlc_is_contiguous(a) && mlc_is_contiguous(b)) return 1;
+    return mlc_same_shape_(a, b);
+}
+
 /**********************************
  * Mathematical synopsis of vector addition:
  * 
@@ -38,15 +192,17 @@ vector_add(MlcArray * a, MlcArray * b, MlcArray * result)
         check_inputs(b) != 0 || 
         check_inputs(result) != 0 ||
         a->size != b->size || 
-        a->size != result->size
+        a->size != result->size ||
+        !mlc_vector_shapes_ok_(a, b) ||
+        !mlc_vector_shapes_ok_(a, result)
         ) {
         LOG_ERROR("Invalid or mismatched array sizes");
         return -1;
     }
 
-    for (size_t i = 0; i < a->size; ++i) {
-        result->data[i] = a->data[i] + b->data[i];
-    }
+    MLC_PROFILE_BEGIN("vector_add");
+    mlc_vector_run_(MLC_VEC_ADD, a, b, 0.0f, result);
+    MLC_PROFILE_END(a->size, 3 * a->size * sizeof(float));
     return 0;
 }
 
@@ -63,15 +219,17 @@ vector_sub(MlcArray * a, MlcArray * b, MlcArray * result)
         check_inputs(b) != 0 || 
         check_inputs(result) != 0 ||
         a->size != b->size || 
-        a->size != result->size
+        a->size != result->size ||
+        !mlc_vector_shapes_ok_(a, b) ||
+        !mlc_vector_shapes_ok_(a, result)
         ) {
         LOG_ERROR("Invalid or mismatched array sizes");
         return -1;
     }
 
-    for (size_t i = 0; i < a->size; ++i) {
-        result->data[i] = a->data[i] - b->data[i];
-    }
+    MLC_PROFILE_BEGIN("vector_sub");
+    mlc_vector_run_(MLC_VEC_SUB, a, b, 0.0f, result);
+    MLC_PROFILE_END(a->size, 3 * a->size * sizeof(float));
     return 0;
 }
 
@@ -87,17 +245,17 @@ vector_dot(MlcArray * a, MlcArray * b)
 {
     if (check_inputs(a) != 0 || 
         check_inputs(b) != 0 || 
-        a->size != b->size
+        a->size != b->size ||
+        !mlc_vector_shapes_ok_(a, b)
         ) {
         LOG_ERROR("Invalid or mismatched array sizes");
         return -1.0f;
     }
 
-    float sum = 0.0f;
-    for (size_t i = 0; i < a->size; ++i) {
-        sum += (a->data[i] * b->data[i]);
-    }
-    return sum;
+    MLC_PROFILE_BEGIN("vector_dot");
+    float dot = mlc_vector_run_(MLC_VEC_DOT, a, b, 0.0f, NULL);
+    MLC_PROFILE_END(a->size, 2 * a->size * sizeof(float));
+    return dot;
 }
 
 /**********************************
@@ -111,15 +269,16 @@ vector_scale(MlcArray * a, float k, MlcArray * result)
 {
     if (check_inputs(a) != 0 || 
         check_inputs(result) != 0 || 
-        a->size != result->size
+        a->size != result->size ||
+        !mlc_vector_shapes_ok_(a, result)
         ) {
         LOG_ERROR("Invalid or mismatched array sizes");
         return -1;
     }
 
-    for (size_t i = 0; i < a->size; ++i) {
-        result->data[i] = k * a->data[i];
-    }
+    MLC_PROFILE_BEGIN("vector_scale");
+    mlc_vector_run_(MLC_VEC_SCALE, a, NULL, k, result);
+    MLC_PROFILE_END(a->size, 2 * a->size * sizeof(float));
     return 0;
 }
 
@@ -0,0 +1,407 @@
+/* include/mlc/view.h */
+
+#ifndef MLC_VIEW_H
+#define MLC_VIEW_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mlc/data.h>
+#include <mlc/config.h>
+
+/*************************************************************
+ * Strided views:
+ *
+ * A view is an MlcArray that looks at another array's data
+ * without copying it. Its storage is MLC_STORAGE_VIEW, so
+ * mlc_finish() frees only the view's own shape; the viewed
+ * array must outlive it. Element (i0, i1, ...) of an array
+ * lives at
+ *
+ *   data[i0 * strides[0] + i1 * strides[1] + ...]
+ *
+ * and strides = NULL means contiguous row-major data, which is
+ * what every array that is not a view has. Creating a view is
+ * O(ndims), whatever the size of the data:
+ *
+ *  - mlc_view_rows(): rows [begin, begin + count) along the
+ *    first dimension (a mini-batch of a dataset). Stays
+ *    contiguous if the source is.
+ *  - mlc_reshape(): same data, new shape (contiguous only).
+ *  - mlc_transpose_view(): dimensions reversed; for a matrix,
+ *    rows and columns swapped.
+ *
+ * The element-wise kernels (activations.h, vector.h, pipeline.h)
+ * take their usual path on contiguous fp32 arrays and a strided
+ * path otherwise (also used for fp16/bf16 arrays, converted a
+ * tile at a time); strided vector operands must have the same
+ * shape. Matrix kernels accept fp32 views whose rows are
+ * contiguous. mlc_contiguous() copies any view into a new heap
+ * array, and mlc_cast() does the same with another dtype.
+ *
+ * Functions return an MlcArray with data = NULL on error.
+ *************************************************************/
+
+#ifndef MLC_VIEW_TILE
+    #define MLC_VIEW_TILE 256    /* floats gathered per strided run */
+#endif
+
+/* Step between consecutive elements of dimension d */
+static inline size_t
+mlc_stride_(const MlcArray * array, size_t d)
+{
+    if (array->strides != NULL) return array->strides[d];
+
+    size_t stride = 1;
+    for (size_t i = d + 1; i < array->ndims; ++i) {
+        stride *= array->shape[i];
+    }
+    return stride;
+}
+
+/* Returns 1 if the data is laid out contiguously in row-major order. */
+static inline int
+mlc_is_contiguous(const MlcArray * array)
+{
+    if (array->strides == NULL) return 1;
+
+    size_t expected = 1;
+    for (size_t d = array->ndims; d-- > 0;) {
+        if (array->shape[d] != 1 && array->strides[d] != expected) return 0;
+        expected *= array->shape[d];
+    }
+    return 1;
+}
+
+/* Returns 1 if kernels can work on the data directly: contiguous fp32 */
+static inline int
+mlc_is_direct_(const MlcArray * array)
+{
+    return array->dtype == MLC_DTYPE_F32 && mlc_is_contiguous(array);
+}
+
+/* Empty view of `ndims` dimensions over `data`, shape and strides in one block */
+static inline MlcArray
+mlc_view_alloc_(float * data, size_t ndims, size_t size, MlcDtype dtype)
+{
+    MlcArray result = {NULL, ndims, NULL, 0, MLC_STORAGE_VIEW, NULL, 0, NULL, dtype};
+    size_t * block = (size_t *)malloc(2 * ndims * sizeof(size_t));
+
+    if (block == NULL) {
+        LOG_ERROR("Memory allocation failed for view shape");
+        result.storage = MLC_STORAGE_HEAP;
+        return result;
+    }
+    result.data = data;
+    result.shape = block;
+    result.strides = block + ndims;
+    result.size = size;
+    return result;
+}
+
+/* Drops the strides of a view that turned out contiguous */
+static inline void
+mlc_view_normalize_(MlcArray * view)
+{
+    if (view->data != NULL && mlc_is_contiguous(view)) {
+        view->strides = NULL;
+    }
+}
+
+static inline int
+mlc_view_check_(const MlcArray * array)
+{
+    if (array == NULL || array->data == NULL || array->size == 0 ||
+        array->ndims == 0 || array->shape == NULL) {
+        LOG_ERROR("Invalid array for view");
+        return -1;
+    }
+    return 0;
+}
+
+/**********************************
+ * View of the whole array (e.g. to hand out a non-owning
+ * reference). The result is contiguous if the array is.
+ **********************************/
+static inline MlcArray
+mlc_view(const MlcArray * array)
+{
+    if (mlc_view_check_(array) != 0) {
+        MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+        return result;
+    }
+    MlcArray result = mlc_view_alloc_(array->data, array->ndims, array->size, array->dtype);
+
+    for (size_t d = 0; result.data != NULL && d < array->ndims; ++d) {
+        result.shape[d] = array->shape[d];
+        result.strides[d] = mlc_stride_(array, d);
+    }
+    mlc_view_normalize_(&result);
+    return result;
+}
+
+/**********************************
+ * View of rows [begin, begin + count) along the first
+ * dimension.
+ *
+ * Arguments:
+ *  - array: Array or view to slice.
+ *  - begin: First row.
+ *  - count: Number of rows (begin + count <= shape[0]).
+ **********************************/
+static inline MlcArray
+mlc_view_rows(const MlcArray * array, size_t begin, size_t count)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (mlc_view_check_(array) != 0) return result;
+    if (count == 0 || begin + count > array->shape[0] || begin + count < begin) {
+        LOG_ERROR("Row range out of bounds");
+        return result;
+    }
+    size_t row_size = array->size / array->shape[0];
+
+    result = mlc_view_alloc_(mlc_element_(array, begin * mlc_stride_(array, 0)),
+                             array->ndims, count * row_size, array->dtype);
+    for (size_t d = 0; result.data != NULL && d < array->ndims; ++d) {
+        result.shape[d] = (d == 0) ? count : array->shape[d];
+        result.strides[d] = mlc_stride_(array, d);
+    }
+    mlc_view_normalize_(&result);
+    return result;
+}
+
+/**********************************
+ * View of the same data with a new shape, which must have the
+ * same number of elements. The array must be contiguous; use
+ * mlc_contiguous() first to reshape a strided view.
+ **********************************/
+static inline MlcArray
+mlc_reshape(const MlcArray * array, size_t ndims, const size_t * shape)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+    size_t size = 1;
+
+    if (mlc_view_check_(array) != 0) return result;
+    if (ndims == 0 || shape == NULL || !mlc_is_contiguous(array)) {
+        LOG_ERROR("Invalid shape, or array not contiguous");
+        return result;
+    }
+    for (size_t d = 0; d < ndims; ++d) {
+        size *= shape[d];
+    }
+    if (size != array->size) {
+        LOG_ERROR("Reshape must keep the number of elements");
+        return result;
+    }
+    result = mlc_view_alloc_(array->data, ndims, size, array->dtype);
+    if (result.data != NULL) {
+        memcpy(result.shape, shape, ndims * sizeof(size_t));
+        result.strides = NULL;
+    }
+    return result;
+}
+
+/**********************************
+ * View with the order of the dimensions reversed: the
+ * transpose of a matrix, (d0, d1, d2) -> (d2, d1, d0) in
+ * general. No data is moved; the result is strided.
+ **********************************/
+static inline MlcArray
+mlc_transpose_view(const MlcArray * array)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (mlc_view_check_(array) != 0) return result;
+
+    result = mlc_view_alloc_(array->data, array->ndims, array->size, array->dtype);
+    for (size_t d = 0; result.data != NULL && d < array->ndims; ++d) {
+        size_t src = array->ndims - 1 - d;
+        result.shape[d] = array->shape[src];
+        result.strides[d] = mlc_stride_(array, src);
+    }
+    mlc_view_normalize_(&result);
+    return result;
+}
+
+/**********************************
+ * Strided traversal: logical (row-major) position `pos` of the
+ * array lives at the returned pointer. *n receives the number
+ * of elements from pos to the end of its last-dimension row,
+ * capped at `limit - pos`, and *stride their spacing. For
+ * fp16/bf16 arrays the pointer is to uint16_t elements.
+ **********************************/
+static inline float *
+mlc_view_run_(const MlcArray * array, size_t pos, size_t limit, size_t * n, size_t * stride)
+{
+    size_t last = array->ndims - 1;
+    size_t row_len = array->shape[last];
+    size_t row = pos / row_len;
+    size_t col = pos % row_len;
+    size_t offset = col * mlc_stride_(array, last);
+
+    for (size_t d = last; d-- > 0;) {
+        offset += (row % array->shape[d]) * mlc_stride_(array, d);
+        row /= array->shape[d];
+    }
+    *n = (row_len - col < limit - pos) ? row_len - col : limit - pos;
+    *stride = mlc_stride_(array, last);
+    return mlc_element_(array, offset);
+}
+
+/* Copies n elements spaced by stride into dst, and back */
+static inline void
+mlc_view_gather_(float * dst, const float * src, size_t n, size_t stride)
+{
+    for (size_t i = 0; i < n; ++i) dst[i] = src[i * stride];
+}
+
+static inline void
+mlc_view_scatter_(float * dst, const float * src, size_t n, size_t stride)
+{
+    for (size_t i = 0; i < n; ++i) dst[i * stride] = src[i];
+}
+
+/* x (from mlc_view_run_()) advanced by k elements of the array's dtype */
+static inline float *
+mlc_view_advance_(const MlcArray * array, const float * x, size_t k)
+{
+    return (float *)((const char *)x + k * mlc_dtype_size(array->dtype));
+}
+
+/**********************************
+ * Same for elements of the array's dtype: loads n elements at
+ * x (from mlc_view_run_()) as floats into dst, and rounds n
+ * floats back into x.
+ **********************************/
+static inline void
+mlc_view_load_(const MlcArray * array, const float * x, size_t n, size_t stride, float * dst)
+{
+    const uint16_t * h = (const uint16_t *)x;
+
+    switch (array->dtype)
+    {
+        case MLC_DTYPE_F32:
+            mlc_view_gather_(dst, x, n, stride);
+            break;
+        case MLC_DTYPE_F16:
+            if (stride == 1) {
+                mlc_f16_to_f32_span_(h, dst, n);
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) dst[i] = mlc_f16_to_f32(h[i * stride]);
+            break;
+        case MLC_DTYPE_BF16:
+            if (stride == 1) {
+                mlc_bf16_to_f32_span_(h, dst, n);
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) dst[i] = mlc_bf16_to_f32(h[i * stride]);
+            break;
+    }
+}
+
+static inline void
+mlc_view_store_(const MlcArray * array, float * x, size_t n, size_t stride, const float * src)
+{
+    uint16_t * h = (uint16_t *)x;
+
+    switch (array->dtype)
+    {
+        case MLC_DTYPE_F32:
+            mlc_view_scatter_(x, src, n, stride);
+            break;
+        case MLC_DTYPE_F16:
+            if (stride == 1) {
+                mlc_f32_to_f16_span_(src, h, n);
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) h[i * stride] = mlc_f32_to_f16(src[i]);
+            break;
+        case MLC_DTYPE_BF16:
+            if (stride == 1) {
+                mlc_f32_to_bf16_span_(src, h, n);
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) h[i * stride] = mlc_f32_to_bf16(src[i]);
+            break;
+    }
+}
+
+/* Returns 1 if both arrays have the same ndims and shape. */
+static inline int
+mlc_same_shape_(const MlcArray * a, const MlcArray * b)
+{
+    if (a->ndims != b->ndims) return 0;
+    for (size_t d = 0; d < a->ndims; ++d) {
+        if (a->shape[d] != b->shape[d]) return 0;
+    }
+    return 1;
+}
+
+/**********************************
+ * Copies an array or view into a new contiguous heap array of
+ * the same shape, stored as `dtype` (values are rounded when
+ * narrowing to fp16/bf16).
+ **********************************/
+static inline MlcArray
+mlc_cast(const MlcArray * array, MlcDtype dtype)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, dtype};
+    float tile[MLC_VIEW_TILE];
+
+    if (mlc_view_check_(array) != 0) return result;
+
+    result.data = (float *)malloc(array->size * mlc_dtype_size(dtype));
+    result.shape = (size_t *)malloc(array->ndims * sizeof(size_t));
+    if (result.data == NULL || result.shape == NULL) {
+        LOG_ERROR("Memory allocation failed");
+        free(result.data);
+        free(result.shape);
+        result.data = NULL;
+        result.shape = NULL;
+        return result;
+    }
+    memcpy(result.shape, array->shape, array->ndims * sizeof(size_t));
+    result.ndims = array->ndims;
+    result.size = array->size;
+
+    for (size_t pos = 0; pos < array->size;) {
+        size_t n, stride;
+        const float * src = mlc_view_run_(array, pos, array->size, &n, &stride);
+
+        if (dtype == MLC_DTYPE_F32) {
+            mlc_view_load_(array, src, n, stride, result.data + pos);
+        }
+        else if (dtype == array->dtype) {
+            const uint16_t * h = (const uint16_t *)src;
+            uint16_t * dst = (uint16_t *)result.data + pos;
+            for (size_t i = 0; i < n; ++i) dst[i] = h[i * stride];
+        }
+        else {
+            for (size_t i = 0; i < n; i += MLC_VIEW_TILE) {
+                size_t m = (n - i < MLC_VIEW_TILE) ? n - i : MLC_VIEW_TILE;
+
+                mlc_view_load_(array, mlc_view_advance_(array, src, i * stride), m, stride, tile);
+                mlc_view_store_(&result, mlc_element_(&result, pos + i), m, 1, tile);
+            }
+        }
+        pos += n;
+    }
+    return result;
+}
+
+/**********************************
+ * Copies an array or view into a new contiguous heap array of
+ * the same shape and dtype.
+ **********************************/
+static inline MlcArray
+mlc_contiguous(const MlcArray * array)
+{
+    MlcArray result = {NULL, 0, NULL, 0, MLC_STORAGE_HEAP, NULL, 0, NULL, MLC_DTYPE_F32};
+
+    if (mlc_view_check_(array) != 0) return result;
+    return mlc_cast(array, array->dtype);
+}
+
+#endif /* MLC_VIEW_H */